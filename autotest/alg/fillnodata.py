@@ -0,0 +1,105 @@
+#!/usr/bin/env python
+###############################################################################
+# $Id$
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  Test FillNodata() algorithm.
+#
+###############################################################################
+# Copyright (c) 2018, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+import random
+import sys
+
+sys.path.append( '../pymod' )
+
+import gdaltest
+
+from osgeo import gdal
+
+###############################################################################
+# Build a Byte raster with a few holes of various sizes.
+
+def fillnodata_create_ds(nXSize, nYSize, nNoData):
+
+    random.seed(1)
+    drv = gdal.GetDriverByName('MEM')
+    ds = drv.Create('', nXSize, nYSize, 1)
+    band = ds.GetRasterBand(1)
+    band.SetNoDataValue(nNoData)
+
+    data = bytearray(nXSize * nYSize)
+    for i in range(nXSize * nYSize):
+        data[i] = 1 + random.randint(0, 200)
+    for i in range(40):
+        x0 = random.randint(0, nXSize - 1)
+        y0 = random.randint(0, nYSize - 1)
+        w = random.randint(1, 30)
+        h = random.randint(1, 30)
+        for y in range(y0, min(y0 + h, nYSize)):
+            for x in range(x0, min(x0 + w, nXSize)):
+                data[y * nXSize + x] = nNoData
+
+    band.WriteRaster(0, 0, nXSize, nYSize, bytes(data))
+    return ds
+
+###############################################################################
+# Check that the tiled multi-threaded implementation gives the same result
+# as the single threaded one.
+
+def fillnodata_1():
+
+    for (max_dist, smoothing) in [ (5, 0), (20, 0), (100, 0), (20, 2) ]:
+        ref_ds = fillnodata_create_ds(300, 700, 255)
+        gdal.FillNodata(ref_ds.GetRasterBand(1), None, max_dist, smoothing,
+                        ['NUM_THREADS=1'])
+        ref_data = ref_ds.GetRasterBand(1).ReadRaster()
+
+        ds = fillnodata_create_ds(300, 700, 255)
+        gdal.FillNodata(ds.GetRasterBand(1), None, max_dist, smoothing,
+                        ['NUM_THREADS=4'])
+        data = ds.GetRasterBand(1).ReadRaster()
+
+        if data != ref_data:
+            gdaltest.post_reason('fail')
+            print(max_dist, smoothing)
+            return 'fail'
+
+        if ds.GetRasterBand(1).Checksum() == \
+           fillnodata_create_ds(300, 700, 255).GetRasterBand(1).Checksum():
+            gdaltest.post_reason('fail')
+            print('nothing filled')
+            return 'fail'
+
+    return 'success'
+
+gdaltest_list = [
+    fillnodata_1
+    ]
+
+if __name__ == '__main__':
+
+    gdaltest.setup_run( 'fillnodata' )
+
+    gdaltest.run_tests( gdaltest_list )
+
+    gdaltest.summarize()
@@ -29,6 +29,7 @@
 #include <cpl_error.h>
 #include <cpl_hash_set.h>
 #include <cpl_list.h>
+#include <cpl_multiproc.h>
 #include <cpl_sha256.h>
 #include <cpl_string.h>
 #include "cpl_safemaths.hpp"
@@ -1893,4 +1894,162 @@ namespace tut
             ensure( !oParser.GetException().empty() );
         }
     }
+
+/************************************************************************/
+/*                         CPLConfigOptionCache                         */
+/************************************************************************/
+    template<>
+    template<>
+    void object::test<30>()
+    {
+        CPLConfigOptionCache oCache("FOOFOO_CACHED", "DEFAULT");
+        ensure_equals( oCache.Get(), "DEFAULT" );
+        ensure( !oCache.GetBool() );
+        CPLSetConfigOption("FOOFOO_CACHED", "YES");
+        ensure_equals( oCache.Get(), "YES" );
+        ensure( oCache.GetBool() );
+        CPLSetThreadLocalConfigOption("FOOFOO_CACHED", "BAR");
+        ensure_equals( oCache.Get(), "BAR" );
+        CPLSetThreadLocalConfigOption("FOOFOO_CACHED", NULL);
+        ensure_equals( oCache.Get(), "YES" );
+        CPLSetConfigOption("FOOFOO_CACHED", NULL);
+        ensure_equals( oCache.Get(), "DEFAULT" );
+
+        CPLConfigOptionCache oCacheNoDefault("FOOFOO_CACHED", NULL);
+        ensure( oCacheNoDefault.Get() == NULL );
+        ensure( !oCacheNoDefault.GetBool() );
+    }
+
+/************************************************************************/
+/*              Config options read while being modified                */
+/************************************************************************/
+
+    struct TestConfigOptionsReaderArgs
+    {
+        volatile bool bStop;
+        volatile bool bError;
+        int           nReads;
+    };
+
+    static void TestConfigOptionsReader( void* pData )
+    {
+        TestConfigOptionsReaderArgs* psArgs =
+            static_cast<TestConfigOptionsReaderArgs*>(pData);
+        while( !psArgs->bStop )
+        {
+            // The writer never changes this option, but replaces the list
+            // holding it.
+            const char* pszVal = CPLGetConfigOption("FOOFOO_MT_STABLE", NULL);
+            if( pszVal == NULL || strcmp(pszVal, "STABLE") != 0 )
+                psArgs->bError = true;
+            // Values of changing options must not be dereferenced.
+            CPL_IGNORE_RET_VAL(CPLGetConfigOption("FOOFOO_MT_CHANGING", NULL));
+            psArgs->nReads ++;
+        }
+    }
+
+    template<>
+    template<>
+    void object::test<31>()
+    {
+        CPLSetConfigOption("FOOFOO_MT_STABLE", "STABLE");
+
+        const int nReaders = 4;
+        TestConfigOptionsReaderArgs asArgs[nReaders];
+        CPLJoinableThread* apThreads[nReaders];
+        for( int i = 0; i < nReaders; i++ )
+        {
+            asArgs[i].bStop = false;
+            asArgs[i].bError = false;
+            asArgs[i].nReads = 0;
+            apThreads[i] =
+                CPLCreateJoinableThread(TestConfigOptionsReader, &asArgs[i]);
+            ensure( apThreads[i] != NULL );
+        }
+
+        // Each change retires the previous list, and more changes are done
+        // than the number of retired pointers kept before waiting for the
+        // readers.
+        for( int i = 0; i < 20000; i++ )
+        {
+            CPLSetConfigOption("FOOFOO_MT_CHANGING", CPLSPrintf("VALUE_%d", i));
+            if( (i % 3) == 0 )
+                CPLSetConfigOption("FOOFOO_MT_CHANGING", NULL);
+        }
+
+        for( int i = 0; i < nReaders; i++ )
+        {
+            asArgs[i].bStop = true;
+            CPLJoinThread(apThreads[i]);
+            ensure( !asArgs[i].bError );
+        }
+        ensure_equals( CPLGetConfigOption("FOOFOO_MT_CHANGING", NULL),
+                       std::string("VALUE_19999") );
+
+        CPLSetConfigOption("FOOFOO_MT_CHANGING", NULL);
+        CPLSetConfigOption("FOOFOO_MT_STABLE", NULL);
+    }
+
+    // Test CPLFormatDoubleFast() against CPLsnprintf() and the CPLStrtod()
+    // fast path against strtod()
+    template<>
+    template<>
+    void object::test<32>()
+    {
+        const double adfValues[] = {
+            0.0, -0.0, 1.0, -1.0, 0.5, 0.1, 0.2, 0.30000000000000004,
+            2.5, -12.25, 1e-5, 1e-4, 123456789012345.0, 1e15, 1e16, 1e17,
+            1e21, 9e18, 2.3456789e-10, 12345.678901, -179.99999999,
+            45.123456789012, 1234567.125, 1.0 / 3.0, 4.35, 99.999999999999 };
+        const int anPrecisions[] = { 0, 1, 3, 6, 8, 15, 17, 20 };
+        const char achSpecifiers[] = { 'f', 'g' };
+        for( size_t i = 0; i < CPL_ARRAYSIZE(adfValues); i++ )
+        {
+            for( size_t j = 0; j < CPL_ARRAYSIZE(anPrecisions); j++ )
+            {
+                for( size_t k = 0; k < CPL_ARRAYSIZE(achSpecifiers); k++ )
+                {
+                    char szFast[128] = {};
+                    const int nRet = CPLFormatDoubleFast(
+                        szFast, sizeof(szFast), adfValues[i],
+                        anPrecisions[j], achSpecifiers[k]);
+                    if( nRet < 0 )
+                        continue;
+                    char szFormat[16] = {};
+                    snprintf(szFormat, sizeof(szFormat), "%%.%d%c",
+                             anPrecisions[j], achSpecifiers[k]);
+                    char szRef[128] = {};
+                    CPLsnprintf(szRef, sizeof(szRef), szFormat, adfValues[i]);
+                    ensure_equals( std::string(szFast), std::string(szRef) );
+                    ensure_equals( nRet, static_cast<int>(strlen(szRef)) );
+                }
+            }
+        }
+
+        // Common coordinates must not need the C library.
+        char szBuffer[32] = {};
+        ensure_equals( CPLFormatDoubleFast(szBuffer, sizeof(szBuffer),
+                                           -179.99999999, 15, 'g'), 13 );
+        ensure_equals( std::string(szBuffer), std::string("-179.99999999") );
+        // Too small buffer.
+        ensure_equals( CPLFormatDoubleFast(szBuffer, 4, 1.5, 15, 'f'), -1 );
+
+        const char* const apszNumbers[] = {
+            "1", "-0", "0.5", "1.", "-.5", ".", "-", "1e", "1e+", "1e5x",
+            "0x10", "12.5e-3", "  3.25", "00000001.25", "9007199254740993",
+            "1e22", "1e23", "123456789012345678901", "1e-22", "4.9e-324",
+            "1.7976931348623157e308", ".e1", "+1.5", "1.5E+10", "1,5" };
+        for( size_t i = 0; i < CPL_ARRAYSIZE(apszNumbers); i++ )
+        {
+            char* pszEnd = NULL;
+            char* pszRefEnd = NULL;
+            const double dfValue = CPLStrtod(apszNumbers[i], &pszEnd);
+            const double dfRef = strtod(apszNumbers[i], &pszRefEnd);
+            ensure( memcmp(&dfValue, &dfRef, sizeof(double)) == 0 );
+            ensure_equals( pszEnd - apszNumbers[i],
+                           pszRefEnd - apszNumbers[i] );
+        }
+        ensure_equals( CPLStrtodDelim("1,5", NULL, ','), 1.5 );
+    }
+
 } // namespace tut
@@ -30,8 +30,10 @@
 #include <gdal_priv_templates.hpp>
 #include <gdal.h>
 
+#include <cstring>
 #include <limits>
 #include <string>
+#include <vector>
 
 namespace tut
 {
@@ -464,4 +466,168 @@ namespace tut
         ensure( GDALDataTypeIsComplex(GDT_CFloat64) );
     }
 
+    // Raster band whose reads fail below a given line
+    class FailingRasterBand: public GDALRasterBand
+    {
+        int m_nFailFromLine;
+        public:
+            FailingRasterBand(int nXSize, int nYSize, int nFailFromLine):
+                m_nFailFromLine(nFailFromLine)
+            {
+                nRasterXSize = nXSize;
+                nRasterYSize = nYSize;
+                nBlockXSize = nXSize;
+                nBlockYSize = 1;
+                eDataType = GDT_Byte;
+            }
+
+            virtual CPLErr IReadBlock(int, int nYBlock, void* pData) override
+            {
+                if( nYBlock >= m_nFailFromLine )
+                {
+                    CPLError(CE_Failure, CPLE_AppDefined, "read error");
+                    return CE_Failure;
+                }
+                memset(pData, static_cast<GByte>(nYBlock), nBlockXSize);
+                return CE_None;
+            }
+    };
+
+    class FailingDataset: public GDALDataset
+    {
+        public:
+            FailingDataset(int nXSize, int nYSize, int nFailFromLine)
+            {
+                nRasterXSize = nXSize;
+                nRasterYSize = nYSize;
+                SetBand(1, new FailingRasterBand(nXSize, nYSize, nFailFromLine));
+            }
+    };
+
+    static GDALDataset* CreatePatternDataset(int nXSize, int nYSize,
+                                             int nBands,
+                                             const char* pszInterleave)
+    {
+        GDALDriver* poMEMDrv = GetGDALDriverManager()->GetDriverByName("MEM");
+        char** papszOptions = CSLSetNameValue(NULL, "INTERLEAVE",
+                                              pszInterleave);
+        GDALDataset* poDS = poMEMDrv->Create("", nXSize, nYSize, nBands,
+                                             GDT_Byte, papszOptions);
+        CSLDestroy(papszOptions);
+        std::vector<GByte> abyLine(nXSize);
+        for( int iBand = 1; iBand <= nBands; iBand++ )
+        {
+            for( int iY = 0; iY < nYSize; iY++ )
+            {
+                for( int iX = 0; iX < nXSize; iX++ )
+                    abyLine[iX] = static_cast<GByte>(iX * 7 + iY * 3 + iBand);
+                poDS->GetRasterBand(iBand)->RasterIO(
+                    GF_Write, 0, iY, nXSize, 1, &abyLine[0], nXSize, 1,
+                    GDT_Byte, 0, 0, NULL);
+            }
+        }
+        return poDS;
+    }
+
+    static bool SameContent(GDALDataset* poDS1, GDALDataset* poDS2)
+    {
+        const int nXSize = poDS1->GetRasterXSize();
+        const int nYSize = poDS1->GetRasterYSize();
+        const int nBands = poDS1->GetRasterCount();
+        std::vector<GByte> abyData1(static_cast<size_t>(nXSize) * nYSize * nBands);
+        std::vector<GByte> abyData2(abyData1.size());
+        poDS1->RasterIO(GF_Read, 0, 0, nXSize, nYSize, &abyData1[0],
+                        nXSize, nYSize, GDT_Byte, nBands, NULL, 0, 0, 0, NULL);
+        poDS2->RasterIO(GF_Read, 0, 0, nXSize, nYSize, &abyData2[0],
+                        nXSize, nYSize, GDT_Byte, nBands, NULL, 0, 0, 0, NULL);
+        return abyData1 == abyData2;
+    }
+
+    static int CPL_STDCALL CancelAfterFirstProgress(double dfComplete,
+                                                    const char*, void*)
+    {
+        return dfComplete < 0.1;
+    }
+
+    // Test GDALDatasetCopyWholeRaster() and GDALRasterBandCopyWholeRaster()
+    // in pipelined mode against the sequential mode
+    template<> template<> void object::test<16>()
+    {
+        GDALAllRegister();
+        GDALDriver* poMEMDrv = GetGDALDriverManager()->GetDriverByName("MEM");
+        CPLSetConfigOption("GDAL_SWATH_SIZE", "1000000");
+        const char* const apszInterleave[] = { "PIXEL", "BAND" };
+        for( int i = 0; i < 2; i++ )
+        {
+            GDALDataset* poSrcDS =
+                CreatePatternDataset(1500, 1000, 3, apszInterleave[i]);
+            const char* const apszOptions[][3] = {
+                { "PIPELINE=YES", NULL, NULL },
+                { "PIPELINE=4", "INTERLEAVE=BAND", NULL },
+                { "PIPELINE=YES", "SKIP_HOLES=YES", NULL },
+                { "PIPELINE=YES", "INTERLEAVE=BAND", "SKIP_HOLES=YES" } };
+            for( size_t j = 0; j < CPL_ARRAYSIZE(apszOptions); j++ )
+            {
+                GDALDataset* poDstDS = poMEMDrv->Create("", 1500, 1000, 3,
+                                                        GDT_Byte, NULL);
+                CPLErr eErr = GDALDatasetCopyWholeRaster(
+                    poSrcDS, poDstDS,
+                    const_cast<char**>(apszOptions[j]), NULL, NULL);
+                ensure_equals(eErr, CE_None);
+                ensure( SameContent(poSrcDS, poDstDS) );
+                delete poDstDS;
+            }
+
+            GDALDataset* poDstDS = poMEMDrv->Create("", 1500, 1000, 3,
+                                                    GDT_Byte, NULL);
+            const char* const apszBandOptions[] = {
+                "PIPELINE=YES", "SKIP_HOLES=YES", NULL };
+            for( int iBand = 1; iBand <= 3; iBand++ )
+            {
+                CPLErr eErr = GDALRasterBandCopyWholeRaster(
+                    poSrcDS->GetRasterBand(iBand),
+                    poDstDS->GetRasterBand(iBand),
+                    const_cast<char**>(apszBandOptions), NULL, NULL);
+                ensure_equals(eErr, CE_None);
+            }
+            ensure( SameContent(poSrcDS, poDstDS) );
+            delete poDstDS;
+            delete poSrcDS;
+        }
+        CPLSetConfigOption("GDAL_SWATH_SIZE", NULL);
+    }
+
+    // Test that a source read error or a cancellation stops a pipelined copy
+    template<> template<> void object::test<17>()
+    {
+        GDALDriver* poMEMDrv = GetGDALDriverManager()->GetDriverByName("MEM");
+        CPLSetConfigOption("GDAL_SWATH_SIZE", "1000000");
+        const char* const apszOptions[] = { "PIPELINE=YES", NULL };
+
+        FailingDataset oFailingDS(1000, 3000, 2500);
+        GDALDataset* poDstDS = poMEMDrv->Create("", 1000, 3000, 1,
+                                                GDT_Byte, NULL);
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        CPLErr eErr = GDALDatasetCopyWholeRaster(
+            &oFailingDS, poDstDS, const_cast<char**>(apszOptions), NULL, NULL);
+        ensure_equals(eErr, CE_Failure);
+        eErr = GDALRasterBandCopyWholeRaster(
+            oFailingDS.GetRasterBand(1), poDstDS->GetRasterBand(1),
+            const_cast<char**>(apszOptions), NULL, NULL);
+        ensure_equals(eErr, CE_Failure);
+
+        GDALDataset* poSrcDS = CreatePatternDataset(1000, 3000, 1, "BAND");
+        CPLErrorReset();
+        eErr = GDALDatasetCopyWholeRaster(
+            poSrcDS, poDstDS, const_cast<char**>(apszOptions),
+            CancelAfterFirstProgress, NULL);
+        ensure_equals(eErr, CE_Failure);
+        ensure_equals(CPLGetLastErrorNo(), CPLE_UserInterrupt);
+        CPLPopErrorHandler();
+
+        delete poSrcDS;
+        delete poDstDS;
+        CPLSetConfigOption("GDAL_SWATH_SIZE", NULL);
+    }
+
 } // namespace tut
@@ -673,6 +673,67 @@ def basic_test_17():
 
     return 'success'
 
+###############################################################################
+# Test that the driver hints of GDALOpenEx() do not bypass the allowed drivers
+# and the driver kind
+
+def basic_test_18():
+
+    for hints in ['YES', 'NO']:
+        gdal.SetConfigOption('GDAL_OPEN_DRIVER_HINTS', hints)
+        gdal.SetConfigOption('GDAL_OPEN_PROBE_STATS', 'YES')
+        for i in range(2):
+            ds = gdal.OpenEx('data/byte.tif')
+            if ds is None or ds.GetDriver().ShortName != 'GTiff':
+                gdal.SetConfigOption('GDAL_OPEN_DRIVER_HINTS', None)
+                gdal.SetConfigOption('GDAL_OPEN_PROBE_STATS', None)
+                gdaltest.post_reason('fail')
+                return 'fail'
+        ds = gdal.OpenEx('data/byte.tif', allowed_drivers = ['HFA'])
+        ds_vector = gdal.OpenEx('data/byte.tif', gdal.OF_VECTOR)
+        gdal.SetConfigOption('GDAL_OPEN_DRIVER_HINTS', None)
+        gdal.SetConfigOption('GDAL_OPEN_PROBE_STATS', None)
+        if ds is not None or ds_vector is not None:
+            gdaltest.post_reason('fail')
+            return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test that opening a file with restricted drivers does not change the driver
+# used by a later unrestricted open. A regular grid in a .csv file is opened by
+# the XYZ raster driver, registered before the CSV vector driver.
+
+def basic_test_19():
+
+    if gdal.GetDriverByName('XYZ') is None or \
+       gdal.GetDriverByName('CSV') is None:
+        return 'skip'
+
+    gdal.FileFromMemBuffer('/vsimem/basic_test_19.csv',
+                           'x,y,z\n0,0,1\n1,0,2\n0,1,3\n1,1,4\n')
+    gdal.SetConfigOption('GDAL_OPEN_DRIVER_HINTS', 'YES')
+    ret = 'success'
+    for i in range(2):
+        ds = gdal.OpenEx('/vsimem/basic_test_19.csv', allowed_drivers = ['CSV'])
+        if ds is None or ds.GetDriver().ShortName != 'CSV':
+            gdaltest.post_reason('fail')
+            ret = 'fail'
+            break
+        ds = gdal.OpenEx('/vsimem/basic_test_19.csv')
+        if ds is None or ds.GetDriver().ShortName != 'XYZ':
+            gdaltest.post_reason('fail')
+            if ds is not None:
+                print(ds.GetDriver().ShortName)
+            ret = 'fail'
+            break
+        ds = None
+    gdal.SetConfigOption('GDAL_OPEN_DRIVER_HINTS', None)
+    ds = None
+    gdal.Unlink('/vsimem/basic_test_19.csv')
+
+    return ret
+
 gdaltest_list = [ basic_test_1,
                   basic_test_2,
                   basic_test_3,
@@ -689,7 +750,9 @@ gdaltest_list = [ basic_test_1,
                   basic_test_14,
                   basic_test_15,
                   basic_test_16,
-                  basic_test_17 ]
+                  basic_test_17,
+                  basic_test_18,
+                  basic_test_19 ]
 
 
 if __name__ == '__main__':
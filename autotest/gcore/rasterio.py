@@ -1081,6 +1081,66 @@ cellsize     0
 
     return 'success'
 
+###############################################################################
+# Test GDALDatasetCopyWholeRaster() in pipelined mode (reading in a helper
+# thread) against the sequential mode
+
+def rasterio_17():
+
+    # Sparse tiled source, so that SKIP_HOLES has holes to skip
+    src_ds = gdal.GetDriverByName('GTiff').Create(
+        '/vsimem/rasterio_17_src.tif', 1024, 1024, 3,
+        options = ['TILED=YES', 'SPARSE_OK=YES'])
+    for i in range(3):
+        data = struct.pack('B' * 256,
+                           *[(j * 7 + i * 13) % 256 for j in range(256)])
+        for y in range(0, 1024, 512):
+            src_ds.GetRasterBand(i + 1).WriteRaster(
+                0, y, 256, 256, data * 256)
+    src_ds = None
+    src_ds = gdal.Open('/vsimem/rasterio_17_src.tif')
+    src_cs = [src_ds.GetRasterBand(i + 1).Checksum() for i in range(3)]
+
+    gdal.SetConfigOption('GDAL_SWATH_SIZE', '1000000')
+    for interleave in ['PIXEL', 'BAND']:
+        for pipeline in ['NO', 'YES', '4']:
+            gdal.SetConfigOption('GDAL_COPY_WHOLE_RASTER_PIPELINE', pipeline)
+            out_ds = gdal.GetDriverByName('GTiff').CreateCopy(
+                '/vsimem/rasterio_17_out.tif', src_ds,
+                options = ['INTERLEAVE=' + interleave])
+            gdal.SetConfigOption('GDAL_COPY_WHOLE_RASTER_PIPELINE', None)
+            out_ds = None
+            out_ds = gdal.Open('/vsimem/rasterio_17_out.tif')
+            cs = [out_ds.GetRasterBand(i + 1).Checksum() for i in range(3)]
+            out_ds = None
+            if cs != src_cs:
+                gdaltest.post_reason('fail')
+                print(interleave, pipeline, cs, src_cs)
+                gdal.SetConfigOption('GDAL_SWATH_SIZE', None)
+                return 'fail'
+    gdal.SetConfigOption('GDAL_SWATH_SIZE', None)
+
+    # Cancellation from the progress callback must stop the copy
+    def cancel_cbk(pct, msg, user_data):
+        return pct < 0.2
+
+    gdal.SetConfigOption('GDAL_SWATH_SIZE', '1000000')
+    gdal.SetConfigOption('GDAL_COPY_WHOLE_RASTER_PIPELINE', 'YES')
+    with gdaltest.error_handler():
+        out_ds = gdal.GetDriverByName('GTiff').CreateCopy(
+            '/vsimem/rasterio_17_out.tif', src_ds, callback = cancel_cbk)
+    gdal.SetConfigOption('GDAL_COPY_WHOLE_RASTER_PIPELINE', None)
+    gdal.SetConfigOption('GDAL_SWATH_SIZE', None)
+    if out_ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    src_ds = None
+    gdal.Unlink('/vsimem/rasterio_17_src.tif')
+    gdal.Unlink('/vsimem/rasterio_17_out.tif')
+
+    return 'success'
+
 
 gdaltest_list = [
     rasterio_1,
@@ -1098,7 +1158,8 @@ gdaltest_list = [
     rasterio_13,
     rasterio_14,
     rasterio_15,
-    rasterio_16
+    rasterio_16,
+    rasterio_17
     ]
 
 #gdaltest_list = [ rasterio_16 ]
@@ -7615,6 +7615,81 @@ def tiff_write_165():
 
     return 'success'
 
+###############################################################################
+# Test COG=YES creation option on a source without overviews
+
+def tiff_write_166():
+
+    src_ds = gdal.Open('data/utmsmall.tif')
+
+    # Reference overviews
+    ref_ds = gdaltest.tiff_drv.CreateCopy('/vsimem/tiff_write_166_ref.tif', src_ds)
+    ref_ds.BuildOverviews( 'NEAR', overviewlist = [2, 4] )
+    expected_cs1 = ref_ds.GetRasterBand(1).GetOverview(0).Checksum()
+    expected_cs2 = ref_ds.GetRasterBand(1).GetOverview(1).Checksum()
+    ref_ds = None
+    gdaltest.tiff_drv.Delete('/vsimem/tiff_write_166_ref.tif')
+
+    ds = gdaltest.tiff_drv.CreateCopy('/vsimem/tiff_write_166.tif', src_ds,
+            options = ['COG=YES', 'BLOCKXSIZE=32', 'BLOCKYSIZE=32',
+                       'COMPRESS=DEFLATE', 'NUM_THREADS=2'])
+    ds = None
+
+    # Temporary overview files are neither left in /vsimem nor next to
+    # the output
+    for filename in gdal.ReadDir('/vsimem/'):
+        if filename.startswith('gtiff_cog_ovr') or \
+           filename.startswith('tiff_write_166.tif.ovr'):
+            gdaltest.post_reason('temporary file not removed')
+            print(filename)
+            return 'fail'
+
+    f = gdal.VSIFOpenL('/vsimem/tiff_write_166.tif', 'rb')
+    data = gdal.VSIFReadL(1, 100, f).decode('LATIN1')
+    gdal.VSIFCloseL(f)
+    if data.find('GDAL_STRUCTURAL_METADATA_SIZE=') != 8 or \
+       data.find('LAYOUT=IFDS_BEFORE_DATA') < 0:
+        gdaltest.post_reason('did not find structural metadata')
+        print(data)
+        return 'fail'
+
+    ds = gdal.Open('/vsimem/tiff_write_166.tif')
+    if ds.GetRasterBand(1).GetBlockSize() != [32, 32] or \
+       ds.GetRasterBand(1).GetOverviewCount() != 2:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    cs = ds.GetRasterBand(1).Checksum()
+    cs1 = ds.GetRasterBand(1).GetOverview(0).Checksum()
+    cs2 = ds.GetRasterBand(1).GetOverview(1).Checksum()
+    ifd_main = int(ds.GetRasterBand(1).GetMetadataItem('IFD_OFFSET', 'TIFF'))
+    ifd_ovr_1 = int(ds.GetRasterBand(1).GetOverview(1).GetMetadataItem('IFD_OFFSET', 'TIFF'))
+    data_ovr_1 = int(ds.GetRasterBand(1).GetOverview(1).GetMetadataItem('BLOCK_OFFSET_0_0', 'TIFF'))
+    data_ovr_0 = int(ds.GetRasterBand(1).GetOverview(0).GetMetadataItem('BLOCK_OFFSET_0_0', 'TIFF'))
+    data_main = int(ds.GetRasterBand(1).GetMetadataItem('BLOCK_OFFSET_0_0', 'TIFF'))
+    ds = None
+
+    gdaltest.tiff_drv.Delete('/vsimem/tiff_write_166.tif')
+
+    if cs != src_ds.GetRasterBand(1).Checksum() or \
+       cs1 != expected_cs1 or cs2 != expected_cs2:
+        gdaltest.post_reason('did not get expected checksums')
+        print(cs, cs1, cs2, expected_cs1, expected_cs2)
+        return 'fail'
+
+    if not(ifd_main < ifd_ovr_1 and ifd_ovr_1 < data_ovr_1 and data_ovr_1 < data_ovr_0 and data_ovr_0 < data_main):
+        gdaltest.post_reason('failure')
+        print(ifd_main, ifd_ovr_1, data_ovr_1, data_ovr_0, data_main)
+        return 'fail'
+
+    with gdaltest.error_handler():
+        ds = gdaltest.tiff_drv.CreateCopy('/vsimem/tiff_write_166.tif', src_ds,
+                                          options = ['COG=YES', 'TILED=NO'])
+    if ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Ask to run again tests with GDAL_API_PROXY=YES
 
@@ -7810,6 +7885,7 @@ gdaltest_list = [
     tiff_write_163,
     tiff_write_164,
     tiff_write_165,
+    tiff_write_166,
     #tiff_write_api_proxy,
     tiff_write_cleanup ]
 
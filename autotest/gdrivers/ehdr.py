@@ -344,6 +344,59 @@ def ehdr_14():
 
     return 'success'
 
+###############################################################################
+# Test reads served from a memory mapping of the file, with a byte swapped
+# pixel interleaved layout.
+
+def ehdr_15():
+
+    import struct
+
+    open('tmp/ehdr_15.hdr', 'wt').write("""NROWS 5
+NCOLS 7
+NBANDS 2
+NBITS 16
+PIXELTYPE SIGNEDINT
+BYTEORDER M
+LAYOUT BIP
+SKIPBYTES 4
+""")
+    values = [(i * 37) % 65536 - 32768 for i in range(5 * 7 * 2)]
+    f = open('tmp/ehdr_15.bil', 'wb')
+    f.write(b'\0' * 4)
+    f.write(struct.pack('>' + 'h' * len(values), *values))
+    f.close()
+
+    results = []
+    for use_mmap in ['NO', 'YES']:
+        gdal.SetConfigOption('GDAL_RAW_USE_MMAP', use_mmap)
+        ds = gdal.Open('tmp/ehdr_15.bil')
+        res = []
+        for band in [1, 2]:
+            res.append(ds.GetRasterBand(band).Checksum())
+            res.append(ds.GetRasterBand(band).ReadRaster(1, 2, 5, 3))
+            res.append(ds.GetRasterBand(band).ReadRaster(
+                1, 2, 5, 3, buf_type=gdal.GDT_Float32))
+        res.append(ds.ReadRaster(0, 0, 7, 5))
+        res.append(ds.ReadRaster(2, 1, 4, 4, buf_type=gdal.GDT_Int32))
+        res.append(ds.ReadRaster(0, 0, 7, 5, 3, 2))
+        ds = None
+        gdal.SetConfigOption('GDAL_RAW_USE_MMAP', None)
+        results.append(res)
+
+    gdal.GetDriverByName('EHDR').Delete('tmp/ehdr_15.bil')
+
+    if results[0] != results[1]:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    expected = struct.pack('=' + 'h' * 7, *values[0:14:2])
+    if results[1][6][0:14] != expected:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     ehdr_1,
     ehdr_2,
@@ -358,7 +411,8 @@ gdaltest_list = [
     ehdr_11,
     ehdr_12,
     ehdr_13,
-    ehdr_14 ]
+    ehdr_14,
+    ehdr_15 ]
 
 if __name__ == '__main__':
 
@@ -3782,6 +3782,88 @@ def gpkg_48():
 
     return 'success'
 
+###############################################################################
+# Test tile encoding in worker threads (NUM_THREADS creation option)
+
+def gpkg_49():
+
+    if gdaltest.gpkg_dr is None:
+        return 'skip'
+    if gdaltest.png_dr is None:
+        return 'skip'
+
+    src_ds = gdal.Translate('', 'data/small_world.tif', format = 'MEM',
+                            width = 1000, height = 500)
+    expected_cs = None
+    for tile_format in [ 'PNG', 'PNG8', 'JPEG' ]:
+        if tile_format == 'JPEG' and gdaltest.jpeg_dr is None:
+            continue
+        for num_threads in [ '1', '4' ]:
+            tmpfile = '/vsimem/gpkg_49.gpkg'
+            gdaltest.gpkg_dr.CreateCopy(tmpfile, src_ds,
+                options = [ 'TILE_FORMAT=' + tile_format,
+                            'BLOCKSIZE=128',
+                            'NUM_THREADS=' + num_threads ])
+            ds = gdal.OpenEx(tmpfile, gdal.OF_UPDATE,
+                    open_options = [ 'NUM_THREADS=' + num_threads ])
+            ds.BuildOverviews('AVERAGE', [2, 4])
+            ds = None
+            ds = gdal.Open(tmpfile)
+            cs = [ ds.GetRasterBand(i+1).Checksum() for i in range(4) ]
+            cs += [ ds.GetRasterBand(i+1).GetOverview(0).Checksum() for i in range(4) ]
+            ds = None
+            gdal.Unlink(tmpfile)
+            if num_threads == '1':
+                expected_cs = cs
+            elif cs != expected_cs:
+                gdaltest.post_reason('fail')
+                print(tile_format, cs, expected_cs)
+                return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test tile decoding in worker threads (NUM_THREADS open option)
+
+def gpkg_50():
+
+    if gdaltest.gpkg_dr is None:
+        return 'skip'
+    if gdaltest.png_dr is None:
+        return 'skip'
+
+    tmpfile = '/vsimem/gpkg_50.gpkg'
+    src_ds = gdal.Translate('', 'data/small_world.tif', format = 'MEM',
+                            width = 1000, height = 500)
+    gdaltest.gpkg_dr.CreateCopy(tmpfile, src_ds,
+                                options = [ 'BLOCKSIZE=128' ])
+    ds = gdal.Open(tmpfile, gdal.GA_Update)
+    ds.BuildOverviews('AVERAGE', [2])
+    ds = None
+
+    ds = gdal.Open(tmpfile)
+    expected_data = ds.ReadRaster(0, 0, 1000, 500)
+    expected_band_data = ds.GetRasterBand(2).ReadRaster(3, 5, 997, 495)
+    expected_ovr_data = ds.ReadRaster(0, 0, 1000, 500, 500, 250)
+    ds = None
+
+    ds = gdal.OpenEx(tmpfile, open_options = [ 'NUM_THREADS=4' ])
+    data = ds.ReadRaster(0, 0, 1000, 500)
+    ds = None
+    ds = gdal.OpenEx(tmpfile, open_options = [ 'NUM_THREADS=4' ])
+    band_data = ds.GetRasterBand(2).ReadRaster(3, 5, 997, 495)
+    ovr_data = ds.ReadRaster(0, 0, 1000, 500, 500, 250)
+    ds = None
+
+    gdal.Unlink(tmpfile)
+
+    if data != expected_data or band_data != expected_band_data or \
+       ovr_data != expected_ovr_data:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 #
 
@@ -3852,6 +3934,8 @@ gdaltest_list = [
     gpkg_46,
     gpkg_47,
     gpkg_48,
+    gpkg_49,
+    gpkg_50,
     gpkg_cleanup,
 ]
 #gdaltest_list = [ gpkg_init, gpkg_47, gpkg_cleanup ]
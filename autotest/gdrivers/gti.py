@@ -0,0 +1,291 @@
+#!/usr/bin/env python
+###############################################################################
+# $Id$
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  Test GTI (GDAL Raster Tile Index) driver
+#
+###############################################################################
+# Copyright (c) 2018, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+import sys
+from osgeo import gdal
+from osgeo import ogr
+from osgeo import osr
+
+sys.path.append( '../pymod' )
+
+import gdaltest
+
+###############################################################################
+# Split data/byte.tif in 4 tiles and write a shapefile tile index of them.
+# Tiles are resampled to width x height pixels when those are set.
+
+def gti_create_index(filename, tiles, width = 0, height = 0):
+
+    ds = ogr.GetDriverByName('ESRI Shapefile').CreateDataSource(filename)
+    src_ds = gdal.Open('data/byte.tif')
+    srs = osr.SpatialReference()
+    srs.ImportFromWkt(src_ds.GetProjectionRef())
+    lyr = ds.CreateLayer('index', srs = srs, geom_type = ogr.wkbPolygon)
+    lyr.CreateField(ogr.FieldDefn('location', ogr.OFTString))
+    for (name, xoff, yoff, xsize, ysize) in tiles:
+        gdal.Translate(name, src_ds, srcWin = [xoff, yoff, xsize, ysize],
+                       width = width, height = height)
+        tile_ds = gdal.Open(name)
+        gt = tile_ds.GetGeoTransform()
+        minx = gt[0]
+        maxx = gt[0] + gt[1] * tile_ds.RasterXSize
+        maxy = gt[3]
+        miny = gt[3] + gt[5] * tile_ds.RasterYSize
+        tile_ds = None
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f['location'] = name
+        f.SetGeometry(ogr.CreateGeometryFromWkt(
+            'POLYGON((%.18g %.18g,%.18g %.18g,%.18g %.18g,%.18g %.18g,%.18g %.18g))' %
+            (minx, miny, minx, maxy, maxx, maxy, maxx, miny, minx, miny)))
+        lyr.CreateFeature(f)
+    ds = None
+
+def gti_cleanup_index(filename, tiles):
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource(filename)
+    for tile in tiles:
+        gdal.Unlink(tile[0])
+
+gti_tiles = [ ('/vsimem/gti_tile_0_0.tif', 0, 0, 10, 10),
+              ('/vsimem/gti_tile_1_0.tif', 10, 0, 10, 10),
+              ('/vsimem/gti_tile_0_1.tif', 0, 10, 10, 10),
+              ('/vsimem/gti_tile_1_1.tif', 10, 10, 10, 10) ]
+
+###############################################################################
+# Read back a mosaic of 4 tiles.
+
+def gti_1():
+
+    if gdal.GetDriverByName('GTI') is None:
+        return 'skip'
+
+    gti_create_index('/vsimem/gti_1.shp', gti_tiles)
+
+    ds = gdal.Open('GTI:/vsimem/gti_1.shp')
+    if ds is None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.RasterXSize != 20 or ds.RasterYSize != 20 or ds.RasterCount != 1:
+        gdaltest.post_reason('fail')
+        print(ds.RasterXSize, ds.RasterYSize, ds.RasterCount)
+        return 'fail'
+
+    ref_ds = gdal.Open('data/byte.tif')
+    if gdaltest.geotransform_equals(ds.GetGeoTransform(),
+                                    ref_ds.GetGeoTransform(), 1e-8) != 1:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.GetProjectionRef().find('NAD27') < 0:
+        gdaltest.post_reason('fail')
+        print(ds.GetProjectionRef())
+        return 'fail'
+
+    cs = ds.GetRasterBand(1).Checksum()
+    if cs != 4672:
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+
+    # Window crossing the 4 tiles, and one within a single tile
+    for (xoff, yoff, xsize, ysize) in [ (5, 5, 10, 10), (12, 1, 5, 3) ]:
+        got = ds.ReadRaster(xoff, yoff, xsize, ysize)
+        expected = ref_ds.ReadRaster(xoff, yoff, xsize, ysize)
+        if got != expected:
+            gdaltest.post_reason('fail')
+            print(xoff, yoff, xsize, ysize)
+            return 'fail'
+
+    # Downsampled read
+    got = ds.ReadRaster(0, 0, 20, 20, 10, 10)
+    expected = ref_ds.ReadRaster(0, 0, 20, 20, 10, 10)
+    if got != expected:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    with gdaltest.error_handler():
+        ret = ds.GetRasterBand(1).WriteRaster(0, 0, 1, 1, ' ')
+    if ret == 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    ds = None
+
+    gti_cleanup_index('/vsimem/gti_1.shp', gti_tiles)
+
+    return 'success'
+
+###############################################################################
+# Open options overriding the properties of the first tile, and a missing
+# tile.
+
+def gti_2():
+
+    if gdal.GetDriverByName('GTI') is None:
+        return 'skip'
+
+    tiles = gti_tiles[0:3]
+    gti_create_index('/vsimem/gti_2.shp', tiles)
+
+    # The extent of the layer does not cover the 4th tile: extend it.
+    ref_ds = gdal.Open('data/byte.tif')
+    gt = ref_ds.GetGeoTransform()
+    ds = gdal.OpenEx('GTI:/vsimem/gti_2.shp',
+                     open_options = [ 'MAXX=%.18g' % (gt[0] + 20 * gt[1]),
+                                      'MINY=%.18g' % (gt[3] + 20 * gt[5]),
+                                      'DATA_TYPE=UInt16', 'NODATA=0',
+                                      'BAND_COUNT=2',
+                                      'RESX=%.18g' % gt[1],
+                                      'RESY=%.18g' % -gt[5] ])
+    if ds is None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.RasterXSize != 20 or ds.RasterYSize != 20 or ds.RasterCount != 2:
+        gdaltest.post_reason('fail')
+        print(ds.RasterXSize, ds.RasterYSize, ds.RasterCount)
+        return 'fail'
+    band = ds.GetRasterBand(1)
+    if band.DataType != gdal.GDT_UInt16 or band.GetNoDataValue() != 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    # Area of the missing tile is nodata
+    if ds.ReadRaster(10, 10, 10, 10, buf_type = gdal.GDT_Byte) != \
+       ''.join(['\0' for i in range(100)]).encode('latin1'):
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.ReadRaster(0, 0, 10, 10, band_list = [1],
+                     buf_type = gdal.GDT_Byte) != \
+       ref_ds.ReadRaster(0, 0, 10, 10):
+        gdaltest.post_reason('fail')
+        return 'fail'
+    # Second band is absent from the tiles
+    if ds.GetRasterBand(2).Checksum() != 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    gti_cleanup_index('/vsimem/gti_2.shp', tiles)
+
+    # Tile that cannot be opened
+    gti_create_index('/vsimem/gti_2.shp', tiles)
+    gdal.Unlink(tiles[1][0])
+    ds = gdal.Open('GTI:/vsimem/gti_2.shp')
+    with gdaltest.error_handler():
+        cs = ds.GetRasterBand(1).Checksum()
+    if gdal.GetLastErrorMsg() == '':
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+    ds = None
+    gti_cleanup_index('/vsimem/gti_2.shp', tiles)
+
+    return 'success'
+
+###############################################################################
+# Errors.
+
+def gti_3():
+
+    if gdal.GetDriverByName('GTI') is None:
+        return 'skip'
+
+    with gdaltest.error_handler():
+        ds = gdal.Open('GTI:/vsimem/i_do_not_exist.shp')
+    if ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    gti_create_index('/vsimem/gti_3.shp', gti_tiles)
+    with gdaltest.error_handler():
+        ds = gdal.OpenEx('GTI:/vsimem/gti_3.shp',
+                         open_options = [ 'LOCATION_FIELD=foo' ])
+    if ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    gti_cleanup_index('/vsimem/gti_3.shp', gti_tiles)
+
+    return 'success'
+
+###############################################################################
+# Downsampled reads of two windows, each strictly within a tile that has
+# overviews. The implicit overviews of the VRT used for a window must not be
+# reused for the next one.
+
+def gti_4():
+
+    if gdal.GetDriverByName('GTI') is None:
+        return 'skip'
+
+    tiles = [ ('/vsimem/gti_4_left.tif', 0, 0, 10, 20),
+              ('/vsimem/gti_4_right.tif', 10, 0, 10, 20) ]
+    gti_create_index('/vsimem/gti_4.shp', tiles, width = 256, height = 512)
+    for tile in tiles:
+        tile_ds = gdal.Open(tile[0], gdal.GA_Update)
+        tile_ds.BuildOverviews('NEAR', overviewlist = [2])
+        tile_ds = None
+
+    ds = gdal.Open('GTI:/vsimem/gti_4.shp')
+    if ds.RasterXSize != 512 or ds.RasterYSize != 512:
+        gdaltest.post_reason('fail')
+        print(ds.RasterXSize, ds.RasterYSize)
+        return 'fail'
+
+    for (xoff, tile) in [ (2, tiles[0]), (258, tiles[1]), (2, tiles[0]) ]:
+        tile_ds = gdal.Open(tile[0])
+        expected = tile_ds.ReadRaster(2, 0, 252, 512, 126, 256)
+        tile_ds = None
+
+        got = ds.ReadRaster(xoff, 0, 252, 512, 126, 256)
+        if got != expected:
+            gdaltest.post_reason('fail')
+            print(xoff)
+            return 'fail'
+        got = ds.GetRasterBand(1).ReadRaster(xoff, 0, 252, 512, 126, 256)
+        if got != expected:
+            gdaltest.post_reason('fail')
+            print(xoff)
+            return 'fail'
+    ds = None
+
+    gti_cleanup_index('/vsimem/gti_4.shp', tiles)
+
+    return 'success'
+
+gdaltest_list = [
+    gti_1,
+    gti_2,
+    gti_3,
+    gti_4 ]
+
+if __name__ == '__main__':
+
+    gdaltest.setup_run( 'gti' )
+
+    gdaltest.run_tests( gdaltest_list )
+
+    gdaltest.summarize()
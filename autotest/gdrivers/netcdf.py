@@ -3141,6 +3141,161 @@ def netcdf_82():
 
     return 'success'
 
+###############################################################################
+# Test multi-band reads of a 3D variable, done with one hyperslab read
+
+def netcdf_83():
+
+    if gdaltest.netcdf_drv is None:
+        return 'skip'
+
+    src_ds = gdal.GetDriverByName('MEM').Create('', 5, 4, 3, gdal.GDT_Float32)
+    src_ds.SetGeoTransform([2, 1, 0, 49, 0, -1])
+    src_ds.SetMetadataItem('NETCDF_DIM_EXTRA', '{time}')
+    src_ds.SetMetadataItem('NETCDF_DIM_time_DEF', '{3,6}')
+    src_ds.SetMetadataItem('NETCDF_DIM_time_VALUES', '{1,2,3}')
+    for i in range(3):
+        src_ds.GetRasterBand(i + 1).WriteRaster(0, 0, 5, 4,
+            struct.pack('f' * 20, *[100 * i + j for j in range(20)]))
+    gdaltest.netcdf_drv.CreateCopy('tmp/netcdf_83.nc', src_ds)
+    src_ds = None
+
+    ds = gdal.Open('tmp/netcdf_83.nc')
+    if ds.RasterCount != 3:
+        gdaltest.post_reason('fail')
+        print(ds.RasterCount)
+        return 'fail'
+
+    for (xoff, yoff, xsize, ysize) in [(0, 0, 5, 4), (1, 2, 3, 2), (4, 3, 1, 1)]:
+        data = ds.ReadRaster(xoff, yoff, xsize, ysize)
+        gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_READ', 'NO')
+        ref_data = ds.ReadRaster(xoff, yoff, xsize, ysize)
+        gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_READ', None)
+        if data != ref_data:
+            gdaltest.post_reason('fail')
+            return 'fail'
+
+    # Time series at one pixel
+    data = struct.unpack('f' * 3, ds.ReadRaster(1, 2, 1, 1,
+                                                buf_type=gdal.GDT_Float32))
+    if data != (11.0, 111.0, 211.0):
+        gdaltest.post_reason('fail')
+        print(data)
+        return 'fail'
+
+    # Force one hyperslab read per row
+    gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_MAX_SIZE', '100')
+    data = ds.ReadRaster(0, 0, 5, 4)
+    gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_MAX_SIZE', None)
+    gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_READ', 'NO')
+    ref_data = ds.ReadRaster(0, 0, 5, 4)
+    gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_READ', None)
+    if data != ref_data:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    ds = None
+    gdal.Unlink('tmp/netcdf_83.nc')
+
+    # Chunked NC4 variable, with nodata and valid_range, stored bottom-up,
+    # with chunks of 2 rows. Requires ncgen to create it.
+    if not gdaltest.netcdf_drv_has_nc4:
+        return 'success'
+    try:
+        (ret, err) = gdaltest.runexternal_out_and_err('ncgen -version')
+    except:
+        print('NOTICE: ncgen not found')
+        return 'success'
+    if err is None or ('netCDF' not in ret and 'netCDF' not in err):
+        print('NOTICE: ncgen not found')
+        return 'success'
+
+    values = []
+    for t in range(3):
+        for j in range(35):
+            if j == 3:
+                values.append('-9999')
+            elif j == 12 + t:
+                values.append('300')
+            else:
+                values.append(str(100 * t + j))
+    open('tmp/netcdf_83.cdl', 'wt').write("""netcdf netcdf_83 {
+dimensions:
+    time = 3 ;
+    lat = 7 ;
+    lon = 5 ;
+variables:
+    double time(time) ;
+        time:units = "days since 2000-01-01" ;
+    float lat(lat) ;
+        lat:units = "degrees_north" ;
+    float lon(lon) ;
+        lon:units = "degrees_east" ;
+    float v(time, lat, lon) ;
+        v:_FillValue = -9999.f ;
+        v:valid_range = 0.f, 250.f ;
+        v:_Storage = "chunked" ;
+        v:_ChunkSizes = 1, 2, 5 ;
+data:
+ time = 1, 2, 3 ;
+ lat = 40, 41, 42, 43, 44, 45, 46 ;
+ lon = 2, 3, 4, 5, 6 ;
+ v = %s ;
+}
+""" % ', '.join(values))
+    (ret, err) = gdaltest.runexternal_out_and_err(
+        'ncgen -k nc4 -o tmp/netcdf_83_chunked.nc tmp/netcdf_83.cdl')
+    os.unlink('tmp/netcdf_83.cdl')
+    if err != '':
+        gdaltest.post_reason('fail')
+        print(err)
+        return 'fail'
+
+    ds = gdal.OpenEx('tmp/netcdf_83_chunked.nc',
+                     open_options = ['CHUNK_CACHE_SIZE=1000000'])
+    if ds.RasterCount != 3 or \
+       ds.GetRasterBand(1).GetBlockSize() != [5, 2]:
+        gdaltest.post_reason('fail')
+        print(ds.RasterCount)
+        print(ds.GetRasterBand(1).GetBlockSize())
+        return 'fail'
+
+    # 3 rows per read, which are not aligned on the chunks of the file
+    gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_MAX_SIZE', '180')
+    for (xoff, yoff, xsize, ysize) in [(0, 0, 5, 7), (1, 1, 3, 5),
+                                       (0, 3, 5, 4), (2, 6, 1, 1)]:
+        data = ds.ReadRaster(xoff, yoff, xsize, ysize)
+        gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_READ', 'NO')
+        ref_data = ds.ReadRaster(xoff, yoff, xsize, ysize)
+        gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_READ', None)
+        if data != ref_data:
+            gdaltest.post_reason('fail')
+            print(xoff, yoff, xsize, ysize)
+            gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_MAX_SIZE', None)
+            return 'fail'
+    gdal.SetConfigOption('GDAL_NETCDF_HYPERSLAB_MAX_SIZE', None)
+
+    # First row is the last one of the file. Second row holds the values
+    # outside of valid_range.
+    data = struct.unpack('f' * 15, ds.ReadRaster(0, 0, 5, 1,
+                                                 buf_type=gdal.GDT_Float32))
+    if (data[0], data[5], data[10]) != (30.0, 130.0, 230.0):
+        gdaltest.post_reason('fail')
+        print(data)
+        return 'fail'
+    data = struct.unpack('f' * 9, ds.ReadRaster(2, 4, 3, 1,
+                                                 buf_type=gdal.GDT_Float32))
+    if data != (-9999.0, 13.0, 14.0, 112.0, -9999.0, 114.0,
+                212.0, 213.0, -9999.0):
+        gdaltest.post_reason('fail')
+        print(data)
+        return 'fail'
+
+    ds = None
+    gdal.Unlink('tmp/netcdf_83_chunked.nc')
+
+    return 'success'
+
 ###############################################################################
 
 ###############################################################################
@@ -3233,7 +3388,8 @@ gdaltest_list = [
     netcdf_79,
     netcdf_80,
     netcdf_81,
-    netcdf_82
+    netcdf_82,
+    netcdf_83
 ]
 
 ###############################################################################
@@ -874,6 +874,252 @@ def wms_19():
 
     return 'success'
 ###############################################################################
+# Test the SQLite tile cache
+
+def wms_20():
+
+    if gdaltest.wms_drv is None:
+        return 'skip'
+
+    png_drv = gdal.GetDriverByName('PNG')
+    if png_drv is None:
+        return 'skip'
+
+    try:
+        shutil.rmtree('tmp/wms20')
+    except:
+        pass
+    os.makedirs('tmp/wms20/tiles/0/0')
+    src_ds = gdal.Open('data/byte.tif')
+    png_drv.CreateCopy('tmp/wms20/tiles/0/0/0.png', src_ds)
+    src_ds = None
+
+    tms = """<GDAL_WMS>
+    <Service name="TMS">
+        <ServerUrl>file://%s/tmp/wms20/tiles/${z}/${x}/${y}.png</ServerUrl>
+    </Service>
+    <DataWindow>
+        <UpperLeftX>0</UpperLeftX>
+        <UpperLeftY>20</UpperLeftY>
+        <LowerRightX>20</LowerRightX>
+        <LowerRightY>0</LowerRightY>
+        <TileLevel>0</TileLevel>
+        <TileCountX>1</TileCountX>
+        <TileCountY>1</TileCountY>
+    </DataWindow>
+    <BlockSizeX>20</BlockSizeX>
+    <BlockSizeY>20</BlockSizeY>
+    <BandsCount>1</BandsCount>
+    <Cache>
+        <Type>sqlite</Type>
+        <Path>./tmp/wms20/cache</Path>
+        <MaxSize>1000000</MaxSize>
+    </Cache>
+    %s
+</GDAL_WMS>"""
+
+    ds = gdal.Open(tms % (os.getcwd(), ''))
+    if ds is None:
+        gdaltest.post_reason('open failed.')
+        return 'fail'
+    cs = ds.GetRasterBand(1).Checksum()
+    ds = None
+    if cs != 4672:
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+
+    try:
+        os.stat('tmp/wms20/cache/gdalwmscache.sqlite')
+    except:
+        gdaltest.post_reason('tmp/wms20/cache/gdalwmscache.sqlite should exist')
+        return 'fail'
+
+    # Now, we should read from the cache only
+    shutil.rmtree('tmp/wms20/tiles')
+    ds = gdal.Open(tms % (os.getcwd(), '<OfflineMode>true</OfflineMode>'))
+    cs = ds.GetRasterBand(1).Checksum()
+    ds = None
+    if cs != 4672:
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+
+    if gdal.ReadDir('/vsimem/wmscache'):
+        gdaltest.post_reason('fail')
+        print(gdal.ReadDir('/vsimem/wmscache'))
+        return 'fail'
+
+    shutil.rmtree('tmp/wms20')
+
+    return 'success'
+
+###############################################################################
+# Helper for the SQLite tile cache tests: a TMS service of file:// tiles
+
+def wms_sqlite_cache_xml(tile_count_x, cache_options, offline = False):
+
+    return """<GDAL_WMS>
+    <Service name="TMS">
+        <ServerUrl>file://%s/tmp/wms_sqlite/tiles/${z}/${x}/${y}.png</ServerUrl>
+    </Service>
+    <DataWindow>
+        <UpperLeftX>0</UpperLeftX>
+        <UpperLeftY>20</UpperLeftY>
+        <LowerRightX>%d</LowerRightX>
+        <LowerRightY>0</LowerRightY>
+        <TileLevel>0</TileLevel>
+        <TileCountX>%d</TileCountX>
+        <TileCountY>1</TileCountY>
+    </DataWindow>
+    <BlockSizeX>20</BlockSizeX>
+    <BlockSizeY>20</BlockSizeY>
+    <BandsCount>1</BandsCount>
+    <Cache>
+        <Type>sqlite</Type>
+        <Path>./tmp/wms_sqlite/cache</Path>
+        %s
+    </Cache>
+    %s
+</GDAL_WMS>""" % (os.getcwd(), 20 * tile_count_x, tile_count_x,
+                    cache_options,
+                    '<OfflineMode>true</OfflineMode>' if offline else '')
+
+def wms_sqlite_cache_setup(tile_count_x):
+
+    try:
+        import sqlite3
+    except:
+        return None
+
+    if gdaltest.wms_drv is None or gdal.GetDriverByName('PNG') is None:
+        return None
+
+    try:
+        shutil.rmtree('tmp/wms_sqlite')
+    except:
+        pass
+    os.makedirs('tmp/wms_sqlite/tiles/0/0')
+    src_ds = gdal.Open('data/byte.tif')
+    for x in range(tile_count_x):
+        try:
+            os.makedirs('tmp/wms_sqlite/tiles/0/%d' % x)
+        except:
+            pass
+        gdal.GetDriverByName('PNG').CreateCopy(
+            'tmp/wms_sqlite/tiles/0/%d/0.png' % x, src_ds)
+    src_ds = None
+
+    return sqlite3
+
+###############################################################################
+# Test that the SQLite tile cache evicts the least recently used tiles
+
+def wms_21():
+
+    sqlite3 = wms_sqlite_cache_setup(2)
+    if sqlite3 is None:
+        return 'skip'
+
+    tile_size = os.stat('tmp/wms_sqlite/tiles/0/0/0.png').st_size
+    max_size = tile_size * 3 // 2
+    xml = wms_sqlite_cache_xml(2, '<MaxSize>%d</MaxSize>' % max_size)
+
+    # Read the first tile, then the second one
+    ds = gdal.Open(xml)
+    ds.GetRasterBand(1).ReadRaster(0, 0, 20, 20)
+    ds = None
+    ds = gdal.Open(xml)
+    ds.GetRasterBand(1).ReadRaster(20, 0, 20, 20)
+    ds = None
+
+    conn = sqlite3.connect('tmp/wms_sqlite/cache/gdalwmscache.sqlite')
+    keys = [row[0] for row in conn.execute('SELECT key FROM tiles')]
+    total_size = conn.execute("SELECT value FROM cache_info "
+                              "WHERE name = 'total_size'").fetchone()[0]
+    sum_size = conn.execute('SELECT SUM(size) FROM tiles').fetchone()[0]
+    conn.close()
+
+    if len(keys) != 1 or not keys[0].endswith('/0/1/0.png'):
+        gdaltest.post_reason('older tile should have been evicted')
+        print(keys)
+        return 'fail'
+    if total_size != sum_size or total_size > max_size:
+        gdaltest.post_reason('fail')
+        print(total_size, sum_size, max_size)
+        return 'fail'
+
+    if gdal.ReadDir('/vsimem/wmscache'):
+        gdaltest.post_reason('fail')
+        print(gdal.ReadDir('/vsimem/wmscache'))
+        return 'fail'
+
+    shutil.rmtree('tmp/wms_sqlite')
+
+    return 'success'
+
+###############################################################################
+# Test expiry of the tiles of the SQLite tile cache
+
+def wms_22():
+
+    sqlite3 = wms_sqlite_cache_setup(1)
+    if sqlite3 is None:
+        return 'skip'
+
+    xml = wms_sqlite_cache_xml(1, '<Expires>1</Expires>')
+    ds = gdal.Open(xml)
+    cs = ds.GetRasterBand(1).Checksum()
+    ds = None
+    if cs != 4672:
+        gdaltest.post_reason('fail')
+        print(cs)
+        return 'fail'
+
+    # Make the cached tile stale and change the remote one
+    conn = sqlite3.connect('tmp/wms_sqlite/cache/gdalwmscache.sqlite')
+    conn.execute('UPDATE tiles SET created = 0')
+    conn.commit()
+    conn.close()
+    mem_ds = gdal.GetDriverByName('MEM').Create('', 20, 20)
+    mem_ds.GetRasterBand(1).Fill(255)
+    gdal.GetDriverByName('PNG').CreateCopy('tmp/wms_sqlite/tiles/0/0/0.png',
+                                           mem_ds)
+    mem_ds = None
+    expected_cs = gdal.Open('tmp/wms_sqlite/tiles/0/0/0.png').GetRasterBand(1).Checksum()
+
+    # Online: the tile must be fetched again
+    ds = gdal.Open(xml)
+    cs = ds.GetRasterBand(1).Checksum()
+    ds = None
+    if cs != expected_cs:
+        gdaltest.post_reason('stale tile should have been fetched again')
+        print(cs, expected_cs)
+        return 'fail'
+
+    # Offline: a stale tile must be reported as missing
+    conn = sqlite3.connect('tmp/wms_sqlite/cache/gdalwmscache.sqlite')
+    conn.execute('UPDATE tiles SET created = 0')
+    conn.commit()
+    conn.close()
+    ds = gdal.Open(wms_sqlite_cache_xml(1, '<Expires>1</Expires>', offline = True))
+    cs = ds.GetRasterBand(1).Checksum()
+    ds = None
+    if cs != 0:
+        gdaltest.post_reason('stale tile should be missing in offline mode')
+        print(cs)
+        return 'fail'
+
+    if gdal.ReadDir('/vsimem/wmscache'):
+        gdaltest.post_reason('fail')
+        print(gdal.ReadDir('/vsimem/wmscache'))
+        return 'fail'
+
+    shutil.rmtree('tmp/wms_sqlite')
+
+    return 'success'
+
+###############################################################################
 def wms_cleanup():
 
     gdaltest.wms_ds = None
@@ -902,6 +1148,9 @@ gdaltest_list = [
     #wms_17,
     wms_18,
     wms_19,
+    wms_20,
+    wms_21,
+    wms_22,
     wms_cleanup ]
 
 
@@ -3852,6 +3852,51 @@ def ogr_geojson_66():
 
     return 'success'
 
+###############################################################################
+# Test that the geometries serialized by the writer without json-c objects
+# are identical to OGR_G_ExportToJson() output
+
+def ogr_geojson_67():
+
+    wkts = [ 'POINT (1.23456789012345 -2)', 'POINT Z (1 2 3)',
+             'LINESTRING (0 0,1e-10 1e10,123456789.123 -0.5)',
+             'LINESTRING EMPTY',
+             'POLYGON ((0 0,0 1,1 1,0 0),(0.2 0.2,0.8 0.8,0.2 0.8,0.2 0.2))',
+             'POLYGON EMPTY', 'MULTIPOINT (1 2,3 4)', 'MULTIPOINT Z (1 2 3)',
+             'MULTILINESTRING ((0 0,1 1),(2 2,3 3))',
+             'MULTIPOLYGON (((0 0,0 1,1 1,0 0)))', 'MULTIPOLYGON EMPTY',
+             'GEOMETRYCOLLECTION (POINT (1 2),POINT EMPTY,LINESTRING (0 0,1 1))',
+             'GEOMETRYCOLLECTION EMPTY' ]
+
+    for options in [ [], ['COORDINATE_PRECISION=3'],
+                     ['SIGNIFICANT_FIGURES=5'] ]:
+        ds = ogr.GetDriverByName('GeoJSON').CreateDataSource('/vsimem/ogr_geojson_67.json')
+        lyr = ds.CreateLayer('test', options = options)
+        for wkt in wkts + [ 'POINT EMPTY' ]:
+            f = ogr.Feature(lyr.GetLayerDefn())
+            f.SetGeometry(ogr.CreateGeometryFromWkt(wkt))
+            lyr.CreateFeature(f)
+        ds = None
+
+        fp = gdal.VSIFOpenL('/vsimem/ogr_geojson_67.json', 'rb')
+        data = gdal.VSIFReadL(1, 100000, fp).decode('ascii')
+        gdal.VSIFCloseL(fp)
+        for wkt in wkts:
+            expected = ogr.CreateGeometryFromWkt(wkt).ExportToJson(options = options)
+            if data.find('"geometry": ' + expected + ' }') < 0:
+                gdaltest.post_reason('fail')
+                print(options, wkt, expected)
+                print(data)
+                return 'fail'
+        if data.find('"geometry": null }') < 0:
+            gdaltest.post_reason('fail')
+            print(data)
+            return 'fail'
+
+    gdal.Unlink('/vsimem/ogr_geojson_67.json')
+
+    return 'success'
+
 gdaltest_list = [
     ogr_geojson_1,
     ogr_geojson_2,
@@ -3919,6 +3964,7 @@ gdaltest_list = [
     ogr_geojson_64,
     ogr_geojson_65,
     ogr_geojson_66,
+    ogr_geojson_67,
     ogr_geojson_cleanup ]
 
 if __name__ == '__main__':
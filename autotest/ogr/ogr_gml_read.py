@@ -4242,6 +4242,57 @@ def ogr_gml_82():
 
     return 'success'
 
+###############################################################################
+# Test the SPOOLED_LAYERS read mode
+
+def ogr_gml_83():
+
+    if not gdaltest.have_gml_reader:
+        return 'skip'
+
+    ds_ref = gdal.OpenEx('data/testfmegml_interleaved.gml',
+                         open_options = ['READ_MODE=STANDARD'])
+    ds = gdal.OpenEx('data/testfmegml_interleaved.gml',
+                     open_options = ['READ_MODE=SPOOLED_LAYERS'])
+    if ds.GetLayerCount() != ds_ref.GetLayerCount() or ds.GetLayerCount() < 2:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    # Read layers in an interleaved way, one feature at a time
+    expected = []
+    got = []
+    for i in range(ds.GetLayerCount()):
+        lyr_ref = ds_ref.GetLayer(i)
+        expected.append([f.DumpReadableAsString() for f in lyr_ref])
+        got.append([])
+        ds.GetLayer(i).ResetReading()
+    while True:
+        found = False
+        for i in range(ds.GetLayerCount()):
+            f = ds.GetLayer(i).GetNextFeature()
+            if f is not None:
+                found = True
+                got[i].append(f.DumpReadableAsString())
+        if not found:
+            break
+    if got != expected:
+        gdaltest.post_reason('fail')
+        print(got)
+        print(expected)
+        return 'fail'
+
+    # Re-read a layer after a ResetReading()
+    lyr = ds.GetLayer(1)
+    lyr.ResetReading()
+    if [f.DumpReadableAsString() for f in lyr] != expected[1]:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if lyr.GetFeatureCount() != len(expected[1]):
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
 ###############################################################################
 #  Cleanup
 
@@ -4461,6 +4512,7 @@ gdaltest_list = [
     ogr_gml_80,
     ogr_gml_81,
     ogr_gml_82,
+    ogr_gml_83,
     ogr_gml_cleanup ]
 
 disabled_gdaltest_list = [
@@ -4571,6 +4571,96 @@ CREATE TABLE "poly"("fid" INTEGER PRIMARY KEY, "geom" POLYGON);
 
     return 'success'
 
+###############################################################################
+# Test reading vector layers with worker threads (NUM_THREADS open option)
+
+def ogr_gpkg_58():
+
+    if gdaltest.gpkg_dr is None:
+        return 'skip'
+
+    # Worker threads need a real file, not the /vsi virtual file system
+    filename = 'tmp/ogr_gpkg_58.gpkg'
+    ds = gdaltest.gpkg_dr.CreateDataSource(filename)
+    lyr = ds.CreateLayer('test', geom_type = ogr.wkbPoint)
+    lyr.CreateField(ogr.FieldDefn('i', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('s', ogr.OFTString))
+    lyr.StartTransaction()
+    for i in range(5000):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f.SetFID(1 + 3 * i)
+        f['i'] = i
+        if i % 7 != 0:
+            f['s'] = 'str%d' % i
+        if i % 11 != 0:
+            f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(%d %d)' % (i % 100, i // 100)))
+        lyr.CreateFeature(f)
+    lyr.CommitTransaction()
+    ds = None
+
+    def read_all(lyr):
+        ret = []
+        lyr.ResetReading()
+        for f in lyr:
+            g = f.GetGeometryRef()
+            ret.append((f.GetFID(), f['i'], f['s'], g.ExportToWkt() if g else None))
+        return ret
+
+    ds_ref = ogr.Open(filename)
+    lyr_ref = ds_ref.GetLayer(0)
+    for options in [ ['NUM_THREADS=4'], ['NUM_THREADS=3', 'ORDERED_SCAN=NO'] ]:
+        ds = gdal.OpenEx(filename, gdal.OF_VECTOR, open_options = options)
+        lyr = ds.GetLayer(0)
+        ordered = 'ORDERED_SCAN=NO' not in options
+
+        # No filter, spatial filter using the R-Tree, then with an
+        # attribute filter, then only an attribute filter
+        for (rect, attr_filter) in [ (None, None),
+                                     ((10, 5, 30.5, 20), None),
+                                     ((10, 5, 30.5, 20), 'i % 3 = 0'),
+                                     (None, 's IS NULL OR i > 4000') ]:
+            for l in [ lyr_ref, lyr ]:
+                if rect is None:
+                    l.SetSpatialFilter(None)
+                else:
+                    l.SetSpatialFilterRect(rect[0], rect[1], rect[2], rect[3])
+                l.SetAttributeFilter(attr_filter)
+            expected = read_all(lyr_ref)
+            got = read_all(lyr)
+            if not ordered or attr_filter is not None:
+                expected.sort()
+                got.sort()
+            if not expected or got != expected:
+                gdaltest.post_reason('fail')
+                print(options, rect, attr_filter, len(got), len(expected))
+                return 'fail'
+
+        # Changing the spatial filter in the middle of a scan
+        lyr.SetAttributeFilter(None)
+        lyr.SetSpatialFilter(None)
+        for i in range(1500):
+            lyr.GetNextFeature()
+        lyr.SetSpatialFilterRect(10, 5, 30.5, 20)
+        lyr_ref.SetAttributeFilter(None)
+        lyr_ref.SetSpatialFilterRect(10, 5, 30.5, 20)
+        expected = sorted(read_all(lyr_ref))
+        got = sorted(read_all(lyr))
+        if got != expected:
+            gdaltest.post_reason('fail')
+            print(options)
+            return 'fail'
+        lyr_ref.SetSpatialFilter(None)
+
+        # Close the dataset while features are being read
+        lyr.SetSpatialFilter(None)
+        lyr.GetNextFeature()
+        ds = None
+    ds_ref = None
+
+    gdaltest.gpkg_dr.DeleteDataSource(filename)
+
+    return 'success'
+
 ###############################################################################
 # Remove the test db from the tmp directory
 
@@ -4653,6 +4743,7 @@ gdaltest_list = [
     ogr_gpkg_55,
     ogr_gpkg_56,
     ogr_gpkg_57,
+    ogr_gpkg_58,
     ogr_gpkg_test_ogrsf,
     ogr_gpkg_cleanup,
 ]
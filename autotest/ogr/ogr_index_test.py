@@ -493,6 +493,105 @@ def ogr_index_11():
 
     return 'success'
 
+###############################################################################
+# Test range, BETWEEN and LIKE prefix lookups through the attribute indexes
+
+def ogr_index_12():
+
+    ds = ogr.GetDriverByName( 'ESRI Shapefile' ).CreateDataSource('tmp/ogr_index_12.dbf')
+    lyr = ds.CreateLayer('ogr_index_12', geom_type = ogr.wkbNone)
+    lyr.CreateField(ogr.FieldDefn('intfield', ogr.OFTInteger))
+    lyr.CreateField(ogr.FieldDefn('realfield', ogr.OFTReal))
+    lyr.CreateField(ogr.FieldDefn('strfield', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('datefield', ogr.OFTDate))
+
+    for i in range(20):
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField('intfield', i - 5)
+        feat.SetField('realfield', (i - 10) * 0.5)
+        feat.SetField('strfield', 'foo%d' % i if i % 2 == 0 else 'bar%d' % i)
+        feat.SetField('datefield', '2018/01/%02d' % (i + 1))
+        lyr.CreateFeature(feat)
+
+    for field in [ 'intfield', 'realfield', 'strfield', 'datefield' ]:
+        ds.ExecuteSQL('CREATE INDEX ON ogr_index_12 USING %s' % field)
+
+    tests = [ ("intfield > 3 AND intfield <= 6", [ 9, 10, 11 ]),
+              ("intfield BETWEEN 0 AND 2", [ 5, 6, 7 ]),
+              ("intfield < -3", [ 0, 1 ]),
+              ("realfield > -1.5 AND realfield < 1", [ 8, 9, 10, 11 ]),
+              ("realfield >= 4", [ 18, 19 ]),
+              ("realfield < -4", [ 0, 1 ]),
+              ("strfield LIKE 'FOO1%'", [ 10, 12, 14, 16, 18 ]),
+              ("strfield LIKE 'bar1_'", [ 11, 13, 15, 17, 19 ]),
+              ("datefield >= '2018/01/18'", [ 17, 18, 19 ]),
+              ("datefield BETWEEN '2018/01/02' AND '2018/01/03'", [ 1, 2 ]) ]
+    for (sql, expected_fids) in tests:
+        lyr.SetAttributeFilter(sql)
+        ret = ogr_index_11_check(lyr, expected_fids)
+        if ret != 'success':
+            print(sql)
+            return ret
+        if lyr.GetNextFeature() is not None:
+            gdaltest.post_reason('failed')
+            print(sql)
+            return 'fail'
+
+    ds = None
+
+    return 'success'
+
+###############################################################################
+# Test range lookups on a field indexed as a 10 digit integer, and reopened as
+# a 64 bit integer field, with values that do not fit in the 32 bit keys of
+# the index
+
+def ogr_index_13():
+
+    ds = ogr.GetDriverByName( 'ESRI Shapefile' ).CreateDataSource('tmp/ogr_index_13.dbf')
+    lyr = ds.CreateLayer('ogr_index_13', geom_type = ogr.wkbNone)
+    fd = ogr.FieldDefn('int64field', ogr.OFTInteger)
+    fd.SetWidth(10)
+    lyr.CreateField(fd)
+
+    for val in [ 5, 20 ]:
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField('int64field', val)
+        lyr.CreateFeature(feat)
+
+    ds.ExecuteSQL('CREATE INDEX ON ogr_index_13 USING int64field')
+    ds = None
+
+    ds = ogr.Open('tmp/ogr_index_13.dbf', update = 1)
+    lyr = ds.GetLayer(0)
+    if lyr.GetLayerDefn().GetFieldDefn(0).GetType() != ogr.OFTInteger64:
+        gdaltest.post_reason('failed')
+        return 'fail'
+
+    for val in [ 3000000000, -3000000000 ]:
+        feat = ogr.Feature(lyr.GetLayerDefn())
+        feat.SetField('int64field', val)
+        lyr.CreateFeature(feat)
+
+    tests = [ ("int64field >= 10", [ 1, 2 ]),
+              ("int64field > 10 AND int64field < 4000000000", [ 1, 2 ]),
+              ("int64field BETWEEN 0 AND 3000000000", [ 0, 1, 2 ]),
+              ("int64field < 10", [ 0, 3 ]) ]
+    for (sql, expected_fids) in tests:
+        lyr.SetAttributeFilter(sql)
+        ret = ogr_index_11_check(lyr, expected_fids)
+        if ret != 'success':
+            print(sql)
+            return ret
+        if lyr.GetNextFeature() is not None:
+            gdaltest.post_reason('failed')
+            print(sql)
+            return 'fail'
+
+    ds = None
+
+    return 'success'
+
 ###############################################################################
 
 def ogr_index_cleanup():
@@ -522,6 +621,10 @@ def ogr_index_cleanup():
         'tmp/ogr_index_10.shp' )
     ogr.GetDriverByName( 'ESRI Shapefile' ).DeleteDataSource(
         'tmp/ogr_index_11.dbf' )
+    ogr.GetDriverByName( 'ESRI Shapefile' ).DeleteDataSource(
+        'tmp/ogr_index_12.dbf' )
+    ogr.GetDriverByName( 'ESRI Shapefile' ).DeleteDataSource(
+        'tmp/ogr_index_13.dbf' )
 
     return 'success'
 
@@ -537,6 +640,8 @@ gdaltest_list = [
     ogr_index_9,
     ogr_index_10,
     ogr_index_11,
+    ogr_index_12,
+    ogr_index_13,
     ogr_index_cleanup ]
 
 if __name__ == '__main__':
@@ -232,8 +232,8 @@ def ogr_mem_7():
     gdaltest.mem_lyr.SetSpatialFilter( geom )
     geom.Destroy()
 
-    if gdaltest.mem_lyr.TestCapability( ogr.OLCFastSpatialFilter ):
-        gdaltest.post_reason( 'OLCFastSpatialFilter capability test should have failed.' )
+    if not gdaltest.mem_lyr.TestCapability( ogr.OLCFastSpatialFilter ):
+        gdaltest.post_reason( 'OLCFastSpatialFilter capability test should have succeeded.' )
         return 'fail'
 
     tr = ogrtest.check_features_against_list( gdaltest.mem_lyr, 'eas_id',
@@ -838,6 +838,63 @@ def ogr_mem_17():
 
     return 'success'
 
+###############################################################################
+# Test that the spatial index follows feature creations, updates and deletions
+
+def ogr_mem_18():
+
+    ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    lyr = ds.CreateLayer('ogr_mem_18')
+    for i in range(100):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(%d %d)' % (i, i)))
+        lyr.CreateFeature(f)
+
+    lyr.SetSpatialFilterRect(9.5, 9.5, 12.5, 12.5)
+    fids = [ f.GetFID() for f in lyr ]
+    if fids != [ 10, 11, 12 ]:
+        gdaltest.post_reason('fail')
+        print(fids)
+        return 'fail'
+
+    # Move a feature into the filter, another one out of it, delete one,
+    # and add a new one out of the initial extent of the layer.
+    f = lyr.GetFeature(50)
+    f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(10 12)'))
+    lyr.SetFeature(f)
+    f = lyr.GetFeature(11)
+    f.SetGeometry(ogr.CreateGeometryFromWkt('POINT(1000 1000)'))
+    lyr.SetFeature(f)
+    lyr.DeleteFeature(12)
+    f = ogr.Feature(lyr.GetLayerDefn())
+    f.SetGeometry(ogr.CreateGeometryFromWkt('LINESTRING(-1000 -1000,1000 1000)'))
+    lyr.CreateFeature(f)
+
+    lyr.ResetReading()
+    fids = [ f.GetFID() for f in lyr ]
+    if fids != [ 10, 50, 100 ]:
+        gdaltest.post_reason('fail')
+        print(fids)
+        return 'fail'
+
+    if lyr.GetFeatureCount() != 3:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    lyr.SetSpatialFilterRect(999, 999, 1001, 1001)
+    fids = [ f.GetFID() for f in lyr ]
+    if fids != [ 11, 100 ]:
+        gdaltest.post_reason('fail')
+        print(fids)
+        return 'fail'
+
+    lyr.SetSpatialFilter(None)
+    if lyr.GetFeatureCount() != 100:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
 def ogr_mem_cleanup():
 
     if gdaltest.mem_ds is None:
@@ -866,6 +923,7 @@ gdaltest_list = [
     ogr_mem_15,
     ogr_mem_16,
     ogr_mem_17,
+    ogr_mem_18,
     ogr_mem_cleanup ]
 
 if __name__ == '__main__':
@@ -333,6 +333,15 @@ def ogr_osm_3_custom_compress_nodes():
     gdal.SetConfigOption('OSM_COMPRESS_NODES', None)
     return ret
 
+###############################################################################
+# Test ogr2ogr with --config OSM_DENSE_NODE_INDEX YES
+
+def ogr_osm_3_dense_node_index():
+    gdal.SetConfigOption('OSM_DENSE_NODE_INDEX', 'YES')
+    ret = ogr_osm_3()
+    gdal.SetConfigOption('OSM_DENSE_NODE_INDEX', None)
+    return ret
+
 ###############################################################################
 # Test ogr2ogr with all layers
 
@@ -975,6 +984,7 @@ gdaltest_list = [
     ogr_osm_3,
     ogr_osm_3_sqlite_nodes,
     ogr_osm_3_custom_compress_nodes,
+    ogr_osm_3_dense_node_index,
     ogr_osm_3_all_layers,
     ogr_osm_4,
     ogr_osm_5,
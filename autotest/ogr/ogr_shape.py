@@ -5273,6 +5273,75 @@ def ogr_shape_108():
 
     return 'success'
 
+###############################################################################
+# Test that attribute filters evaluated on the raw DBF records give the same
+# results as the generic evaluation (done by a Memory copy of the layer)
+
+def ogr_shape_109():
+
+    ds = ogr.GetDriverByName('ESRI Shapefile').CreateDataSource('/vsimem/ogr_shape_109.shp')
+    lyr = ds.CreateLayer('ogr_shape_109', geom_type = ogr.wkbPoint,
+                         options = ['ENCODING=ISO-8859-1'])
+    lyr.CreateField(ogr.FieldDefn('str', ogr.OFTString))
+    lyr.CreateField(ogr.FieldDefn('int', ogr.OFTInteger))
+    fld_defn = ogr.FieldDefn('int64', ogr.OFTInteger64)
+    fld_defn.SetWidth(15)
+    lyr.CreateField(fld_defn)
+    fld_defn = ogr.FieldDefn('real', ogr.OFTReal)
+    fld_defn.SetWidth(20)
+    fld_defn.SetPrecision(5)
+    lyr.CreateField(fld_defn)
+    values = [ ('foo', 1, 1234567890123, 1.5),
+               ('FOO', -2, -1234567890123, -2.25),
+               (' bar ', 3, 3, 3),
+               ('b\xc3\xa9', None, None, None),
+               (None, 0, 0, 0.0),
+               ('2017/01/01 12:34:56+00', 5, 5, 5.5) ]
+    for i, (s, n, n64, r) in enumerate(values):
+        f = ogr.Feature(lyr.GetLayerDefn())
+        if s is not None:
+            f.SetField('str', s)
+        if n is not None:
+            f.SetField('int', n)
+            f.SetField('int64', n64)
+            f.SetField('real', r)
+        f.SetGeometry(ogr.CreateGeometryFromWkt('POINT (%d %d)' % (i, i)))
+        lyr.CreateFeature(f)
+    ds = None
+
+    ds = ogr.Open('/vsimem/ogr_shape_109.shp')
+    lyr = ds.GetLayer(0)
+    mem_ds = ogr.GetDriverByName('Memory').CreateDataSource('')
+    mem_lyr = mem_ds.CopyLayer(lyr, 'ogr_shape_109')
+
+    for filter in [ "str = 'foo'", "str <> 'foo'", "str IN ('bar', 'x')",
+                    "str = 'b\xc3\xa9'", "str = '2017/01/01 12:34:56'",
+                    "int = 1", "int <> 1", "int < 3", "int <= 3", "int > 0",
+                    "int >= 0", "int IN (1, 3)", "int BETWEEN -2 AND 1",
+                    "int = 1.5", "int < 1.5",
+                    "int64 = 1234567890123", "int64 < 0", "int64 IN (3, 5)",
+                    "real = 1.5", "real > 1", "real IN (1.5, 5.5)",
+                    "real BETWEEN 0 AND 3",
+                    "int = 1 AND str = 'foo'", "int = 3 OR str = 'foo'",
+                    "int = 3 OR str LIKE 'f%'", "NOT int = 1",
+                    "int = 1 AND FID = 0", "int IS NULL", "str IS NOT NULL",
+                    "OGR_GEOM_AREA = 0 AND int = 1" ]:
+        lyr.SetAttributeFilter(filter)
+        mem_lyr.SetAttributeFilter(filter)
+        got = [ (f.GetFID(), f.GetGeometryRef().ExportToWkt()) for f in lyr ]
+        expected = [ (f.GetFID(), f.GetGeometryRef().ExportToWkt()) for f in mem_lyr ]
+        if got != expected:
+            gdaltest.post_reason('fail')
+            print(filter)
+            print(got)
+            print(expected)
+            return 'fail'
+
+    ds = None
+    ogr.GetDriverByName('ESRI Shapefile').DeleteDataSource('/vsimem/ogr_shape_109.shp')
+
+    return 'success'
+
 ###############################################################################
 def ogr_shape_cleanup():
 
@@ -5425,6 +5494,7 @@ gdaltest_list = [
     ogr_shape_106,
     ogr_shape_107,
     ogr_shape_108,
+    ogr_shape_109,
     ogr_shape_cleanup ]
 
 # gdaltest_list = [ ogr_shape_107 ]
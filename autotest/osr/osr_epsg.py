@@ -389,6 +389,41 @@ def osr_epsg_13():
 
     return 'success'
 
+###############################################################################
+# Test that the EPSG import cache returns the same definitions as a
+# fresh import, and that they can be modified independently.
+
+def osr_epsg_14():
+
+    for epsg in [ 4326, 32631, 2065, 4312, 5773, 7400, 27700 ]:
+        with gdaltest.config_option('OSR_EPSG_CACHE', 'NO'):
+            ref_sr = osr.SpatialReference()
+            ref_sr.ImportFromEPSGA( epsg )
+        ref_wkt = ref_sr.ExportToWkt()
+
+        for i in range(2):
+            sr = osr.SpatialReference()
+            sr.ImportFromEPSGA( epsg )
+            if sr.ExportToWkt() != ref_wkt:
+                gdaltest.post_reason('fail')
+                print(epsg)
+                print(sr.ExportToWkt())
+                print(ref_wkt)
+                return 'fail'
+            sr.SetAttrValue('GEOGCS|DATUM', 'modified')
+
+        sr = osr.SpatialReference()
+        sr.ImportFromEPSG( epsg )
+        with gdaltest.config_option('OSR_EPSG_CACHE', 'NO'):
+            ref_sr = osr.SpatialReference()
+            ref_sr.ImportFromEPSG( epsg )
+        if sr.ExportToWkt() != ref_sr.ExportToWkt():
+            gdaltest.post_reason('fail')
+            print(epsg)
+            return 'fail'
+
+    return 'success'
+
 ###############################################################################
 
 gdaltest_list = [
@@ -405,6 +440,7 @@ gdaltest_list = [
     osr_epsg_11,
     osr_epsg_12,
     osr_epsg_13,
+    osr_epsg_14,
     None ]
 
 if __name__ == '__main__':
@@ -111,6 +111,11 @@ def get_gdalwarp_path():
 def get_gdaladdo_path():
     return get_cli_utility_path('gdaladdo')
 
+###############################################################################
+#
+def get_gdal_tiler_path():
+    return get_cli_utility_path('gdal_tiler')
+
 ###############################################################################
 #
 def get_gdaltransform_path():
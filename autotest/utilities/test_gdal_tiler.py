@@ -0,0 +1,250 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+# $Id$
+#
+# Project:  GDAL/OGR Test Suite
+# Purpose:  gdal_tiler testing
+#
+###############################################################################
+# Copyright (c) 2018, GDAL contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+###############################################################################
+
+import sys
+import os
+import shutil
+
+sys.path.append( '../pymod' )
+
+from osgeo import gdal
+import gdaltest
+import test_cli_utilities
+
+###############################################################################
+# Return the list of (z, x, y) of the tiles of a XYZ/TMS directory
+
+def get_tiles(dirname):
+    tiles = []
+    for z in os.listdir(dirname):
+        for x in os.listdir(os.path.join(dirname, z)):
+            for y in os.listdir(os.path.join(dirname, z, x)):
+                tiles.append((int(z), int(x), int(y.split('.')[0])))
+    return sorted(tiles)
+
+###############################################################################
+# Basic XYZ generation
+
+def test_gdal_tiler_1():
+    if test_cli_utilities.get_gdal_tiler_path() is None:
+        return 'skip'
+
+    shutil.rmtree('tmp/test_gdal_tiler_1', ignore_errors=True)
+
+    (out, err) = gdaltest.runexternal_out_and_err(test_cli_utilities.get_gdal_tiler_path() + ' -q -z 10-13 ../gcore/data/byte.tif tmp/test_gdal_tiler_1')
+    if not (err is None or err == '') :
+        gdaltest.post_reason('got error/warning')
+        print(err)
+        return 'fail'
+
+    tiles = get_tiles('tmp/test_gdal_tiler_1')
+    if len([t for t in tiles if t[0] == 10]) != 1 or \
+       len([t for t in tiles if t[0] == 13]) == 0:
+        gdaltest.post_reason('fail')
+        print(tiles)
+        return 'fail'
+
+    # Each tile is within its parent
+    for (z, x, y) in tiles:
+        if z > 10 and (z - 1, x // 2, y // 2) not in tiles:
+            gdaltest.post_reason('fail')
+            print(z, x, y)
+            return 'fail'
+
+    (z, x, y) = tiles[-1]
+    ds = gdal.Open('tmp/test_gdal_tiler_1/%d/%d/%d.png' % (z, x, y))
+    if ds.RasterXSize != 256 or ds.RasterYSize != 256 or ds.RasterCount != 2:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if ds.GetRasterBand(2).Checksum() == 0:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    ds = None
+
+    return 'success'
+
+###############################################################################
+# Test -of TMS
+
+def test_gdal_tiler_2():
+    if test_cli_utilities.get_gdal_tiler_path() is None:
+        return 'skip'
+
+    shutil.rmtree('tmp/test_gdal_tiler_2', ignore_errors=True)
+
+    gdaltest.runexternal(test_cli_utilities.get_gdal_tiler_path() + ' -q -of TMS -z 10-13 ../gcore/data/byte.tif tmp/test_gdal_tiler_2')
+
+    tiles_xyz = get_tiles('tmp/test_gdal_tiler_1')
+    tiles_tms = get_tiles('tmp/test_gdal_tiler_2')
+    expected = sorted([(z, x, (1 << z) - 1 - y) for (z, x, y) in tiles_xyz])
+    if tiles_tms != expected:
+        gdaltest.post_reason('fail')
+        print(tiles_tms)
+        print(expected)
+        return 'fail'
+
+    for (z, x, y) in tiles_xyz:
+        ds1 = gdal.Open('tmp/test_gdal_tiler_1/%d/%d/%d.png' % (z, x, y))
+        ds2 = gdal.Open('tmp/test_gdal_tiler_2/%d/%d/%d.png' % (z, x, (1 << z) - 1 - y))
+        if ds1.GetRasterBand(1).Checksum() != ds2.GetRasterBand(1).Checksum():
+            gdaltest.post_reason('fail')
+            print(z, x, y)
+            return 'fail'
+
+    shutil.rmtree('tmp/test_gdal_tiler_2')
+
+    return 'success'
+
+###############################################################################
+# Return a dictionary of the per-band checksums of the tiles of a XYZ/TMS
+# directory, indexed by (z, x, y)
+
+def get_checksums(dirname):
+    checksums = {}
+    for (z, x, y) in get_tiles(dirname):
+        ds = gdal.Open('%s/%d/%d/%d.png' % (dirname, z, x, y))
+        checksums[(z, x, y)] = [ds.GetRasterBand(i+1).Checksum() for i in range(ds.RasterCount)]
+        ds = None
+    return checksums
+
+###############################################################################
+# Test -resume after an interrupted run, simulated by removing tiles. The
+# chunks of tiles are generated at zoom level 10 for -z 7-13.
+
+def test_gdal_tiler_3():
+    if test_cli_utilities.get_gdal_tiler_path() is None:
+        return 'skip'
+
+    dirname = 'tmp/test_gdal_tiler_3'
+    shutil.rmtree(dirname, ignore_errors=True)
+
+    cmd = test_cli_utilities.get_gdal_tiler_path() + ' -q -z 7-13 ../gcore/data/byte.tif ' + dirname
+    gdaltest.runexternal(cmd)
+    checksums = get_checksums(dirname)
+    tiles = sorted(checksums.keys())
+    if sorted(set([t[0] for t in tiles])) != list(range(7, 14)):
+        gdaltest.post_reason('fail')
+        print(tiles)
+        return 'fail'
+
+    # Only the levels above the chunks are missing: the chunks must be reused.
+    # Then the tile of the chunk is also missing, as well as one of its
+    # descendants: the chunk must be generated again.
+    old_mtime = 1000000000
+    for (deleted_zooms, deleted_tiles, rewritten_zooms) in \
+            [ ([7, 8, 9], [], [7, 8, 9]),
+              ([7, 8, 9, 10], [tiles[-1]], list(range(7, 14))) ]:
+        for (z, x, y) in tiles:
+            os.utime('%s/%d/%d/%d.png' % (dirname, z, x, y), (old_mtime, old_mtime))
+        for z in deleted_zooms:
+            shutil.rmtree('%s/%d' % (dirname, z))
+        for (z, x, y) in deleted_tiles:
+            os.unlink('%s/%d/%d/%d.png' % (dirname, z, x, y))
+
+        (out, err) = gdaltest.runexternal_out_and_err(cmd.replace(' -q ', ' -q -resume '))
+        if not (err is None or err == '') :
+            gdaltest.post_reason('got error/warning')
+            print(err)
+            return 'fail'
+
+        if get_checksums(dirname) != checksums:
+            gdaltest.post_reason('fail')
+            print(deleted_zooms)
+            return 'fail'
+        for (z, x, y) in tiles:
+            mtime = os.stat('%s/%d/%d/%d.png' % (dirname, z, x, y)).st_mtime
+            if (mtime != old_mtime) != (z in rewritten_zooms):
+                gdaltest.post_reason('fail')
+                print(deleted_zooms, z, x, y, mtime)
+                return 'fail'
+
+    shutil.rmtree(dirname)
+
+    return 'success'
+
+###############################################################################
+# Test GPKG output: same tiles as the XYZ output
+
+def test_gdal_tiler_4():
+    if test_cli_utilities.get_gdal_tiler_path() is None:
+        return 'skip'
+    if gdal.GetDriverByName('GPKG') is None:
+        return 'skip'
+
+    gdal.Unlink('tmp/test_gdal_tiler_4.gpkg')
+
+    (out, err) = gdaltest.runexternal_out_and_err(test_cli_utilities.get_gdal_tiler_path() + ' -q -z 10-13 ../gcore/data/byte.tif tmp/test_gdal_tiler_4.gpkg')
+    if not (err is None or err == '') :
+        gdaltest.post_reason('got error/warning')
+        print(err)
+        return 'fail'
+
+    max_gm = 20037508.342789244
+    # Compare with the gray+alpha PNG tiles
+    gpkg_ds = gdal.OpenEx('tmp/test_gdal_tiler_4.gpkg', open_options = ['BAND_COUNT=2'])
+    if gpkg_ds.GetRasterBand(1).GetOverviewCount() != 3:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    for (z, x, y) in get_tiles('tmp/test_gdal_tiler_1'):
+        if z == 13:
+            ds = gpkg_ds
+        else:
+            ds = gpkg_ds.GetRasterBand(1).GetOverview(12 - z).GetDataset()
+        gt = ds.GetGeoTransform()
+        res = 2 * max_gm / 256 / (1 << z)
+        xoff = int((-max_gm + x * 256 * res - gt[0]) / gt[1] + 0.5)
+        yoff = int((max_gm - y * 256 * res - gt[3]) / gt[5] + 0.5)
+        tile_ds = gdal.Open('tmp/test_gdal_tiler_1/%d/%d/%d.png' % (z, x, y))
+        if ds.ReadRaster(xoff, yoff, 256, 256) != tile_ds.ReadRaster():
+            gdaltest.post_reason('fail')
+            print(z, x, y)
+            return 'fail'
+    gpkg_ds = None
+
+    gdal.Unlink('tmp/test_gdal_tiler_4.gpkg')
+    shutil.rmtree('tmp/test_gdal_tiler_1')
+
+    return 'success'
+
+gdaltest_list = [
+    test_gdal_tiler_1,
+    test_gdal_tiler_2,
+    test_gdal_tiler_3,
+    test_gdal_tiler_4
+    ]
+
+
+if __name__ == '__main__':
+
+    gdaltest.setup_run( 'test_gdal_tiler' )
+
+    gdaltest.run_tests( gdaltest_list )
+
+    gdaltest.summarize()
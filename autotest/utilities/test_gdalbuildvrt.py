@@ -544,6 +544,95 @@ def test_gdalbuildvrt_16():
 
     return 'success'
 
+###############################################################################
+# Test -threads and -tileindex_footprints
+
+def test_gdalbuildvrt_17():
+    if test_cli_utilities.get_gdalbuildvrt_path() is None:
+        return 'skip'
+    if test_cli_utilities.get_gdaltindex_path() is None:
+        return 'skip'
+
+    (out, err) = gdaltest.runexternal_out_and_err(test_cli_utilities.get_gdalbuildvrt_path() + ' -threads 3 tmp/mosaic.vrt tmp/gdalbuildvrt1.tif tmp/gdalbuildvrt2.tif tmp/gdalbuildvrt3.tif tmp/gdalbuildvrt4.tif')
+    if not (err is None or err == '') :
+        gdaltest.post_reason('got error/warning')
+        print(err)
+        return 'fail'
+
+    ret = test_gdalbuildvrt_check()
+    if ret != 'success':
+        return ret
+
+    # tmp/tileindex.shp has been created by test_gdalbuildvrt_2
+    gdal.GetDriverByName('VRT').Delete('tmp/mosaic.vrt')
+    (out, err) = gdaltest.runexternal_out_and_err(test_cli_utilities.get_gdalbuildvrt_path() + ' -threads 2 -tileindex_footprints tmp/mosaic.vrt tmp/tileindex.shp')
+    if not (err is None or err == '') :
+        gdaltest.post_reason('got error/warning')
+        print(err)
+        return 'fail'
+
+    ret = test_gdalbuildvrt_check()
+    if ret != 'success':
+        return ret
+
+    # Footprints in another SRS than the tiles must not be used
+    shp_drv = ogr.GetDriverByName('ESRI Shapefile')
+    for name in ['tmp/test_gdalbuildvrt_17_3857.shp', 'tmp/test_gdalbuildvrt_17.shp']:
+        if os.path.exists(name):
+            shp_drv.DeleteDataSource(name)
+    gdaltest.runexternal(test_cli_utilities.get_gdaltindex_path() + ' -t_srs EPSG:3857 tmp/test_gdalbuildvrt_17_3857.shp tmp/gdalbuildvrt1.tif tmp/gdalbuildvrt2.tif tmp/gdalbuildvrt3.tif tmp/gdalbuildvrt4.tif')
+    gdal.GetDriverByName('VRT').Delete('tmp/mosaic.vrt')
+    (out, err) = gdaltest.runexternal_out_and_err(test_cli_utilities.get_gdalbuildvrt_path() + ' -tileindex_footprints tmp/mosaic.vrt tmp/test_gdalbuildvrt_17_3857.shp')
+    shp_drv.DeleteDataSource('tmp/test_gdalbuildvrt_17_3857.shp')
+    if err.find('not in the projection of the tiles') < 0:
+        gdaltest.post_reason('expected warning')
+        print(err)
+        return 'fail'
+
+    ret = test_gdalbuildvrt_check()
+    if ret != 'success':
+        return ret
+
+    # Only the first tile must be opened: the others are deleted before
+    # building the VRT
+    for i in range(4):
+        gdal.GetDriverByName('GTiff').CreateCopy(
+            'tmp/test_gdalbuildvrt_17_%d.tif' % (i + 1),
+            gdal.Open('tmp/gdalbuildvrt%d.tif' % (i + 1)))
+    gdaltest.runexternal(test_cli_utilities.get_gdaltindex_path() + ' tmp/test_gdalbuildvrt_17.shp tmp/test_gdalbuildvrt_17_1.tif tmp/test_gdalbuildvrt_17_2.tif tmp/test_gdalbuildvrt_17_3.tif tmp/test_gdalbuildvrt_17_4.tif')
+    for i in range(1, 4):
+        gdal.GetDriverByName('GTiff').Delete('tmp/test_gdalbuildvrt_17_%d.tif' % (i + 1))
+    (out, err) = gdaltest.runexternal_out_and_err(test_cli_utilities.get_gdalbuildvrt_path() + ' -tileindex_footprints tmp/test_gdalbuildvrt_17.vrt tmp/test_gdalbuildvrt_17.shp')
+    shp_drv.DeleteDataSource('tmp/test_gdalbuildvrt_17.shp')
+    gdal.GetDriverByName('GTiff').Delete('tmp/test_gdalbuildvrt_17_1.tif')
+    if not (err is None or err == '') :
+        gdaltest.post_reason('got error/warning')
+        print(err)
+        return 'fail'
+
+    ds = gdal.Open('tmp/test_gdalbuildvrt_17.vrt')
+    gt = ds.GetGeoTransform()
+    expected_gt = [ 2, 0.1, 0, 49, 0, -0.1 ]
+    for i in range(6):
+        if abs(gt[i] - expected_gt[i]) > 1e-5:
+            gdaltest.post_reason('fail')
+            print(gt)
+            return 'fail'
+    if ds.RasterXSize != 20 or ds.RasterYSize != 20 or ds.RasterCount != 1:
+        gdaltest.post_reason('fail')
+        print(ds.RasterXSize, ds.RasterYSize, ds.RasterCount)
+        return 'fail'
+    ds = None
+    vrt_content = open('tmp/test_gdalbuildvrt_17.vrt').read()
+    os.unlink('tmp/test_gdalbuildvrt_17.vrt')
+    for i in range(4):
+        if vrt_content.find('test_gdalbuildvrt_17_%d.tif' % (i + 1)) < 0:
+            gdaltest.post_reason('fail')
+            print(vrt_content)
+            return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Cleanup
 
@@ -604,6 +693,7 @@ gdaltest_list = [
     test_gdalbuildvrt_14,
     test_gdalbuildvrt_15,
     test_gdalbuildvrt_16,
+    test_gdalbuildvrt_17,
     test_gdalbuildvrt_cleanup
     ]
 
@@ -29,6 +29,7 @@
 # DEALINGS IN THE SOFTWARE.
 ###############################################################################
 
+import struct
 import sys
 
 sys.path.append( '../pymod' )
@@ -155,6 +156,48 @@ def test_gdallocationinfo_6():
 
     return 'success'
 
+###############################################################################
+# Test -batch and -r
+
+def test_gdallocationinfo_7():
+    if test_cli_utilities.get_gdallocationinfo_path() is None:
+        return 'skip'
+
+    # Batch mode must report the same values as -valonly, in input order
+    strin = '10 10\n0 0\n-1 0\n19 19\n1 0\n'
+    ref = gdaltest.runexternal(test_cli_utilities.get_gdallocationinfo_path() + ' -valonly ../gcore/data/byte.tif', strin)
+    ret = gdaltest.runexternal(test_cli_utilities.get_gdallocationinfo_path() + ' -batch ../gcore/data/byte.tif', strin)
+    if ret != ref:
+        print(ref)
+        print(ret)
+        return 'fail'
+
+    ds = gdal.Open('../gcore/data/byte.tif')
+    data = ds.GetRasterBand(1).ReadRaster(0, 0, 2, 2)
+    ds = None
+    vals = struct.unpack('B' * 4, data)
+
+    # Bilinear interpolation between the centers of the 4 top-left pixels
+    ret = gdaltest.runexternal(test_cli_utilities.get_gdallocationinfo_path() + ' -r bilinear ../gcore/data/byte.tif 1 1')
+    expected = (vals[0] + vals[1] + vals[2] + vals[3]) / 4.0
+    if abs(float(ret) - expected) > 1e-8:
+        print(ret)
+        return 'fail'
+
+    # At a pixel center, interpolation returns the pixel value
+    ret = gdaltest.runexternal(test_cli_utilities.get_gdallocationinfo_path() + ' -r cubic ../gcore/data/byte.tif 0.5 0.5')
+    if abs(float(ret) - vals[0]) > 1e-8:
+        print(ret)
+        return 'fail'
+
+    # A band that cannot be queried gives an empty value for each point
+    ret = gdaltest.runexternal(test_cli_utilities.get_gdallocationinfo_path() + ' -batch -overview 1 ../gcore/data/byte.tif', '0 0\n1 1\n2 2\n')
+    if ret.count('\n') != 3 or ret.strip() != '':
+        print(ret)
+        return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     test_gdallocationinfo_1,
     test_gdallocationinfo_2,
@@ -162,6 +205,7 @@ gdaltest_list = [
     test_gdallocationinfo_4,
     test_gdallocationinfo_5,
     test_gdallocationinfo_6,
+    test_gdallocationinfo_7,
     ]
 
 
@@ -33,7 +33,7 @@ import sys
 
 sys.path.append( '../pymod' )
 
-from osgeo import gdal, ogr
+from osgeo import gdal, ogr, osr
 import gdaltest
 import ogrtest
 
@@ -408,6 +408,87 @@ def test_ogr2ogr_lib_18():
 
     return 'success'
 
+###############################################################################
+# Test -threads : output must be identical to the single-threaded one
+
+def test_ogr2ogr_lib_19():
+
+    src_ds = gdal.OpenEx('../ogr/data/poly.shp')
+    ref_ds = gdal.VectorTranslate('', src_ds, format = 'Memory',
+                                  options = '-t_srs EPSG:4326 -segmentize 100')
+    ds = gdal.VectorTranslate('', src_ds, format = 'Memory',
+                              options = '-t_srs EPSG:4326 -segmentize 100 -threads 3')
+    ref_lyr = ref_ds.GetLayer(0)
+    lyr = ds.GetLayer(0)
+    if lyr.GetFeatureCount() != 10:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    for i in range(10):
+        ref_f = ref_lyr.GetNextFeature()
+        f = lyr.GetNextFeature()
+        if f.GetField('EAS_ID') != ref_f.GetField('EAS_ID') or \
+           f.GetGeometryRef().ExportToWkt() != ref_f.GetGeometryRef().ExportToWkt():
+            gdaltest.post_reason('fail')
+            f.DumpReadable()
+            ref_f.DumpReadable()
+            return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test -threads with several batches, group transactions smaller than a
+# batch and non contiguous FIDs: the output must match a single-threaded run
+
+def test_ogr2ogr_lib_20():
+
+    if ogr.GetDriverByName('GPKG') is None:
+        return 'skip'
+
+    src_ds = gdal.GetDriverByName('Memory').Create('', 0, 0, 0, gdal.GDT_Unknown)
+    sr = osr.SpatialReference()
+    sr.ImportFromEPSG(32631)
+    src_lyr = src_ds.CreateLayer('test', srs = sr, geom_type = ogr.wkbPoint)
+    src_lyr.CreateField(ogr.FieldDefn('val', ogr.OFTInteger))
+    for i in range(2000):
+        f = ogr.Feature(src_lyr.GetLayerDefn())
+        f.SetFID(10 * i + 7)
+        f.SetField('val', i)
+        f.SetGeometry(ogr.CreateGeometryFromWkt(
+            'POINT (%d %d)' % (400000 + i, 5000000 + i)))
+        src_lyr.CreateFeature(f)
+
+    ref_ds = gdal.VectorTranslate('/vsimem/test_ogr2ogr_lib_20_ref.gpkg',
+                                  src_ds, format = 'GPKG',
+                                  options = '-t_srs EPSG:4326 -preserve_fid -gt 100')
+    ds = gdal.VectorTranslate('/vsimem/test_ogr2ogr_lib_20.gpkg',
+                              src_ds, format = 'GPKG',
+                              options = '-t_srs EPSG:4326 -preserve_fid -gt 100 -threads 3')
+    ref_lyr = ref_ds.GetLayer(0)
+    lyr = ds.GetLayer(0)
+    if lyr.GetFeatureCount() != 2000:
+        gdaltest.post_reason('fail')
+        print(lyr.GetFeatureCount())
+        return 'fail'
+    ret = 'success'
+    for i in range(2000):
+        ref_f = ref_lyr.GetNextFeature()
+        f = lyr.GetNextFeature()
+        if f.GetFID() != ref_f.GetFID() or f.GetFID() != 10 * i + 7 or \
+           f.GetField('val') != i or \
+           f.GetGeometryRef().ExportToWkt() != ref_f.GetGeometryRef().ExportToWkt():
+            gdaltest.post_reason('fail')
+            f.DumpReadable()
+            ref_f.DumpReadable()
+            ret = 'fail'
+            break
+
+    ref_ds = None
+    ds = None
+    gdal.Unlink('/vsimem/test_ogr2ogr_lib_20_ref.gpkg')
+    gdal.Unlink('/vsimem/test_ogr2ogr_lib_20.gpkg')
+
+    return ret
+
 gdaltest_list = [
     test_ogr2ogr_lib_1,
     test_ogr2ogr_lib_2,
@@ -426,7 +507,9 @@ gdaltest_list = [
     test_ogr2ogr_lib_15,
     test_ogr2ogr_lib_16,
     test_ogr2ogr_lib_17,
-    test_ogr2ogr_lib_18
+    test_ogr2ogr_lib_18,
+    test_ogr2ogr_lib_19,
+    test_ogr2ogr_lib_20
     ]
 
 if __name__ == '__main__':
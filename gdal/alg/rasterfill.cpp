@@ -37,12 +37,15 @@
 #include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 
 CPL_CVSID("$Id$")
@@ -362,6 +365,733 @@ if( quad_value != nNoDataVal )                                          \
     }                                                                   \
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*      Tiled, multi-threaded implementation.                           */
+/*                                                                      */
+/*      The value of a filled pixel only depends on the "nearest       */
+/*      valid pixel above / below" information of the columns within   */
+/*      the search distance, and that information only depends on the  */
+/*      pixels within the search distance above / below.  So the        */
+/*      raster is processed by strips of lines, read with a halo of     */
+/*      nMaxSearchDist lines below (the top-down information is         */
+/*      carried from one strip to the next), and each strip is split    */
+/*      in column tiles with a halo of nMaxSearchDist columns that are  */
+/*      processed in parallel.  The computations are the same as in     */
+/*      the scanline implementation, including its handling of the      */
+/*      first and last lines, so the results are identical.             */
+/* ==================================================================== */
+/************************************************************************/
+
+namespace {
+
+struct GDALFillStrip
+{
+    int             nXSize;
+    int             nYSize;
+    double          dfMaxSearchDist;
+    int             nMaxSearchDist;
+    GUInt32         nNoDataVal;
+
+    // Lines [nStripY0, nStripY1) are filled, from the window of lines
+    // [nStripY0, nWindowY1) held in pabyMask and pafValues.
+    int             nStripY0;
+    int             nStripY1;
+    int             nWindowY1;
+    const GByte    *pabyMask;
+    const float    *pafValues;
+
+    // Top-down information of line nStripY0 - 1, and where the one of
+    // line nStripY1 - 1 is stored.
+    const GUInt32  *panTopDownY;
+    const float    *pafTopDownValue;
+    GUInt32        *panNextTopDownY;
+    float          *pafNextTopDownValue;
+
+    // Filled values and filter mask of the strip lines.
+    float          *pafOut;
+    GByte          *pabyFiltMask;
+};
+
+struct GDALFillTileJob
+{
+    const GDALFillStrip *psStrip;
+    int                  nX0;
+    int                  nX1;
+    bool                 bOK;
+};
+
+}  // namespace
+
+/************************************************************************/
+/*                         GDALFillTileFunc()                           */
+/************************************************************************/
+
+static void GDALFillTileFunc( void *pData )
+{
+    GDALFillTileJob *psJob = static_cast<GDALFillTileJob *>(pData);
+    const GDALFillStrip *psStrip = psJob->psStrip;
+
+    const int nXSize = psStrip->nXSize;
+    const int nYSize = psStrip->nYSize;
+    const double dfMaxSearchDist = psStrip->dfMaxSearchDist;
+    const int nMaxSearchDist = psStrip->nMaxSearchDist;
+    const GUInt32 nNoDataVal = psStrip->nNoDataVal;
+    const int nY0 = psStrip->nStripY0;
+    const int nLines = psStrip->nStripY1 - nY0;
+    const int nHaloX0 = std::max(0, psJob->nX0 - nMaxSearchDist);
+    const int nHaloX1 = std::min(nXSize, psJob->nX1 + nMaxSearchDist);
+    const int nCols = nHaloX1 - nHaloX0;
+
+    GUInt32 *panTopDownY = static_cast<GUInt32 *>(
+        VSI_MALLOC3_VERBOSE(nCols, nLines, sizeof(GUInt32)));
+    float *pafTopDownValue = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nCols, nLines, sizeof(float)));
+    GUInt32 *panBottomUpY = static_cast<GUInt32 *>(
+        VSI_MALLOC3_VERBOSE(nCols, nLines, sizeof(GUInt32)));
+    float *pafBottomUpValue = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nCols, nLines, sizeof(float)));
+    if( panTopDownY == NULL || pafTopDownValue == NULL ||
+        panBottomUpY == NULL || pafBottomUpValue == NULL )
+    {
+        CPLFree(panTopDownY);
+        CPLFree(pafTopDownValue);
+        CPLFree(panBottomUpY);
+        CPLFree(pafBottomUpValue);
+        psJob->bOK = false;
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Collect the "last known value" of each column, from the top     */
+/*      (including the current line) and from the bottom (excluding     */
+/*      it, as the scanline implementation uses the information of the  */
+/*      previous line of its bottom to top pass).                       */
+/* -------------------------------------------------------------------- */
+    for( int iCol = 0; iCol < nCols; iCol++ )
+    {
+        const int iX = nHaloX0 + iCol;
+
+        GUInt32 nLastY = psStrip->panTopDownY[iX];
+        float fLastValue = psStrip->pafTopDownValue[iX];
+        for( int iLine = 0; iLine < nLines; iLine++ )
+        {
+            const int iY = nY0 + iLine;
+            const size_t nIdx = static_cast<size_t>(iLine) * nXSize + iX;
+            if( psStrip->pabyMask[nIdx] )
+            {
+                fLastValue = psStrip->pafValues[nIdx];
+                nLastY = iY;
+            }
+            else if( !(iY <= dfMaxSearchDist + nLastY) )
+            {
+                nLastY = nNoDataVal;
+            }
+            panTopDownY[iLine * nCols + iCol] = nLastY;
+            pafTopDownValue[iLine * nCols + iCol] = fLastValue;
+        }
+        if( iX >= psJob->nX0 && iX < psJob->nX1 )
+        {
+            psStrip->panNextTopDownY[iX] = nLastY;
+            psStrip->pafNextTopDownValue[iX] = fLastValue;
+        }
+
+        // The window extends nMaxSearchDist lines below the strip (or up
+        // to the last line), so a valid pixel below it is out of reach.
+        nLastY = nNoDataVal;
+        fLastValue = 0.0f;
+        for( int iY = psStrip->nWindowY1 - 1; iY > nY0; iY-- )
+        {
+            const size_t nIdx =
+                static_cast<size_t>(iY - nY0) * nXSize + iX;
+            if( psStrip->pabyMask[nIdx] )
+            {
+                fLastValue = psStrip->pafValues[nIdx];
+                nLastY = iY;
+            }
+            else if( !(nLastY - iY <= dfMaxSearchDist) )
+            {
+                nLastY = nNoDataVal;
+            }
+            const int iLine = iY - 1 - nY0;
+            if( iLine < nLines )
+            {
+                panBottomUpY[iLine * nCols + iCol] = nLastY;
+                pafBottomUpValue[iLine * nCols + iCol] = fLastValue;
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Interpolate the nodata pixels of the tile.                      */
+/* -------------------------------------------------------------------- */
+    for( int iLine = 0; iLine < nLines; iLine++ )
+    {
+        const int iY = nY0 + iLine;
+        const GByte *pabyMask =
+            psStrip->pabyMask + static_cast<size_t>(iLine) * nXSize;
+        float *pafScanline =
+            psStrip->pafOut + static_cast<size_t>(iLine) * nXSize;
+        GByte *pabyFiltMask =
+            psStrip->pabyFiltMask + static_cast<size_t>(iLine) * nXSize;
+
+        // Shifted so that they can be indexed by column.
+        const GUInt32 *panTopDownLineY =
+            panTopDownY + iLine * nCols - nHaloX0;
+        const float *pafTopDownLineValue =
+            pafTopDownValue + iLine * nCols - nHaloX0;
+        // The scanline implementation uses the top-down information as
+        // bottom information for the last line.
+        const GUInt32 *panLastY = iY == nYSize - 1 ?
+            panTopDownLineY : panBottomUpY + iLine * nCols - nHaloX0;
+        const float *pafLastValue = iY == nYSize - 1 ?
+            pafTopDownLineValue : pafBottomUpValue + iLine * nCols - nHaloX0;
+
+        for( int iX = psJob->nX0; iX < psJob->nX1; iX++ )
+        {
+            int nThisMaxSearchDist = nMaxSearchDist;
+
+            if( pabyMask[iX] )
+                continue;
+
+            double adfQuadDist[4] = {};
+            double adfQuadValue[4] = {};
+
+            for( int iQuad = 0; iQuad < 4; iQuad++ )
+            {
+                adfQuadDist[iQuad] = dfMaxSearchDist + 1.0;
+                adfQuadValue[iQuad] = 0.0;
+            }
+
+            for( int iStep = 0; iStep < nThisMaxSearchDist; iStep++ )
+            {
+                const int iLeftX = std::max(0, iX - iStep);
+                const int iRightX = std::min(nXSize - 1, iX + iStep);
+
+                QUAD_CHECK(adfQuadDist[0], adfQuadValue[0],
+                           iLeftX, panTopDownLineY[iLeftX], iX, iY,
+                           pafTopDownLineValue[iLeftX] );
+
+                QUAD_CHECK(adfQuadDist[1], adfQuadValue[1],
+                           iLeftX, panLastY[iLeftX], iX, iY,
+                           pafLastValue[iLeftX] );
+
+                if( iStep == 0 )
+                     continue;
+
+                QUAD_CHECK(adfQuadDist[2], adfQuadValue[2],
+                           iRightX, panTopDownLineY[iRightX], iX, iY,
+                           pafTopDownLineValue[iRightX] );
+
+                QUAD_CHECK(adfQuadDist[3], adfQuadValue[3],
+                           iRightX, panLastY[iRightX], iX, iY,
+                           pafLastValue[iRightX] );
+
+                if( (iStep & 0x3) == 0 )
+                    nThisMaxSearchDist = static_cast<int>(floor(
+                        std::max(std::max(adfQuadDist[0], adfQuadDist[1]),
+                                 std::max(adfQuadDist[2], adfQuadDist[3]))));
+            }
+
+            double dfWeightSum = 0.0;
+            double dfValueSum = 0.0;
+
+            for( int iQuad = 0; iQuad < 4; iQuad++ )
+            {
+                if( adfQuadDist[iQuad] <= dfMaxSearchDist )
+                {
+                    const double dfWeight = 1.0 / adfQuadDist[iQuad];
+
+                    dfWeightSum += dfWeight;
+                    dfValueSum += adfQuadValue[iQuad] * dfWeight;
+                }
+            }
+
+            if( dfWeightSum > 0.0 )
+            {
+                pabyFiltMask[iX] = 255;
+                pafScanline[iX] = static_cast<float>(dfValueSum / dfWeightSum);
+            }
+        }
+    }
+
+    CPLFree(panTopDownY);
+    CPLFree(pafTopDownValue);
+    CPLFree(panBottomUpY);
+    CPLFree(pafBottomUpValue);
+    psJob->bOK = true;
+}
+
+/************************************************************************/
+/*                        GDALRunTileJobs()                             */
+/*                                                                      */
+/*      Run one job per column tile and wait for all of them.           */
+/************************************************************************/
+
+template<class JobType>
+static bool GDALRunTileJobs( CPLWorkerThreadPool *poPool,
+                             CPLThreadFunc pfnFunc,
+                             std::vector<JobType>& aoJobs )
+{
+    std::vector<void *> apData;
+    for( size_t i = 0; i < aoJobs.size(); i++ )
+        apData.push_back(&aoJobs[i]);
+    if( !poPool->SubmitJobs(pfnFunc, apData) )
+        return false;
+    poPool->WaitCompletion();
+    for( size_t i = 0; i < aoJobs.size(); i++ )
+    {
+        if( !aoJobs[i].bOK )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                        GDALFillNodataTiled()                         */
+/************************************************************************/
+
+static CPLErr
+GDALFillNodataTiled( GDALRasterBandH hTargetBand,
+                     GDALRasterBandH hMaskBand,
+                     GDALRasterBandH hFiltMaskBand,
+                     double dfMaxSearchDist,
+                     GUInt32 nNoDataVal,
+                     CPLWorkerThreadPool *poPool,
+                     double dfProgressRatio,
+                     GDALProgressFunc pfnProgress,
+                     void * pProgressArg )
+
+{
+    const int nXSize = GDALGetRasterBandXSize(hTargetBand);
+    const int nYSize = GDALGetRasterBandYSize(hTargetBand);
+    const int nMaxSearchDist = static_cast<int>(floor(dfMaxSearchDist));
+
+    const int nStripLines =
+        std::min(nYSize, std::max(64, std::min(512, nMaxSearchDist)));
+    const int nTileCols =
+        std::max(256, 2 * std::min(nMaxSearchDist, nXSize));
+    const int nMaxWindowLines =
+        static_cast<int>(std::min(static_cast<GIntBig>(nYSize),
+                                  static_cast<GIntBig>(nStripLines) +
+                                      nMaxSearchDist + 1));
+
+    GByte *pabyMask = static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(nXSize, nMaxWindowLines));
+    float *pafValues = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nMaxWindowLines, sizeof(float)));
+    float *pafOut = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nStripLines, sizeof(float)));
+    GByte *pabyFiltMask = static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(nXSize, nStripLines));
+    GUInt32 *panTopDownY = static_cast<GUInt32 *>(
+        VSI_MALLOC2_VERBOSE(nXSize, sizeof(GUInt32)));
+    float *pafTopDownValue = static_cast<float *>(
+        VSI_CALLOC_VERBOSE(nXSize, sizeof(float)));
+    GUInt32 *panNextTopDownY = static_cast<GUInt32 *>(
+        VSI_MALLOC2_VERBOSE(nXSize, sizeof(GUInt32)));
+    float *pafNextTopDownValue = static_cast<float *>(
+        VSI_MALLOC2_VERBOSE(nXSize, sizeof(float)));
+
+    CPLErr eErr = CE_None;
+    if( pabyMask == NULL || pafValues == NULL || pafOut == NULL ||
+        pabyFiltMask == NULL || panTopDownY == NULL ||
+        pafTopDownValue == NULL || panNextTopDownY == NULL ||
+        pafNextTopDownValue == NULL )
+    {
+        eErr = CE_Failure;
+    }
+    else
+    {
+        for( int iX = 0; iX < nXSize; iX++ )
+            panTopDownY[iX] = nNoDataVal;
+    }
+
+    GDALFillStrip sStrip;
+    sStrip.nXSize = nXSize;
+    sStrip.nYSize = nYSize;
+    sStrip.dfMaxSearchDist = dfMaxSearchDist;
+    sStrip.nMaxSearchDist = nMaxSearchDist;
+    sStrip.nNoDataVal = nNoDataVal;
+    sStrip.pabyMask = pabyMask;
+    sStrip.pafValues = pafValues;
+    sStrip.pafOut = pafOut;
+    sStrip.pabyFiltMask = pabyFiltMask;
+
+    std::vector<GDALFillTileJob> asJobs;
+    for( int iX = 0; iX < nXSize; iX += nTileCols )
+    {
+        GDALFillTileJob sJob;
+        sJob.psStrip = &sStrip;
+        sJob.nX0 = iX;
+        sJob.nX1 = std::min(nXSize, iX + nTileCols);
+        sJob.bOK = false;
+        asJobs.push_back(sJob);
+    }
+
+    // Lines of the window that are already loaded, starting at nStripY0.
+    int nLoadedY1 = 0;
+    for( int nY0 = 0; nY0 < nYSize && eErr == CE_None; nY0 += nStripLines )
+    {
+        const int nY1 = std::min(nYSize, nY0 + nStripLines);
+        const int nWindowY1 = static_cast<int>(std::min(
+            static_cast<GIntBig>(nYSize),
+            static_cast<GIntBig>(nY1) + nMaxSearchDist + 1));
+
+/* -------------------------------------------------------------------- */
+/*      Slide the window, reusing the lines shared with the previous    */
+/*      one.                                                            */
+/* -------------------------------------------------------------------- */
+        int nFirstLineToRead = nY0;
+        if( nLoadedY1 > nY0 )
+        {
+            const size_t nShift =
+                static_cast<size_t>(nStripLines) * nXSize;
+            const size_t nKept =
+                static_cast<size_t>(nLoadedY1 - nY0) * nXSize;
+            memmove(pabyMask, pabyMask + nShift, nKept);
+            memmove(pafValues, pafValues + nShift, nKept * sizeof(float));
+            nFirstLineToRead = nLoadedY1;
+        }
+        if( nFirstLineToRead < nWindowY1 )
+        {
+            const size_t nOffset =
+                static_cast<size_t>(nFirstLineToRead - nY0) * nXSize;
+            const int nLinesToRead = nWindowY1 - nFirstLineToRead;
+            eErr = GDALRasterIO( hMaskBand, GF_Read,
+                                 0, nFirstLineToRead, nXSize, nLinesToRead,
+                                 pabyMask + nOffset, nXSize, nLinesToRead,
+                                 GDT_Byte, 0, 0 );
+            if( eErr == CE_None )
+                eErr = GDALRasterIO( hTargetBand, GF_Read,
+                                     0, nFirstLineToRead, nXSize,
+                                     nLinesToRead,
+                                     pafValues + nOffset, nXSize,
+                                     nLinesToRead, GDT_Float32, 0, 0 );
+            if( eErr != CE_None )
+                break;
+        }
+        nLoadedY1 = nWindowY1;
+
+/* -------------------------------------------------------------------- */
+/*      Fill the strip.                                                 */
+/* -------------------------------------------------------------------- */
+        const size_t nStripPixels = static_cast<size_t>(nY1 - nY0) * nXSize;
+        memcpy(pafOut, pafValues, nStripPixels * sizeof(float));
+        memset(pabyFiltMask, 0, nStripPixels);
+
+        sStrip.nStripY0 = nY0;
+        sStrip.nStripY1 = nY1;
+        sStrip.nWindowY1 = nWindowY1;
+        sStrip.panTopDownY = panTopDownY;
+        sStrip.pafTopDownValue = pafTopDownValue;
+        sStrip.panNextTopDownY = panNextTopDownY;
+        sStrip.pafNextTopDownValue = pafNextTopDownValue;
+
+        if( !GDALRunTileJobs(poPool, GDALFillTileFunc, asJobs) )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+        std::swap(panTopDownY, panNextTopDownY);
+        std::swap(pafTopDownValue, pafNextTopDownValue);
+
+/* -------------------------------------------------------------------- */
+/*      Write out the updated data and mask information.  Later         */
+/*      strips only read lines below this one.                          */
+/* -------------------------------------------------------------------- */
+        eErr = GDALRasterIO( hTargetBand, GF_Write, 0, nY0, nXSize, nY1 - nY0,
+                             pafOut, nXSize, nY1 - nY0, GDT_Float32, 0, 0 );
+        if( eErr == CE_None && hFiltMaskBand != NULL )
+            eErr = GDALRasterIO( hFiltMaskBand, GF_Write,
+                                 0, nY0, nXSize, nY1 - nY0,
+                                 pabyFiltMask, nXSize, nY1 - nY0,
+                                 GDT_Byte, 0, 0 );
+
+        if( eErr == CE_None &&
+            !pfnProgress(dfProgressRatio * nY1 / static_cast<double>(nYSize),
+                         "Filling...", pProgressArg) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    CPLFree(pabyMask);
+    CPLFree(pafValues);
+    CPLFree(pafOut);
+    CPLFree(pabyFiltMask);
+    CPLFree(panTopDownY);
+    CPLFree(pafTopDownValue);
+    CPLFree(panNextTopDownY);
+    CPLFree(pafNextTopDownValue);
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                     GDALMultiFilterTileFunc()                        */
+/************************************************************************/
+
+namespace {
+
+struct GDALFilterStrip
+{
+    int             nXSize;
+    int             nYSize;
+    int             nIterations;
+
+    // Lines [nStripY0, nStripY1) are filtered, from the window of lines
+    // [nWindowY0, nWindowY1).
+    int             nStripY0;
+    int             nStripY1;
+    int             nWindowY0;
+    int             nWindowY1;
+    const GByte    *pabyTMask;
+    const GByte    *pabyFMask;
+    const float    *pafValues;
+
+    float          *pafOut;
+};
+
+struct GDALFilterTileJob
+{
+    const GDALFilterStrip *psStrip;
+    int                    nX0;
+    int                    nX1;
+    bool                   bOK;
+};
+
+}  // namespace
+
+/*      Apply the iterations of GDALMultiFilter() to a column tile of   */
+/*      the window.  Lines and columns at the window edges are not      */
+/*      correctly filtered, but the error moves inward by only one      */
+/*      pixel per iteration, so it does not reach the tile itself.      */
+
+static void GDALMultiFilterTileFunc( void *pData )
+{
+    GDALFilterTileJob *psJob = static_cast<GDALFilterTileJob *>(pData);
+    const GDALFilterStrip *psStrip = psJob->psStrip;
+
+    const int nXSize = psStrip->nXSize;
+    const int nIterations = psStrip->nIterations;
+    const int nHaloX0 = std::max(0, psJob->nX0 - nIterations);
+    const int nHaloX1 = std::min(nXSize, psJob->nX1 + nIterations);
+    const int nCols = nHaloX1 - nHaloX0;
+    const int nLines = psStrip->nWindowY1 - psStrip->nWindowY0;
+
+    float *pafLastPass = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nCols, nLines, sizeof(float)));
+    float *pafThisPass = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nCols, nLines, sizeof(float)));
+    if( pafLastPass == NULL || pafThisPass == NULL )
+    {
+        CPLFree(pafLastPass);
+        CPLFree(pafThisPass);
+        psJob->bOK = false;
+        return;
+    }
+
+    for( int iLine = 0; iLine < nLines; iLine++ )
+    {
+        memcpy(pafLastPass + static_cast<size_t>(iLine) * nCols,
+               psStrip->pafValues + static_cast<size_t>(iLine) * nXSize +
+                   nHaloX0,
+               nCols * sizeof(float));
+    }
+
+    for( int iIter = 0; iIter < nIterations; iIter++ )
+    {
+        for( int iLine = 0; iLine < nLines; iLine++ )
+        {
+            const int iY = psStrip->nWindowY0 + iLine;
+            float *pafThisLine =
+                pafThisPass + static_cast<size_t>(iLine) * nCols;
+            const float *pafLastLine =
+                pafLastPass + static_cast<size_t>(iLine) * nCols;
+
+            // The first and last lines of the raster are not filtered.
+            if( iLine == 0 || iLine == nLines - 1 ||
+                iY < 1 || iY >= psStrip->nYSize - 1 )
+            {
+                memcpy(pafThisLine, pafLastLine, nCols * sizeof(float));
+                continue;
+            }
+
+            const size_t nMaskOffset =
+                static_cast<size_t>(iLine) * nXSize + nHaloX0;
+            GDALFilterLine(
+                const_cast<float *>(pafLastLine) - nCols,
+                const_cast<float *>(pafLastLine),
+                const_cast<float *>(pafLastLine) + nCols,
+                pafThisLine,
+                const_cast<GByte *>(psStrip->pabyTMask) + nMaskOffset - nXSize,
+                const_cast<GByte *>(psStrip->pabyTMask) + nMaskOffset,
+                const_cast<GByte *>(psStrip->pabyTMask) + nMaskOffset + nXSize,
+                const_cast<GByte *>(psStrip->pabyFMask) + nMaskOffset,
+                nCols );
+        }
+        std::swap(pafLastPass, pafThisPass);
+    }
+
+    for( int iY = psStrip->nStripY0; iY < psStrip->nStripY1; iY++ )
+    {
+        const int iLine = iY - psStrip->nWindowY0;
+        memcpy(psStrip->pafOut +
+                   static_cast<size_t>(iY - psStrip->nStripY0) * nXSize +
+                   psJob->nX0,
+               pafLastPass + static_cast<size_t>(iLine) * nCols +
+                   (psJob->nX0 - nHaloX0),
+               (psJob->nX1 - psJob->nX0) * sizeof(float));
+    }
+
+    CPLFree(pafLastPass);
+    CPLFree(pafThisPass);
+    psJob->bOK = true;
+}
+
+/************************************************************************/
+/*                       GDALMultiFilterTiled()                         */
+/*                                                                      */
+/*      Same result as GDALMultiFilter(), computed by strips of lines   */
+/*      read with a halo of nIterations lines, each strip being split  */
+/*      in column tiles filtered in parallel.  A strip is written once  */
+/*      the window of the next one has been read, as that window        */
+/*      overlaps it.                                                    */
+/************************************************************************/
+
+static CPLErr
+GDALMultiFilterTiled( GDALRasterBandH hTargetBand,
+                      GDALRasterBandH hTargetMaskBand,
+                      GDALRasterBandH hFiltMaskBand,
+                      int nIterations,
+                      CPLWorkerThreadPool *poPool,
+                      GDALProgressFunc pfnProgress,
+                      void * pProgressArg )
+
+{
+    const int nXSize = GDALGetRasterBandXSize(hTargetBand);
+    const int nYSize = GDALGetRasterBandYSize(hTargetBand);
+
+    if( !pfnProgress( 0.0, "Smoothing Filter...", pProgressArg ) )
+    {
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return CE_Failure;
+    }
+
+    const int nStripLines = std::min(nYSize, std::max(64, nIterations));
+    const int nTileCols = std::max(256, 2 * nIterations);
+    const int nMaxWindowLines =
+        std::min(nYSize, nStripLines + 2 * nIterations);
+
+    GByte *pabyTMask = static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(nXSize, nMaxWindowLines));
+    GByte *pabyFMask = static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(nXSize, nMaxWindowLines));
+    float *pafValues = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nMaxWindowLines, sizeof(float)));
+    float *pafOut = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nStripLines, sizeof(float)));
+    float *pafPendingOut = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(nXSize, nStripLines, sizeof(float)));
+
+    CPLErr eErr = CE_None;
+    if( pabyTMask == NULL || pabyFMask == NULL || pafValues == NULL ||
+        pafOut == NULL || pafPendingOut == NULL )
+    {
+        eErr = CE_Failure;
+    }
+
+    GDALFilterStrip sStrip;
+    sStrip.nXSize = nXSize;
+    sStrip.nYSize = nYSize;
+    sStrip.nIterations = nIterations;
+    sStrip.pabyTMask = pabyTMask;
+    sStrip.pabyFMask = pabyFMask;
+    sStrip.pafValues = pafValues;
+
+    std::vector<GDALFilterTileJob> asJobs;
+    for( int iX = 0; iX < nXSize; iX += nTileCols )
+    {
+        GDALFilterTileJob sJob;
+        sJob.psStrip = &sStrip;
+        sJob.nX0 = iX;
+        sJob.nX1 = std::min(nXSize, iX + nTileCols);
+        sJob.bOK = false;
+        asJobs.push_back(sJob);
+    }
+
+    int nPendingY0 = 0;
+    int nPendingLines = 0;
+    for( int nY0 = 0; nY0 < nYSize && eErr == CE_None; nY0 += nStripLines )
+    {
+        const int nY1 = std::min(nYSize, nY0 + nStripLines);
+        const int nWindowY0 = std::max(0, nY0 - nIterations);
+        const int nWindowY1 = std::min(nYSize, nY1 + nIterations);
+        const int nWindowLines = nWindowY1 - nWindowY0;
+
+        eErr = GDALRasterIO( hTargetMaskBand, GF_Read,
+                             0, nWindowY0, nXSize, nWindowLines,
+                             pabyTMask, nXSize, nWindowLines,
+                             GDT_Byte, 0, 0 );
+        if( eErr == CE_None )
+            eErr = GDALRasterIO( hFiltMaskBand, GF_Read,
+                                 0, nWindowY0, nXSize, nWindowLines,
+                                 pabyFMask, nXSize, nWindowLines,
+                                 GDT_Byte, 0, 0 );
+        if( eErr == CE_None )
+            eErr = GDALRasterIO( hTargetBand, GF_Read,
+                                 0, nWindowY0, nXSize, nWindowLines,
+                                 pafValues, nXSize, nWindowLines,
+                                 GDT_Float32, 0, 0 );
+        if( eErr == CE_None && nPendingLines > 0 )
+            eErr = GDALRasterIO( hTargetBand, GF_Write,
+                                 0, nPendingY0, nXSize, nPendingLines,
+                                 pafPendingOut, nXSize, nPendingLines,
+                                 GDT_Float32, 0, 0 );
+        if( eErr != CE_None )
+            break;
+
+        sStrip.nStripY0 = nY0;
+        sStrip.nStripY1 = nY1;
+        sStrip.nWindowY0 = nWindowY0;
+        sStrip.nWindowY1 = nWindowY1;
+        sStrip.pafOut = pafOut;
+
+        if( !GDALRunTileJobs(poPool, GDALMultiFilterTileFunc, asJobs) )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+
+        std::swap(pafOut, pafPendingOut);
+        nPendingY0 = nY0;
+        nPendingLines = nY1 - nY0;
+
+        if( !pfnProgress(nY1 / static_cast<double>(nYSize),
+                         "Smoothing Filter...", pProgressArg) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    if( eErr == CE_None && nPendingLines > 0 )
+        eErr = GDALRasterIO( hTargetBand, GF_Write,
+                             0, nPendingY0, nXSize, nPendingLines,
+                             pafPendingOut, nXSize, nPendingLines,
+                             GDT_Float32, 0, 0 );
+
+    CPLFree(pabyTMask);
+    CPLFree(pabyFMask);
+    CPLFree(pafValues);
+    CPLFree(pafOut);
+    CPLFree(pafPendingOut);
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                           GDALFillNodata()                           */
 /************************************************************************/
@@ -394,6 +1124,9 @@ if( quad_value != nNoDataVal )                                          \
  * run (0 or more).
  * @param papszOptions additional name=value options in a string list (the
  * temporary file driver can be specified like TEMP_FILE_DRIVER=MEM).
+ * Starting with GDAL 2.3, NUM_THREADS=number|ALL_CPUS can be specified to
+ * process the raster by tiles in parallel (defaults to the GDAL_NUM_THREADS
+ * configuration option).  The result is the same as with a single thread.
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
  *
@@ -479,6 +1212,87 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
                 papszWorkFileOptions, "BIGTIFF", "IF_SAFER");
     }
 
+/* -------------------------------------------------------------------- */
+/*      Use the tiled implementation when several threads are           */
+/*      requested, unless the search distance is so large that the      */
+/*      special nodata index could be mistaken for a line number.      */
+/* -------------------------------------------------------------------- */
+    const char* pszNumThreads = CSLFetchNameValueDef(
+        papszOptions, "NUM_THREADS",
+        CPLGetConfigOption("GDAL_NUM_THREADS", "1"));
+    int nThreads = EQUAL(pszNumThreads, "ALL_CPUS") ?
+        CPLGetNumCPUs() : atoi(pszNumThreads);
+    nThreads = std::min(nThreads, 128);
+    if( nThreads > 1 &&
+        static_cast<double>(nNoDataVal) - nYSize >= dfMaxSearchDist )
+    {
+        CPLWorkerThreadPool oThreadPool;
+        if( oThreadPool.Setup(nThreads, NULL, NULL) )
+        {
+            CPLDebug("GDAL", "GDALFillNodata(): using %d threads", nThreads);
+            CPLErr eErr = CE_None;
+
+            // Only the filter mask needs a work file, when smoothing.
+            const CPLString osFiltMaskTmpFile =
+                CPLString(CPLGenerateTempFilename("")) +
+                "fill_filtmask_work.tif";
+            GDALDatasetH hFiltMaskDS = NULL;
+            GDALRasterBandH hFiltMaskBand = NULL;
+            if( nSmoothingIterations > 0 )
+            {
+                hFiltMaskDS =
+                    GDALCreate( hDriver, osFiltMaskTmpFile, nXSize, nYSize, 1,
+                                GDT_Byte, papszWorkFileOptions );
+                if( hFiltMaskDS == NULL )
+                {
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "Could not create mask work file. "
+                             "Check driver capabilities.");
+                    eErr = CE_Failure;
+                }
+                else
+                {
+                    hFiltMaskBand = GDALGetRasterBand( hFiltMaskDS, 1 );
+                }
+            }
+
+            if( eErr == CE_None )
+                eErr = GDALFillNodataTiled( hTargetBand, hMaskBand,
+                                            hFiltMaskBand, dfMaxSearchDist,
+                                            nNoDataVal, &oThreadPool,
+                                            dfProgressRatio,
+                                            pfnProgress, pProgressArg );
+
+            if( eErr == CE_None && nSmoothingIterations > 0 )
+            {
+                // Force masks to be to flushed and recomputed.
+                GDALFlushRasterCache( hMaskBand );
+
+                void *pScaledProgress =
+                    GDALCreateScaledProgress( dfProgressRatio, 1.0,
+                                              pfnProgress, NULL );
+
+                eErr = GDALMultiFilterTiled( hTargetBand, hMaskBand,
+                                             hFiltMaskBand,
+                                             nSmoothingIterations,
+                                             &oThreadPool,
+                                             GDALScaledProgress,
+                                             pScaledProgress );
+
+                GDALDestroyScaledProgress( pScaledProgress );
+            }
+
+            CSLDestroy(papszWorkFileOptions);
+            if( hFiltMaskDS != NULL )
+            {
+                GDALClose( hFiltMaskDS );
+                GDALDeleteDataset( hDriver, osFiltMaskTmpFile );
+            }
+
+            return eErr;
+        }
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Create a work file to hold the Y "last value" indices.          */
 /* -------------------------------------------------------------------- */
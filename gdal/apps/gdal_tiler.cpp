@@ -0,0 +1,1315 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Utilities
+ * Purpose:  Command line application to generate a pyramid of map tiles
+ *           (XYZ/TMS directories, MBTiles or GeoPackage).
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_atomic_ops.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
+#include "gdal_alg.h"
+#include "gdal_priv.h"
+#include "gdalwarper.h"
+#include "ogr_spatialref.h"
+#include "commonutils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+CPL_CVSID("$Id$")
+
+static const int TILE_SIZE = 256;
+static const int MAX_ZOOM = 24;
+static const double MAX_GM = 20037508.342789244;
+
+// Zoom levels warped at once from the source: a chunk is made of
+// 2^CHUNK_ZOOM_SPAN x 2^CHUNK_ZOOM_SPAN tiles of the maximum zoom level.
+static const int CHUNK_ZOOM_SPAN = 3;
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage( const char* pszErrorMsg = NULL )
+
+{
+    printf("Usage: gdal_tiler [--help-general] [-of XYZ|TMS|MBTILES|GPKG]\n"
+           "                  [-tf PNG|JPEG|WEBP] [-z zoom|minzoom-maxzoom]\n"
+           "                  [-r near|bilinear|cubic|cubicspline|lanczos|average|mode]\n"
+           "                  [-profile mercator|geodetic] [-co NAME=VALUE]*\n"
+           "                  [-num_threads n|ALL_CPUS] [-resume] [-q]\n"
+           "                  src_dataset dst_dataset\n"
+           "\n"
+           "  -of : output layout or format. Defaults to MBTILES or GPKG\n"
+           "        depending on the extension of dst_dataset, and XYZ otherwise\n"
+           "  -tf : tile format (default: PNG)\n"
+           "  -z : zoom level(s) to generate. Default is computed from the\n"
+           "       resolution and extent of the source dataset\n"
+           "  -r : resampling method (default: average)\n"
+           "  -profile : tiling scheme (default: mercator)\n"
+           "  -co : creation option of the tile driver (XYZ/TMS) or of the\n"
+           "        MBTiles/GPKG driver\n"
+           "  -num_threads : number of threads for warping and tile encoding.\n"
+           "                 Defaults to GDAL_NUM_THREADS, or ALL_CPUS\n"
+           "  -resume : only generate missing tiles (XYZ/TMS only)\n"
+           "  -q : turn off progress display\n");
+
+    if( pszErrorMsg != NULL )
+        fprintf(stderr, "\nFAILURE: %s\n", pszErrorMsg);
+
+    exit(1);
+}
+
+/************************************************************************/
+/*                          CreateMEMDataset()                          */
+/*                                                                      */
+/*      Wraps a band sequential buffer of nBands planes of nSize x      */
+/*      nSize Byte pixels as a MEM dataset, whose last band is the      */
+/*      alpha band if bHasAlpha.                                        */
+/************************************************************************/
+
+static GDALDataset* CreateMEMDataset( GByte* pabyData, int nSize, int nBands,
+                                      bool bHasAlpha )
+{
+    GDALDriver* poMEMDriver =
+        GetGDALDriverManager()->GetDriverByName("MEM");
+    if( poMEMDriver == NULL )
+        return NULL;
+    GDALDataset* poDS =
+        poMEMDriver->Create("", nSize, nSize, 0, GDT_Byte, NULL);
+    if( poDS == NULL )
+        return NULL;
+
+    const int nColorBands = bHasAlpha ? nBands - 1 : nBands;
+    for( int iBand = 0; iBand < nBands; iBand++ )
+    {
+        char szPointer[64] = { '\0' };
+        const int nRet = CPLPrintPointer(
+            szPointer, pabyData + static_cast<size_t>(iBand) * nSize * nSize,
+            sizeof(szPointer));
+        szPointer[nRet] = '\0';
+        char szOption[96] = { '\0' };
+        snprintf(szOption, sizeof(szOption), "DATAPOINTER=%s", szPointer);
+        char* apszOptions[2] = { szOption, NULL };
+        poDS->AddBand(GDT_Byte, apszOptions);
+
+        GDALColorInterp eInterp = GCI_AlphaBand;
+        if( iBand < nColorBands )
+            eInterp = (nColorBands == 1) ? GCI_GrayIndex :
+                      static_cast<GDALColorInterp>(GCI_RedBand + iBand);
+        poDS->GetRasterBand(iBand + 1)->SetColorInterpretation(eInterp);
+    }
+    return poDS;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                             GDALTiler                                */
+/* ==================================================================== */
+/************************************************************************/
+
+class GDALTiler;
+
+typedef struct
+{
+    GDALTiler  *poTiler;
+    CPLString   osFilename;
+    GByte      *pabyData;
+} GDALTilerWriteJob;
+
+class GDALTiler
+{
+  public:
+    // Options.
+    bool                bGeodetic;
+    bool                bTMS;
+    bool                bContainer;
+    bool                bResume;
+    int                 nMinZoom;
+    int                 nMaxZoom;
+    int                 nThreads;
+    GDALResampleAlg     eResampleAlg;
+    CPLString           osOvrResampling;
+    CPLString           osTileExt;
+    GDALDriver         *poTileDriver;
+    char              **papszTileOptions;
+    GDALProgressFunc    pfnProgress;
+
+    // Source.
+    GDALDatasetH        hSrcDS;
+    int                 nColorBands;
+    int                 nSrcAlphaBand;
+    CPLString           osDstWKT;
+    void               *hTransformArg;  // approximate transformer
+    void               *hGenImgProjArg; // owned by hTransformArg
+
+    // Output.
+    CPLString           osOutput;
+    int                 nBands;         // nColorBands + alpha
+    int                 nOutBands;      // nBands, or nColorBands for JPEG
+    GDALDataset        *poContainerDS;
+    CPLWorkerThreadPool *poPool;
+    volatile int        nFailures;
+    std::set<CPLString> oSetDirs;
+
+    // Tile ranges of the maximum zoom level, in XYZ convention.
+    int                 nMinTileX;
+    int                 nMinTileY;
+    int                 nMaxTileX;
+    int                 nMaxTileY;
+    int                 nChunkZoom;
+    int                 nChunkCount;
+    int                 nChunksDone;
+
+                        GDALTiler();
+                       ~GDALTiler();
+
+    double              GetResolution( int nZoom ) const;
+    double              GetOriginX() const
+                            { return bGeodetic ? -180.0 : -MAX_GM; }
+    double              GetOriginY() const
+                            { return bGeodetic ? 90.0 : MAX_GM; }
+    void                GetTileRange( int nZoom, int& nTileMinX,
+                                      int& nTileMinY, int& nTileMaxX,
+                                      int& nTileMaxY ) const;
+    static int          ZoomForPixelSize( double dfPixelSize,
+                                          bool bGeodeticIn );
+
+    CPLString           GetTileFilename( int nZoom, int nX, int nY ) const;
+    bool                CreateDirectoryFor( int nZoom, int nX );
+    bool                WriteTile( int nZoom, int nX, int nY,
+                                   GByte* pabyTile );
+    GByte*              ReadTile( int nZoom, int nX, int nY );
+    static void         WriteTileFunc( void* pData );
+    bool                WaitPendingTiles();
+
+    bool                Downsample( GByte* pabySrc, int nSrcSize,
+                                    GByte* pabyDst );
+    GByte*              ProcessChunk( int nX, int nY );
+    GByte*              ProcessQuad( int nZoom, int nX, int nY,
+                                     bool& bError );
+};
+
+/************************************************************************/
+/*                             GDALTiler()                              */
+/************************************************************************/
+
+GDALTiler::GDALTiler() :
+    bGeodetic(false),
+    bTMS(false),
+    bContainer(false),
+    bResume(false),
+    nMinZoom(-1),
+    nMaxZoom(-1),
+    nThreads(1),
+    eResampleAlg(GRA_Average),
+    osOvrResampling("AVERAGE"),
+    poTileDriver(NULL),
+    papszTileOptions(NULL),
+    pfnProgress(GDALTermProgress),
+    hSrcDS(NULL),
+    nColorBands(0),
+    nSrcAlphaBand(0),
+    hTransformArg(NULL),
+    hGenImgProjArg(NULL),
+    nBands(0),
+    nOutBands(0),
+    poContainerDS(NULL),
+    poPool(NULL),
+    nFailures(0),
+    nMinTileX(0),
+    nMinTileY(0),
+    nMaxTileX(0),
+    nMaxTileY(0),
+    nChunkZoom(0),
+    nChunkCount(0),
+    nChunksDone(0)
+{
+}
+
+/************************************************************************/
+/*                            ~GDALTiler()                              */
+/************************************************************************/
+
+GDALTiler::~GDALTiler()
+{
+    delete poPool;
+    if( hTransformArg != NULL )
+        GDALDestroyTransformer(hTransformArg);
+    CSLDestroy(papszTileOptions);
+}
+
+/************************************************************************/
+/*                           GetResolution()                            */
+/************************************************************************/
+
+double GDALTiler::GetResolution( int nZoom ) const
+{
+    if( bGeodetic )
+        return 180.0 / TILE_SIZE / (1 << nZoom);
+    return 2 * MAX_GM / TILE_SIZE / (1 << nZoom);
+}
+
+/************************************************************************/
+/*                         ZoomForPixelSize()                           */
+/*                                                                      */
+/*      Same rule as gdal2tiles: the finest zoom level whose            */
+/*      resolution is not finer than dfPixelSize.                       */
+/************************************************************************/
+
+int GDALTiler::ZoomForPixelSize( double dfPixelSize, bool bGeodeticIn )
+{
+    const double dfRes0 = bGeodeticIn ? 180.0 / TILE_SIZE :
+                                        2 * MAX_GM / TILE_SIZE;
+    for( int i = 0; i <= MAX_ZOOM; i++ )
+    {
+        if( dfPixelSize > dfRes0 / (1 << i) )
+            return std::max(0, i - 1);
+    }
+    return MAX_ZOOM;
+}
+
+/************************************************************************/
+/*                           GetTileRange()                             */
+/*                                                                      */
+/*      Ranges of lower zoom levels are derived from the one of the     */
+/*      maximum zoom level, so that they are exactly nested.            */
+/************************************************************************/
+
+void GDALTiler::GetTileRange( int nZoom, int& nTileMinX, int& nTileMinY,
+                              int& nTileMaxX, int& nTileMaxY ) const
+{
+    const int nShift = nMaxZoom - nZoom;
+    nTileMinX = nMinTileX >> nShift;
+    nTileMinY = nMinTileY >> nShift;
+    nTileMaxX = nMaxTileX >> nShift;
+    nTileMaxY = nMaxTileY >> nShift;
+}
+
+/************************************************************************/
+/*                          GetTileFilename()                           */
+/************************************************************************/
+
+CPLString GDALTiler::GetTileFilename( int nZoom, int nX, int nY ) const
+{
+    if( bTMS )
+        nY = (1 << nZoom) - 1 - nY;
+    return CPLFormFilename(
+        CPLFormFilename(
+            CPLFormFilename(osOutput, CPLSPrintf("%d", nZoom), NULL),
+            CPLSPrintf("%d", nX), NULL),
+        CPLSPrintf("%d", nY), osTileExt);
+}
+
+/************************************************************************/
+/*                         CreateDirectoryFor()                         */
+/************************************************************************/
+
+bool GDALTiler::CreateDirectoryFor( int nZoom, int nX )
+{
+    const CPLString osZoomDir =
+        CPLFormFilename(osOutput, CPLSPrintf("%d", nZoom), NULL);
+    const CPLString osXDir =
+        CPLFormFilename(osZoomDir, CPLSPrintf("%d", nX), NULL);
+    if( oSetDirs.find(osXDir) != oSetDirs.end() )
+        return true;
+
+    const char* const apszDirs[2] = { osZoomDir.c_str(), osXDir.c_str() };
+    for( int i = 0; i < 2; i++ )
+    {
+        VSIStatBufL sStat;
+        if( VSIStatL(apszDirs[i], &sStat) != 0 &&
+            VSIMkdir(apszDirs[i], 0755) != 0 )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "Cannot create directory %s", apszDirs[i]);
+            return false;
+        }
+    }
+    oSetDirs.insert(osXDir);
+    return true;
+}
+
+/************************************************************************/
+/*                           WriteTileFunc()                            */
+/*                                                                      */
+/*      Encodes a tile in a worker thread. The tile is written under    */
+/*      a temporary name and renamed afterwards, so that an existing    */
+/*      tile is always a complete one (which -resume relies on).        */
+/************************************************************************/
+
+void GDALTiler::WriteTileFunc( void* pData )
+{
+    GDALTilerWriteJob* psJob = static_cast<GDALTilerWriteJob*>(pData);
+    GDALTiler* poTiler = psJob->poTiler;
+
+    bool bOK = false;
+    GDALDataset* poMEMDS =
+        CreateMEMDataset(psJob->pabyData, TILE_SIZE, poTiler->nOutBands,
+                         poTiler->nOutBands == poTiler->nBands);
+    if( poMEMDS != NULL )
+    {
+        const CPLString osTmpFilename(psJob->osFilename + ".tmp");
+        GDALDataset* poTileDS = poTiler->poTileDriver->CreateCopy(
+            osTmpFilename, poMEMDS, FALSE, poTiler->papszTileOptions,
+            NULL, NULL);
+        if( poTileDS != NULL )
+        {
+            GDALClose(poTileDS);
+            bOK = VSIRename(osTmpFilename, psJob->osFilename) == 0;
+            if( !bOK )
+            {
+                CPLError(CE_Failure, CPLE_FileIO, "Cannot rename %s to %s",
+                         osTmpFilename.c_str(), psJob->osFilename.c_str());
+                VSIUnlink(osTmpFilename);
+            }
+        }
+        GDALClose(poMEMDS);
+    }
+    if( !bOK )
+        CPLAtomicInc(&poTiler->nFailures);
+
+    VSIFree(psJob->pabyData);
+    delete psJob;
+}
+
+/************************************************************************/
+/*                          WaitPendingTiles()                          */
+/************************************************************************/
+
+bool GDALTiler::WaitPendingTiles()
+{
+    if( poPool != NULL )
+        poPool->WaitCompletion(0);
+    return nFailures == 0;
+}
+
+/************************************************************************/
+/*                             WriteTile()                              */
+/*                                                                      */
+/*      Fully transparent tiles are not written. Ownership of           */
+/*      pabyTile is not taken.                                          */
+/************************************************************************/
+
+bool GDALTiler::WriteTile( int nZoom, int nX, int nY, GByte* pabyTile )
+{
+    const size_t nPlaneSize = static_cast<size_t>(TILE_SIZE) * TILE_SIZE;
+    const GByte* pabyAlpha = pabyTile + nColorBands * nPlaneSize;
+    size_t i = 0;
+    for( ; i < nPlaneSize && pabyAlpha[i] == 0; i++ )
+    {
+    }
+    if( i == nPlaneSize )
+        return true;
+
+    if( poContainerDS != NULL )
+    {
+        GDALDataset* poDS = poContainerDS;
+        if( nZoom < nMaxZoom )
+        {
+            GDALRasterBand* poOvrBand = poContainerDS->GetRasterBand(1)->
+                GetOverview(nMaxZoom - 1 - nZoom);
+            poDS = poOvrBand ? poOvrBand->GetDataset() : NULL;
+            if( poDS == NULL )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Cannot find zoom level %d in output", nZoom);
+                return false;
+            }
+        }
+        double adfGT[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+        poDS->GetGeoTransform(adfGT);
+        const double dfTileSize = TILE_SIZE * GetResolution(nZoom);
+        const int nXOff = static_cast<int>(floor(
+            (GetOriginX() + nX * dfTileSize - adfGT[0]) / adfGT[1] + 0.5));
+        const int nYOff = static_cast<int>(floor(
+            (GetOriginY() - nY * dfTileSize - adfGT[3]) / adfGT[5] + 0.5));
+        return poDS->RasterIO(GF_Write, nXOff, nYOff, TILE_SIZE, TILE_SIZE,
+                              pabyTile, TILE_SIZE, TILE_SIZE, GDT_Byte,
+                              nOutBands, NULL, 1, TILE_SIZE,
+                              nPlaneSize, NULL) == CE_None;
+    }
+
+    if( !CreateDirectoryFor(nZoom, nX) )
+        return false;
+
+    GDALTilerWriteJob* psJob = new GDALTilerWriteJob;
+    psJob->poTiler = this;
+    psJob->osFilename = GetTileFilename(nZoom, nX, nY);
+    psJob->pabyData =
+        static_cast<GByte*>(VSI_MALLOC2_VERBOSE(nOutBands, nPlaneSize));
+    if( psJob->pabyData == NULL )
+    {
+        delete psJob;
+        return false;
+    }
+    memcpy(psJob->pabyData, pabyTile, nOutBands * nPlaneSize);
+
+    // Bound the memory used by queued tiles.
+    poPool->SubmitJob(WriteTileFunc, psJob);
+    poPool->WaitCompletion(4 * poPool->GetThreadCount());
+    return nFailures == 0;
+}
+
+/************************************************************************/
+/*                              ReadTile()                              */
+/*                                                                      */
+/*      Reads back an existing tile for -resume. Returns NULL if the    */
+/*      tile does not exist or cannot be read.                          */
+/************************************************************************/
+
+GByte* GDALTiler::ReadTile( int nZoom, int nX, int nY )
+{
+    const CPLString osFilename(GetTileFilename(nZoom, nX, nY));
+    VSIStatBufL sStat;
+    if( VSIStatL(osFilename, &sStat) != 0 )
+        return NULL;
+
+    GDALDatasetH hTileDS = GDALOpenEx(osFilename, GDAL_OF_RASTER,
+                                      NULL, NULL, NULL);
+    if( hTileDS == NULL )
+        return NULL;
+    const int nTileBands = GDALGetRasterCount(hTileDS);
+    const size_t nPlaneSize = static_cast<size_t>(TILE_SIZE) * TILE_SIZE;
+    GByte* pabyTile = NULL;
+    if( GDALGetRasterXSize(hTileDS) == TILE_SIZE &&
+        GDALGetRasterYSize(hTileDS) == TILE_SIZE &&
+        (nTileBands == nBands || nTileBands == nColorBands) )
+    {
+        pabyTile = static_cast<GByte*>(
+            VSI_MALLOC2_VERBOSE(nBands, nPlaneSize));
+        if( pabyTile != NULL )
+        {
+            // Tiles without alpha (JPEG) are opaque.
+            memset(pabyTile + nColorBands * nPlaneSize, 255, nPlaneSize);
+            if( GDALDatasetRasterIO(hTileDS, GF_Read, 0, 0,
+                                    TILE_SIZE, TILE_SIZE, pabyTile,
+                                    TILE_SIZE, TILE_SIZE, GDT_Byte,
+                                    nTileBands, NULL, 1, TILE_SIZE,
+                                    nPlaneSize) != CE_None )
+            {
+                VSIFree(pabyTile);
+                pabyTile = NULL;
+            }
+        }
+    }
+    GDALClose(hTileDS);
+    return pabyTile;
+}
+
+/************************************************************************/
+/*                             Downsample()                             */
+/*                                                                      */
+/*      Halves a band sequential image of nSrcSize x nSrcSize pixels.   */
+/*      The alpha band acts as the mask of the color bands, so          */
+/*      transparent pixels do not darken the edges of the data.         */
+/************************************************************************/
+
+bool GDALTiler::Downsample( GByte* pabySrc, int nSrcSize, GByte* pabyDst )
+{
+    GDALDataset* poSrcDS = CreateMEMDataset(pabySrc, nSrcSize, nBands, true);
+    GDALDataset* poDstDS =
+        CreateMEMDataset(pabyDst, nSrcSize / 2, nBands, true);
+    bool bOK = poSrcDS != NULL && poDstDS != NULL;
+    for( int iBand = 1; bOK && iBand <= nBands; iBand++ )
+    {
+        GDALRasterBandH hOvrBand = poDstDS->GetRasterBand(iBand);
+        bOK = GDALRegenerateOverviews(poSrcDS->GetRasterBand(iBand),
+                                      1, &hOvrBand, osOvrResampling,
+                                      NULL, NULL) == CE_None;
+    }
+    if( poSrcDS != NULL )
+        GDALClose(poSrcDS);
+    if( poDstDS != NULL )
+        GDALClose(poDstDS);
+    return bOK;
+}
+
+/************************************************************************/
+/*                            ProcessChunk()                            */
+/*                                                                      */
+/*      Warps the area of tile (nX, nY) of the chunk zoom level at the  */
+/*      maximum zoom level in one go, writes its tiles, and halves the  */
+/*      image down to the chunk zoom level, writing the tiles of each   */
+/*      intermediate zoom level. Returns the tile of the chunk zoom     */
+/*      level, or NULL on error.                                        */
+/************************************************************************/
+
+GByte* GDALTiler::ProcessChunk( int nX, int nY )
+{
+    const int nSpan = nMaxZoom - nChunkZoom;
+    const int nSize = TILE_SIZE << nSpan;
+    const size_t nPlaneSize = static_cast<size_t>(nSize) * nSize;
+    GByte* pabyImage = static_cast<GByte*>(
+        VSI_CALLOC_VERBOSE(nBands, nPlaneSize));
+    if( pabyImage == NULL )
+        return NULL;
+
+/* -------------------------------------------------------------------- */
+/*      Warp the chunk at the maximum zoom level.                       */
+/* -------------------------------------------------------------------- */
+    const double dfRes = GetResolution(nMaxZoom);
+    double adfDstGT[6] = {
+        GetOriginX() + static_cast<double>(nX) * nSize * dfRes, dfRes, 0.0,
+        GetOriginY() - static_cast<double>(nY) * nSize * dfRes, 0.0, -dfRes };
+    GDALDataset* poChunkDS = CreateMEMDataset(pabyImage, nSize, nBands, true);
+    if( poChunkDS == NULL )
+    {
+        VSIFree(pabyImage);
+        return NULL;
+    }
+    poChunkDS->SetProjection(osDstWKT);
+    poChunkDS->SetGeoTransform(adfDstGT);
+
+    GDALSetGenImgProjTransformerDstGeoTransform(hGenImgProjArg, adfDstGT);
+
+    GDALWarpOptions* psWO = GDALCreateWarpOptions();
+    psWO->hSrcDS = hSrcDS;
+    psWO->hDstDS = poChunkDS;
+    psWO->eResampleAlg = eResampleAlg;
+    psWO->pfnTransformer = GDALApproxTransform;
+    psWO->pTransformerArg = hTransformArg;
+    psWO->nBandCount = nColorBands;
+    psWO->panSrcBands =
+        static_cast<int*>(CPLMalloc(nColorBands * sizeof(int)));
+    psWO->panDstBands =
+        static_cast<int*>(CPLMalloc(nColorBands * sizeof(int)));
+    for( int i = 0; i < nColorBands; i++ )
+    {
+        psWO->panSrcBands[i] = i + 1;
+        psWO->panDstBands[i] = i + 1;
+    }
+    psWO->nSrcAlphaBand = nSrcAlphaBand;
+    psWO->nDstAlphaBand = nColorBands + 1;
+
+    if( nSrcAlphaBand == 0 )
+    {
+        for( int i = 0; i < nColorBands; i++ )
+        {
+            int bHasNoData = FALSE;
+            const double dfNoData = GDALGetRasterNoDataValue(
+                GDALGetRasterBand(hSrcDS, i + 1), &bHasNoData);
+            if( !bHasNoData )
+                continue;
+            if( psWO->padfSrcNoDataReal == NULL )
+            {
+                GDALWarpInitSrcNoDataReal(psWO, -1.1e20);
+                GDALWarpInitSrcNoDataImag(psWO, 0.0);
+            }
+            psWO->padfSrcNoDataReal[i] = dfNoData;
+        }
+    }
+
+    psWO->papszWarpOptions =
+        CSLSetNameValue(psWO->papszWarpOptions, "INIT_DEST", "0");
+    psWO->papszWarpOptions =
+        CSLSetNameValue(psWO->papszWarpOptions, "NUM_THREADS",
+                        CPLSPrintf("%d", nThreads));
+
+    bool bOK = false;
+    {
+        GDALWarpOperation oWO;
+        if( oWO.Initialize(psWO) == CE_None )
+            bOK = oWO.ChunkAndWarpImage(0, 0, nSize, nSize) == CE_None;
+    }
+    GDALDestroyWarpOptions(psWO);
+    GDALClose(poChunkDS);
+
+/* -------------------------------------------------------------------- */
+/*      Cut the tiles of each zoom level, halving the image between     */
+/*      them.                                                           */
+/* -------------------------------------------------------------------- */
+    GByte* pabyTile = static_cast<GByte*>(
+        VSI_MALLOC2_VERBOSE(nBands, static_cast<size_t>(TILE_SIZE) * TILE_SIZE));
+    bOK = bOK && pabyTile != NULL;
+    int nLevelSize = nSize;
+    for( int nZoom = nMaxZoom; bOK && nZoom >= nChunkZoom; nZoom-- )
+    {
+        const int nTilesPerSide = nLevelSize / TILE_SIZE;
+        int nTileMinX = 0;
+        int nTileMinY = 0;
+        int nTileMaxX = 0;
+        int nTileMaxY = 0;
+        GetTileRange(nZoom, nTileMinX, nTileMinY, nTileMaxX, nTileMaxY);
+
+        for( int iY = 0; bOK && iY < nTilesPerSide; iY++ )
+        {
+            const int nTileY = nY * nTilesPerSide + iY;
+            if( nTileY < nTileMinY || nTileY > nTileMaxY )
+                continue;
+            for( int iX = 0; bOK && iX < nTilesPerSide; iX++ )
+            {
+                const int nTileX = nX * nTilesPerSide + iX;
+                if( nTileX < nTileMinX || nTileX > nTileMaxX )
+                    continue;
+                for( int iBand = 0; iBand < nBands; iBand++ )
+                {
+                    const GByte* pabySrc = pabyImage +
+                        iBand * static_cast<size_t>(nLevelSize) * nLevelSize +
+                        static_cast<size_t>(iY) * TILE_SIZE * nLevelSize +
+                        iX * TILE_SIZE;
+                    GByte* pabyDst = pabyTile +
+                        iBand * static_cast<size_t>(TILE_SIZE) * TILE_SIZE;
+                    for( int iLine = 0; iLine < TILE_SIZE; iLine++ )
+                    {
+                        memcpy(pabyDst + iLine * TILE_SIZE,
+                               pabySrc +
+                                   static_cast<size_t>(iLine) * nLevelSize,
+                               TILE_SIZE);
+                    }
+                }
+                // The tile of the chunk zoom level is written by the caller.
+                if( nZoom > nChunkZoom )
+                    bOK = WriteTile(nZoom, nTileX, nTileY, pabyTile);
+            }
+        }
+
+        if( bOK && nZoom > nChunkZoom )
+        {
+            // Halve in place: the destination plane layout is smaller.
+            GByte* pabyHalf = static_cast<GByte*>(VSI_MALLOC2_VERBOSE(
+                nBands, static_cast<size_t>(nLevelSize / 2) * (nLevelSize / 2)));
+            bOK = pabyHalf != NULL &&
+                  Downsample(pabyImage, nLevelSize, pabyHalf);
+            VSIFree(pabyImage);
+            pabyImage = pabyHalf;
+            nLevelSize /= 2;
+        }
+    }
+    VSIFree(pabyImage);
+
+    nChunksDone++;
+    if( !pfnProgress(static_cast<double>(nChunksDone) / nChunkCount,
+                     NULL, NULL) )
+    {
+        CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+        bOK = false;
+    }
+
+    if( !bOK )
+    {
+        VSIFree(pabyTile);
+        return NULL;
+    }
+    return pabyTile;
+}
+
+/************************************************************************/
+/*                            ProcessQuad()                             */
+/*                                                                      */
+/*      Generates tile (nX, nY) of zoom level nZoom and all the tiles   */
+/*      below it, and returns it. Tiles of zoom levels lower than the   */
+/*      chunk zoom level are computed from their 4 children. Any tile   */
+/*      of those levels is written, with -resume, only once its         */
+/*      descendants are on disk, so that an existing one can be reused  */
+/*      as is.                                                          */
+/************************************************************************/
+
+GByte* GDALTiler::ProcessQuad( int nZoom, int nX, int nY, bool& bError )
+{
+    const size_t nPlaneSize = static_cast<size_t>(TILE_SIZE) * TILE_SIZE;
+
+    if( bResume )
+    {
+        GByte* pabyTile = ReadTile(nZoom, nX, nY);
+        if( pabyTile != NULL )
+        {
+            // Account for the chunks below it in the progress.
+            int nTileMinX = 0;
+            int nTileMinY = 0;
+            int nTileMaxX = 0;
+            int nTileMaxY = 0;
+            GetTileRange(nChunkZoom, nTileMinX, nTileMinY,
+                         nTileMaxX, nTileMaxY);
+            const int nShift = nChunkZoom - nZoom;
+            const int nCountX =
+                std::min(nTileMaxX, ((nX + 1) << nShift) - 1) -
+                std::max(nTileMinX, nX << nShift) + 1;
+            const int nCountY =
+                std::min(nTileMaxY, ((nY + 1) << nShift) - 1) -
+                std::max(nTileMinY, nY << nShift) + 1;
+            nChunksDone += nCountX * nCountY;
+            pfnProgress(static_cast<double>(nChunksDone) / nChunkCount,
+                        NULL, NULL);
+            return pabyTile;
+        }
+    }
+
+    GByte* pabyTile = NULL;
+    if( nZoom == nChunkZoom )
+    {
+        pabyTile = ProcessChunk(nX, nY);
+    }
+    else
+    {
+        int nTileMinX = 0;
+        int nTileMinY = 0;
+        int nTileMaxX = 0;
+        int nTileMaxY = 0;
+        GetTileRange(nZoom + 1, nTileMinX, nTileMinY, nTileMaxX, nTileMaxY);
+
+        const int nQuadSize = 2 * TILE_SIZE;
+        GByte* pabyQuad = static_cast<GByte*>(
+            VSI_CALLOC_VERBOSE(nBands, 4 * nPlaneSize));
+        pabyTile = static_cast<GByte*>(
+            VSI_MALLOC2_VERBOSE(nBands, nPlaneSize));
+        bool bOK = pabyQuad != NULL && pabyTile != NULL;
+        for( int iChild = 0; bOK && iChild < 4; iChild++ )
+        {
+            const int iX = iChild % 2;
+            const int iY = iChild / 2;
+            const int nChildX = 2 * nX + iX;
+            const int nChildY = 2 * nY + iY;
+            if( nChildX < nTileMinX || nChildX > nTileMaxX ||
+                nChildY < nTileMinY || nChildY > nTileMaxY )
+                continue;
+            GByte* pabyChild = ProcessQuad(nZoom + 1, nChildX, nChildY,
+                                           bError);
+            if( pabyChild == NULL )
+            {
+                bOK = false;
+                break;
+            }
+            for( int iBand = 0; iBand < nBands; iBand++ )
+            {
+                for( int iLine = 0; iLine < TILE_SIZE; iLine++ )
+                {
+                    memcpy(pabyQuad + iBand * 4 * nPlaneSize +
+                               static_cast<size_t>(iY * TILE_SIZE + iLine) *
+                                   nQuadSize + iX * TILE_SIZE,
+                           pabyChild + iBand * nPlaneSize +
+                               static_cast<size_t>(iLine) * TILE_SIZE,
+                           TILE_SIZE);
+                }
+            }
+            VSIFree(pabyChild);
+        }
+        bOK = bOK && Downsample(pabyQuad, nQuadSize, pabyTile);
+        VSIFree(pabyQuad);
+        if( !bOK )
+        {
+            VSIFree(pabyTile);
+            pabyTile = NULL;
+        }
+    }
+
+    if( pabyTile == NULL || (bResume && !WaitPendingTiles()) ||
+        !WriteTile(nZoom, nX, nY, pabyTile) )
+    {
+        bError = true;
+        VSIFree(pabyTile);
+        return NULL;
+    }
+    return pabyTile;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+#define CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(nExtraArg) \
+    do { if (iArg + nExtraArg >= nArgc) \
+        Usage(CPLSPrintf("%s option requires %d argument(s)", \
+                         papszArgv[iArg], nExtraArg)); } while(false)
+
+MAIN_START(nArgc, papszArgv)
+
+{
+    // Check that we are running against at least GDAL 2.3.
+    // Note to developers: if we use newer API, please change the requirement.
+    if( atoi(GDALVersionInfo("VERSION_NUM")) < 2030000 )
+    {
+        fprintf(stderr,
+                "At least, GDAL >= 2.3.0 is required for this version of %s, "
+                "which was compiled against GDAL %s\n",
+                papszArgv[0], GDAL_RELEASE_NAME);
+        exit(1);
+    }
+
+    GDALAllRegister();
+
+    nArgc = GDALGeneralCmdLineProcessor(nArgc, &papszArgv, 0);
+    if( nArgc < 1 )
+        exit(-nArgc);
+
+    GDALTiler oTiler;
+    const char* pszSrcFilename = NULL;
+    const char* pszDstFilename = NULL;
+    const char* pszFormat = NULL;
+    const char* pszTileFormat = "PNG";
+    const char* pszResampling = "average";
+    const char* pszNumThreads = NULL;
+    char** papszCreateOptions = NULL;
+
+/* -------------------------------------------------------------------- */
+/*      Parse command line.                                             */
+/* -------------------------------------------------------------------- */
+    for( int iArg = 1; iArg < nArgc; iArg++ )
+    {
+        if( EQUAL(papszArgv[iArg], "--utility_version") )
+        {
+            printf("%s was compiled against GDAL %s and "
+                   "is running against GDAL %s\n",
+                   papszArgv[0], GDAL_RELEASE_NAME,
+                   GDALVersionInfo("RELEASE_NAME"));
+            CSLDestroy(papszArgv);
+            return 0;
+        }
+        else if( EQUAL(papszArgv[iArg], "--help") )
+        {
+            Usage();
+        }
+        else if( EQUAL(papszArgv[iArg], "-of") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
+            pszFormat = papszArgv[++iArg];
+        }
+        else if( EQUAL(papszArgv[iArg], "-tf") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
+            pszTileFormat = papszArgv[++iArg];
+        }
+        else if( EQUAL(papszArgv[iArg], "-z") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
+            const char* pszZoom = papszArgv[++iArg];
+            oTiler.nMinZoom = atoi(pszZoom);
+            const char* pszDash = strchr(pszZoom + 1, '-');
+            oTiler.nMaxZoom = pszDash ? atoi(pszDash + 1) : oTiler.nMinZoom;
+            if( oTiler.nMinZoom < 0 || oTiler.nMaxZoom < oTiler.nMinZoom ||
+                oTiler.nMaxZoom > MAX_ZOOM )
+            {
+                Usage(CPLSPrintf("Invalid zoom level(s): %s", pszZoom));
+            }
+        }
+        else if( EQUAL(papszArgv[iArg], "-r") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
+            pszResampling = papszArgv[++iArg];
+        }
+        else if( EQUAL(papszArgv[iArg], "-profile") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
+            const char* pszProfile = papszArgv[++iArg];
+            if( EQUAL(pszProfile, "geodetic") )
+                oTiler.bGeodetic = true;
+            else if( !EQUAL(pszProfile, "mercator") )
+                Usage(CPLSPrintf("Unsupported profile: %s", pszProfile));
+        }
+        else if( EQUAL(papszArgv[iArg], "-co") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
+            papszCreateOptions =
+                CSLAddString(papszCreateOptions, papszArgv[++iArg]);
+        }
+        else if( EQUAL(papszArgv[iArg], "-num_threads") )
+        {
+            CHECK_HAS_ENOUGH_ADDITIONAL_ARGS(1);
+            pszNumThreads = papszArgv[++iArg];
+        }
+        else if( EQUAL(papszArgv[iArg], "-resume") )
+        {
+            oTiler.bResume = true;
+        }
+        else if( EQUAL(papszArgv[iArg], "-q") ||
+                 EQUAL(papszArgv[iArg], "-quiet") )
+        {
+            oTiler.pfnProgress = GDALDummyProgress;
+        }
+        else if( papszArgv[iArg][0] == '-' )
+        {
+            Usage(CPLSPrintf("Unknown option name '%s'", papszArgv[iArg]));
+        }
+        else if( pszSrcFilename == NULL )
+        {
+            pszSrcFilename = papszArgv[iArg];
+        }
+        else if( pszDstFilename == NULL )
+        {
+            pszDstFilename = papszArgv[iArg];
+        }
+        else
+        {
+            Usage("Too many command options.");
+        }
+    }
+
+    if( pszSrcFilename == NULL )
+        Usage("No source dataset specified.");
+    if( pszDstFilename == NULL )
+        Usage("No target dataset specified.");
+
+/* -------------------------------------------------------------------- */
+/*      Resolve the output layout, tile format and resampling.          */
+/* -------------------------------------------------------------------- */
+    if( pszFormat == NULL )
+    {
+        const CPLString osExt(CPLGetExtension(pszDstFilename));
+        if( EQUAL(osExt, "mbtiles") )
+            pszFormat = "MBTILES";
+        else if( EQUAL(osExt, "gpkg") )
+            pszFormat = "GPKG";
+        else
+            pszFormat = "XYZ";
+    }
+    GDALDriver* poContainerDriver = NULL;
+    if( EQUAL(pszFormat, "TMS") )
+    {
+        oTiler.bTMS = true;
+    }
+    else if( EQUAL(pszFormat, "MBTILES") || EQUAL(pszFormat, "GPKG") )
+    {
+        oTiler.bContainer = true;
+        poContainerDriver = GetGDALDriverManager()->GetDriverByName(pszFormat);
+        if( poContainerDriver == NULL )
+            Usage(CPLSPrintf("%s driver not available", pszFormat));
+        if( EQUAL(pszFormat, "MBTILES") && oTiler.bGeodetic )
+            Usage("MBTiles output requires the mercator profile.");
+        if( oTiler.bResume )
+            Usage("-resume is only supported for XYZ and TMS outputs.");
+    }
+    else if( !EQUAL(pszFormat, "XYZ") )
+    {
+        Usage(CPLSPrintf("Unsupported output format: %s", pszFormat));
+    }
+
+    const bool bJPEG = EQUAL(pszTileFormat, "JPEG");
+    if( !bJPEG && !EQUAL(pszTileFormat, "PNG") &&
+        !EQUAL(pszTileFormat, "WEBP") )
+    {
+        Usage(CPLSPrintf("Unsupported tile format: %s", pszTileFormat));
+    }
+    oTiler.poTileDriver = GetGDALDriverManager()->GetDriverByName(pszTileFormat);
+    if( oTiler.poTileDriver == NULL )
+        Usage(CPLSPrintf("%s driver not available", pszTileFormat));
+    oTiler.osTileExt = bJPEG ? "jpg" : CPLString(pszTileFormat).tolower();
+
+    static const struct
+    {
+        const char     *pszName;
+        GDALResampleAlg eAlg;
+        const char     *pszOvrName;
+    } asResamplings[] = {
+        { "near", GRA_NearestNeighbour, "NEAREST" },
+        { "bilinear", GRA_Bilinear, "BILINEAR" },
+        { "cubic", GRA_Cubic, "CUBIC" },
+        { "cubicspline", GRA_CubicSpline, "CUBICSPLINE" },
+        { "lanczos", GRA_Lanczos, "LANCZOS" },
+        { "average", GRA_Average, "AVERAGE" },
+        { "mode", GRA_Mode, "MODE" } };
+    size_t iResampling = 0;
+    for( ; iResampling < CPL_ARRAYSIZE(asResamplings); iResampling++ )
+    {
+        if( EQUAL(pszResampling, asResamplings[iResampling].pszName) )
+            break;
+    }
+    if( iResampling == CPL_ARRAYSIZE(asResamplings) )
+        Usage(CPLSPrintf("Unsupported resampling method: %s", pszResampling));
+    oTiler.eResampleAlg = asResamplings[iResampling].eAlg;
+    oTiler.osOvrResampling = asResamplings[iResampling].pszOvrName;
+
+    if( pszNumThreads == NULL )
+        pszNumThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "ALL_CPUS");
+    oTiler.nThreads = EQUAL(pszNumThreads, "ALL_CPUS") ?
+                            CPLGetNumCPUs() : atoi(pszNumThreads);
+    oTiler.nThreads = std::max(1, std::min(128, oTiler.nThreads));
+
+/* -------------------------------------------------------------------- */
+/*      Open and check the source dataset.                              */
+/* -------------------------------------------------------------------- */
+    oTiler.hSrcDS = GDALOpenEx(pszSrcFilename,
+                               GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR,
+                               NULL, NULL, NULL);
+    if( oTiler.hSrcDS == NULL )
+        exit(2);
+
+    const int nSrcBands = GDALGetRasterCount(oTiler.hSrcDS);
+    oTiler.nColorBands = nSrcBands;
+    if( nSrcBands > 0 &&
+        GDALGetRasterColorInterpretation(GDALGetRasterBand(
+            oTiler.hSrcDS, nSrcBands)) == GCI_AlphaBand )
+    {
+        oTiler.nSrcAlphaBand = nSrcBands;
+        oTiler.nColorBands--;
+    }
+    if( oTiler.nColorBands != 1 && oTiler.nColorBands != 3 )
+    {
+        fprintf(stderr, "The source dataset must have 1 (gray) or 3 (RGB) "
+                "bands, optionally followed by an alpha band.\n");
+        exit(1);
+    }
+    for( int iBand = 1; iBand <= nSrcBands; iBand++ )
+    {
+        if( GDALGetRasterDataType(GDALGetRasterBand(oTiler.hSrcDS, iBand))
+                != GDT_Byte )
+        {
+            fprintf(stderr, "Only Byte source datasets are supported.\n");
+            exit(1);
+        }
+    }
+    if( GDALGetRasterColorTable(GDALGetRasterBand(oTiler.hSrcDS, 1)) != NULL )
+    {
+        fprintf(stderr, "Source datasets with a color table are not "
+                "supported. Use gdal_translate -expand rgb or -expand rgba "
+                "first.\n");
+        exit(1);
+    }
+    const char* pszSrcWKT = GDALGetProjectionRef(oTiler.hSrcDS);
+    if( (pszSrcWKT == NULL || pszSrcWKT[0] == '\0') &&
+        GDALGetGCPCount(oTiler.hSrcDS) == 0 )
+    {
+        fprintf(stderr, "The source dataset is not georeferenced.\n");
+        exit(1);
+    }
+    oTiler.nBands = oTiler.nColorBands + 1;
+    oTiler.nOutBands = bJPEG ? oTiler.nColorBands : oTiler.nBands;
+
+/* -------------------------------------------------------------------- */
+/*      Compute the extent in the target SRS and the zoom levels.       */
+/* -------------------------------------------------------------------- */
+    {
+        OGRSpatialReference oSRS;
+        oSRS.importFromEPSG(oTiler.bGeodetic ? 4326 : 3857);
+        char* pszWKT = NULL;
+        oSRS.exportToWkt(&pszWKT);
+        oTiler.osDstWKT = pszWKT;
+        CPLFree(pszWKT);
+    }
+
+    char** papszTO = CSLSetNameValue(NULL, "DST_SRS", oTiler.osDstWKT);
+    oTiler.hGenImgProjArg = GDALCreateGenImgProjTransformer2(
+        oTiler.hSrcDS, NULL, papszTO);
+    CSLDestroy(papszTO);
+    if( oTiler.hGenImgProjArg == NULL )
+        exit(1);
+
+    double adfSuggestedGT[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    double adfExtent[4] = { 0.0, 0.0, 0.0, 0.0 };
+    int nPixels = 0;
+    int nLines = 0;
+    if( GDALSuggestedWarpOutput2(oTiler.hSrcDS, GDALGenImgProjTransform,
+                                 oTiler.hGenImgProjArg, adfSuggestedGT,
+                                 &nPixels, &nLines, adfExtent, 0) != CE_None )
+    {
+        GDALDestroyTransformer(oTiler.hGenImgProjArg);
+        exit(1);
+    }
+    oTiler.hTransformArg =
+        GDALCreateApproxTransformer(GDALGenImgProjTransform,
+                                    oTiler.hGenImgProjArg, 0.125);
+    GDALApproxTransformerOwnsSubtransformer(oTiler.hTransformArg, TRUE);
+
+    if( oTiler.nMaxZoom < 0 )
+    {
+        oTiler.nMaxZoom =
+            GDALTiler::ZoomForPixelSize(adfSuggestedGT[1], oTiler.bGeodetic);
+        oTiler.nMinZoom = std::min(oTiler.nMaxZoom,
+            GDALTiler::ZoomForPixelSize(
+                adfSuggestedGT[1] * std::max(nPixels, nLines) / TILE_SIZE,
+                oTiler.bGeodetic));
+    }
+
+    {
+        const double dfTileSize =
+            TILE_SIZE * oTiler.GetResolution(oTiler.nMaxZoom);
+        const int nMaxTileYIdx = (1 << oTiler.nMaxZoom) - 1;
+        const int nMaxTileXIdx =
+            oTiler.bGeodetic ? 2 * nMaxTileYIdx + 1 : nMaxTileYIdx;
+        const double dfEps = 1e-8;
+        oTiler.nMinTileX = static_cast<int>(std::max(0.0, std::min(
+            static_cast<double>(nMaxTileXIdx),
+            floor((adfExtent[0] - oTiler.GetOriginX()) / dfTileSize + dfEps))));
+        oTiler.nMaxTileX = static_cast<int>(std::max(0.0, std::min(
+            static_cast<double>(nMaxTileXIdx),
+            ceil((adfExtent[2] - oTiler.GetOriginX()) / dfTileSize - dfEps)
+                - 1)));
+        oTiler.nMinTileY = static_cast<int>(std::max(0.0, std::min(
+            static_cast<double>(nMaxTileYIdx),
+            floor((oTiler.GetOriginY() - adfExtent[3]) / dfTileSize + dfEps))));
+        oTiler.nMaxTileY = static_cast<int>(std::max(0.0, std::min(
+            static_cast<double>(nMaxTileYIdx),
+            ceil((oTiler.GetOriginY() - adfExtent[1]) / dfTileSize - dfEps)
+                - 1)));
+        oTiler.nMaxTileX = std::max(oTiler.nMinTileX, oTiler.nMaxTileX);
+        oTiler.nMaxTileY = std::max(oTiler.nMinTileY, oTiler.nMaxTileY);
+    }
+
+    oTiler.nChunkZoom =
+        std::max(oTiler.nMinZoom, oTiler.nMaxZoom - CHUNK_ZOOM_SPAN);
+    {
+        int nTileMinX = 0;
+        int nTileMinY = 0;
+        int nTileMaxX = 0;
+        int nTileMaxY = 0;
+        oTiler.GetTileRange(oTiler.nChunkZoom, nTileMinX, nTileMinY,
+                            nTileMaxX, nTileMaxY);
+        oTiler.nChunkCount =
+            (nTileMaxX - nTileMinX + 1) * (nTileMaxY - nTileMinY + 1);
+    }
+
+    CPLDebug("GDAL_TILER", "Zoom levels %d to %d, chunks at zoom level %d, "
+             "%d thread(s)", oTiler.nMinZoom, oTiler.nMaxZoom,
+             oTiler.nChunkZoom, oTiler.nThreads);
+
+/* -------------------------------------------------------------------- */
+/*      Create the output.                                              */
+/* -------------------------------------------------------------------- */
+    oTiler.osOutput = pszDstFilename;
+    if( oTiler.bContainer )
+    {
+        // Canvas at the maximum zoom level, aligned on the tiles of the
+        // minimum zoom level so that all levels are aligned.
+        int nTileMinX = 0;
+        int nTileMinY = 0;
+        int nTileMaxX = 0;
+        int nTileMaxY = 0;
+        oTiler.GetTileRange(oTiler.nMinZoom, nTileMinX, nTileMinY,
+                            nTileMaxX, nTileMaxY);
+        const GIntBig nFactor =
+            static_cast<GIntBig>(TILE_SIZE) <<
+                (oTiler.nMaxZoom - oTiler.nMinZoom);
+        const GIntBig nXSize = (nTileMaxX - nTileMinX + 1) * nFactor;
+        const GIntBig nYSize = (nTileMaxY - nTileMinY + 1) * nFactor;
+        if( nXSize > INT_MAX || nYSize > INT_MAX )
+        {
+            fprintf(stderr, "Too many zoom levels for %s output.\n",
+                    pszFormat);
+            exit(1);
+        }
+
+        char** papszOptions = CSLDuplicate(papszCreateOptions);
+        if( CSLFetchNameValue(papszOptions, "TILE_FORMAT") == NULL )
+            papszOptions = CSLSetNameValue(papszOptions, "TILE_FORMAT",
+                                           pszTileFormat);
+        if( CSLFetchNameValue(papszOptions, "NUM_THREADS") == NULL )
+            papszOptions = CSLSetNameValue(papszOptions, "NUM_THREADS",
+                                    CPLSPrintf("%d", oTiler.nThreads));
+        if( EQUAL(pszFormat, "GPKG") )
+            papszOptions = CSLSetNameValue(papszOptions, "TILING_SCHEME",
+                oTiler.bGeodetic ? "InspireCRS84Quad" : "GoogleMapsCompatible");
+
+        oTiler.poContainerDS = poContainerDriver->Create(
+            pszDstFilename, static_cast<int>(nXSize),
+            static_cast<int>(nYSize), oTiler.nOutBands, GDT_Byte,
+            papszOptions);
+        CSLDestroy(papszOptions);
+        if( oTiler.poContainerDS == NULL )
+            exit(1);
+
+        const double dfRes = oTiler.GetResolution(oTiler.nMaxZoom);
+        const double dfTileSize =
+            TILE_SIZE * oTiler.GetResolution(oTiler.nMinZoom);
+        double adfGT[6] = {
+            oTiler.GetOriginX() + nTileMinX * dfTileSize, dfRes, 0.0,
+            oTiler.GetOriginY() - nTileMinY * dfTileSize, 0.0, -dfRes };
+        if( oTiler.poContainerDS->SetProjection(oTiler.osDstWKT) != CE_None ||
+            oTiler.poContainerDS->SetGeoTransform(adfGT) != CE_None )
+        {
+            GDALClose(oTiler.poContainerDS);
+            exit(1);
+        }
+    }
+    else
+    {
+        oTiler.papszTileOptions = CSLDuplicate(papszCreateOptions);
+
+        VSIStatBufL sStat;
+        if( VSIStatL(pszDstFilename, &sStat) != 0 &&
+            VSIMkdir(pszDstFilename, 0755) != 0 )
+        {
+            fprintf(stderr, "Cannot create directory %s\n", pszDstFilename);
+            exit(1);
+        }
+
+        oTiler.poPool = new CPLWorkerThreadPool();
+        if( !oTiler.poPool->Setup(oTiler.nThreads, NULL, NULL) )
+            exit(1);
+    }
+    CSLDestroy(papszCreateOptions);
+
+/* -------------------------------------------------------------------- */
+/*      Generate the pyramid, from each tile of the minimum zoom level. */
+/* -------------------------------------------------------------------- */
+    int nRetCode = 0;
+    {
+        int nTileMinX = 0;
+        int nTileMinY = 0;
+        int nTileMaxX = 0;
+        int nTileMaxY = 0;
+        oTiler.GetTileRange(oTiler.nMinZoom, nTileMinX, nTileMinY,
+                            nTileMaxX, nTileMaxY);
+        bool bError = false;
+        oTiler.pfnProgress(0.0, NULL, NULL);
+        for( int nY = nTileMinY; !bError && nY <= nTileMaxY; nY++ )
+        {
+            for( int nX = nTileMinX; !bError && nX <= nTileMaxX; nX++ )
+            {
+                VSIFree(oTiler.ProcessQuad(oTiler.nMinZoom, nX, nY, bError));
+            }
+        }
+        if( !oTiler.WaitPendingTiles() )
+            bError = true;
+        if( bError )
+            nRetCode = 1;
+    }
+
+    if( oTiler.poContainerDS != NULL )
+    {
+        // Updates the minzoom metadata item of MBTiles.
+        if( nRetCode == 0 && EQUAL(pszFormat, "MBTILES") &&
+            oTiler.nMinZoom < oTiler.nMaxZoom )
+        {
+            int anLevels[MAX_ZOOM] = {};
+            const int nLevels = oTiler.nMaxZoom - oTiler.nMinZoom;
+            for( int i = 0; i < nLevels; i++ )
+                anLevels[i] = 2 << i;
+            if( oTiler.poContainerDS->BuildOverviews(
+                    "NONE", nLevels, anLevels, 0, NULL,
+                    NULL, NULL) != CE_None )
+                nRetCode = 1;
+        }
+        CPLErrorReset();
+        GDALClose(oTiler.poContainerDS);
+        if( CPLGetLastErrorType() == CE_Failure )
+            nRetCode = 1;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Cleanup                                                         */
+/* -------------------------------------------------------------------- */
+    delete oTiler.poPool;
+    oTiler.poPool = NULL;
+    GDALDestroyTransformer(oTiler.hTransformArg);
+    oTiler.hTransformArg = NULL;
+    GDALClose(oTiler.hSrcDS);
+
+    CSLDestroy(papszArgv);
+    GDALDestroyDriverManager();
+
+    return nRetCode;
+}
+MAIN_END
@@ -43,7 +43,7 @@ static void Usage(const char* pszErrorMsg)
 
 {
     fprintf(stdout, "%s",
-            "Usage: gdalbuildvrt [-tileindex field_name]\n"
+            "Usage: gdalbuildvrt [-tileindex field_name] [-tileindex_footprints]\n"
             "                    [-resolution {highest|lowest|average|user}]\n"
             "                    [-te xmin ymin xmax ymax] [-tr xres yres] [-tap]\n"
             "                    [-separate] [-b band] [-sd subdataset]\n"
@@ -53,6 +53,7 @@ static void Usage(const char* pszErrorMsg)
             "                    [-a_srs srs_def]\n"
             "                    [-r {nearest,bilinear,cubic,cubicspline,lanczos,average,mode}]\n"
             "                    [-oo NAME=VALUE]*\n"
+            "                    [-threads n|ALL_CPUS]\n"
             "                    [-input_file_list my_list.txt] [-overwrite] output.vrt [gdalfile]*\n"
             "\n"
             "e.g.\n"
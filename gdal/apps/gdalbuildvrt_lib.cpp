@@ -40,12 +40,16 @@
 #include <cstring>
 
 #include <algorithm>
+#include <map>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_vrt.h"
 #include "gdal_priv.h"
@@ -83,6 +87,7 @@ typedef struct
     GDALDataType firstBandType;
     int*         panHasNoData;
     double*      padfNoDataValues;
+    int    nNoDataCount;
     int    bHasDatasetMask;
     int    nMaskBlockXSize;
     int    nMaskBlockYSize;
@@ -165,6 +170,163 @@ static int  GetSrcDstWin(DatasetProperty* psDP,
     return TRUE;
 }
 
+/************************************************************************/
+/*                         VRTBuilderOpener                             */
+/************************************************************************/
+
+/* Opens input datasets ahead of their analysis in a pool of worker threads, */
+/* so that the latency of GDALOpenEx() on network file systems is overlapped. */
+/* Datasets are still handed out, analyzed and closed in input order. */
+
+class VRTBuilderOpener
+{
+    struct OpenJob
+    {
+        VRTBuilderOpener *poOpener;
+        CPLString         osFilename;
+        GDALDatasetH      hDS;
+        bool              bDone;
+    };
+
+    CPLWorkerThreadPool       *poPool;
+    char                     **papszOpenOptions;
+    CPLMutex                  *hMutex;
+    CPLCond                   *hCond;
+    std::map<int, OpenJob*>    oMapJobs;
+
+    static void OpenJobFunc(void* pData);
+
+    CPL_DISALLOW_COPY_ASSIGN(VRTBuilderOpener)
+
+    public:
+                VRTBuilderOpener(int nThreads, char** papszOpenOptionsIn);
+               ~VRTBuilderOpener();
+
+        bool         IsEnabled() const { return poPool != NULL; }
+        int          GetJobCount() const { return static_cast<int>(oMapJobs.size()); }
+        void         Submit(int iFile, const char* pszFilename);
+        GDALDatasetH Get(int iFile, bool* pbSubmitted);
+};
+
+/************************************************************************/
+/*                          VRTBuilderOpener()                          */
+/************************************************************************/
+
+VRTBuilderOpener::VRTBuilderOpener(int nThreads, char** papszOpenOptionsIn) :
+    poPool(NULL),
+    papszOpenOptions(papszOpenOptionsIn),
+    hMutex(NULL),
+    hCond(NULL)
+{
+    if( nThreads <= 1 )
+        return;
+
+    poPool = new CPLWorkerThreadPool();
+    if( !poPool->Setup(nThreads, NULL, NULL) )
+    {
+        delete poPool;
+        poPool = NULL;
+        return;
+    }
+    hMutex = CPLCreateMutex();
+    CPLReleaseMutex(hMutex);
+    hCond = CPLCreateCond();
+}
+
+/************************************************************************/
+/*                         ~VRTBuilderOpener()                          */
+/************************************************************************/
+
+VRTBuilderOpener::~VRTBuilderOpener()
+{
+    if( poPool == NULL )
+        return;
+
+    poPool->WaitCompletion();
+    delete poPool;
+
+    /* Datasets opened in advance but never requested (early exit, or */
+    /* inputs whose properties were taken from the tile index) */
+    std::map<int, OpenJob*>::iterator oIter = oMapJobs.begin();
+    for( ; oIter != oMapJobs.end(); ++oIter )
+    {
+        if( oIter->second->hDS )
+            GDALClose(oIter->second->hDS);
+        delete oIter->second;
+    }
+
+    CPLDestroyCond(hCond);
+    CPLDestroyMutex(hMutex);
+}
+
+/************************************************************************/
+/*                            OpenJobFunc()                             */
+/************************************************************************/
+
+void VRTBuilderOpener::OpenJobFunc(void* pData)
+{
+    OpenJob* psJob = static_cast<OpenJob*>(pData);
+    VRTBuilderOpener* poOpener = psJob->poOpener;
+
+    GDALDatasetH hDS =
+        GDALOpenEx( psJob->osFilename,
+                    GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR, NULL,
+                    poOpener->papszOpenOptions, NULL );
+
+    CPLAcquireMutex(poOpener->hMutex, 1000.0);
+    psJob->hDS = hDS;
+    psJob->bDone = true;
+    CPLCondSignal(poOpener->hCond);
+    CPLReleaseMutex(poOpener->hMutex);
+}
+
+/************************************************************************/
+/*                               Submit()                               */
+/************************************************************************/
+
+void VRTBuilderOpener::Submit(int iFile, const char* pszFilename)
+{
+    OpenJob* psJob = new OpenJob();
+    psJob->poOpener = this;
+    /* Take a copy: the filename array may be reallocated when subdatasets */
+    /* are expanded while the job is pending */
+    psJob->osFilename = pszFilename;
+    psJob->hDS = NULL;
+    psJob->bDone = false;
+    oMapJobs[iFile] = psJob;
+    poPool->SubmitJob(OpenJobFunc, psJob);
+}
+
+/************************************************************************/
+/*                                 Get()                                */
+/************************************************************************/
+
+/* Waits for the dataset of index iFile to be opened and returns it. The */
+/* caller takes ownership. *pbSubmitted is set to false if no job was */
+/* submitted for that index, in which case the caller must open it itself. */
+
+GDALDatasetH VRTBuilderOpener::Get(int iFile, bool* pbSubmitted)
+{
+    std::map<int, OpenJob*>::iterator oIter = oMapJobs.find(iFile);
+    if( oIter == oMapJobs.end() )
+    {
+        *pbSubmitted = false;
+        return NULL;
+    }
+    *pbSubmitted = true;
+
+    OpenJob* psJob = oIter->second;
+    CPLAcquireMutex(hMutex, 1000.0);
+    while( !psJob->bDone )
+        CPLCondWait(hCond, hMutex);
+    CPLReleaseMutex(hMutex);
+
+    GDALDatasetH hDS = psJob->hDS;
+    delete psJob;
+    oMapJobs.erase(oIter);
+    return hDS;
+}
+
 /************************************************************************/
 /*                            VRTBuilder                                */
 /************************************************************************/
@@ -197,6 +359,11 @@ class VRTBuilder
     char               *pszOutputSRS;
     char               *pszResampling;
     char              **papszOpenOptions;
+    int                 nThreads;
+    std::map<CPLString, OGREnvelope> oMapFootprints;
+    // Index in aosFootprintSRS of the SRS of each footprint.
+    std::map<CPLString, int> oMapFootprintSRS;
+    std::vector<CPLString> aosFootprintSRS;
 
     /* Internal variables */
     char               *pszProjectionRef;
@@ -218,6 +385,12 @@ class VRTBuilder
 
     int         AnalyseRaster(GDALDatasetH hDS,
                               DatasetProperty* psDatasetProperties);
+    int         AnalyseFootprint(const OGREnvelope& sFootprint,
+                                 const DatasetProperty* psTemplate,
+                                 DatasetProperty* psDatasetProperties);
+    void        UpdateResolution(const double* padfGeoTransform);
+    const OGREnvelope* GetFootprint(int iFile) const;
+    void        DiscardFootprintsOfOtherSRS();
 
     void        CreateVRTSeparate(VRTDatasetH hVRTDS);
     void        CreateVRTNonSeparate(VRTDatasetH hVRTDS);
@@ -237,7 +410,13 @@ class VRTBuilder
                            const char* pszSrcNoData, const char* pszVRTNoData,
                            const char* pszOutputSRS,
                            const char* pszResampling,
-                           const char* const* papszOpenOptionsIn );
+                           const char* const* papszOpenOptionsIn,
+                           int nThreads,
+                           int nFootprintCount,
+                           const char* const* papszFootprintNames,
+                           const double* padfFootprints,
+                           const int* panFootprintSRS,
+                           const char* const* papszFootprintSRS );
 
                ~VRTBuilder();
 
@@ -262,7 +441,13 @@ VRTBuilder::VRTBuilder(const char* pszOutputFilenameIn,
                        const char* pszSrcNoDataIn, const char* pszVRTNoDataIn,
                        const char* pszOutputSRSIn,
                        const char* pszResamplingIn,
-                       const char* const * papszOpenOptionsIn )
+                       const char* const * papszOpenOptionsIn,
+                       int nThreadsIn,
+                       int nFootprintCount,
+                       const char* const* papszFootprintNames,
+                       const double* padfFootprints,
+                       const int* panFootprintSRS,
+                       const char* const* papszFootprintSRS )
 {
     pszOutputFilename = CPLStrdup(pszOutputFilenameIn);
     nInputFiles = nInputFilesIn;
@@ -335,6 +520,20 @@ VRTBuilder::VRTBuilder(const char* pszOutputFilenameIn,
     nVRTNoDataCount = 0;
     bHasRunBuild = FALSE;
     bHasDatasetMask = FALSE;
+
+    nThreads = nThreadsIn;
+    for(int i=0;i<nFootprintCount;i++)
+    {
+        OGREnvelope sEnvelope;
+        sEnvelope.MinX = padfFootprints[4*i];
+        sEnvelope.MinY = padfFootprints[4*i+1];
+        sEnvelope.MaxX = padfFootprints[4*i+2];
+        sEnvelope.MaxY = padfFootprints[4*i+3];
+        oMapFootprints[papszFootprintNames[i]] = sEnvelope;
+        oMapFootprintSRS[papszFootprintNames[i]] = panFootprintSRS[i];
+    }
+    for(int i=0;papszFootprintSRS != NULL && papszFootprintSRS[i] != NULL;i++)
+        aosFootprintSRS.push_back(papszFootprintSRS[i]);
 }
 
 /************************************************************************/
@@ -578,6 +777,7 @@ int VRTBuilder::AnalyseRaster( GDALDatasetH hDS, DatasetProperty* psDatasetPrope
         static_cast<double *>(CPLCalloc(sizeof(double), _nBands));
     psDatasetProperties->panHasNoData =
         static_cast<int *>(CPLCalloc(sizeof(int), _nBands));
+    psDatasetProperties->nNoDataCount = _nBands;
 
     psDatasetProperties->bHasDatasetMask = GDALGetMaskFlags(GDALGetRasterBand(hDS, 1)) == GMF_PER_DATASET;
     if (psDatasetProperties->bHasDatasetMask)
@@ -753,6 +953,17 @@ int VRTBuilder::AnalyseRaster( GDALDatasetH hDS, DatasetProperty* psDatasetPrope
         }
     }
 
+    UpdateResolution(padfGeoTransform);
+
+    return TRUE;
+}
+
+/************************************************************************/
+/*                          UpdateResolution()                          */
+/************************************************************************/
+
+void VRTBuilder::UpdateResolution( const double* padfGeoTransform )
+{
     if (resolutionStrategy == AVERAGE_RESOLUTION)
     {
         we_res += padfGeoTransform[GEOTRSFRM_WE_RES];
@@ -778,10 +989,120 @@ int VRTBuilder::AnalyseRaster( GDALDatasetH hDS, DatasetProperty* psDatasetPrope
             ns_res = std::min(ns_res, padfGeoTransform[GEOTRSFRM_NS_RES]);
         }
     }
+}
+
+/************************************************************************/
+/*                            GetFootprint()                            */
+/************************************************************************/
+
+const OGREnvelope* VRTBuilder::GetFootprint( int iFile ) const
+{
+    if( oMapFootprints.empty() )
+        return NULL;
+    std::map<CPLString, OGREnvelope>::const_iterator oIter =
+        oMapFootprints.find(ppszInputFilenames[iFile]);
+    if( oIter == oMapFootprints.end() )
+        return NULL;
+    return &(oIter->second);
+}
+
+/************************************************************************/
+/*                          AnalyseFootprint()                          */
+/************************************************************************/
+
+/* Fills the properties of a tile from its footprint in the tile index and */
+/* from the properties of a template tile that has been actually opened, */
+/* assuming that the tile has the same resolution, band count, data types, */
+/* color interpretation and nodata values. Only the projection is checked */
+/* (see DiscardFootprintsOfOtherSRS()). Returns FALSE if the footprint is not */
+/* consistent with the resolution of the template, in which case the tile */
+/* must be opened. */
+
+int VRTBuilder::AnalyseFootprint( const OGREnvelope& sFootprint,
+                                  const DatasetProperty* psTemplate,
+                                  DatasetProperty* psDatasetProperties )
+{
+    const double dfTemplateWERes =
+        psTemplate->adfGeoTransform[GEOTRSFRM_WE_RES];
+    const double dfTemplateNSRes =
+        psTemplate->adfGeoTransform[GEOTRSFRM_NS_RES];
+    const double dfXSize =
+        (sFootprint.MaxX - sFootprint.MinX) / dfTemplateWERes;
+    const double dfYSize =
+        (sFootprint.MaxY - sFootprint.MinY) / -dfTemplateNSRes;
+    const int nXSize = static_cast<int>(dfXSize + 0.5);
+    const int nYSize = static_cast<int>(dfYSize + 0.5);
+    if( nXSize <= 0 || nYSize <= 0 ||
+        fabs(dfXSize - nXSize) > 1e-3 || fabs(dfYSize - nYSize) > 1e-3 )
+    {
+        return FALSE;
+    }
+
+    memcpy(psDatasetProperties, psTemplate, sizeof(DatasetProperty));
+    psDatasetProperties->nRasterXSize = nXSize;
+    psDatasetProperties->nRasterYSize = nYSize;
+    psDatasetProperties->adfGeoTransform[GEOTRSFRM_TOPLEFT_X] = sFootprint.MinX;
+    psDatasetProperties->adfGeoTransform[GEOTRSFRM_TOPLEFT_Y] = sFootprint.MaxY;
+    psDatasetProperties->panHasNoData = static_cast<int *>(
+        CPLMalloc(sizeof(int) * psTemplate->nNoDataCount));
+    memcpy(psDatasetProperties->panHasNoData, psTemplate->panHasNoData,
+           sizeof(int) * psTemplate->nNoDataCount);
+    psDatasetProperties->padfNoDataValues = static_cast<double *>(
+        CPLMalloc(sizeof(double) * psTemplate->nNoDataCount));
+    memcpy(psDatasetProperties->padfNoDataValues, psTemplate->padfNoDataValues,
+           sizeof(double) * psTemplate->nNoDataCount);
+
+    if (!bUserExtent)
+    {
+        minX = std::min(minX, sFootprint.MinX);
+        minY = std::min(minY, sFootprint.MinY);
+        maxX = std::max(maxX, sFootprint.MaxX);
+        maxY = std::max(maxY, sFootprint.MaxY);
+    }
+
+    UpdateResolution(psDatasetProperties->adfGeoTransform);
 
     return TRUE;
 }
 
+/************************************************************************/
+/*                    DiscardFootprintsOfOtherSRS()                     */
+/************************************************************************/
+
+/* Footprints are only usable if they are expressed in the projection of the */
+/* template tile: the others are discarded, so that their tiles are opened. */
+
+void VRTBuilder::DiscardFootprintsOfOtherSRS()
+{
+    const char* pszTemplateSRS = pszProjectionRef ? pszProjectionRef : "";
+    std::vector<bool> abSameSRS;
+    for( size_t i = 0; i < aosFootprintSRS.size(); i++ )
+    {
+        const char* pszSRS = aosFootprintSRS[i].c_str();
+        abSameSRS.push_back(
+            (pszSRS[0] == '\0' && pszTemplateSRS[0] == '\0') ||
+            (pszSRS[0] != '\0' && pszTemplateSRS[0] != '\0' &&
+             ProjAreEqual(pszSRS, pszTemplateSRS)));
+    }
+
+    int nDiscarded = 0;
+    std::map<CPLString, int>::const_iterator oIter = oMapFootprintSRS.begin();
+    for( ; oIter != oMapFootprintSRS.end(); ++oIter )
+    {
+        if( !abSameSRS[oIter->second] )
+        {
+            oMapFootprints.erase(oIter->first);
+            nDiscarded ++;
+        }
+    }
+    if( nDiscarded > 0 )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "%d tile index footprints are not in the projection of the "
+                 "tiles. Their tiles will be opened.", nDiscarded);
+    }
+}
+
 /************************************************************************/
 /*                         CreateVRTSeparate()                          */
 /************************************************************************/
@@ -1114,6 +1435,16 @@ GDALDataset* VRTBuilder::Build(GDALProgressFunc pfnProgress, void * pProgressDat
         }
     }
 
+    /* Inputs are opened in advance by worker threads, within a bounded */
+    /* window after the one being analyzed */
+    VRTBuilderOpener oOpener( (pahSrcDS) ? 1 : nThreads, papszOpenOptions );
+    const int nOpenAhead = 4 * nThreads;
+    int iNextToOpen = 0;
+
+    /* Once a file has been successfully analyzed, the properties of the */
+    /* files with a footprint in the tile index are derived from it */
+    int iTemplate = -1;
+
     int nCountValid = 0;
     for(int i=0; ppszInputFilenames != NULL && i<nInputFiles;i++)
     {
@@ -1124,13 +1455,52 @@ GDALDataset* VRTBuilder::Build(GDALProgressFunc pfnProgress, void * pProgressDat
             return NULL;
         }
 
-        GDALDatasetH hDS =
-            (pahSrcDS) ? pahSrcDS[i] :
-                GDALOpenEx( ppszInputFilenames[i],
-                            GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR, NULL,
-                            papszOpenOptions, NULL );
         pasDatasetProperties[i].isFileOK = FALSE;
 
+        const OGREnvelope* psFootprint =
+            (pahSrcDS == NULL && iTemplate >= 0 &&
+             (!bSeparate || bHasGeoTransform)) ? GetFootprint(i) : NULL;
+        if (psFootprint != NULL &&
+            AnalyseFootprint( *psFootprint, &pasDatasetProperties[iTemplate],
+                              &pasDatasetProperties[i] ))
+        {
+            pasDatasetProperties[i].isFileOK = TRUE;
+            nCountValid ++;
+
+            /* It may have been opened in advance before the template was known */
+            bool bSubmitted = false;
+            GDALDatasetH hUnusedDS = oOpener.Get(i, &bSubmitted);
+            if (hUnusedDS)
+                GDALClose(hUnusedDS);
+            continue;
+        }
+
+        GDALDatasetH hDS = NULL;
+        bool bOpened = false;
+        if (pahSrcDS)
+        {
+            hDS = pahSrcDS[i];
+            bOpened = true;
+        }
+        else if (oOpener.IsEnabled())
+        {
+            iNextToOpen = std::max(iNextToOpen, i);
+            for( ; iNextToOpen < nInputFiles &&
+                   oOpener.GetJobCount() < nOpenAhead; iNextToOpen++ )
+            {
+                if (iTemplate >= 0 && GetFootprint(iNextToOpen) != NULL)
+                    continue;
+                oOpener.Submit(iNextToOpen, ppszInputFilenames[iNextToOpen]);
+            }
+            hDS = oOpener.Get(i, &bOpened);
+        }
+        if (!bOpened)
+        {
+            hDS = GDALOpenEx( ppszInputFilenames[i],
+                              GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR, NULL,
+                              papszOpenOptions, NULL );
+        }
+
         if (hDS)
         {
             if (AnalyseRaster( hDS, &pasDatasetProperties[i] ))
@@ -1138,6 +1508,12 @@ GDALDataset* VRTBuilder::Build(GDALProgressFunc pfnProgress, void * pProgressDat
                 pasDatasetProperties[i].isFileOK = TRUE;
                 nCountValid ++;
                 bFirst = FALSE;
+                if (iTemplate < 0)
+                {
+                    iTemplate = i;
+                    if( !oMapFootprints.empty() )
+                        DiscardFootprintsOfOtherSRS();
+                }
             }
             if( pahSrcDS == NULL )
                 GDALClose(hDS);
@@ -1216,12 +1592,63 @@ GDALDataset* VRTBuilder::Build(GDALProgressFunc pfnProgress, void * pProgressDat
     return (GDALDataset*)hVRTDS;
 }
 
+/************************************************************************/
+/*                        GDALBuildVRTOptions                           */
+/************************************************************************/
+
+/** Options for use with GDALBuildVRT(). GDALBuildVRTOptions* must be allocated and
+ * freed with GDALBuildVRTOptionsNew() and GDALBuildVRTOptionsFree() respectively.
+ */
+struct GDALBuildVRTOptions
+{
+    char *pszResolution;
+    int bSeparate;
+    int bAllowProjectionDifference;
+    double we_res;
+    double ns_res;
+    int bTargetAlignedPixels;
+    double xmin;
+    double ymin;
+    double xmax;
+    double ymax;
+    int bAddAlpha;
+    int bHideNoData;
+    int nSubdataset;
+    char* pszSrcNoData;
+    char* pszVRTNoData;
+    char* pszOutputSRS;
+    int *panBandList;
+    int nBandCount;
+    int nMaxBandNo;
+    char* pszResampling;
+    char** papszOpenOptions;
+    int nThreads;
+    int bUseTileIndexFootprints;
+    int nTileIndexFootprintCount;
+    char** papszTileIndexFootprintNames;
+    double* padfTileIndexFootprints;
+    /* Index in papszTileIndexSRS of the SRS of each footprint */
+    int* panTileIndexFootprintSRS;
+    /* SRS of the geometries of each tile index, as WKT or empty */
+    char** papszTileIndexSRS;
+
+    /*! allow or suppress progress monitor and other non-error output */
+    int bQuiet;
+
+    /*! the progress function to use */
+    GDALProgressFunc pfnProgress;
+
+    /*! pointer to the progress data variable */
+    void *pProgressData;
+};
+
 /************************************************************************/
 /*                        add_file_to_list()                            */
 /************************************************************************/
 
 static bool add_file_to_list(const char* filename, const char* tile_index,
-                             int* pnInputFiles, char*** pppszInputFilenames)
+                             int* pnInputFiles, char*** pppszInputFilenames,
+                             GDALBuildVRTOptions* psOptions)
 {
 
     int nInputFiles = *pnInputFiles;
@@ -1281,14 +1708,82 @@ static bool add_file_to_list(const char* filename, const char* tile_index,
         ppszInputFilenames = static_cast<char **>(
             CPLRealloc(ppszInputFilenames,
                        sizeof(char*) * (nInputFiles+nTileIndexFiles + 1)));
+        psOptions->padfTileIndexFootprints = static_cast<double *>(
+            CPLRealloc(psOptions->padfTileIndexFootprints,
+                       sizeof(double) * 4 *
+                       (psOptions->nTileIndexFootprintCount + nTileIndexFiles)));
+        psOptions->panTileIndexFootprintSRS = static_cast<int *>(
+            CPLRealloc(psOptions->panTileIndexFootprintSRS,
+                       sizeof(int) *
+                       (psOptions->nTileIndexFootprintCount + nTileIndexFiles)));
+
+        /* The footprints are in the SRS of the layer. If the tiles have */
+        /* their own SRS recorded (gdaltindex -src_srs_name src_srs), the */
+        /* footprints of the tiles in another SRS cannot be used. */
+        OGRSpatialReferenceH hLayerSRS = OGR_L_GetSpatialRef(hLayer);
+        char* pszLayerSRS = NULL;
+        if( hLayerSRS != NULL )
+            OSRExportToWkt(hLayerSRS, &pszLayerSRS);
+        const int iSRS = CSLCount(psOptions->papszTileIndexSRS);
+        psOptions->papszTileIndexSRS =
+            CSLAddString(psOptions->papszTileIndexSRS,
+                         pszLayerSRS ? pszLayerSRS : "");
+        const int iSrcSRSField = OGR_FD_GetFieldIndex(hFDefn, "src_srs");
+        std::map<CPLString, bool> oMapSrcSRSIsLayerSRS;
+
         for(int j=0;j<nTileIndexFiles;j++)
         {
             OGRFeatureH hFeat = OGR_L_GetNextFeature(hLayer);
-            ppszInputFilenames[nInputFiles++] =
-                    CPLStrdup(OGR_F_GetFieldAsString(hFeat, ti_field ));
+            const char* pszLocation = OGR_F_GetFieldAsString(hFeat, ti_field );
+            ppszInputFilenames[nInputFiles++] = CPLStrdup(pszLocation);
+
+            bool bFootprintInTileSRS = true;
+            if( iSrcSRSField >= 0 &&
+                OGR_F_IsFieldSetAndNotNull(hFeat, iSrcSRSField) )
+            {
+                const CPLString osSrcSRS(
+                    OGR_F_GetFieldAsString(hFeat, iSrcSRSField));
+                std::map<CPLString, bool>::iterator oIter =
+                    oMapSrcSRSIsLayerSRS.find(osSrcSRS);
+                if( oIter == oMapSrcSRSIsLayerSRS.end() )
+                {
+                    OGRSpatialReferenceH hSrcSRS =
+                        OSRNewSpatialReference(NULL);
+                    const bool bSame =
+                        hLayerSRS != NULL &&
+                        OSRSetFromUserInput(hSrcSRS, osSrcSRS) ==
+                            OGRERR_NONE &&
+                        OSRIsSame(hSrcSRS, hLayerSRS);
+                    OSRDestroySpatialReference(hSrcSRS);
+                    oIter = oMapSrcSRSIsLayerSRS.insert(
+                        std::pair<CPLString, bool>(osSrcSRS, bSame)).first;
+                }
+                bFootprintInTileSRS = oIter->second;
+            }
+
+            /* Remember the footprint of the tile, for -tileindex_footprints */
+            OGRGeometryH hGeom = OGR_F_GetGeometryRef(hFeat);
+            if( bFootprintInTileSRS && hGeom != NULL && !OGR_G_IsEmpty(hGeom) )
+            {
+                OGREnvelope sEnvelope;
+                OGR_G_GetEnvelope(hGeom, &sEnvelope);
+                double* padfFootprint = psOptions->padfTileIndexFootprints +
+                                        4 * psOptions->nTileIndexFootprintCount;
+                padfFootprint[0] = sEnvelope.MinX;
+                padfFootprint[1] = sEnvelope.MinY;
+                padfFootprint[2] = sEnvelope.MaxX;
+                padfFootprint[3] = sEnvelope.MaxY;
+                psOptions->papszTileIndexFootprintNames =
+                    CSLAddString(psOptions->papszTileIndexFootprintNames,
+                                 pszLocation);
+                psOptions->panTileIndexFootprintSRS[
+                    psOptions->nTileIndexFootprintCount] = iSRS;
+                psOptions->nTileIndexFootprintCount++;
+            }
             OGR_F_Destroy(hFeat);
         }
         ppszInputFilenames[nInputFiles] = NULL;
+        CPLFree(pszLayerSRS);
 
         OGR_DS_Destroy( hDS );
     }
@@ -1306,47 +1801,6 @@ static bool add_file_to_list(const char* filename, const char* tile_index,
     return true;
 }
 
-/************************************************************************/
-/*                        GDALBuildVRTOptions                           */
-/************************************************************************/
-
-/** Options for use with GDALBuildVRT(). GDALBuildVRTOptions* must be allocated and
- * freed with GDALBuildVRTOptionsNew() and GDALBuildVRTOptionsFree() respectively.
- */
-struct GDALBuildVRTOptions
-{
-    char *pszResolution;
-    int bSeparate;
-    int bAllowProjectionDifference;
-    double we_res;
-    double ns_res;
-    int bTargetAlignedPixels;
-    double xmin;
-    double ymin;
-    double xmax;
-    double ymax;
-    int bAddAlpha;
-    int bHideNoData;
-    int nSubdataset;
-    char* pszSrcNoData;
-    char* pszVRTNoData;
-    char* pszOutputSRS;
-    int *panBandList;
-    int nBandCount;
-    int nMaxBandNo;
-    char* pszResampling;
-    char** papszOpenOptions;
-
-    /*! allow or suppress progress monitor and other non-error output */
-    int bQuiet;
-
-    /*! the progress function to use */
-    GDALProgressFunc pfnProgress;
-
-    /*! pointer to the progress data variable */
-    void *pProgressData;
-};
-
 /************************************************************************/
 /*                        GDALBuildVRTOptionsClone()                   */
 /************************************************************************/
@@ -1368,6 +1822,24 @@ GDALBuildVRTOptions* GDALBuildVRTOptionsClone(const GDALBuildVRTOptions *psOptio
         memcpy(psOptions->panBandList, psOptionsIn->panBandList, sizeof(int) * psOptionsIn->nBandCount);
     }
     if( psOptionsIn->papszOpenOptions ) psOptions->papszOpenOptions = CSLDuplicate(psOptionsIn->papszOpenOptions);
+    if( psOptionsIn->papszTileIndexFootprintNames )
+        psOptions->papszTileIndexFootprintNames = CSLDuplicate(psOptionsIn->papszTileIndexFootprintNames);
+    if( psOptionsIn->padfTileIndexFootprints )
+    {
+        psOptions->padfTileIndexFootprints = static_cast<double*>(
+            CPLMalloc(sizeof(double) * 4 * psOptionsIn->nTileIndexFootprintCount));
+        memcpy(psOptions->padfTileIndexFootprints, psOptionsIn->padfTileIndexFootprints,
+               sizeof(double) * 4 * psOptionsIn->nTileIndexFootprintCount);
+    }
+    if( psOptionsIn->panTileIndexFootprintSRS )
+    {
+        psOptions->panTileIndexFootprintSRS = static_cast<int*>(
+            CPLMalloc(sizeof(int) * psOptionsIn->nTileIndexFootprintCount));
+        memcpy(psOptions->panTileIndexFootprintSRS, psOptionsIn->panTileIndexFootprintSRS,
+               sizeof(int) * psOptionsIn->nTileIndexFootprintCount);
+    }
+    if( psOptionsIn->papszTileIndexSRS )
+        psOptions->papszTileIndexSRS = CSLDuplicate(psOptionsIn->papszTileIndexSRS);
     return psOptions;
 }
 
@@ -1481,7 +1953,14 @@ GDALDatasetH GDALBuildVRT( const char *pszDest,
                         psOptions->bAddAlpha, psOptions->bHideNoData, psOptions->nSubdataset,
                         psOptions->pszSrcNoData, psOptions->pszVRTNoData,
                         psOptions->pszOutputSRS, psOptions->pszResampling,
-                        psOptions->papszOpenOptions);
+                        psOptions->papszOpenOptions,
+                        psOptions->nThreads,
+                        (psOptions->bUseTileIndexFootprints) ?
+                            psOptions->nTileIndexFootprintCount : 0,
+                        psOptions->papszTileIndexFootprintNames,
+                        psOptions->padfTileIndexFootprints,
+                        psOptions->panTileIndexFootprintSRS,
+                        psOptions->papszTileIndexSRS);
 
     GDALDatasetH hDstDS =
         (GDALDatasetH)oBuilder.Build(psOptions->pfnProgress, psOptions->pProgressData);
@@ -1545,6 +2024,7 @@ GDALBuildVRTOptions *GDALBuildVRTOptionsNew(char** papszArgv,
     const char *tile_index = "location";
 
     psOptions->nSubdataset = -1;
+    psOptions->nThreads = 1;
     psOptions->bQuiet = TRUE;
     psOptions->pfnProgress = GDALDummyProgress;
     psOptions->pProgressData = NULL;
@@ -1590,7 +2070,8 @@ GDALBuildVRTOptions *GDALBuildVRTOptionsNew(char** papszArgv,
                             break;
                         if( !add_file_to_list(filename, tile_index,
                                          &psOptionsForBinary->nSrcFiles,
-                                         &psOptionsForBinary->papszSrcFiles) )
+                                         &psOptionsForBinary->papszSrcFiles,
+                                         psOptions) )
                         {
                             VSIFCloseL(f);
                             GDALBuildVRTOptionsFree(psOptions);
@@ -1724,6 +2205,18 @@ GDALBuildVRTOptions *GDALBuildVRTOptionsNew(char** papszArgv,
                     CSLAddString( psOptions->papszOpenOptions,
                                   papszArgv[++iArg] );
         }
+        else if( EQUAL(papszArgv[iArg], "-threads") && iArg+1 < argc )
+        {
+            ++iArg;
+            if( EQUAL(papszArgv[iArg], "ALL_CPUS") )
+                psOptions->nThreads = CPLGetNumCPUs();
+            else
+                psOptions->nThreads = atoi(papszArgv[iArg]);
+        }
+        else if( EQUAL(papszArgv[iArg], "-tileindex_footprints") )
+        {
+            psOptions->bUseTileIndexFootprints = TRUE;
+        }
         else if( papszArgv[iArg][0] == '-' )
         {
             CPLError(CE_Failure, CPLE_NotSupported,
@@ -1741,7 +2234,8 @@ GDALBuildVRTOptions *GDALBuildVRTOptionsNew(char** papszArgv,
                 {
                     if( !add_file_to_list(papszArgv[iArg], tile_index,
                                           &psOptionsForBinary->nSrcFiles,
-                                          &psOptionsForBinary->papszSrcFiles) )
+                                          &psOptionsForBinary->papszSrcFiles,
+                                          psOptions) )
                     {
                         GDALBuildVRTOptionsFree(psOptions);
                         return NULL;
@@ -1777,6 +2271,10 @@ void GDALBuildVRTOptionsFree( GDALBuildVRTOptions *psOptions )
         CPLFree( psOptions->panBandList );
         CPLFree( psOptions->pszResampling );
         CSLDestroy( psOptions->papszOpenOptions );
+        CSLDestroy( psOptions->papszTileIndexFootprintNames );
+        CPLFree( psOptions->padfTileIndexFootprints );
+        CPLFree( psOptions->panTileIndexFootprintSRS );
+        CSLDestroy( psOptions->papszTileIndexSRS );
     }
 
     CPLFree(psOptions);
@@ -32,6 +32,8 @@
 #include "ogr_spatialref.h"
 #include "cpl_minixml.h"
 #include "commonutils.h"
+
+#include <algorithm>
 #include <vector>
 
 CPL_CVSID("$Id$")
@@ -51,6 +53,7 @@ Usage:
 Usage: gdallocationinfo [--help-general] [-xml] [-lifonly] [-valonly]
                         [-b band]* [-overview overview_level]
                         [-l_srs srs_def] [-geoloc] [-wgs84]
+                        [-batch] [-r nearest|bilinear|cubic]
                         [-oo NAME=VALUE]* srcfile [x y]
 \endverbatim
 
@@ -92,6 +95,22 @@ pixel/line) must still be given with respect to the base band.</dd>
 <dt> <b>-wgs84</b>:</dt>
 <dd> Indicates input x,y points are WGS84 long, lat.</dd>
 
+<dt> <b>-batch</b>:</dt>
+<dd>(starting with GDAL 2.3) Batch mode. Coordinates read from stdin are
+processed by groups of 10000 points: the points of a group are sorted by
+raster block, so that each block is read only once, and the values are then
+reported in the input order, as with -valonly. This is much faster than the
+default mode when querying a large number of points. LocationInfo is not
+reported in this mode, and only the real part of complex values is
+reported.</dd>
+
+<dt> <b>-r</b> <em>nearest|bilinear|cubic</em>:</dt>
+<dd>(starting with GDAL 2.3) Resampling method used to compute the value at
+the queried location. Defaults to nearest, that is the value of the pixel
+containing the location. With bilinear or cubic, the value is interpolated
+from the neighbouring pixel centers, ignoring nodata pixels. Implies
+-batch.</dd>
+
 <dt> <b>-oo</b> <em>NAME=VALUE</em>:</dt>
 <dd>(starting with GDAL 2.0) Dataset open option (format specific)</dd>
 
@@ -160,6 +179,13 @@ $ gdallocationinfo -xml -wgs84 utm.vrt -117.5 33.75
 </Report>
 \endverbatim
 
+Query a list of locations read from a file, in batch mode, with bilinear
+interpolation.
+
+\verbatim
+$ gdallocationinfo -geoloc -r bilinear utm.tif < locations.txt
+\endverbatim
+
 \if man
 \section gdallocationinfo_author AUTHORS
 Frank Warmerdam <warmerdam@pobox.com>
@@ -176,6 +202,7 @@ static void Usage()
     printf( "Usage: gdallocationinfo [--help-general] [-xml] [-lifonly] [-valonly]\n"
             "                        [-b band]* [-overview overview_level]\n"
             "                        [-l_srs srs_def] [-geoloc] [-wgs84]\n"
+            "                        [-batch] [-r nearest|bilinear|cubic]\n"
             "                        [-oo NAME=VALUE]* srcfile x y\n"
             "\n" );
     exit( 1 );
@@ -208,6 +235,120 @@ static char *SanitizeSRS( const char *pszUserInput )
     return pszResult;
 }
 
+/************************************************************************/
+/*                             QueryBatch()                             */
+/*                                                                      */
+/*      Report the values of a group of locations, given in pixel/line  */
+/*      space of the dataset, with one block read per raster block.     */
+/************************************************************************/
+
+static void QueryBatch( GDALDatasetH hSrcDS,
+                        const std::vector<int>& anBandList,
+                        int nOverview,
+                        GDALRIOResampleAlg eResampleAlg,
+                        const std::vector<double>& adfPixel,
+                        const std::vector<double>& adfLine )
+{
+    const int nPointCount = static_cast<int>(adfPixel.size());
+    const int nXSize = GDALGetRasterXSize( hSrcDS );
+    const int nYSize = GDALGetRasterYSize( hSrcDS );
+
+    std::vector<bool> abInside(nPointCount);
+    for( int j = 0; j < nPointCount; j++ )
+    {
+        abInside[j] = adfPixel[j] >= 0 && adfPixel[j] < nXSize &&
+                      adfLine[j] >= 0 && adfLine[j] < nYSize;
+    }
+
+    std::vector<double> adfQueryX(nPointCount);
+    std::vector<double> adfQueryY(nPointCount);
+    std::vector<double> adfValues(
+        static_cast<size_t>(nPointCount) * anBandList.size());
+    std::vector<bool> abBandQueried(anBandList.size(), false);
+
+    for( size_t i = 0; i < anBandList.size(); i++ )
+    {
+        GDALRasterBandH hBand = GDALGetRasterBand( hSrcDS, anBandList[i] );
+
+        if( nOverview >= 0 && hBand != NULL )
+        {
+            GDALRasterBandH hOvrBand = GDALGetOverview(hBand, nOverview);
+            if( hOvrBand == NULL )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined,
+                         "Cannot get overview %d of band %d",
+                         nOverview + 1, anBandList[i] );
+            }
+            hBand = hOvrBand;
+        }
+
+        if( hBand == NULL )
+            continue;
+
+        const int nBandXSize = GDALGetRasterBandXSize( hBand );
+        const int nBandYSize = GDALGetRasterBandYSize( hBand );
+
+        for( int j = 0; j < nPointCount; j++ )
+        {
+            if( !abInside[j] )
+            {
+                adfQueryX[j] = -1;
+                adfQueryY[j] = -1;
+            }
+            else if( eResampleAlg == GRIORA_NearestNeighbour )
+            {
+                // Select the same pixel as in the non batch mode.
+                int iPixelToQuery = static_cast<int>(floor(adfPixel[j]));
+                int iLineToQuery = static_cast<int>(floor(adfLine[j]));
+                if( nBandXSize != nXSize || nBandYSize != nYSize )
+                {
+                    iPixelToQuery = std::min(nBandXSize - 1,
+                        static_cast<int>(
+                            0.5 + 1.0 * iPixelToQuery / nXSize * nBandXSize));
+                    iLineToQuery = std::min(nBandYSize - 1,
+                        static_cast<int>(
+                            0.5 + 1.0 * iLineToQuery / nYSize * nBandYSize));
+                }
+                adfQueryX[j] = iPixelToQuery + 0.5;
+                adfQueryY[j] = iLineToQuery + 0.5;
+            }
+            else
+            {
+                adfQueryX[j] = adfPixel[j] * nBandXSize / nXSize;
+                adfQueryY[j] = adfLine[j] * nBandYSize / nYSize;
+            }
+        }
+
+        if( GDALRasterQueryPoints( hBand, nPointCount,
+                                   &adfQueryX[0], &adfQueryY[0],
+                                   eResampleAlg,
+                                   &adfValues[i * nPointCount],
+                                   NULL, NULL ) == CE_None )
+        {
+            abBandQueried[i] = true;
+        }
+    }
+
+    for( int j = 0; j < nPointCount; j++ )
+    {
+        if( !abInside[j] )
+        {
+            printf("\n");
+            continue;
+        }
+        // An empty value is printed for the bands that could not be
+        // queried, so that the output stays aligned with the input points.
+        for( size_t i = 0; i < anBandList.size(); i++ )
+        {
+            if( abBandQueried[i] )
+                printf( "%.15g\n", adfValues[i * nPointCount + j] );
+            else
+                printf( "\n" );
+        }
+    }
+    fflush(stdout);
+}
+
 /************************************************************************/
 /*                                main()                                */
 /************************************************************************/
@@ -221,6 +362,8 @@ MAIN_START(argc, argv)
     std::vector<int>   anBandList;
     bool               bAsXML = false, bLIFOnly = false;
     bool               bQuiet = false, bValOnly = false;
+    bool               bBatch = false;
+    GDALRIOResampleAlg eResampleAlg = GRIORA_NearestNeighbour;
     int                nOverview = -1;
     char             **papszOpenOptions = NULL;
 
@@ -279,6 +422,34 @@ MAIN_START(argc, argv)
             bValOnly = true;
             bQuiet = true;
         }
+        else if( EQUAL(argv[i],"-batch") )
+        {
+            bBatch = true;
+            bValOnly = true;
+            bQuiet = true;
+        }
+        else if( i < argc-1 && EQUAL(argv[i],"-r") )
+        {
+            ++i;
+            if( EQUAL(argv[i], "nearest") )
+                eResampleAlg = GRIORA_NearestNeighbour;
+            else if( EQUAL(argv[i], "bilinear") )
+                eResampleAlg = GRIORA_Bilinear;
+            else if( EQUAL(argv[i], "cubic") )
+                eResampleAlg = GRIORA_Cubic;
+            else
+            {
+                fprintf( stderr, "Unsupported resampling method: %s\n",
+                         argv[i] );
+                Usage();
+            }
+            if( eResampleAlg != GRIORA_NearestNeighbour )
+            {
+                bBatch = true;
+                bValOnly = true;
+                bQuiet = true;
+            }
+        }
         else if( i < argc-1 && EQUAL(argv[i], "-oo") )
         {
             papszOpenOptions = CSLAddString( papszOpenOptions,
@@ -303,6 +474,13 @@ MAIN_START(argc, argv)
     if( pszSrcFilename == NULL || (pszLocX != NULL && pszLocY == NULL) )
         Usage();
 
+    if( bBatch && (bAsXML || bLIFOnly) )
+    {
+        fprintf( stderr,
+                 "-batch and -r are not compatible with -xml and -lifonly.\n" );
+        Usage();
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Open source file.                                               */
 /* -------------------------------------------------------------------- */
@@ -345,7 +523,71 @@ MAIN_START(argc, argv)
     double dfGeoY;
     CPLString osXML;
 
-    if( pszLocX == NULL && pszLocY == NULL )
+    if( bBatch )
+    {
+        double adfInvGeoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+        if( pszSourceSRS != NULL )
+        {
+            double adfGeoTransform[6] = {};
+            if( GDALGetGeoTransform( hSrcDS, adfGeoTransform ) != CE_None )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined, "Cannot get geotransform");
+                exit( 1 );
+            }
+            if( !GDALInvGeoTransform( adfGeoTransform, adfInvGeoTransform ) )
+            {
+                CPLError(CE_Failure, CPLE_AppDefined, "Cannot invert geotransform");
+                exit( 1 );
+            }
+        }
+
+        const size_t nBatchSize = 10000;
+        std::vector<double> adfPixel;
+        std::vector<double> adfLine;
+        adfPixel.reserve(nBatchSize);
+        adfLine.reserve(nBatchSize);
+
+        while( inputAvailable )
+        {
+            adfPixel.clear();
+            adfLine.clear();
+            while( adfPixel.size() < nBatchSize )
+            {
+                if( pszLocX != NULL )
+                {
+                    dfGeoX = CPLAtof(pszLocX);
+                    dfGeoY = CPLAtof(pszLocY);
+                    inputAvailable = 0;
+                }
+                else if( fscanf(stdin, "%lf %lf", &dfGeoX, &dfGeoY) != 2 )
+                {
+                    inputAvailable = 0;
+                    break;
+                }
+
+                if( hCT )
+                {
+                    if( !OCTTransform( hCT, 1, &dfGeoX, &dfGeoY, NULL ) )
+                        exit( 1 );
+                }
+
+                adfPixel.push_back( adfInvGeoTransform[0]
+                                    + adfInvGeoTransform[1] * dfGeoX
+                                    + adfInvGeoTransform[2] * dfGeoY );
+                adfLine.push_back( adfInvGeoTransform[3]
+                                   + adfInvGeoTransform[4] * dfGeoX
+                                   + adfInvGeoTransform[5] * dfGeoY );
+
+                if( !inputAvailable )
+                    break;
+            }
+
+            if( !adfPixel.empty() )
+                QueryBatch( hSrcDS, anBandList, nOverview, eResampleAlg,
+                            adfPixel, adfLine );
+        }
+    }
+    else if( pszLocX == NULL && pszLocY == NULL )
     {
         if (fscanf(stdin, "%lf %lf", &dfGeoX, &dfGeoY) != 2)
         {
@@ -46,9 +46,11 @@
 #include "commonutils.h"
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_alg.h"
 #include "gdal_priv.h"
@@ -340,6 +342,12 @@ struct GDALVectorTranslateOptions
 
     /*! Maximum number of features, or -1 if no limit. */
     GIntBig nLimit;
+
+    /*! Number of worker threads used to convert features (field mapping,
+        geometry operations and reprojection), while the calling thread reads
+        and writes them. Features are written in the source order.
+        0 or 1 means that everything is done in the calling thread. */
+    int nThreads;
 };
 
 typedef struct
@@ -423,6 +431,15 @@ public:
     bool                          m_bExplodeCollections;
     bool                          m_bNativeData;
     GIntBig                       m_nLimit;
+    int                           m_nThreads;
+
+    typedef enum
+    {
+        CONVERT_OK,
+        CONVERT_SKIPPED,         // geometry clipped out
+        CONVERT_SETFROM_FAILED,
+        CONVERT_FAILED           // reprojection failed, no -skipfailures
+    } ConvertStatus;
 
     int                 Translate(OGRFeature* poFeatureIn,
                                   TargetLayerInfo* psInfo,
@@ -432,6 +449,45 @@ public:
                                   GDALProgressFunc pfnProgress,
                                   void *pProgressArg,
                                   GDALVectorTranslateOptions *psOptions);
+
+    ConvertStatus       ConvertFeature(TargetLayerInfo* psInfo,
+                                       OGRFeature* poFeature,
+                                       int nParts, int iPart,
+                                       OGRSpatialReference* poOutputSRS,
+                                       OGRCoordinateTransformation** papoCT,
+                                       bool bSkipFailures,
+                                       OGRFeature** ppoDstFeature,
+                                       bool* pbReprojectionFailed) const;
+
+private:
+    bool                StartNextTransactionIfNeeded(
+                                  OGRLayer* poDstLayer,
+                                  int& nFeaturesInTransaction,
+                                  GIntBig& nTotalEventsDone,
+                                  GDALVectorTranslateOptions *psOptions);
+
+    bool                WriteConvertedFeature(
+                                  TargetLayerInfo* psInfo,
+                                  OGRFeature* poFeature,
+                                  OGRFeature* poDstFeature,
+                                  ConvertStatus eStatus,
+                                  bool bReprojectionFailed,
+                                  GIntBig& nFeaturesWritten,
+                                  GDALVectorTranslateOptions *psOptions);
+
+    bool                TranslateMultiThreaded(
+                                  TargetLayerInfo* psInfo,
+                                  OGRSpatialReference* poOutputSRS,
+                                  GIntBig nCountLayerFeatures,
+                                  GIntBig* pnReadFeatureCount,
+                                  int& nFeaturesInTransaction,
+                                  GIntBig& nTotalEventsDone,
+                                  GIntBig& nCount,
+                                  GIntBig& nFeaturesWritten,
+                                  bool& bRet,
+                                  GDALProgressFunc pfnProgress,
+                                  void *pProgressArg,
+                                  GDALVectorTranslateOptions *psOptions);
 };
 
 static OGRLayer* GetLayerAndOverwriteIfNecessary(GDALDataset *poDstDS,
@@ -2467,6 +2523,7 @@ GDALDatasetH GDALVectorTranslate( const char *pszDest, GDALDatasetH hDstDS, int
     oTranslator.m_bExplodeCollections = psOptions->bExplodeCollections;
     oTranslator.m_bNativeData = psOptions->bNativeData;
     oTranslator.m_nLimit = psOptions->nLimit;
+    oTranslator.m_nThreads = psOptions->nThreads;
 
     if( psOptions->nGroupTransactions )
     {
@@ -4268,6 +4325,375 @@ static bool SetupCT( TargetLayerInfo* psInfo,
     return true;
 }
 
+/************************************************************************/
+/*                LayerTranslator::ConvertFeature()                     */
+/************************************************************************/
+
+// Builds the target feature from a source feature : field mapping, then
+// coordinate dimension, segmentize/simplify, clipping, reprojection and
+// geometry type conversion of each geometry field.
+// This does not touch the target layer nor the transactions, and does not
+// emit errors for failed conversions, so that it can be run from a worker
+// thread (with its own papoCT coordinate transformations). The caller is
+// responsible for reporting the failures, see WriteConvertedFeature().
+
+LayerTranslator::ConvertStatus LayerTranslator::ConvertFeature(
+                                    TargetLayerInfo* psInfo,
+                                    OGRFeature* poFeature,
+                                    int nParts, int iPart,
+                                    OGRSpatialReference* poOutputSRS,
+                                    OGRCoordinateTransformation** papoCT,
+                                    bool bSkipFailures,
+                                    OGRFeature** ppoDstFeature,
+                                    bool* pbReprojectionFailed ) const
+{
+    const int eGType = m_eGType;
+    OGRLayer *poDstLayer = psInfo->poDstLayer;
+    const int iSrcZField = psInfo->iSrcZField;
+    const bool bPreserveFID = psInfo->bPreserveFID;
+    const int nSrcGeomFieldCount =
+        psInfo->poSrcLayer->GetLayerDefn()->GetGeomFieldCount();
+    const int nDstGeomFieldCount =
+        poDstLayer->GetLayerDefn()->GetGeomFieldCount();
+    const bool bExplodeCollections =
+        m_bExplodeCollections && nDstGeomFieldCount <= 1;
+
+    *ppoDstFeature = NULL;
+    *pbReprojectionFailed = false;
+
+    OGRFeature* poDstFeature =
+        OGRFeature::CreateFeature( poDstLayer->GetLayerDefn() );
+
+    /* Optimization to avoid duplicating the source geometry in the */
+    /* target feature : we steal it from the source feature for now... */
+    OGRGeometry* poStolenGeometry = NULL;
+    if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
+        nDstGeomFieldCount == 1 )
+    {
+        poStolenGeometry = poFeature->StealGeometry();
+    }
+    else if( !bExplodeCollections &&
+             psInfo->iRequestedSrcGeomField >= 0 )
+    {
+        poStolenGeometry = poFeature->StealGeometry(
+            psInfo->iRequestedSrcGeomField);
+    }
+
+    if( poDstFeature->SetFrom( poFeature, psInfo->panMap, TRUE ) != OGRERR_NONE )
+    {
+        OGRFeature::DestroyFeature( poDstFeature );
+        OGRGeometryFactory::destroyGeometry( poStolenGeometry );
+        return CONVERT_SETFROM_FAILED;
+    }
+
+    /* ... and now we can attach the stolen geometry */
+    if( poStolenGeometry )
+    {
+        poDstFeature->SetGeometryDirectly(poStolenGeometry);
+    }
+
+    if( bPreserveFID )
+        poDstFeature->SetFID( poFeature->GetFID() );
+    else if( psInfo->iSrcFIDField >= 0 &&
+             poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField))
+        poDstFeature->SetFID( poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField) );
+
+    /* Erase native data if asked explicitly */
+    if( !m_bNativeData )
+    {
+        poDstFeature->SetNativeData(NULL);
+        poDstFeature->SetNativeMediaType(NULL);
+    }
+
+    for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
+    {
+        OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
+        if (poDstGeometry == NULL)
+            continue;
+
+        if (nParts > 0)
+        {
+            /* For -explodecollections, extract the iPart(th) of the geometry */
+            OGRGeometry* poPart = ((OGRGeometryCollection*)poDstGeometry)->getGeometryRef(iPart);
+            ((OGRGeometryCollection*)poDstGeometry)->removeGeometry(iPart, FALSE);
+            delete poDstGeometry;
+            poDstGeometry = poPart;
+        }
+
+        if (iSrcZField != -1)
+        {
+            SetZ(poDstGeometry, poFeature->GetFieldAsDouble(iSrcZField));
+            /* This will correct the coordinate dimension to 3 */
+            OGRGeometry* poDupGeometry = poDstGeometry->clone();
+            delete poDstGeometry;
+            poDstGeometry = poDupGeometry;
+        }
+
+        if (m_nCoordDim == 2 || m_nCoordDim == 3)
+        {
+            poDstGeometry->setCoordinateDimension( m_nCoordDim );
+        }
+        else if (m_nCoordDim == 4)
+        {
+            poDstGeometry->set3D( TRUE );
+            poDstGeometry->setMeasured( TRUE );
+        }
+        else if (m_nCoordDim == COORD_DIM_XYM)
+        {
+            poDstGeometry->set3D( FALSE );
+            poDstGeometry->setMeasured( TRUE );
+        }
+        else if ( m_nCoordDim == COORD_DIM_LAYER_DIM )
+        {
+            const OGRwkbGeometryType eDstLayerGeomType =
+              poDstLayer->GetLayerDefn()->GetGeomFieldDefn(iGeom)->GetType();
+            poDstGeometry->set3D( wkbHasZ(eDstLayerGeomType) );
+            poDstGeometry->setMeasured( wkbHasM(eDstLayerGeomType) );
+        }
+
+        if (m_eGeomOp == GEOMOP_SEGMENTIZE)
+        {
+            if (m_dfGeomOpParam > 0)
+                poDstGeometry->segmentize(m_dfGeomOpParam);
+        }
+        else if (m_eGeomOp == GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY)
+        {
+            if (m_dfGeomOpParam > 0)
+            {
+                OGRGeometry* poNewGeom = poDstGeometry->SimplifyPreserveTopology(m_dfGeomOpParam);
+                if (poNewGeom)
+                {
+                    delete poDstGeometry;
+                    poDstGeometry = poNewGeom;
+                }
+            }
+        }
+
+        if (m_poClipSrc)
+        {
+            OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipSrc);
+            delete poDstGeometry;
+            if (poClipped == NULL || poClipped->IsEmpty())
+            {
+                delete poClipped;
+                OGRFeature::DestroyFeature( poDstFeature );
+                return CONVERT_SKIPPED;
+            }
+            poDstGeometry = poClipped;
+        }
+
+        OGRCoordinateTransformation* poCT = papoCT[iGeom];
+        if( !m_bTransform )
+            poCT = m_poGCPCoordTrans;
+        char** papszTransformOptions = psInfo->papapszTransformOptions[iGeom];
+
+        if( poCT != NULL || papszTransformOptions != NULL)
+        {
+            OGRGeometry* poReprojectedGeom =
+                OGRGeometryFactory::transformWithOptions(poDstGeometry, poCT, papszTransformOptions);
+            if( poReprojectedGeom == NULL )
+            {
+                *pbReprojectionFailed = true;
+                if( !bSkipFailures )
+                {
+                    OGRFeature::DestroyFeature( poDstFeature );
+                    delete poDstGeometry;
+                    return CONVERT_FAILED;
+                }
+            }
+
+            delete poDstGeometry;
+            poDstGeometry = poReprojectedGeom;
+        }
+        else if (poOutputSRS != NULL)
+        {
+            poDstGeometry->assignSpatialReference(poOutputSRS);
+        }
+
+        if (m_poClipDst)
+        {
+            if( poDstGeometry == NULL )
+            {
+                OGRFeature::DestroyFeature( poDstFeature );
+                return CONVERT_SKIPPED;
+            }
+
+            OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipDst);
+            delete poDstGeometry;
+            if (poClipped == NULL || poClipped->IsEmpty())
+            {
+                delete poClipped;
+                OGRFeature::DestroyFeature( poDstFeature );
+                return CONVERT_SKIPPED;
+            }
+
+            poDstGeometry = poClipped;
+        }
+
+        if( eGType != GEOMTYPE_UNCHANGED )
+        {
+            poDstGeometry = OGRGeometryFactory::forceTo(
+                    poDstGeometry, (OGRwkbGeometryType)eGType);
+        }
+        else if( m_eGeomTypeConversion == GTC_PROMOTE_TO_MULTI ||
+                 m_eGeomTypeConversion == GTC_CONVERT_TO_LINEAR ||
+                 m_eGeomTypeConversion == GTC_CONVERT_TO_CURVE )
+        {
+            if( poDstGeometry != NULL )
+            {
+                OGRwkbGeometryType eTargetType = poDstGeometry->getGeometryType();
+                eTargetType = ConvertType(m_eGeomTypeConversion, eTargetType);
+                poDstGeometry = OGRGeometryFactory::forceTo(poDstGeometry, eTargetType);
+            }
+        }
+
+        poDstFeature->SetGeomFieldDirectly(iGeom, poDstGeometry);
+    }
+
+    *ppoDstFeature = poDstFeature;
+    return CONVERT_OK;
+}
+
+/************************************************************************/
+/*             LayerTranslator::StartNextTransactionIfNeeded()          */
+/************************************************************************/
+
+bool LayerTranslator::StartNextTransactionIfNeeded(
+                                    OGRLayer* poDstLayer,
+                                    int& nFeaturesInTransaction,
+                                    GIntBig& nTotalEventsDone,
+                                    GDALVectorTranslateOptions *psOptions )
+{
+    if( psOptions->nLayerTransaction &&
+        ++nFeaturesInTransaction == psOptions->nGroupTransactions )
+    {
+        if( poDstLayer->CommitTransaction() == OGRERR_FAILURE ||
+            poDstLayer->StartTransaction() == OGRERR_FAILURE )
+        {
+            return false;
+        }
+        nFeaturesInTransaction = 0;
+    }
+    else if( !psOptions->nLayerTransaction &&
+             psOptions->nGroupTransactions >= 0 &&
+             ++nTotalEventsDone >= psOptions->nGroupTransactions )
+    {
+        if( m_poODS->CommitTransaction() == OGRERR_FAILURE ||
+                m_poODS->StartTransaction(psOptions->bForceTransaction) == OGRERR_FAILURE )
+        {
+            return false;
+        }
+        nTotalEventsDone = 0;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*               LayerTranslator::WriteConvertedFeature()               */
+/************************************************************************/
+
+// Reports the failures of ConvertFeature() and writes the target feature.
+// Returns false if the translation must stop. The features are not freed.
+
+bool LayerTranslator::WriteConvertedFeature(
+                                    TargetLayerInfo* psInfo,
+                                    OGRFeature* poFeature,
+                                    OGRFeature* poDstFeature,
+                                    ConvertStatus eStatus,
+                                    bool bReprojectionFailed,
+                                    GIntBig& nFeaturesWritten,
+                                    GDALVectorTranslateOptions *psOptions )
+{
+    OGRLayer *poSrcLayer = psInfo->poSrcLayer;
+    OGRLayer *poDstLayer = psInfo->poDstLayer;
+    const bool bPreserveFID = psInfo->bPreserveFID;
+
+    if( eStatus == CONVERT_SETFROM_FAILED )
+    {
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+            {
+                if( poDstLayer->CommitTransaction() != OGRERR_NONE )
+                    return false;
+            }
+        }
+
+        CPLError( CE_Failure, CPLE_AppDefined,
+                "Unable to translate feature " CPL_FRMT_GIB " from layer %s.",
+                poFeature->GetFID(), poSrcLayer->GetName() );
+        return false;
+    }
+
+    if( bReprojectionFailed )
+    {
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+            {
+                if( poDstLayer->CommitTransaction() != OGRERR_NONE &&
+                    !psOptions->bSkipFailures )
+                {
+                    return false;
+                }
+            }
+        }
+
+        CPLError( CE_Failure, CPLE_AppDefined, "Failed to reproject feature " CPL_FRMT_GIB " (geometry probably out of source or destination SRS).",
+                  poFeature->GetFID() );
+        if( !psOptions->bSkipFailures )
+            return false;
+    }
+
+    if( eStatus != CONVERT_OK )
+        return true;
+
+    CPLErrorReset();
+    if( poDstLayer->CreateFeature( poDstFeature ) == OGRERR_NONE )
+    {
+        nFeaturesWritten ++;
+        if( (bPreserveFID && poDstFeature->GetFID() != poFeature->GetFID()) ||
+            (!bPreserveFID && psInfo->iSrcFIDField >= 0 && poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField) &&
+             poDstFeature->GetFID() != poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField)) )
+        {
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "Feature id not preserved");
+        }
+    }
+    else if( !psOptions->bSkipFailures )
+    {
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+                poDstLayer->RollbackTransaction();
+        }
+
+        CPLError( CE_Failure, CPLE_AppDefined,
+                "Unable to write feature " CPL_FRMT_GIB " from layer %s.",
+                poFeature->GetFID(), poSrcLayer->GetName() );
+        return false;
+    }
+    else
+    {
+        CPLDebug( "GDALVectorTranslate", "Unable to write feature " CPL_FRMT_GIB " into layer %s.",
+                   poFeature->GetFID(), poSrcLayer->GetName() );
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+            {
+                poDstLayer->RollbackTransaction();
+                CPL_IGNORE_RET_VAL(poDstLayer->StartTransaction());
+            }
+            else
+            {
+                m_poODS->RollbackTransaction();
+                m_poODS->StartTransaction(psOptions->bForceTransaction);
+            }
+        }
+    }
+    return true;
+}
+
 /************************************************************************/
 /*                     LayerTranslator::Translate()                     */
 /************************************************************************/
@@ -4281,14 +4707,10 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
                                 void *pProgressArg,
                                 GDALVectorTranslateOptions *psOptions )
 {
-    const int eGType = m_eGType;
     OGRSpatialReference* poOutputSRS = m_poOutputSRS;
 
     OGRLayer *poSrcLayer = psInfo->poSrcLayer;
     OGRLayer *poDstLayer = psInfo->poDstLayer;
-    int* const panMap = psInfo->panMap;
-    const int iSrcZField = psInfo->iSrcZField;
-    const bool bPreserveFID = psInfo->bPreserveFID;
     const int nSrcGeomFieldCount = poSrcLayer->GetLayerDefn()->GetGeomFieldCount();
     const int nDstGeomFieldCount = poDstLayer->GetLayerDefn()->GetGeomFieldCount();
     const bool bExplodeCollections = m_bExplodeCollections && nDstGeomFieldCount <= 1;
@@ -4306,6 +4728,14 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
         }
     }
 
+    // Multi-threaded conversion is only possible once the coordinate
+    // transformations are known (after the first feature), and if they
+    // do not depend on each feature.
+    const bool bCanUseThreads =
+        m_nThreads > 1 && poFeatureIn == NULL &&
+        psOptions->nFIDToFetch == OGRNullFID &&
+        !bExplodeCollections && m_poGCPCoordTrans == NULL;
+
 /* -------------------------------------------------------------------- */
 /*      Transfer features.                                              */
 /* -------------------------------------------------------------------- */
@@ -4332,6 +4762,23 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
             break;
         }
 
+        if( bCanUseThreads && psInfo->nFeaturesRead > 0 &&
+            !psInfo->bPerFeatureCT )
+        {
+            if( !TranslateMultiThreaded( psInfo, poOutputSRS,
+                                         nCountLayerFeatures,
+                                         pnReadFeatureCount,
+                                         nFeaturesInTransaction,
+                                         nTotalEventsDone,
+                                         nCount, nFeaturesWritten, bRet,
+                                         pfnProgress, pProgressArg,
+                                         psOptions ) )
+            {
+                return false;
+            }
+            break;
+        }
+
         if( poFeatureIn != NULL )
             poFeature = poFeatureIn;
         else if( psOptions->nFIDToFetch != OGRNullFID )
@@ -4381,302 +4828,36 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
             }
         }
 
-        OGRFeature *poDstFeature = NULL;
         for(int iPart = 0; iPart < nIters; iPart++)
         {
-            if( psOptions->nLayerTransaction &&
-                ++nFeaturesInTransaction == psOptions->nGroupTransactions )
-            {
-                if( poDstLayer->CommitTransaction() == OGRERR_FAILURE ||
-                    poDstLayer->StartTransaction() == OGRERR_FAILURE )
-                {
-                    OGRFeature::DestroyFeature( poFeature );
-                    return false;
-                }
-                nFeaturesInTransaction = 0;
-            }
-            else if( !psOptions->nLayerTransaction &&
-                     psOptions->nGroupTransactions >= 0 &&
-                     ++nTotalEventsDone >= psOptions->nGroupTransactions )
+            if( !StartNextTransactionIfNeeded( poDstLayer,
+                                               nFeaturesInTransaction,
+                                               nTotalEventsDone,
+                                               psOptions ) )
             {
-                if( m_poODS->CommitTransaction() == OGRERR_FAILURE ||
-                        m_poODS->StartTransaction(psOptions->bForceTransaction) == OGRERR_FAILURE )
-                {
-                    OGRFeature::DestroyFeature( poFeature );
-                    return false;
-                }
-                nTotalEventsDone = 0;
-            }
-
-            CPLErrorReset();
-            poDstFeature = OGRFeature::CreateFeature( poDstLayer->GetLayerDefn() );
-
-            /* Optimization to avoid duplicating the source geometry in the */
-            /* target feature : we steal it from the source feature for now... */
-            OGRGeometry* poStolenGeometry = NULL;
-            if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
-                nDstGeomFieldCount == 1 )
-            {
-                poStolenGeometry = poFeature->StealGeometry();
-            }
-            else if( !bExplodeCollections &&
-                     psInfo->iRequestedSrcGeomField >= 0 )
-            {
-                poStolenGeometry = poFeature->StealGeometry(
-                    psInfo->iRequestedSrcGeomField);
-            }
-
-            if( poDstFeature->SetFrom( poFeature, panMap, TRUE ) != OGRERR_NONE )
-            {
-                if( psOptions->nGroupTransactions )
-                {
-                    if( psOptions->nLayerTransaction )
-                    {
-                        if( poDstLayer->CommitTransaction() != OGRERR_NONE )
-                        {
-                            OGRFeature::DestroyFeature( poFeature );
-                            OGRFeature::DestroyFeature( poDstFeature );
-                            OGRGeometryFactory::destroyGeometry( poStolenGeometry );
-                            return false;
-                        }
-                    }
-                }
-
-                CPLError( CE_Failure, CPLE_AppDefined,
-                        "Unable to translate feature " CPL_FRMT_GIB " from layer %s.",
-                        poFeature->GetFID(), poSrcLayer->GetName() );
-
                 OGRFeature::DestroyFeature( poFeature );
-                OGRFeature::DestroyFeature( poDstFeature );
-                OGRGeometryFactory::destroyGeometry( poStolenGeometry );
                 return false;
             }
 
-            /* ... and now we can attach the stolen geometry */
-            if( poStolenGeometry )
-            {
-                poDstFeature->SetGeometryDirectly(poStolenGeometry);
-            }
-
-            if( bPreserveFID )
-                poDstFeature->SetFID( poFeature->GetFID() );
-            else if( psInfo->iSrcFIDField >= 0 &&
-                     poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField))
-                poDstFeature->SetFID( poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField) );
-
-            /* Erase native data if asked explicitly */
-            if( !m_bNativeData )
-            {
-                poDstFeature->SetNativeData(NULL);
-                poDstFeature->SetNativeMediaType(NULL);
-            }
-
-            for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
-            {
-                OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
-                if (poDstGeometry == NULL)
-                    continue;
-
-                if (nParts > 0)
-                {
-                    /* For -explodecollections, extract the iPart(th) of the geometry */
-                    OGRGeometry* poPart = ((OGRGeometryCollection*)poDstGeometry)->getGeometryRef(iPart);
-                    ((OGRGeometryCollection*)poDstGeometry)->removeGeometry(iPart, FALSE);
-                    delete poDstGeometry;
-                    poDstGeometry = poPart;
-                }
-
-                if (iSrcZField != -1)
-                {
-                    SetZ(poDstGeometry, poFeature->GetFieldAsDouble(iSrcZField));
-                    /* This will correct the coordinate dimension to 3 */
-                    OGRGeometry* poDupGeometry = poDstGeometry->clone();
-                    delete poDstGeometry;
-                    poDstGeometry = poDupGeometry;
-                }
-
-                if (m_nCoordDim == 2 || m_nCoordDim == 3)
-                {
-                    poDstGeometry->setCoordinateDimension( m_nCoordDim );
-                }
-                else if (m_nCoordDim == 4)
-                {
-                    poDstGeometry->set3D( TRUE );
-                    poDstGeometry->setMeasured( TRUE );
-                }
-                else if (m_nCoordDim == COORD_DIM_XYM)
-                {
-                    poDstGeometry->set3D( FALSE );
-                    poDstGeometry->setMeasured( TRUE );
-                }
-                else if ( m_nCoordDim == COORD_DIM_LAYER_DIM )
-                {
-                    const OGRwkbGeometryType eDstLayerGeomType =
-                      poDstLayer->GetLayerDefn()->GetGeomFieldDefn(iGeom)->GetType();
-                    poDstGeometry->set3D( wkbHasZ(eDstLayerGeomType) );
-                    poDstGeometry->setMeasured( wkbHasM(eDstLayerGeomType) );
-                }
-
-                if (m_eGeomOp == GEOMOP_SEGMENTIZE)
-                {
-                    if (m_dfGeomOpParam > 0)
-                        poDstGeometry->segmentize(m_dfGeomOpParam);
-                }
-                else if (m_eGeomOp == GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY)
-                {
-                    if (m_dfGeomOpParam > 0)
-                    {
-                        OGRGeometry* poNewGeom = poDstGeometry->SimplifyPreserveTopology(m_dfGeomOpParam);
-                        if (poNewGeom)
-                        {
-                            delete poDstGeometry;
-                            poDstGeometry = poNewGeom;
-                        }
-                    }
-                }
-
-                if (m_poClipSrc)
-                {
-                    OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipSrc);
-                    delete poDstGeometry;
-                    if (poClipped == NULL || poClipped->IsEmpty())
-                    {
-                        delete poClipped;
-                        goto end_loop;
-                    }
-                    poDstGeometry = poClipped;
-                }
-
-                OGRCoordinateTransformation* poCT = psInfo->papoCT[iGeom];
-                if( !m_bTransform )
-                    poCT = m_poGCPCoordTrans;
-                char** papszTransformOptions = psInfo->papapszTransformOptions[iGeom];
-
-                if( poCT != NULL || papszTransformOptions != NULL)
-                {
-                    OGRGeometry* poReprojectedGeom =
-                        OGRGeometryFactory::transformWithOptions(poDstGeometry, poCT, papszTransformOptions);
-                    if( poReprojectedGeom == NULL )
-                    {
-                        if( psOptions->nGroupTransactions )
-                        {
-                            if( psOptions->nLayerTransaction )
-                            {
-                                if( poDstLayer->CommitTransaction() != OGRERR_NONE &&
-                                    !psOptions->bSkipFailures )
-                                {
-                                    OGRFeature::DestroyFeature( poFeature );
-                                    OGRFeature::DestroyFeature( poDstFeature );
-                                    delete poDstGeometry;
-                                    return false;
-                                }
-                            }
-                        }
-
-                        CPLError( CE_Failure, CPLE_AppDefined, "Failed to reproject feature " CPL_FRMT_GIB " (geometry probably out of source or destination SRS).",
-                                  poFeature->GetFID() );
-                        if( !psOptions->bSkipFailures )
-                        {
-                            OGRFeature::DestroyFeature( poFeature );
-                            OGRFeature::DestroyFeature( poDstFeature );
-                            delete poDstGeometry;
-                            return false;
-                        }
-                    }
-
-                    delete poDstGeometry;
-                    poDstGeometry = poReprojectedGeom;
-                }
-                else if (poOutputSRS != NULL)
-                {
-                    poDstGeometry->assignSpatialReference(poOutputSRS);
-                }
-
-                if (m_poClipDst)
-                {
-                    if( poDstGeometry == NULL )
-                        goto end_loop;
-
-                    OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipDst);
-                    delete poDstGeometry;
-                    if (poClipped == NULL || poClipped->IsEmpty())
-                    {
-                        delete poClipped;
-                        goto end_loop;
-                    }
-
-                    poDstGeometry = poClipped;
-                }
-
-                if( eGType != GEOMTYPE_UNCHANGED )
-                {
-                    poDstGeometry = OGRGeometryFactory::forceTo(
-                            poDstGeometry, (OGRwkbGeometryType)eGType);
-                }
-                else if( m_eGeomTypeConversion == GTC_PROMOTE_TO_MULTI ||
-                         m_eGeomTypeConversion == GTC_CONVERT_TO_LINEAR ||
-                         m_eGeomTypeConversion == GTC_CONVERT_TO_CURVE )
-                {
-                    if( poDstGeometry != NULL )
-                    {
-                        OGRwkbGeometryType eTargetType = poDstGeometry->getGeometryType();
-                        eTargetType = ConvertType(m_eGeomTypeConversion, eTargetType);
-                        poDstGeometry = OGRGeometryFactory::forceTo(poDstGeometry, eTargetType);
-                    }
-                }
-
-                poDstFeature->SetGeomFieldDirectly(iGeom, poDstGeometry);
-            }
-
             CPLErrorReset();
-            if( poDstLayer->CreateFeature( poDstFeature ) == OGRERR_NONE )
-            {
-                nFeaturesWritten ++;
-                if( (bPreserveFID && poDstFeature->GetFID() != poFeature->GetFID()) ||
-                    (!bPreserveFID && psInfo->iSrcFIDField >= 0 && poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField) &&
-                     poDstFeature->GetFID() != poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField)) )
-                {
-                    CPLError( CE_Warning, CPLE_AppDefined,
-                              "Feature id not preserved");
-                }
-            }
-            else if( !psOptions->bSkipFailures )
+            OGRFeature *poDstFeature = NULL;
+            bool bReprojectionFailed = false;
+            const ConvertStatus eStatus =
+                ConvertFeature( psInfo, poFeature, nParts, iPart,
+                                poOutputSRS, psInfo->papoCT,
+                                psOptions->bSkipFailures,
+                                &poDstFeature, &bReprojectionFailed );
+
+            const bool bGoOn =
+                WriteConvertedFeature( psInfo, poFeature, poDstFeature,
+                                       eStatus, bReprojectionFailed,
+                                       nFeaturesWritten, psOptions );
+            OGRFeature::DestroyFeature( poDstFeature );
+            if( !bGoOn )
             {
-                if( psOptions->nGroupTransactions )
-                {
-                    if( psOptions->nLayerTransaction )
-                        poDstLayer->RollbackTransaction();
-                }
-
-                CPLError( CE_Failure, CPLE_AppDefined,
-                        "Unable to write feature " CPL_FRMT_GIB " from layer %s.",
-                        poFeature->GetFID(), poSrcLayer->GetName() );
-
                 OGRFeature::DestroyFeature( poFeature );
-                OGRFeature::DestroyFeature( poDstFeature );
                 return false;
             }
-            else
-            {
-                CPLDebug( "GDALVectorTranslate", "Unable to write feature " CPL_FRMT_GIB " into layer %s.",
-                           poFeature->GetFID(), poSrcLayer->GetName() );
-                if( psOptions->nGroupTransactions )
-                {
-                    if( psOptions->nLayerTransaction )
-                    {
-                        poDstLayer->RollbackTransaction();
-                        CPL_IGNORE_RET_VAL(poDstLayer->StartTransaction());
-                    }
-                    else
-                    {
-                        m_poODS->RollbackTransaction();
-                        m_poODS->StartTransaction(psOptions->bForceTransaction);
-                    }
-                }
-            }
-
-end_loop:
-            OGRFeature::DestroyFeature( poDstFeature );
         }
 
         OGRFeature::DestroyFeature( poFeature );
@@ -4721,6 +4902,293 @@ end_loop:
     return bRet;
 }
 
+/************************************************************************/
+/*                     OGR2OGRConvertFeaturesJob                        */
+/************************************************************************/
+
+namespace {
+
+struct OGR2OGRConvertedFeature
+{
+    OGRFeature                     *poFeature;
+    OGRFeature                     *poDstFeature;
+    LayerTranslator::ConvertStatus  eStatus;
+    bool                            bReprojectionFailed;
+};
+
+struct OGR2OGRThreadError
+{
+    CPLErr      eErr;
+    CPLErrorNum nErrNo;
+    CPLString   osMsg;
+};
+
+struct OGR2OGRConvertFeaturesJob
+{
+    const LayerTranslator                *poTranslator;
+    TargetLayerInfo                      *psInfo;
+    OGRSpatialReference                  *poOutputSRS;
+    OGRCoordinateTransformation         **papoCT;  // Owned by this job.
+    bool                                  bSkipFailures;
+    std::vector<OGR2OGRConvertedFeature> *pasFeatures;
+    size_t                                nStart;
+    size_t                                nEnd;
+    // Errors raised while converting, re-emitted by the calling thread.
+    std::vector<OGR2OGRThreadError>       aoErrors;
+};
+
+}  // namespace
+
+static void CPL_STDCALL OGR2OGRThreadErrorHandler( CPLErr eErr,
+                                                   CPLErrorNum nErrNo,
+                                                   const char* pszMsg )
+{
+    std::vector<OGR2OGRThreadError>* paoErrors =
+        static_cast<std::vector<OGR2OGRThreadError>*>(
+            CPLGetErrorHandlerUserData());
+    OGR2OGRThreadError sError;
+    sError.eErr = eErr;
+    sError.nErrNo = nErrNo;
+    sError.osMsg = pszMsg;
+    paoErrors->push_back(sError);
+}
+
+static void OGR2OGRConvertFeaturesJobFunc( void* pData )
+{
+    OGR2OGRConvertFeaturesJob* psJob =
+        static_cast<OGR2OGRConvertFeaturesJob*>(pData);
+    // The error handler stack is per thread, so this only catches the
+    // errors of this job.
+    CPLPushErrorHandlerEx( OGR2OGRThreadErrorHandler, &psJob->aoErrors );
+    for( size_t i = psJob->nStart; i < psJob->nEnd; i++ )
+    {
+        OGR2OGRConvertedFeature& sFeature = (*psJob->pasFeatures)[i];
+        sFeature.eStatus = psJob->poTranslator->ConvertFeature(
+            psJob->psInfo, sFeature.poFeature, 0, 0,
+            psJob->poOutputSRS, psJob->papoCT, psJob->bSkipFailures,
+            &sFeature.poDstFeature, &sFeature.bReprojectionFailed );
+    }
+    CPLPopErrorHandler();
+}
+
+/* Re-emit on the calling thread the errors raised by the jobs of the last */
+/* converted batch, in feature order. */
+static void OGR2OGREmitThreadErrors(
+                        std::vector<OGR2OGRConvertFeaturesJob>& asJobs )
+{
+    for( size_t i = 0; i < asJobs.size(); i++ )
+    {
+        std::vector<OGR2OGRThreadError>& aoErrors = asJobs[i].aoErrors;
+        for( size_t j = 0; j < aoErrors.size(); j++ )
+        {
+            CPLError( aoErrors[j].eErr, aoErrors[j].nErrNo, "%s",
+                      aoErrors[j].osMsg.c_str() );
+        }
+        aoErrors.clear();
+    }
+}
+
+static void OGR2OGRDestroyConvertedFeatures(
+                        std::vector<OGR2OGRConvertedFeature>& asFeatures )
+{
+    for( size_t i = 0; i < asFeatures.size(); i++ )
+    {
+        OGRFeature::DestroyFeature( asFeatures[i].poFeature );
+        OGRFeature::DestroyFeature( asFeatures[i].poDstFeature );
+    }
+    asFeatures.clear();
+}
+
+/************************************************************************/
+/*               LayerTranslator::TranslateMultiThreaded()              */
+/************************************************************************/
+
+// Pipelined version of the main loop of Translate(). The calling thread
+// reads batch N+1 and writes batch N-1 while the worker threads convert
+// batch N, so at most 3 batches of features are in memory. Features are
+// written in the order they are read.
+// Returns false in case of a fatal error. bRet is set to false if reading
+// failed or if the user interrupted the processing.
+
+bool LayerTranslator::TranslateMultiThreaded(
+                                    TargetLayerInfo* psInfo,
+                                    OGRSpatialReference* poOutputSRS,
+                                    GIntBig nCountLayerFeatures,
+                                    GIntBig* pnReadFeatureCount,
+                                    int& nFeaturesInTransaction,
+                                    GIntBig& nTotalEventsDone,
+                                    GIntBig& nCount,
+                                    GIntBig& nFeaturesWritten,
+                                    bool& bRet,
+                                    GDALProgressFunc pfnProgress,
+                                    void *pProgressArg,
+                                    GDALVectorTranslateOptions *psOptions )
+{
+    const int nBatchSizePerThread = 256;
+    const int nThreads = m_nThreads;
+    OGRLayer *poSrcLayer = psInfo->poSrcLayer;
+    OGRLayer *poDstLayer = psInfo->poDstLayer;
+    const int nDstGeomFieldCount =
+        poDstLayer->GetLayerDefn()->GetGeomFieldCount();
+
+    CPLWorkerThreadPool oPool;
+    if( !oPool.Setup(nThreads, NULL, NULL) )
+        return false;
+
+    // Coordinate transformations are not thread-safe, so each job gets its
+    // own copy.
+    std::vector<OGR2OGRConvertFeaturesJob> asJobs(nThreads);
+    bool bFatal = false;
+    for( int i = 0; i < nThreads; i++ )
+    {
+        asJobs[i].poTranslator = this;
+        asJobs[i].psInfo = psInfo;
+        asJobs[i].poOutputSRS = poOutputSRS;
+        asJobs[i].bSkipFailures = psOptions->bSkipFailures;
+        asJobs[i].papoCT = static_cast<OGRCoordinateTransformation**>(
+            CPLCalloc(std::max(1, nDstGeomFieldCount),
+                      sizeof(OGRCoordinateTransformation*)));
+        for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom++ )
+        {
+            OGRCoordinateTransformation* poCT = psInfo->papoCT[iGeom];
+            if( poCT == NULL )
+                continue;
+            asJobs[i].papoCT[iGeom] = OGRCreateCoordinateTransformation(
+                poCT->GetSourceCS(), poCT->GetTargetCS() );
+            if( asJobs[i].papoCT[iGeom] == NULL && !bFatal )
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                          "Cannot create a copy of the coordinate "
+                          "transformation of layer %s for the worker "
+                          "threads.", poSrcLayer->GetName() );
+                bFatal = true;
+            }
+        }
+    }
+
+    std::vector<OGR2OGRConvertedFeature> asToWrite;
+    std::vector<OGR2OGRConvertedFeature> asToConvert;
+    std::vector<OGR2OGRConvertedFeature> asToRead;
+    const size_t nBatchSize =
+        static_cast<size_t>(nBatchSizePerThread) * nThreads;
+    bool bEOF = false;
+    bool bReadError = false;
+
+    while( !bFatal )
+    {
+        // Dispatch the batch to convert to the workers.
+        if( !asToConvert.empty() )
+        {
+            std::vector<void*> apJobs;
+            const size_t nPerJob =
+                (asToConvert.size() + nThreads - 1) / nThreads;
+            for( int i = 0; i < nThreads; i++ )
+            {
+                asJobs[i].pasFeatures = &asToConvert;
+                asJobs[i].nStart =
+                    std::min(asToConvert.size(), i * nPerJob);
+                asJobs[i].nEnd =
+                    std::min(asToConvert.size(), (i + 1) * nPerJob);
+                if( asJobs[i].nStart < asJobs[i].nEnd )
+                    apJobs.push_back(&asJobs[i]);
+            }
+            if( !oPool.SubmitJobs(OGR2OGRConvertFeaturesJobFunc, apJobs) )
+            {
+                bFatal = true;
+                break;
+            }
+        }
+
+        // Write the previously converted batch.
+        for( size_t i = 0; bRet && i < asToWrite.size(); i++ )
+        {
+            OGR2OGRConvertedFeature& sFeature = asToWrite[i];
+            if( !StartNextTransactionIfNeeded( poDstLayer,
+                                               nFeaturesInTransaction,
+                                               nTotalEventsDone,
+                                               psOptions ) ||
+                !WriteConvertedFeature( psInfo, sFeature.poFeature,
+                                        sFeature.poDstFeature,
+                                        sFeature.eStatus,
+                                        sFeature.bReprojectionFailed,
+                                        nFeaturesWritten, psOptions ) )
+            {
+                bFatal = true;
+                break;
+            }
+
+            /* Report progress */
+            nCount ++;
+            if( pfnProgress &&
+                !pfnProgress(nCountLayerFeatures ? nCount * 1.0 / nCountLayerFeatures: 1.0, "", pProgressArg) )
+            {
+                bRet = false;
+                break;
+            }
+
+            if (pnReadFeatureCount)
+                *pnReadFeatureCount = nCount;
+        }
+        OGR2OGRDestroyConvertedFeatures(asToWrite);
+
+        // Read the next batch.
+        while( !bFatal && bRet && !bEOF && asToRead.size() < nBatchSize )
+        {
+            if( m_nLimit >= 0 && psInfo->nFeaturesRead >= m_nLimit )
+            {
+                bEOF = true;
+                break;
+            }
+            CPLErrorReset();
+            OGRFeature* poFeature = poSrcLayer->GetNextFeature();
+            if( poFeature == NULL )
+            {
+                // Features read before the error are still written.
+                if( CPLGetLastErrorType() == CE_Failure )
+                    bReadError = true;
+                bEOF = true;
+                break;
+            }
+            psInfo->nFeaturesRead ++;
+
+            OGR2OGRConvertedFeature sFeature;
+            sFeature.poFeature = poFeature;
+            sFeature.poDstFeature = NULL;
+            sFeature.eStatus = CONVERT_OK;
+            sFeature.bReprojectionFailed = false;
+            asToRead.push_back(sFeature);
+        }
+
+        oPool.WaitCompletion();
+        OGR2OGREmitThreadErrors(asJobs);
+
+        if( bFatal || !bRet ||
+            (asToConvert.empty() && asToRead.empty()) )
+        {
+            break;
+        }
+        asToWrite.swap(asToConvert);
+        asToConvert.swap(asToRead);
+    }
+
+    if( bReadError )
+        bRet = false;
+
+    oPool.WaitCompletion();
+    OGR2OGREmitThreadErrors(asJobs);
+    OGR2OGRDestroyConvertedFeatures(asToWrite);
+    OGR2OGRDestroyConvertedFeatures(asToConvert);
+    OGR2OGRDestroyConvertedFeatures(asToRead);
+    for( int i = 0; i < nThreads; i++ )
+    {
+        for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom++ )
+            delete asJobs[i].papoCT[iGeom];
+        CPLFree(asJobs[i].papoCT);
+    }
+
+    return !bFatal;
+}
+
 /************************************************************************/
 /*                             RemoveBOM()                              */
 /************************************************************************/
@@ -4822,6 +5290,7 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
     psOptions->hSpatialFilter = NULL;
     psOptions->bNativeData = true;
     psOptions->nLimit = -1;
+    psOptions->nThreads = 0;
 
     int nArgc = CSLCount(papszArgv);
     for( int i = 0; papszArgv != NULL && i < nArgc; i++ )
@@ -5401,6 +5870,14 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
         {
             psOptions->nLimit = CPLAtoGIntBig( papszArgv[++i] );
         }
+        else if( i+1 < nArgc && EQUAL(papszArgv[i],"-threads") )
+        {
+            ++i;
+            if( EQUAL(papszArgv[i], "ALL_CPUS") )
+                psOptions->nThreads = CPLGetNumCPUs();
+            else
+                psOptions->nThreads = atoi(papszArgv[i]);
+        }
         else if( papszArgv[i][0] == '-' )
         {
             CPLError(CE_Failure, CPLE_NotSupported,
@@ -438,7 +438,8 @@ class GTiffDataset CPL_FINAL : public GDALPamDataset
     bool          bDebugDontWriteBlocks;
 
     CPLErr        RegisterNewOverviewDataset( toff_t nOverviewOffset, int l_nJpegQuality );
-    CPLErr        CreateOverviewsFromSrcOverviews( GDALDataset* poSrcDS );
+    CPLErr        CreateOverviewsFromSrcOverviews( GDALDataset* poSrcDS,
+                                                   GDALDataset* poOvrSrcDS );
     CPLErr        CreateInternalMaskOverviews( int nOvrBlockXSize,
                                                int nOvrBlockYSize );
 
@@ -469,6 +470,7 @@ class GTiffDataset CPL_FINAL : public GDALPamDataset
     std::vector<GTiffCompressionJob> asCompressionJobs;
     CPLMutex      *hCompressThreadPoolMutex;
     void           InitCompressionThreads( char** papszOptions );
+    void           InitCompressionJobs( int nThreads );
     void           InitCreationOrOpenOptions( char** papszOptions );
     static void    ThreadCompressionFunc( void* pData );
     void           WaitCompletionForBlock( int nBlockId );
@@ -1125,6 +1127,7 @@ class GTiffRasterBand : public GDALPamRasterBand
                                  GDALRasterIOExtraArg* psExtraArg );
 
     std::set<GTiffRasterBand **> aSetPSelf;
+    CPLConfigOptionCache oMaxRawBlockCacheSize;
     static void     DropReferenceVirtualMem( void* pUserData );
     CPLVirtualMem * GetVirtualMemAutoInternal( GDALRWFlag eRWFlag,
                                                int *pnPixelSpace,
@@ -1225,6 +1228,7 @@ GTiffRasterBand::GTiffRasterBand( GTiffDataset *poDSIn, int nBandIn ) :
     bHaveOffsetScale(false),
     dfOffset(0.0),
     dfScale(1.0),
+    oMaxRawBlockCacheSize("GDAL_MAX_RAW_BLOCK_CACHE_SIZE", "10485760"),
     poGDS(poDSIn),
     bNoDataSet(false),
     dfNoDataValue(-9999.0)
@@ -4018,8 +4022,7 @@ void* GTiffRasterBand::CacheMultiRange( int nXOff, int nYOff,
         size_t nTotalSize = 0;
         nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
         const unsigned int nMaxRawBlockCacheSize =
-            atoi(CPLGetConfigOption("GDAL_MAX_RAW_BLOCK_CACHE_SIZE",
-                                    "10485760"));
+            atoi(oMaxRawBlockCacheSize.Get());
         for( int iY = nBlockY1; iY <= nBlockY2; iY ++)
         {
             for( int iX = nBlockX1; iX <= nBlockX2; iX ++)
@@ -7420,11 +7423,10 @@ int GTiffDataset::Finalize()
 /* -------------------------------------------------------------------- */
     FlushCacheInternal( true );
 
-    // Destroy compression pool.
+    // Release compression jobs. The pool itself may be shared with the
+    // overviews, so it is only destroyed once they are gone.
     if( poCompressThreadPool )
     {
-        delete poCompressThreadPool;
-
         for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
         {
             CPLFree(asCompressionJobs[i].pabyBuffer);
@@ -7476,6 +7478,11 @@ int GTiffDataset::Finalize()
     CPLFree( papoOverviewDS );
     papoOverviewDS = NULL;
 
+    // Destroy compression pool.
+    if( bBase )
+        delete poCompressThreadPool;
+    poCompressThreadPool = NULL;
+
     // poMaskDS is owned by the main image and the overviews
     // so because of the latter case, we can delete it even if
     // we are not the base image.
@@ -8424,33 +8431,7 @@ void GTiffDataset::InitCompressionThreads( char** papszOptions )
                 }
                 else
                 {
-                    // Add a margin of an extra job w.r.t thread number
-                    // so as to optimize compression time (enables the main
-                    // thread to do boring I/O while all CPUs are working).
-                    asCompressionJobs.resize(nThreads + 1);
-                    memset(&asCompressionJobs[0], 0,
-                           asCompressionJobs.size() *
-                           sizeof(GTiffCompressionJob));
-                    for( int i = 0;
-                         i < static_cast<int>(asCompressionJobs.size());
-                         ++i )
-                    {
-                        asCompressionJobs[i].pszTmpFilename =
-                            CPLStrdup(CPLSPrintf("/vsimem/gtiff/thread/job/%p",
-                                                 &asCompressionJobs[i]));
-                        asCompressionJobs[i].nStripOrTile = -1;
-                    }
-                    hCompressThreadPoolMutex = CPLCreateMutex();
-                    CPLReleaseMutex(hCompressThreadPoolMutex);
-
-                    // This is kind of a hack, but basically using
-                    // TIFFWriteRawStrip/Tile and then TIFFReadEncodedStrip/Tile
-                    // does not work on a newly created file, because
-                    // TIFF_MYBUFFER is not set in tif_flags
-                    // (if using TIFFWriteEncodedStrip/Tile first,
-                    // TIFFWriteBufferSetup() is automatically called).
-                    // This should likely rather fixed in libtiff itself.
-                    TIFFWriteBufferSetup(hTIFF, NULL, -1);
+                    InitCompressionJobs(nThreads);
                 }
             }
         }
@@ -8465,6 +8446,38 @@ void GTiffDataset::InitCompressionThreads( char** papszOptions )
     }
 }
 
+/************************************************************************/
+/*                        InitCompressionJobs()                         */
+/************************************************************************/
+
+void GTiffDataset::InitCompressionJobs( int nThreads )
+{
+    // Add a margin of an extra job w.r.t thread number
+    // so as to optimize compression time (enables the main
+    // thread to do boring I/O while all CPUs are working).
+    asCompressionJobs.resize(nThreads + 1);
+    memset(&asCompressionJobs[0], 0,
+           asCompressionJobs.size() * sizeof(GTiffCompressionJob));
+    for( int i = 0; i < static_cast<int>(asCompressionJobs.size()); ++i )
+    {
+        asCompressionJobs[i].pszTmpFilename =
+            CPLStrdup(CPLSPrintf("/vsimem/gtiff/thread/job/%p",
+                                 &asCompressionJobs[i]));
+        asCompressionJobs[i].nStripOrTile = -1;
+    }
+    hCompressThreadPoolMutex = CPLCreateMutex();
+    CPLReleaseMutex(hCompressThreadPoolMutex);
+
+    // This is kind of a hack, but basically using
+    // TIFFWriteRawStrip/Tile and then TIFFReadEncodedStrip/Tile
+    // does not work on a newly created file, because
+    // TIFF_MYBUFFER is not set in tif_flags
+    // (if using TIFFWriteEncodedStrip/Tile first,
+    // TIFFWriteBufferSetup() is automatically called).
+    // This should likely rather fixed in libtiff itself.
+    TIFFWriteBufferSetup(hTIFF, NULL, -1);
+}
+
 /************************************************************************/
 /*                       GetGTIFFKeysFlavor()                           */
 /************************************************************************/
@@ -8585,6 +8598,11 @@ void GTiffDataset::WriteRawStripOrTile( int nStripOrTile,
     CPLDebug("GTIFF", "Writing raw strip/tile %d, size %d",
              nStripOrTile, nCompressedBufferSize);
 #endif
+    // Overviews share hTIFF with the main dataset, and their pending jobs
+    // may be flushed while another directory is active.
+    if( !SetDirectory() )
+        return;
+
     toff_t *panOffsets = NULL;
     if( TIFFGetField(
             hTIFF,
@@ -9913,6 +9931,14 @@ CPLErr GTiffDataset::RegisterNewOverviewDataset(toff_t nOverviewOffset,
                     nOverviewCount * (sizeof(void*))) );
     papoOverviewDS[nOverviewCount-1] = poODS;
     poODS->poBaseDS = this;
+
+    // Let the overview compress its blocks with our worker threads.
+    if( poCompressThreadPool != NULL )
+    {
+        poODS->poCompressThreadPool = poCompressThreadPool;
+        poODS->InitCompressionJobs(
+            static_cast<int>(asCompressionJobs.size()) - 1 );
+    }
     return CE_None;
 }
 
@@ -9967,11 +9993,43 @@ static void CreateTIFFColorTable(GDALColorTable* poColorTable,
     panBlue = &(anTBlue[0]);
 }
 
+/************************************************************************/
+/*                      GTIFFGetSrcOverviewCount()                      */
+/*                                                                      */
+/*      Overviews to copy come either from the source dataset, or in    */
+/*      COG mode from a temporary dataset whose full resolution is the  */
+/*      first overview level.                                           */
+/************************************************************************/
+
+static int GTIFFGetSrcOverviewCount( GDALDataset* poSrcDS,
+                                     GDALDataset* poOvrSrcDS )
+{
+    if( poOvrSrcDS == NULL )
+        return poSrcDS->GetRasterBand(1)->GetOverviewCount();
+    return 1 + poOvrSrcDS->GetRasterBand(1)->GetOverviewCount();
+}
+
+/************************************************************************/
+/*                      GTIFFGetSrcOverviewBand()                       */
+/************************************************************************/
+
+static GDALRasterBand* GTIFFGetSrcOverviewBand( GDALDataset* poSrcDS,
+                                                GDALDataset* poOvrSrcDS,
+                                                int nBand, int iOvr )
+{
+    if( poOvrSrcDS == NULL )
+        return poSrcDS->GetRasterBand(nBand)->GetOverview(iOvr);
+    if( iOvr == 0 )
+        return poOvrSrcDS->GetRasterBand(nBand);
+    return poOvrSrcDS->GetRasterBand(nBand)->GetOverview(iOvr - 1);
+}
+
 /************************************************************************/
 /*                  CreateOverviewsFromSrcOverviews()                   */
 /************************************************************************/
 
-CPLErr GTiffDataset::CreateOverviewsFromSrcOverviews(GDALDataset* poSrcDS)
+CPLErr GTiffDataset::CreateOverviewsFromSrcOverviews(GDALDataset* poSrcDS,
+                                                     GDALDataset* poOvrSrcDS)
 {
     CPLAssert(poSrcDS->GetRasterCount() != 0);
     CPLAssert(nOverviewCount == 0);
@@ -10044,12 +10102,13 @@ CPLErr GTiffDataset::CreateOverviewsFromSrcOverviews(GDALDataset* poSrcDS)
     int nOvrBlockYSize = 0;
     GTIFFGetOverviewBlockSize(&nOvrBlockXSize, &nOvrBlockYSize);
 
-    int nSrcOverviews = poSrcDS->GetRasterBand(1)->GetOverviewCount();
+    int nSrcOverviews = GTIFFGetSrcOverviewCount(poSrcDS, poOvrSrcDS);
     CPLErr eErr = CE_None;
 
     for( int i = 0; i < nSrcOverviews && eErr == CE_None; ++i )
     {
-        GDALRasterBand* poOvrBand = poSrcDS->GetRasterBand(1)->GetOverview(i);
+        GDALRasterBand* poOvrBand =
+            GTIFFGetSrcOverviewBand(poSrcDS, poOvrSrcDS, 1, i);
 
         int nOXSize = poOvrBand->GetXSize();
         int nOYSize = poOvrBand->GetYSize();
@@ -15148,6 +15207,13 @@ TIFF *GTiffDataset::CreateLL( const char * pszFilename,
             "Streaming not supported with COPY_SRC_OVERVIEWS" );
         return NULL;
     }
+    if( bStreaming && CPLFetchBool(papszParmList, "COG", false) )
+    {
+        CPLError(
+            CE_Failure, CPLE_NotSupported,
+            "Streaming not supported with COG" );
+        return NULL;
+    }
     if( bStreaming )
     {
         static int nCounter = 0;
@@ -16465,8 +16531,55 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      In COG mode, the output is tiled and carries internal           */
+/*      overviews. If the source has none, the list of overview         */
+/*      factors is computed so that the smallest level fits in a tile.  */
+/* -------------------------------------------------------------------- */
+    const bool bCOG = CPLFetchBool(papszOptions, "COG", false);
+    const bool bCopySrcOverviews =
+        bCOG || CPLFetchBool(papszOptions, "COPY_SRC_OVERVIEWS", false);
+    std::vector<int> anCOGOverviewList;
     double dfExtraSpaceForOverviews = 0;
-    if( CPLFetchBool(papszOptions, "COPY_SRC_OVERVIEWS", false) )
+
+    if( bCOG )
+    {
+        const char* pszTiled = CSLFetchNameValue(papszOptions, "TILED");
+        if( pszTiled != NULL && !CPLTestBool(pszTiled) )
+        {
+            CPLError( CE_Failure, CPLE_NotSupported,
+                      "COG=YES is not compatible with TILED=NO." );
+            CSLDestroy(papszCreateOptions);
+            return NULL;
+        }
+        papszCreateOptions =
+            CSLSetNameValue( papszCreateOptions, "TILED", "YES" );
+
+        if( poSrcDS->GetRasterBand(1)->GetOverviewCount() == 0 )
+        {
+            const int nBlockXSize = std::max(1,
+                atoi(CSLFetchNameValueDef(papszOptions, "BLOCKXSIZE", "256")));
+            const int nBlockYSize = std::max(1,
+                atoi(CSLFetchNameValueDef(papszOptions, "BLOCKYSIZE", "256")));
+            int nOvrFactor = 2;
+            int nOvrXSize = poSrcDS->GetRasterXSize();
+            int nOvrYSize = poSrcDS->GetRasterYSize();
+            while( (nOvrXSize > nBlockXSize || nOvrYSize > nBlockYSize) &&
+                   nOvrFactor < INT_MAX / 2 )
+            {
+                anCOGOverviewList.push_back(nOvrFactor);
+                nOvrXSize = DIV_ROUND_UP(poSrcDS->GetRasterXSize(), nOvrFactor);
+                nOvrYSize = DIV_ROUND_UP(poSrcDS->GetRasterYSize(), nOvrFactor);
+                dfExtraSpaceForOverviews +=
+                    static_cast<double>(nOvrXSize) * nOvrYSize;
+                nOvrFactor *= 2;
+            }
+            dfExtraSpaceForOverviews *=
+                                l_nBands * GDALGetDataTypeSizeBytes(eType);
+        }
+    }
+
+    if( bCopySrcOverviews )
     {
         const int nSrcOverviews = poSrcDS->GetRasterBand(1)->GetOverviewCount();
         if( nSrcOverviews )
@@ -16605,6 +16718,33 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
         return NULL;
     }
 
+/* -------------------------------------------------------------------- */
+/*      In COG mode, write right after the TIFF header a "ghost" area   */
+/*      that readers can use to learn about the layout of the file.     */
+/*      libtiff appends the IFDs after it.                              */
+/* -------------------------------------------------------------------- */
+    if( bCOG )
+    {
+        const char* pszStructuralMD =
+            "LAYOUT=IFDS_BEFORE_DATA\n"
+            "BLOCK_ORDER=ROW_MAJOR\n";
+        CPLString osGhostArea;
+        osGhostArea.Printf("GDAL_STRUCTURAL_METADATA_SIZE=%06d bytes\n",
+                           static_cast<int>(strlen(pszStructuralMD)));
+        osGhostArea += pszStructuralMD;
+        if( VSIFSeekL(l_fpL, 0, SEEK_END) != 0 ||
+            VSIFWriteL(osGhostArea.c_str(), osGhostArea.size(), 1,
+                       l_fpL) != 1 )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Cannot write COG structural metadata" );
+            XTIFFClose( l_hTIFF );
+            CPL_IGNORE_RET_VAL(VSIFCloseL(l_fpL));
+            VSIUnlink( pszFilename );
+            return NULL;
+        }
+    }
+
     uint16 l_nPlanarConfig = 0;
     TIFFGetField( l_hTIFF, TIFFTAG_PLANARCONFIG, &l_nPlanarConfig );
 
@@ -17273,13 +17413,110 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
     double dfTotalPixels = static_cast<double>(nXSize) * nYSize;
     double dfCurPixels = 0;
 
-    if( eErr == CE_None &&
-        CPLFetchBool(papszOptions, "COPY_SRC_OVERVIEWS", false) )
+/* -------------------------------------------------------------------- */
+/*      In COG mode, compute the missing overviews from the source      */
+/*      into a temporary compressed file, so that they can then be      */
+/*      copied like source overviews. Mask overviews go into a second   */
+/*      file. The output may be on a read-only or non-seekable file     */
+/*      system, so those files are kept in memory when the overviews    */
+/*      fit in the block cache, and are otherwise created in the        */
+/*      temporary directory.                                            */
+/* -------------------------------------------------------------------- */
+    GDALDataset* poOvrSrcDS = NULL;
+    GDALDataset* poMaskOvrSrcDS = NULL;
+    CPLString osTmpOvrFilename;
+    CPLString osTmpMaskOvrFilename;
+    if( !anCOGOverviewList.empty() )
     {
-        const int nSrcOverviews = poSrcDS->GetRasterBand(1)->GetOverviewCount();
+        if( dfExtraSpaceForOverviews < GDALGetCacheMax64() )
+            osTmpOvrFilename.Printf("/vsimem/gtiff_cog_ovr_%p", poDS);
+        else
+            osTmpOvrFilename =
+                CPLGenerateTempFilename(CPLGetBasename(pszFilename));
+        osTmpMaskOvrFilename = osTmpOvrFilename + ".msk.ovr.tif";
+        osTmpOvrFilename += ".ovr.tif";
+    }
+
+    if( eErr == CE_None && !anCOGOverviewList.empty() )
+    {
+        const char* pszResampling =
+            CSLFetchNameValueDef(papszOptions, "OVERVIEW_RESAMPLING",
+                                 "NEAREST");
+        const int nOverviews = static_cast<int>(anCOGOverviewList.size());
+        const bool bHasMask = poDS->poMaskDS != NULL;
+
+        dfTotalPixels *= bHasMask ? 3 : 2;
+        const double dfOvrPixels = static_cast<double>(nXSize) * nYSize;
+
+        // The temporary files are only read back once, so favor their
+        // size over the speed of encoding.
+        const bool bSetCompress =
+            CPLGetConfigOption("COMPRESS_OVERVIEW", NULL) == NULL;
+        if( bSetCompress )
+            CPLSetThreadLocalConfigOption("COMPRESS_OVERVIEW", "DEFLATE");
+
+        // GTIFFBuildOverviews() would append to a leftover file.
+        VSIUnlink(osTmpOvrFilename);
+        VSIUnlink(osTmpMaskOvrFilename);
+
+        std::vector<GDALRasterBand*> apoSrcBands;
+        for( int i = 1; i <= l_nBands; ++i )
+            apoSrcBands.push_back(poSrcDS->GetRasterBand(i));
+
+        void* pScaledData =
+            GDALCreateScaledProgress( 0, dfOvrPixels / dfTotalPixels,
+                                      pfnProgress, pProgressData );
+        eErr = GTIFFBuildOverviews( osTmpOvrFilename, l_nBands,
+                                    &apoSrcBands[0], nOverviews,
+                                    &anCOGOverviewList[0], pszResampling,
+                                    GDALScaledProgress, pScaledData );
+        GDALDestroyScaledProgress(pScaledData);
+        dfCurPixels = dfOvrPixels;
+
+        if( eErr == CE_None && bHasMask )
+        {
+            GDALRasterBand* poSrcMaskBand =
+                poSrcDS->GetRasterBand(1)->GetMaskBand();
+            pScaledData =
+                GDALCreateScaledProgress( dfCurPixels / dfTotalPixels,
+                                          2 * dfOvrPixels / dfTotalPixels,
+                                          pfnProgress, pProgressData );
+            eErr = GTIFFBuildOverviews( osTmpMaskOvrFilename, 1,
+                                        &poSrcMaskBand, nOverviews,
+                                        &anCOGOverviewList[0], pszResampling,
+                                        GDALScaledProgress, pScaledData );
+            GDALDestroyScaledProgress(pScaledData);
+            dfCurPixels += dfOvrPixels;
+        }
+
+        if( bSetCompress )
+            CPLSetThreadLocalConfigOption("COMPRESS_OVERVIEW", NULL);
+
+        if( eErr == CE_None )
+        {
+            poOvrSrcDS = static_cast<GDALDataset*>(
+                                GDALOpen(osTmpOvrFilename, GA_ReadOnly));
+            if( bHasMask )
+                poMaskOvrSrcDS = static_cast<GDALDataset*>(
+                                GDALOpen(osTmpMaskOvrFilename, GA_ReadOnly));
+            if( poOvrSrcDS == NULL || (bHasMask && poMaskOvrSrcDS == NULL) ||
+                GTIFFGetSrcOverviewCount(poSrcDS, poOvrSrcDS) != nOverviews )
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                          "Cannot open temporary overview file %s",
+                          osTmpOvrFilename.c_str() );
+                eErr = CE_Failure;
+            }
+        }
+    }
+
+    if( eErr == CE_None && bCopySrcOverviews )
+    {
+        const int nSrcOverviews =
+            GTIFFGetSrcOverviewCount(poSrcDS, poOvrSrcDS);
         if( nSrcOverviews )
         {
-            eErr = poDS->CreateOverviewsFromSrcOverviews(poSrcDS);
+            eErr = poDS->CreateOverviewsFromSrcOverviews(poSrcDS, poOvrSrcDS);
 
             if( poDS->nOverviewCount != nSrcOverviews )
             {
@@ -17293,7 +17530,7 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
             for( int i = 0; i < nSrcOverviews; ++i )
             {
                 GDALRasterBand* poOvrBand =
-                    poSrcDS->GetRasterBand(1)->GetOverview(i);
+                    GTIFFGetSrcOverviewBand(poSrcDS, poOvrSrcDS, 1, i);
                 dfTotalPixels += static_cast<double>(poOvrBand->GetXSize()) *
                                 poOvrBand->GetYSize();
             }
@@ -17310,11 +17547,17 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
 
                 // Create a fake dataset with the source overview level so that
                 // GDALDatasetCopyWholeRaster can cope with it.
-                GDALDataset* poSrcOvrDS =
-                    GDALCreateOverviewDataset(poSrcDS, iOvrLevel, TRUE);
+                GDALDataset* poSrcOvrDS = NULL;
+                if( poOvrSrcDS == NULL )
+                    poSrcOvrDS =
+                        GDALCreateOverviewDataset(poSrcDS, iOvrLevel, TRUE);
+                else if( iOvrLevel > 0 )
+                    poSrcOvrDS =
+                        GDALCreateOverviewDataset(poOvrSrcDS, iOvrLevel - 1,
+                                                  TRUE);
 
                 GDALRasterBand* poOvrBand =
-                        poSrcDS->GetRasterBand(1)->GetOverview(iOvrLevel);
+                    GTIFFGetSrcOverviewBand(poSrcDS, poOvrSrcDS, 1, iOvrLevel);
                 double dfNextCurPixels =
                     dfCurPixels +
                     static_cast<double>(poOvrBand->GetXSize()) *
@@ -17327,7 +17570,8 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
 
                 eErr =
                     GDALDatasetCopyWholeRaster(
-                        (GDALDatasetH) poSrcOvrDS,
+                        (GDALDatasetH) (poSrcOvrDS != NULL ? poSrcOvrDS
+                                                           : poOvrSrcDS),
                         (GDALDatasetH) poDS->papoOverviewDS[iOvrLevel],
                         papszCopyWholeRasterOptions,
                         GDALScaledProgress, pScaledData );
@@ -17342,9 +17586,14 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
                 // Copy mask of the overview.
                 if( eErr == CE_None && poDS->poMaskDS != NULL )
                 {
+                    GDALRasterBand* poOvrMaskBand =
+                        poMaskOvrSrcDS != NULL ?
+                        GTIFFGetSrcOverviewBand(NULL, poMaskOvrSrcDS, 1,
+                                                iOvrLevel) :
+                        poOvrBand->GetMaskBand();
                     eErr =
                         GDALRasterBandCopyWholeRaster(
-                            poOvrBand->GetMaskBand(),
+                            poOvrMaskBand,
                             poDS->papoOverviewDS[iOvrLevel]->
                             poMaskDS->GetRasterBand(1),
                             papszCopyWholeRasterOptions,
@@ -17355,6 +17604,17 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
         }
     }
 
+    if( !anCOGOverviewList.empty() )
+    {
+        if( poOvrSrcDS != NULL )
+            GDALClose(poOvrSrcDS);
+        if( poMaskOvrSrcDS != NULL )
+            GDALClose(poMaskOvrSrcDS);
+        VSIUnlink(osTmpOvrFilename);
+        if( poDS->poMaskDS != NULL )
+            VSIUnlink(osTmpMaskOvrFilename);
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Copy actual imagery.                                            */
 /* -------------------------------------------------------------------- */
@@ -18626,7 +18886,7 @@ void GDALRegister_GTiff()
     if( GDALGetDriverByName( "GTiff" ) != NULL )
         return;
 
-    char szCreateOptions[5000] = { '\0' };
+    char szCreateOptions[6000] = { '\0' };
     char szOptionalCompressItems[500] = { '\0' };
     bool bHasJPEG = false;
     bool bHasLZW = false;
@@ -18788,6 +19048,17 @@ void GDALRegister_GTiff()
 "       <Value>BIG</Value>"
 "   </Option>"
 "   <Option name='COPY_SRC_OVERVIEWS' type='boolean' default='NO' description='Force copy of overviews of source dataset (CreateCopy())'/>"
+"   <Option name='COG' type='boolean' default='NO' description='Write a Cloud Optimized GeoTIFF, computing overviews if the source has none (CreateCopy())'/>"
+"   <Option name='OVERVIEW_RESAMPLING' type='string-select' default='NEAREST' description='Resampling method for overviews computed in COG mode'>"
+"       <Value>NEAREST</Value>"
+"       <Value>AVERAGE</Value>"
+"       <Value>BILINEAR</Value>"
+"       <Value>CUBIC</Value>"
+"       <Value>CUBICSPLINE</Value>"
+"       <Value>LANCZOS</Value>"
+"       <Value>GAUSS</Value>"
+"       <Value>MODE</Value>"
+"   </Option>"
 "   <Option name='SOURCE_ICC_PROFILE' type='string' description='ICC profile'/>"
 "   <Option name='SOURCE_PRIMARIES_RED' type='string' description='x,y,1.0 (xyY) red chromaticity'/>"
 "   <Option name='SOURCE_PRIMARIES_GREEN' type='string' description='x,y,1.0 (xyY) green chromaticity'/>"
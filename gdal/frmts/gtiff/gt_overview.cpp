@@ -727,7 +727,9 @@ GTIFFBuildOverviews( const char * pszFilename,
     CPLString osMetadata;
     GDALDataset *poBaseDS = papoBandList[0]->GetDataset();
 
-    GTIFFBuildOverviewMetadata( pszResampling, poBaseDS, osMetadata );
+    // Mask bands may not be attached to a dataset.
+    if( poBaseDS != NULL )
+        GTIFFBuildOverviewMetadata( pszResampling, poBaseDS, osMetadata );
 
 /* -------------------------------------------------------------------- */
 /*      Loop, creating overviews.                                       */
@@ -98,6 +98,11 @@ class MBTilesDataset : public GDALPamDataset, public GDALGPKGMBTilesLikePseudoDa
     virtual char      **GetMetadata( const char * pszDomain = "" ) override;
     virtual const char *GetMetadataItem( const char* pszName, const char * pszDomain = "" ) override;
 
+    virtual CPLErr    IRasterIO( GDALRWFlag, int, int, int, int,
+                                 void *, int, int, GDALDataType,
+                                 int, int *, GSpacing, GSpacing, GSpacing,
+                                 GDALRasterIOExtraArg* psExtraArg ) override;
+
     virtual CPLErr    IBuildOverviews(
                         const char * pszResampling,
                         int nOverviews, int * panOverviewList,
@@ -2014,6 +2019,10 @@ GDALDataset* MBTilesDataset::Open(GDALOpenInfo* poOpenInfo)
 
             poDS->ParseCompressionOptions(poOpenInfo->papszOpenOptions);
         }
+        else
+        {
+            poDS->InitWorkerThreads(poOpenInfo->papszOpenOptions);
+        }
 
 /* -------------------------------------------------------------------- */
 /*      Add overview levels as internal datasets                        */
@@ -2525,6 +2534,32 @@ void MBTilesDataset::ParseCompressionOptions(char** papszOptions)
     const char* pszDither = CSLFetchNameValue(papszOptions, "DITHER");
     if( pszDither )
         m_bDither = CPLTestBool(pszDither);
+
+    InitWorkerThreads(papszOptions);
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr MBTilesDataset::IRasterIO( GDALRWFlag eRWFlag,
+                                int nXOff, int nYOff, int nXSize, int nYSize,
+                                void * pData, int nBufXSize, int nBufYSize,
+                                GDALDataType eBufType,
+                                int nBandCount, int *panBandMap,
+                                GSpacing nPixelSpace, GSpacing nLineSpace,
+                                GSpacing nBandSpace,
+                                GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag == GF_Read )
+    {
+        PrefetchTiles(nXOff, nYOff, nXSize, nYSize, nBufXSize, nBufYSize);
+    }
+    return GDALPamDataset::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                               pData, nBufXSize, nBufYSize, eBufType,
+                               nBandCount, panBandMap,
+                               nPixelSpace, nLineSpace, nBandSpace,
+                               psExtraArg);
 }
 
 /************************************************************************/
@@ -2719,6 +2754,7 @@ void GDALRegister_MBTiles()
 "  <Option name='QUALITY' type='int' min='1' max='100' description='Quality for JPEG tiles' default='75'/>" \
 "  <Option name='ZLEVEL' type='int' min='1' max='9' description='DEFLATE compression level for PNG tiles' default='6'/>" \
 "  <Option name='DITHER' type='boolean' description='Whether to apply Floyd-Steinberg dithering (for TILE_FORMAT=PNG8)' default='NO'/>" \
+"  <Option name='NUM_THREADS' type='string' description='Number of worker threads for tile encoding and decoding. Can be set to ALL_CPUS' default='1'/>" \
 
     poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST, "<OpenOptionList>"
 "  <Option name='ZOOM_LEVEL' type='integer' description='Zoom level of full resolution. If not specified, maximum non-empty zoom level'/>"
@@ -157,6 +157,9 @@ class netCDFRasterBand : public GDALPamRasterBand
                                         size_t nTmpBlockXSize,
                                         size_t nTmpBlockYSize,
                                         bool bCheckIsNan=false ) ;
+    void            CheckDataRow( void *pRow, size_t nCount );
+    int             ReadHyperslab( const size_t *start, const size_t *edge,
+                                   void *pBuffer );
 
   protected:
     CPLXMLNode *SerializeToXML( const char *pszVRTPath ) override;
@@ -521,6 +524,28 @@ netCDFRasterBand::netCDFRasterBand( netCDFDataset *poNCDFDS,
                      static_cast<long>(chunksize[nZDim - 2]));
             nBlockXSize = (int)chunksize[nZDim - 1];
             nBlockYSize = (int)chunksize[nZDim - 2];
+
+            // Let the user size the chunk cache, typically to hold all the
+            // chunks crossed by a multi-band (e.g. time series) request.
+            const char *pszChunkCacheSize = CSLFetchNameValue(
+                poNCDFDS->GetOpenOptions(), "CHUNK_CACHE_SIZE");
+            size_t nCacheSize = 0;
+            size_t nCacheNElems = 0;
+            float fCachePreemption = 0.0f;
+            if( pszChunkCacheSize != NULL &&
+                nc_get_var_chunk_cache(cdfid, nZId, &nCacheSize,
+                                       &nCacheNElems,
+                                       &fCachePreemption) == NC_NOERR )
+            {
+                nCacheSize = static_cast<size_t>(
+                    CPLAtoGIntBig(pszChunkCacheSize));
+                status = nc_set_var_chunk_cache(cdfid, nZId, nCacheSize,
+                                                nCacheNElems,
+                                                fCachePreemption);
+                NCDF_ERR(status);
+                CPLDebug("GDAL_netCDF", "setting chunk cache size to %ld",
+                         static_cast<long>(nCacheSize));
+            }
         }
     }
 #endif
@@ -1712,6 +1737,75 @@ CPLErr netCDFRasterBand::IReadBlock( int nBlockXOff, int nBlockYOff,
     return CE_None;
 }
 
+/************************************************************************/
+/*                            CheckDataRow()                            */
+/************************************************************************/
+
+// Applies the nodata / valid range checks of CheckData() to a single row
+// of nCount values of the band data type.
+void netCDFRasterBand::CheckDataRow( void *pRow, size_t nCount )
+{
+    if( eDataType == GDT_Byte )
+    {
+        if( bSignedData )
+            CheckData<signed char>(pRow, pRow, nCount, 1, false);
+        else
+            CheckData<unsigned char>(pRow, pRow, nCount, 1, false);
+    }
+    else if( eDataType == GDT_Int16 )
+        CheckData<short>(pRow, pRow, nCount, 1, false);
+    else if( eDataType == GDT_Int32 )
+        CheckData<int>(pRow, pRow, nCount, 1, false);
+    else if( eDataType == GDT_Float32 )
+        CheckData<float>(pRow, pRow, nCount, 1, true);
+    else if( eDataType == GDT_Float64 )
+        CheckData<double>(pRow, pRow, nCount, 1, true);
+    else if( eDataType == GDT_UInt16 )
+        CheckData<unsigned short>(pRow, pRow, nCount, 1, false);
+    else if( eDataType == GDT_UInt32 )
+        CheckData<unsigned int>(pRow, pRow, nCount, 1, false);
+}
+
+/************************************************************************/
+/*                           ReadHyperslab()                            */
+/************************************************************************/
+
+// Reads a hyperslab of the variable of the band, in its data type, and
+// returns the netCDF status.
+int netCDFRasterBand::ReadHyperslab( const size_t *start, const size_t *edge,
+                                     void *pBuffer )
+{
+    if( eDataType == GDT_Byte )
+    {
+        if( bSignedData )
+            return nc_get_vara_schar(cdfid, nZId, start, edge,
+                                     static_cast<signed char *>(pBuffer));
+        return nc_get_vara_uchar(cdfid, nZId, start, edge,
+                                 static_cast<unsigned char *>(pBuffer));
+    }
+    if( eDataType == GDT_Int16 )
+        return nc_get_vara_short(cdfid, nZId, start, edge,
+                                 static_cast<short *>(pBuffer));
+    if( eDataType == GDT_Int32 )
+        return nc_get_vara_int(cdfid, nZId, start, edge,
+                               static_cast<int *>(pBuffer));
+    if( eDataType == GDT_Float32 )
+        return nc_get_vara_float(cdfid, nZId, start, edge,
+                                 static_cast<float *>(pBuffer));
+    if( eDataType == GDT_Float64 )
+        return nc_get_vara_double(cdfid, nZId, start, edge,
+                                  static_cast<double *>(pBuffer));
+#ifdef NETCDF_HAS_NC4
+    if( eDataType == GDT_UInt16 )
+        return nc_get_vara_ushort(cdfid, nZId, start, edge,
+                                  static_cast<unsigned short *>(pBuffer));
+    if( eDataType == GDT_UInt32 )
+        return nc_get_vara_uint(cdfid, nZId, start, edge,
+                                static_cast<unsigned int *>(pBuffer));
+#endif
+    return NC_EBADTYPE;
+}
+
 /************************************************************************/
 /*                             IWriteBlock()                            */
 /************************************************************************/
@@ -1980,6 +2074,177 @@ netCDFDataset::~netCDFDataset()
 #endif
 }
 
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+// Reads of consecutive bands of a 3D variable (typically time steps) are
+// done with one hyperslab read along the extra dimension, rather than one
+// read per band and block.
+CPLErr netCDFDataset::IRasterIO( GDALRWFlag eRWFlag,
+                                 int nXOff, int nYOff, int nXSize, int nYSize,
+                                 void *pData, int nBufXSize, int nBufYSize,
+                                 GDALDataType eBufType,
+                                 int nBandCount, int *panBandMap,
+                                 GSpacing nPixelSpace, GSpacing nLineSpace,
+                                 GSpacing nBandSpace,
+                                 GDALRasterIOExtraArg *psExtraArg )
+{
+    netCDFRasterBand *poFirstBand = nBandCount > 1 ?
+        static_cast<netCDFRasterBand *>(GetRasterBand(panBandMap[0])) : NULL;
+    bool bHyperslab =
+        eRWFlag == GF_Read && eAccess == GA_ReadOnly &&
+        nXSize == nBufXSize && nYSize == nBufYSize &&
+        poFirstBand != NULL && poFirstBand->nZDim == 3 &&
+        !poFirstBand->bCheckLongitude &&
+        CPLTestBool(CPLGetConfigOption("GDAL_NETCDF_HYPERSLAB_READ", "YES"));
+    for( int i = 1; bHyperslab && i < nBandCount; i++ )
+    {
+        netCDFRasterBand *poBand =
+            static_cast<netCDFRasterBand *>(GetRasterBand(panBandMap[i]));
+        bHyperslab = poBand->nZId == poFirstBand->nZId &&
+                     poBand->nZDim == 3 &&
+                     poBand->nLevel == poFirstBand->nLevel + i;
+    }
+
+    // Bound the size of a single read, in rows aligned on the chunk rows.
+    const GDALDataType eDT = poFirstBand ? poFirstBand->eDataType : GDT_Byte;
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+    const GIntBig nMaxBufferSize = std::max(static_cast<GIntBig>(1),
+        CPLAtoGIntBig(CPLGetConfigOption("GDAL_NETCDF_HYPERSLAB_MAX_SIZE",
+                                         "67108864")));
+    int nRowsPerRead = 1;
+    if( bHyperslab )
+    {
+        nRowsPerRead = static_cast<int>(std::max(static_cast<GIntBig>(1),
+            std::min(static_cast<GIntBig>(nYSize),
+                     nMaxBufferSize / (static_cast<GIntBig>(nBandCount) *
+                                       nXSize * nDTSize))));
+        const int nChunkRows = poFirstBand->nBlockYSize;
+        if( nRowsPerRead > nChunkRows && nRowsPerRead < nYSize )
+            nRowsPerRead = nRowsPerRead / nChunkRows * nChunkRows;
+    }
+    GByte *pabyBuffer = bHyperslab ? static_cast<GByte *>(
+        VSI_MALLOC3_VERBOSE(nBandCount, nRowsPerRead,
+                            static_cast<size_t>(nXSize) * nDTSize)) : NULL;
+    GByte *pabyRow = pabyBuffer ? static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(nXSize, nDTSize)) : NULL;
+    if( pabyRow == NULL )
+    {
+        CPLFree(pabyBuffer);
+        return GDALPamDataset::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                         pData, nBufXSize, nBufYSize, eBufType,
+                                         nBandCount, panBandMap,
+                                         nPixelSpace, nLineSpace, nBandSpace,
+                                         psExtraArg);
+    }
+
+    CPLMutexHolderD(&hNCMutex);
+
+    // Make sure we are in data mode.
+    SetDefineMode(false);
+
+    const int nXPos = poFirstBand->nBandXPos;
+    const int nYPos = poFirstBand->nBandYPos;
+    const int nZPos = poFirstBand->panBandZPos[0];
+    const int nChunkRows = poFirstBand->nBlockYSize;
+
+    CPLErr eErr = CE_None;
+    for( int iY = 0; iY < nYSize && eErr == CE_None; )
+    {
+        // Stop at a chunk boundary of the file when possible. For bottom-up
+        // files, the end of the window in GDAL rows is the start of the
+        // hyperslab in file rows.
+        int nRows = std::min(nRowsPerRead, nYSize - iY);
+        if( iY + nRows < nYSize )
+        {
+            int nAlignedRows = 0;
+            if( bBottomUp )
+            {
+                const int nFileStart = nRasterYSize - nYOff - iY - nRows;
+                const int nAlignedStart =
+                    (nFileStart + nChunkRows - 1) / nChunkRows * nChunkRows;
+                nAlignedRows = nRasterYSize - nYOff - iY - nAlignedStart;
+            }
+            else
+            {
+                nAlignedRows =
+                    (nYOff + iY + nRows) / nChunkRows * nChunkRows -
+                    nYOff - iY;
+            }
+            if( nAlignedRows > 0 )
+                nRows = nAlignedRows;
+        }
+
+        size_t start[MAX_NC_DIMS] = {};
+        size_t edge[MAX_NC_DIMS] = {};
+        start[nXPos] = nXOff;
+        edge[nXPos] = nXSize;
+        start[nYPos] = bBottomUp ? nRasterYSize - nYOff - iY - nRows
+                                 : nYOff + iY;
+        edge[nYPos] = nRows;
+        start[nZPos] = poFirstBand->nLevel;
+        edge[nZPos] = nBandCount;
+
+        const int status =
+            poFirstBand->ReadHyperslab(start, edge, pabyBuffer);
+        if( status != NC_NOERR )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "netCDF hyperslab fetch failed: #%d (%s)", status,
+                     nc_strerror(status));
+            eErr = CE_Failure;
+            break;
+        }
+
+        // Element strides of the buffer, which is in the dimension order
+        // of the variable.
+        size_t anStride[3] = { edge[1] * edge[2], edge[2], 1 };
+        const size_t nXStride = anStride[nXPos];
+
+        for( int iBand = 0; iBand < nBandCount; iBand++ )
+        {
+            netCDFRasterBand *poBand = static_cast<netCDFRasterBand *>(
+                GetRasterBand(panBandMap[iBand]));
+            for( int iRow = 0; iRow < nRows; iRow++ )
+            {
+                const int iSrcRow = bBottomUp ? nRows - 1 - iRow : iRow;
+                GByte *pabySrc = pabyBuffer +
+                    (iBand * anStride[nZPos] + iSrcRow * anStride[nYPos]) *
+                    nDTSize;
+                GByte *pabyValues = pabySrc;
+                if( nXStride != 1 )
+                {
+                    GDALCopyWords(pabySrc, eDT,
+                                  static_cast<int>(nXStride * nDTSize),
+                                  pabyRow, eDT, nDTSize, nXSize);
+                    pabyValues = pabyRow;
+                }
+                poBand->CheckDataRow(pabyValues, nXSize);
+                GDALCopyWords(pabyValues, eDT, nDTSize,
+                              static_cast<GByte *>(pData) +
+                                  iBand * nBandSpace +
+                                  (iY + iRow) * nLineSpace,
+                              eBufType, static_cast<int>(nPixelSpace),
+                              nXSize);
+            }
+        }
+
+        iY += nRows;
+        if( psExtraArg->pfnProgress != NULL &&
+            !psExtraArg->pfnProgress(1.0 * iY / nYSize, "",
+                                     psExtraArg->pProgressData) )
+        {
+            CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+            eErr = CE_Failure;
+        }
+    }
+
+    CPLFree(pabyRow);
+    CPLFree(pabyBuffer);
+    return eErr;
+}
+
 /************************************************************************/
 /*                            SetDefineMode()                           */
 /************************************************************************/
@@ -8823,6 +9088,11 @@ void GDALRegister_netCDF()
 "   <Option name='HONOUR_VALID_RANGE' type='boolean' "
     "description='Whether to set to nodata pixel values outside of the "
     "validity range' default='YES'/>"
+#ifdef NETCDF_HAS_NC4
+"   <Option name='CHUNK_CACHE_SIZE' type='int' "
+    "description='Size in bytes of the chunk cache of the variable, for "
+    "netCDF-4 files'/>"
+#endif
 "</OpenOptionList>" );
 
 
@@ -848,6 +848,11 @@ class netCDFDataset : public GDALPamDataset
 
     CPLXMLNode *SerializeToXML( const char *pszVRTPath ) override;
 
+    virtual CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                              void *, int, int, GDALDataType,
+                              int, int *, GSpacing, GSpacing, GSpacing,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
+
     virtual OGRLayer   *ICreateLayer( const char *pszName,
                                      OGRSpatialReference *poSpatialRef,
                                      OGRwkbGeometryType eGType,
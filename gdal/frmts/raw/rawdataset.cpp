@@ -68,7 +68,9 @@ RawRasterBand::RawRasterBand( GDALDataset *poDSIn, int nBandIn,
     nPixelOffset(nPixelOffsetIn),
     nLineOffset(nLineOffsetIn),
     bNativeOrder(bNativeOrderIn),
-    bOwnsFP(bOwnsFPIn)
+    bOwnsFP(bOwnsFPIn),
+    pVMemRead(NULL),
+    bVMemReadTried(FALSE)
 {
     poDS = poDSIn;
     nBand = nBandIn;
@@ -121,7 +123,9 @@ RawRasterBand::RawRasterBand( void *fpRawIn, vsi_l_offset nImgOffsetIn,
     poCT(NULL),
     eInterp(GCI_Undefined),
     papszCategoryNames(NULL),
-    bOwnsFP(bOwnsFPIn)
+    bOwnsFP(bOwnsFPIn),
+    pVMemRead(NULL),
+    bVMemReadTried(FALSE)
 {
     poDS = NULL;
     nBand = 1;
@@ -214,6 +218,9 @@ RawRasterBand::~RawRasterBand()
 
     FlushCache();
 
+    if( pVMemRead != NULL )
+        CPLVirtualMemFree(pVMemRead);
+
     if (bOwnsFP)
     {
         if ( bIsVSIL )
@@ -375,6 +382,16 @@ CPLErr RawRasterBand::IReadBlock(CPL_UNUSED int nBlockXOff,
     if (pLineBuffer == NULL)
         return CE_Failure;
 
+    // Copy straight from the file mapping when there is one.
+    if( CanUseMappedIO(GF_Read, nBlockXSize, 1, nBlockXSize, 1) )
+    {
+        CopyFromMapping(GetReadOnlyMapping() +
+                            static_cast<size_t>(nBlockYOff) * nLineOffset,
+                        pImage, eDataType,
+                        GDALGetDataTypeSizeBytes(eDataType), nBlockXSize);
+        return CE_None;
+    }
+
     const CPLErr eErr = AccessLine(nBlockYOff);
     if( eErr == CE_Failure )
         return eErr;
@@ -605,6 +622,162 @@ int RawRasterBand::CanUseDirectIO(int /* nXOff */,
     return CPLTestBool(pszGDAL_ONE_BIG_READ);
 }
 
+/************************************************************************/
+/*                         GetReadOnlyMapping()                         */
+/*                                                                      */
+/*      Return the start of a read-only memory mapping of the band      */
+/*      extent, creating it on first use.  Only done for local files    */
+/*      opened in read-only mode, with positive offsets aligned on      */
+/*      the data type, so that pixels can be copied straight from       */
+/*      the page cache.  Can be disabled with GDAL_RAW_USE_MMAP=NO.     */
+/************************************************************************/
+
+const GByte *RawRasterBand::GetReadOnlyMapping()
+{
+    if( pVMemRead != NULL )
+        return static_cast<const GByte *>(CPLVirtualMemGetAddr(pVMemRead));
+    if( bVMemReadTried )
+        return NULL;
+    bVMemReadTried = TRUE;
+
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    const int nWordSize =
+        GDALDataTypeIsComplex(eDataType) ? nDTSize / 2 : nDTSize;
+    if( !bIsVSIL || fpRawL == NULL || nDTSize == 0 ||
+        nPixelOffset < nDTSize || nLineOffset <= 0 ||
+        (nImgOffset % nWordSize) != 0 ||
+        (nPixelOffset % nWordSize) != 0 ||
+        (nLineOffset % nWordSize) != 0 ||
+        VSIFGetNativeFileDescriptorL(fpRawL) == NULL ||
+        !CPLIsVirtualMemFileMapAvailable() ||
+        !CPLTestBool(CPLGetConfigOption("GDAL_RAW_USE_MMAP", "YES")) )
+    {
+        return NULL;
+    }
+
+    const vsi_l_offset nSize =
+        static_cast<vsi_l_offset>(nRasterYSize - 1) * nLineOffset +
+        static_cast<vsi_l_offset>(nRasterXSize - 1) * nPixelOffset + nDTSize;
+    if( static_cast<size_t>(nSize) != nSize )
+        return NULL;
+
+    // Truncated files cannot be mapped: they go through the regular
+    // path that reports or zero-fills the missing data.
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    pVMemRead = CPLVirtualMemFileMapNew(fpRawL, nImgOffset, nSize,
+                                        VIRTUALMEM_READONLY, NULL, NULL);
+    CPLPopErrorHandler();
+    CPLErrorReset();
+    if( pVMemRead == NULL )
+        return NULL;
+
+    CPLDebug("RAW", "Using memory mapped reads for band %d", nBand);
+    return static_cast<const GByte *>(CPLVirtualMemGetAddr(pVMemRead));
+}
+
+/************************************************************************/
+/*                           CanUseMappedIO()                           */
+/************************************************************************/
+
+int RawRasterBand::CanUseMappedIO( GDALRWFlag eRWFlag,
+                                   int nXSize, int nYSize,
+                                   int nBufXSize, int nBufYSize )
+{
+    // Pending writes would not be visible through the mapping, so only
+    // read-only bands qualify.  Resampled requests go through the
+    // generic code.
+    if( eRWFlag != GF_Read || eAccess != GA_ReadOnly ||
+        poDS == NULL || poDS->GetAccess() != GA_ReadOnly ||
+        nXSize != nBufXSize || nYSize != nBufYSize ||
+        pLineBuffer == NULL )
+    {
+        return FALSE;
+    }
+    return GetReadOnlyMapping() != NULL;
+}
+
+/************************************************************************/
+/*                          CopyFromMapping()                           */
+/*                                                                      */
+/*      Copy nCount pixels, nPixelOffset bytes apart in the mapping,   */
+/*      into pDst, converting them to native byte order.                */
+/************************************************************************/
+
+void RawRasterBand::CopyFromMapping( const GByte *pabySrc, void *pDst,
+                                     GDALDataType eBufType, int nPixelSpace,
+                                     int nCount )
+{
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    if( bNativeOrder || nDTSize == 1 )
+    {
+        GDALCopyWords(pabySrc, eDataType, nPixelOffset,
+                      pDst, eBufType, nPixelSpace, nCount);
+        return;
+    }
+
+    // Swap in the destination when it has the band data type, otherwise
+    // go through the line buffer, which is then no longer valid.
+    GByte *pabySwapped = static_cast<GByte *>(pDst);
+    int nSwappedSpace = nPixelSpace;
+    if( eBufType != eDataType )
+    {
+        pabySwapped = static_cast<GByte *>(pLineBuffer);
+        nSwappedSpace = nDTSize;
+        nLoadedScanline = -1;
+    }
+    GDALCopyWords(pabySrc, eDataType, nPixelOffset,
+                  pabySwapped, eDataType, nSwappedSpace, nCount);
+    if( GDALDataTypeIsComplex(eDataType) )
+    {
+        const int nWordSize = nDTSize / 2;
+        GDALSwapWordsEx(pabySwapped, nWordSize, nCount, nSwappedSpace);
+        GDALSwapWordsEx(pabySwapped + nWordSize, nWordSize, nCount,
+                        nSwappedSpace);
+    }
+    else
+    {
+        GDALSwapWordsEx(pabySwapped, nDTSize, nCount, nSwappedSpace);
+    }
+    if( eBufType != eDataType )
+    {
+        GDALCopyWords(pabySwapped, eDataType, nDTSize,
+                      pDst, eBufType, nPixelSpace, nCount);
+    }
+}
+
+/************************************************************************/
+/*                           MappedRasterIO()                           */
+/*                                                                      */
+/*      Serve a non resampled read from the file mapping, without       */
+/*      going through the block cache.                                  */
+/************************************************************************/
+
+CPLErr RawRasterBand::MappedRasterIO( int nXOff, int nYOff,
+                                      int nXSize, int nYSize,
+                                      void *pData, GDALDataType eBufType,
+                                      GSpacing nPixelSpace,
+                                      GSpacing nLineSpace,
+                                      GDALRasterIOExtraArg* psExtraArg )
+{
+    const GByte *pabyMapping = GetReadOnlyMapping();
+    for( int iLine = 0; iLine < nYSize; iLine++ )
+    {
+        CopyFromMapping(pabyMapping +
+                            static_cast<size_t>(nYOff + iLine) * nLineOffset +
+                            static_cast<size_t>(nXOff) * nPixelOffset,
+                        static_cast<GByte *>(pData) + iLine * nLineSpace,
+                        eBufType, static_cast<int>(nPixelSpace), nXSize);
+
+        if( psExtraArg->pfnProgress != NULL &&
+            !psExtraArg->pfnProgress(1.0 * (iLine + 1) / nYSize, "",
+                                     psExtraArg->pProgressData) )
+        {
+            return CE_Failure;
+        }
+    }
+    return CE_None;
+}
+
 /************************************************************************/
 /*                             IRasterIO()                              */
 /************************************************************************/
@@ -626,6 +799,12 @@ CPLErr RawRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 #endif
     const int nBufDataSize = GDALGetDataTypeSizeBytes(eBufType);
 
+    if( CanUseMappedIO(eRWFlag, nXSize, nYSize, nBufXSize, nBufYSize) )
+    {
+        return MappedRasterIO(nXOff, nYOff, nXSize, nYSize, pData, eBufType,
+                              nPixelSpace, nLineSpace, psExtraArg);
+    }
+
     if( !CanUseDirectIO(nXOff, nYOff, nXSize, nYSize, eBufType) )
     {
         return GDALRasterBand::IRasterIO(eRWFlag, nXOff, nYOff,
@@ -1166,8 +1345,10 @@ CPLErr RawDataset::IRasterIO( GDALRWFlag eRWFlag,
             RawRasterBand *poBand = dynamic_cast<RawRasterBand *>(
                 GetRasterBand(panBandMap[iBandIndex]));
             if( poBand == NULL ||
-                !poBand->CanUseDirectIO(nXOff, nYOff,
-                                        nXSize, nYSize, eBufType) )
+                (!poBand->CanUseMappedIO(eRWFlag, nXSize, nYSize,
+                                         nBufXSize, nBufYSize) &&
+                 !poBand->CanUseDirectIO(nXOff, nYOff,
+                                         nXSize, nYSize, eBufType)) )
             {
                 break;
             }
@@ -102,6 +102,9 @@ protected:
 
     int         bOwnsFP;
 
+    CPLVirtualMem *pVMemRead;
+    int         bVMemReadTried;
+
     int         Seek( vsi_l_offset, int );
     size_t      Read( void *, size_t, size_t );
     size_t      Write( void *, size_t, size_t );
@@ -119,6 +122,17 @@ protected:
     int         CanUseDirectIO(int nXOff, int nYOff, int nXSize, int nYSize,
                                GDALDataType eBufType);
 
+    const GByte *GetReadOnlyMapping();
+    int         CanUseMappedIO( GDALRWFlag eRWFlag, int nXSize, int nYSize,
+                                int nBufXSize, int nBufYSize );
+    void        CopyFromMapping( const GByte *pabySrc, void *pDst,
+                                 GDALDataType eBufType, int nPixelSpace,
+                                 int nCount );
+    CPLErr      MappedRasterIO( int nXOff, int nYOff, int nXSize, int nYSize,
+                                void *pData, GDALDataType eBufType,
+                                GSpacing nPixelSpace, GSpacing nLineSpace,
+                                GDALRasterIOExtraArg* psExtraArg );
+
 public:
 
                  RawRasterBand( GDALDataset *poDS, int nBand, void * fpRaw,
@@ -0,0 +1,884 @@
+/******************************************************************************
+ *
+ * Project:  Virtual GDAL Datasets
+ * Purpose:  Mosaic driver reading the rasters referenced by a vector tile
+ *           index (GTI).
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "vrtdataset.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_string.h"
+#include "gdal.h"
+#include "gdal_frmts.h"
+#include "gdal_pam.h"
+#include "gdal_priv.h"
+#include "ogr_core.h"
+#include "ogr_feature.h"
+#include "ogr_spatialref.h"
+#include "ogrsf_frmts.h"
+
+CPL_CVSID("$Id$")
+
+static const char GTI_PREFIX[] = "GTI:";
+static const char GTI_EXTENSION[] = ".gti.gpkg";
+
+/************************************************************************/
+/* ==================================================================== */
+/*                         GDALTileIndexDataset                         */
+/* ==================================================================== */
+/************************************************************************/
+
+/* The mosaic is described by a vector layer with one feature per tile,    */
+/* whose geometry is the footprint of the tile and a string field gives    */
+/* the name of the raster (as written by gdaltindex). Opening only reads   */
+/* the layer extent and, when needed, the first tile. Each read then asks  */
+/* the layer (and its spatial index) for the tiles intersecting the        */
+/* requested window, and composites them through a VRT dataset holding     */
+/* sources for those tiles only.                                            */
+
+class GDALTileIndexDataset : public GDALPamDataset
+{
+    friend class GDALTileIndexBand;
+
+    GDALDataset  *poVectorDS;
+    OGRLayer     *poLayer;
+    int           iLocationField;
+    CPLString     osIndexPath;
+
+    double        adfGeoTransform[6];
+    char         *pszProjection;
+    CPLString     osResampling;
+
+    // Scratch VRT whose sources are the tiles of the last read window.
+    // It is created again for each window, since VRTDataset builds its
+    // implicit overviews from the sources it has at that time.
+    VRTDataset   *poVRTDS;
+    int           nLastXOff;
+    int           nLastYOff;
+    int           nLastXSize;
+    int           nLastYSize;
+
+    // Most recently used tiles, kept open between reads.
+    std::list< std::pair<CPLString, GDALDataset*> > oTileCache;
+    size_t        nMaxOpenTiles;
+    bool          bWarnedRotatedTile;
+
+    GDALDataset  *GetTile( const char* pszLocation );
+    VRTDataset   *CreateScratchVRT();
+    bool          CollectSources( int nXOff, int nYOff,
+                                  int nXSize, int nYSize );
+
+  public:
+                  GDALTileIndexDataset();
+    virtual      ~GDALTileIndexDataset();
+
+    virtual CPLErr GetGeoTransform( double * ) override;
+    virtual const char *GetProjectionRef() override;
+
+    virtual CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                              void *, int, int, GDALDataType,
+                              int, int *,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GSpacing nBandSpace,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
+
+    static int          Identify( GDALOpenInfo * );
+    static GDALDataset *Open( GDALOpenInfo * );
+};
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          GDALTileIndexBand                           */
+/* ==================================================================== */
+/************************************************************************/
+
+class GDALTileIndexBand : public GDALPamRasterBand
+{
+    friend class GDALTileIndexDataset;
+
+    int           bNoDataSet;
+    double        dfNoDataValue;
+    GDALColorInterp eColorInterp;
+    GDALColorTable *poColorTable;
+
+  public:
+                  GDALTileIndexBand( GDALTileIndexDataset *poDSIn, int nBandIn,
+                                     GDALDataType eDT );
+    virtual      ~GDALTileIndexBand();
+
+    virtual CPLErr IReadBlock( int, int, void * ) override;
+    virtual CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                              void *, int, int, GDALDataType,
+                              GSpacing nPixelSpace, GSpacing nLineSpace,
+                              GDALRasterIOExtraArg* psExtraArg ) override;
+
+    virtual double GetNoDataValue( int *pbSuccess = NULL ) override;
+    virtual GDALColorInterp GetColorInterpretation() override;
+    virtual GDALColorTable *GetColorTable() override;
+};
+
+/************************************************************************/
+/*                        GDALTileIndexDataset()                        */
+/************************************************************************/
+
+GDALTileIndexDataset::GDALTileIndexDataset() :
+    poVectorDS(NULL),
+    poLayer(NULL),
+    iLocationField(-1),
+    pszProjection(CPLStrdup("")),
+    osResampling("near"),
+    poVRTDS(NULL),
+    nLastXOff(-1),
+    nLastYOff(-1),
+    nLastXSize(-1),
+    nLastYSize(-1),
+    nMaxOpenTiles(100),
+    bWarnedRotatedTile(false)
+{
+    adfGeoTransform[0] = 0.0;
+    adfGeoTransform[1] = 1.0;
+    adfGeoTransform[2] = 0.0;
+    adfGeoTransform[3] = 0.0;
+    adfGeoTransform[4] = 0.0;
+    adfGeoTransform[5] = 1.0;
+}
+
+/************************************************************************/
+/*                       ~GDALTileIndexDataset()                        */
+/************************************************************************/
+
+GDALTileIndexDataset::~GDALTileIndexDataset()
+{
+    FlushCache();
+
+    // Sources hold references on the tiles, so release them first.
+    delete poVRTDS;
+
+    for( std::list< std::pair<CPLString, GDALDataset*> >::iterator oIter =
+             oTileCache.begin(); oIter != oTileCache.end(); ++oIter )
+    {
+        oIter->second->ReleaseRef();
+    }
+    oTileCache.clear();
+
+    if( poVectorDS != NULL )
+        GDALClose( poVectorDS );
+    CPLFree( pszProjection );
+}
+
+/************************************************************************/
+/*                          GetGeoTransform()                           */
+/************************************************************************/
+
+CPLErr GDALTileIndexDataset::GetGeoTransform( double *padfTransform )
+{
+    memcpy( padfTransform, adfGeoTransform, sizeof(double) * 6 );
+    return CE_None;
+}
+
+/************************************************************************/
+/*                          GetProjectionRef()                          */
+/************************************************************************/
+
+const char *GDALTileIndexDataset::GetProjectionRef()
+{
+    return pszProjection;
+}
+
+/************************************************************************/
+/*                              GetTile()                               */
+/*                                                                      */
+/*      Return an opened tile, from the cache of recently used ones     */
+/*      if possible. The cache owns one reference on each tile.         */
+/************************************************************************/
+
+GDALDataset *GDALTileIndexDataset::GetTile( const char* pszLocation )
+{
+    for( std::list< std::pair<CPLString, GDALDataset*> >::iterator oIter =
+             oTileCache.begin(); oIter != oTileCache.end(); ++oIter )
+    {
+        if( oIter->first == pszLocation )
+        {
+            // Move to front.
+            oTileCache.splice( oTileCache.begin(), oTileCache, oIter );
+            return oTileCache.front().second;
+        }
+    }
+
+    CPLString osFilename(pszLocation);
+    if( !osIndexPath.empty() && CPLIsFilenameRelative(pszLocation) &&
+        !STARTS_WITH(pszLocation, "/vsi") )
+    {
+        osFilename = CPLProjectRelativeFilename(osIndexPath, pszLocation);
+    }
+
+    GDALDataset* poTileDS = static_cast<GDALDataset*>(
+        GDALOpenEx( osFilename, GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR,
+                    NULL, NULL, NULL ) );
+    if( poTileDS == NULL )
+        return NULL;
+
+    if( oTileCache.size() >= nMaxOpenTiles )
+    {
+        oTileCache.back().second->ReleaseRef();
+        oTileCache.pop_back();
+    }
+    oTileCache.push_front( std::pair<CPLString, GDALDataset*>(pszLocation,
+                                                              poTileDS) );
+    return poTileDS;
+}
+
+/************************************************************************/
+/*                          CreateScratchVRT()                          */
+/************************************************************************/
+
+VRTDataset *GDALTileIndexDataset::CreateScratchVRT()
+{
+    VRTDataset* poScratchDS = new VRTDataset( nRasterXSize, nRasterYSize );
+    poScratchDS->SetWritable( FALSE );
+
+    for( int iBand = 1; iBand <= nBands; ++iBand )
+    {
+        GDALTileIndexBand* poBand =
+            static_cast<GDALTileIndexBand*>(GetRasterBand(iBand));
+        poScratchDS->AddBand( poBand->GetRasterDataType(), NULL );
+        if( poBand->bNoDataSet )
+            poScratchDS->GetRasterBand(iBand)->
+                SetNoDataValue(poBand->dfNoDataValue);
+    }
+
+    return poScratchDS;
+}
+
+/************************************************************************/
+/*                           CollectSources()                           */
+/*                                                                      */
+/*      Make the scratch VRT reference the tiles intersecting the       */
+/*      window, in the order of the layer, the last ones on top.        */
+/************************************************************************/
+
+bool GDALTileIndexDataset::CollectSources( int nXOff, int nYOff,
+                                           int nXSize, int nYSize )
+{
+    if( nXOff == nLastXOff && nYOff == nLastYOff &&
+        nXSize == nLastXSize && nYSize == nLastYSize )
+    {
+        return true;
+    }
+
+    // Sources hold references on the tiles, so release them before
+    // GetTile() possibly closes some.
+    delete poVRTDS;
+    poVRTDS = CreateScratchVRT();
+    nLastXOff = -1;
+
+    const double dfMinX = adfGeoTransform[0] + nXOff * adfGeoTransform[1];
+    const double dfMaxX =
+        adfGeoTransform[0] + (nXOff + nXSize) * adfGeoTransform[1];
+    const double dfMaxY = adfGeoTransform[3] + nYOff * adfGeoTransform[5];
+    const double dfMinY =
+        adfGeoTransform[3] + (nYOff + nYSize) * adfGeoTransform[5];
+
+    poLayer->SetSpatialFilterRect( dfMinX, dfMinY, dfMaxX, dfMaxY );
+    poLayer->ResetReading();
+
+    bool bRet = true;
+    OGRFeature* poFeature = NULL;
+    while( (poFeature = poLayer->GetNextFeature()) != NULL )
+    {
+        const char* pszLocation = poFeature->GetFieldAsString(iLocationField);
+        if( pszLocation[0] == '\0' )
+        {
+            delete poFeature;
+            continue;
+        }
+
+        GDALDataset* poTileDS = GetTile(pszLocation);
+        delete poFeature;
+        if( poTileDS == NULL )
+        {
+            bRet = false;
+            break;
+        }
+
+        double adfTileGT[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+        if( poTileDS->GetGeoTransform(adfTileGT) != CE_None ||
+            adfTileGT[2] != 0.0 || adfTileGT[4] != 0.0 )
+        {
+            if( !bWarnedRotatedTile )
+            {
+                CPLError( CE_Warning, CPLE_NotSupported,
+                          "Tile %s has no geotransform or a rotated one. "
+                          "Ignoring it.", poTileDS->GetDescription() );
+                bWarnedRotatedTile = true;
+            }
+            continue;
+        }
+
+        const double dfDstXOff =
+            (adfTileGT[0] - adfGeoTransform[0]) / adfGeoTransform[1];
+        const double dfDstYOff =
+            (adfTileGT[3] - adfGeoTransform[3]) / adfGeoTransform[5];
+        const double dfDstXSize =
+            poTileDS->GetRasterXSize() * adfTileGT[1] / adfGeoTransform[1];
+        const double dfDstYSize =
+            poTileDS->GetRasterYSize() * adfTileGT[5] / adfGeoTransform[5];
+
+        const int nTileBands = std::min(nBands, poTileDS->GetRasterCount());
+        for( int iBand = 1; iBand <= nTileBands; ++iBand )
+        {
+            GDALRasterBand* poTileBand = poTileDS->GetRasterBand(iBand);
+            VRTSourcedRasterBand* poVRTBand =
+                static_cast<VRTSourcedRasterBand*>(
+                    poVRTDS->GetRasterBand(iBand));
+
+            // Pixels at the nodata value of the tile let the tiles below
+            // show through, as with gdalbuildvrt.
+            int bTileNoDataSet = FALSE;
+            const double dfTileNoData =
+                poTileBand->GetNoDataValue(&bTileNoDataSet);
+            VRTSimpleSource* poSource = NULL;
+            if( bTileNoDataSet )
+            {
+                poSource = new VRTComplexSource();
+                poSource->SetNoDataValue(dfTileNoData);
+            }
+            else
+            {
+                poSource = new VRTSimpleSource();
+            }
+            poSource->SetResampling(osResampling);
+
+            poVRTBand->ConfigureSource( poSource, poTileBand, FALSE,
+                                        0, 0,
+                                        poTileDS->GetRasterXSize(),
+                                        poTileDS->GetRasterYSize(),
+                                        dfDstXOff, dfDstYOff,
+                                        dfDstXSize, dfDstYSize );
+            poVRTBand->AddSource( poSource );
+        }
+    }
+    poLayer->SetSpatialFilter( NULL );
+
+    if( bRet )
+    {
+        nLastXOff = nXOff;
+        nLastYOff = nYOff;
+        nLastXSize = nXSize;
+        nLastYSize = nYSize;
+    }
+    return bRet;
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr GDALTileIndexDataset::IRasterIO( GDALRWFlag eRWFlag,
+                                        int nXOff, int nYOff,
+                                        int nXSize, int nYSize,
+                                        void *pData,
+                                        int nBufXSize, int nBufYSize,
+                                        GDALDataType eBufType,
+                                        int nBandCount, int *panBandMap,
+                                        GSpacing nPixelSpace,
+                                        GSpacing nLineSpace,
+                                        GSpacing nBandSpace,
+                                        GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag != GF_Read )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "GTI datasets are read-only." );
+        return CE_Failure;
+    }
+
+    if( !CollectSources(nXOff, nYOff, nXSize, nYSize) )
+        return CE_Failure;
+
+    return poVRTDS->RasterIO( GF_Read, nXOff, nYOff, nXSize, nYSize,
+                              pData, nBufXSize, nBufYSize, eBufType,
+                              nBandCount, panBandMap,
+                              nPixelSpace, nLineSpace, nBandSpace,
+                              psExtraArg );
+}
+
+/************************************************************************/
+/*                             Identify()                               */
+/************************************************************************/
+
+int GDALTileIndexDataset::Identify( GDALOpenInfo *poOpenInfo )
+{
+    if( STARTS_WITH_CI(poOpenInfo->pszFilename, GTI_PREFIX) )
+        return TRUE;
+
+    const size_t nLen = strlen(poOpenInfo->pszFilename);
+    const size_t nExtLen = strlen(GTI_EXTENSION);
+    return poOpenInfo->nHeaderBytes > 0 && nLen > nExtLen &&
+           EQUAL(poOpenInfo->pszFilename + nLen - nExtLen, GTI_EXTENSION);
+}
+
+/************************************************************************/
+/*                        GTIGetOption()                                */
+/*                                                                      */
+/*      Open options take precedence over the metadata of the layer.   */
+/************************************************************************/
+
+static const char* GTIGetOption( GDALOpenInfo* poOpenInfo, OGRLayer* poLayer,
+                                 const char* pszKey )
+{
+    const char* pszValue =
+        CSLFetchNameValue(poOpenInfo->papszOpenOptions, pszKey);
+    if( pszValue == NULL && poLayer != NULL )
+        pszValue = poLayer->GetMetadataItem(pszKey);
+    return pszValue;
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+GDALDataset *GDALTileIndexDataset::Open( GDALOpenInfo *poOpenInfo )
+{
+    if( !Identify(poOpenInfo) )
+        return NULL;
+
+    if( poOpenInfo->eAccess == GA_Update )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "The GTI driver does not support update access." );
+        return NULL;
+    }
+
+    const char* pszIndex = poOpenInfo->pszFilename;
+    if( STARTS_WITH_CI(pszIndex, GTI_PREFIX) )
+        pszIndex += strlen(GTI_PREFIX);
+
+/* -------------------------------------------------------------------- */
+/*      Open the tile index and find the layer and location field.      */
+/* -------------------------------------------------------------------- */
+    GDALDataset* poVectorDS = static_cast<GDALDataset*>(
+        GDALOpenEx( pszIndex, GDAL_OF_VECTOR | GDAL_OF_VERBOSE_ERROR,
+                    NULL, NULL, NULL ) );
+    if( poVectorDS == NULL )
+        return NULL;
+
+    const char* pszLayerName =
+        CSLFetchNameValue(poOpenInfo->papszOpenOptions, "LAYER");
+    OGRLayer* poLayer = NULL;
+    if( pszLayerName != NULL )
+        poLayer = poVectorDS->GetLayerByName(pszLayerName);
+    else if( poVectorDS->GetLayerCount() == 1 )
+        poLayer = poVectorDS->GetLayer(0);
+    else
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "%s has %d layers. The LAYER open option must be "
+                  "specified.", pszIndex, poVectorDS->GetLayerCount() );
+    }
+    if( poLayer == NULL )
+    {
+        GDALClose( poVectorDS );
+        return NULL;
+    }
+
+    const char* pszLocationField =
+        GTIGetOption(poOpenInfo, poLayer, "LOCATION_FIELD");
+    if( pszLocationField == NULL )
+        pszLocationField = "location";
+    const int iLocationField =
+        poLayer->GetLayerDefn()->GetFieldIndex(pszLocationField);
+    if( iLocationField < 0 )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Cannot find field %s in layer %s", pszLocationField,
+                  poLayer->GetName() );
+        GDALClose( poVectorDS );
+        return NULL;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Raster properties not given by options or layer metadata are    */
+/*      taken from the first tile.                                      */
+/* -------------------------------------------------------------------- */
+    const char* pszResX = GTIGetOption(poOpenInfo, poLayer, "RESX");
+    const char* pszResY = GTIGetOption(poOpenInfo, poLayer, "RESY");
+    const char* pszBandCount = GTIGetOption(poOpenInfo, poLayer, "BAND_COUNT");
+    const char* pszDataType = GTIGetOption(poOpenInfo, poLayer, "DATA_TYPE");
+    const char* pszNoData = GTIGetOption(poOpenInfo, poLayer, "NODATA");
+
+    GDALTileIndexDataset* poDS = new GDALTileIndexDataset();
+    poDS->poVectorDS = poVectorDS;
+    poDS->poLayer = poLayer;
+    poDS->iLocationField = iLocationField;
+    if( !STARTS_WITH(pszIndex, "/vsi") || STARTS_WITH(pszIndex, "/vsimem/") )
+        poDS->osIndexPath = CPLGetPath(pszIndex);
+    const char* pszResampling = GTIGetOption(poOpenInfo, poLayer, "RESAMPLING");
+    if( pszResampling != NULL )
+        poDS->osResampling = pszResampling;
+    poDS->nMaxOpenTiles = static_cast<size_t>(std::max(1, atoi(
+        CPLGetConfigOption("GDAL_GTI_MAX_OPEN_TILES", "100"))));
+
+    GDALDataset* poFirstTileDS = NULL;
+    {
+        poLayer->ResetReading();
+        OGRFeature* poFeature = poLayer->GetNextFeature();
+        if( poFeature == NULL )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Layer %s has no tile", poLayer->GetName() );
+            delete poDS;
+            return NULL;
+        }
+        if( pszResX == NULL || pszResY == NULL || pszBandCount == NULL ||
+            pszDataType == NULL )
+        {
+            poFirstTileDS = poDS->GetTile(
+                poFeature->GetFieldAsString(iLocationField));
+            if( poFirstTileDS == NULL )
+            {
+                delete poFeature;
+                delete poDS;
+                return NULL;
+            }
+        }
+        delete poFeature;
+    }
+
+    double dfResX = 0.0;
+    double dfResY = 0.0;
+    if( pszResX != NULL && pszResY != NULL )
+    {
+        dfResX = CPLAtof(pszResX);
+        dfResY = fabs(CPLAtof(pszResY));
+    }
+    else
+    {
+        double adfTileGT[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+        if( poFirstTileDS->GetGeoTransform(adfTileGT) != CE_None )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot get the resolution of the first tile. "
+                      "Use the RESX and RESY open options." );
+            delete poDS;
+            return NULL;
+        }
+        dfResX = adfTileGT[1];
+        dfResY = fabs(adfTileGT[5]);
+    }
+    if( !(dfResX > 0.0) || !(dfResY > 0.0) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "Invalid resolution" );
+        delete poDS;
+        return NULL;
+    }
+
+    const int l_nBands = pszBandCount != NULL ? atoi(pszBandCount) :
+                                        poFirstTileDS->GetRasterCount();
+    GDALDataType eDT = GDT_Unknown;
+    if( pszDataType != NULL )
+        eDT = GDALGetDataTypeByName(pszDataType);
+    else if( l_nBands > 0 && poFirstTileDS->GetRasterCount() > 0 )
+        eDT = poFirstTileDS->GetRasterBand(1)->GetRasterDataType();
+    if( l_nBands <= 0 || eDT == GDT_Unknown )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Invalid band count or data type" );
+        delete poDS;
+        return NULL;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Extent and SRS.                                                 */
+/* -------------------------------------------------------------------- */
+    const char* pszMinX = GTIGetOption(poOpenInfo, poLayer, "MINX");
+    const char* pszMinY = GTIGetOption(poOpenInfo, poLayer, "MINY");
+    const char* pszMaxX = GTIGetOption(poOpenInfo, poLayer, "MAXX");
+    const char* pszMaxY = GTIGetOption(poOpenInfo, poLayer, "MAXY");
+    OGREnvelope sEnvelope;
+    if( pszMinX != NULL && pszMinY != NULL &&
+        pszMaxX != NULL && pszMaxY != NULL )
+    {
+        sEnvelope.MinX = CPLAtof(pszMinX);
+        sEnvelope.MinY = CPLAtof(pszMinY);
+        sEnvelope.MaxX = CPLAtof(pszMaxX);
+        sEnvelope.MaxY = CPLAtof(pszMaxY);
+    }
+    else if( poLayer->GetExtent(&sEnvelope, TRUE) != OGRERR_NONE )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Cannot get extent of layer %s", poLayer->GetName() );
+        delete poDS;
+        return NULL;
+    }
+
+    const double dfXSize = (sEnvelope.MaxX - sEnvelope.MinX) / dfResX + 0.5;
+    const double dfYSize = (sEnvelope.MaxY - sEnvelope.MinY) / dfResY + 0.5;
+    if( !(dfXSize >= 1 && dfXSize <= INT_MAX &&
+          dfYSize >= 1 && dfYSize <= INT_MAX) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined, "Invalid raster dimensions" );
+        delete poDS;
+        return NULL;
+    }
+    poDS->nRasterXSize = static_cast<int>(dfXSize);
+    poDS->nRasterYSize = static_cast<int>(dfYSize);
+    poDS->adfGeoTransform[0] = sEnvelope.MinX;
+    poDS->adfGeoTransform[1] = dfResX;
+    poDS->adfGeoTransform[3] = sEnvelope.MaxY;
+    poDS->adfGeoTransform[5] = -dfResY;
+
+    const char* pszSRS = GTIGetOption(poOpenInfo, poLayer, "SRS");
+    OGRSpatialReference oSRS;
+    if( pszSRS != NULL )
+    {
+        if( oSRS.SetFromUserInput(pszSRS) != OGRERR_NONE )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined, "Invalid SRS: %s", pszSRS );
+            delete poDS;
+            return NULL;
+        }
+        CPLFree( poDS->pszProjection );
+        poDS->pszProjection = NULL;
+        oSRS.exportToWkt( &poDS->pszProjection );
+    }
+    else if( poLayer->GetSpatialRef() != NULL )
+    {
+        CPLFree( poDS->pszProjection );
+        poDS->pszProjection = NULL;
+        poLayer->GetSpatialRef()->exportToWkt( &poDS->pszProjection );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Create the bands.                                               */
+/* -------------------------------------------------------------------- */
+
+    for( int iBand = 1; iBand <= l_nBands; ++iBand )
+    {
+        GDALTileIndexBand* poBand = new GDALTileIndexBand(poDS, iBand, eDT);
+        GDALRasterBand* poFirstTileBand =
+            (poFirstTileDS != NULL && iBand <= poFirstTileDS->GetRasterCount())
+            ? poFirstTileDS->GetRasterBand(iBand) : NULL;
+        if( pszNoData != NULL )
+        {
+            poBand->bNoDataSet = TRUE;
+            poBand->dfNoDataValue = CPLAtofM(pszNoData);
+        }
+        else if( poFirstTileBand != NULL )
+        {
+            poBand->dfNoDataValue =
+                poFirstTileBand->GetNoDataValue(&poBand->bNoDataSet);
+        }
+        if( poFirstTileBand != NULL )
+        {
+            poBand->eColorInterp = poFirstTileBand->GetColorInterpretation();
+            if( poFirstTileBand->GetColorTable() != NULL )
+                poBand->poColorTable =
+                    poFirstTileBand->GetColorTable()->Clone();
+        }
+        poDS->SetBand( iBand, poBand );
+    }
+
+    poDS->SetDescription( poOpenInfo->pszFilename );
+    poDS->TryLoadXML();
+
+    return poDS;
+}
+
+/************************************************************************/
+/*                         GDALTileIndexBand()                          */
+/************************************************************************/
+
+GDALTileIndexBand::GDALTileIndexBand( GDALTileIndexDataset *poDSIn,
+                                      int nBandIn, GDALDataType eDT ) :
+    bNoDataSet(FALSE),
+    dfNoDataValue(0.0),
+    eColorInterp(GCI_Undefined),
+    poColorTable(NULL)
+{
+    poDS = poDSIn;
+    nBand = nBandIn;
+    eDataType = eDT;
+    nRasterXSize = poDSIn->GetRasterXSize();
+    nRasterYSize = poDSIn->GetRasterYSize();
+    nBlockXSize = std::min(256, nRasterXSize);
+    nBlockYSize = std::min(256, nRasterYSize);
+}
+
+/************************************************************************/
+/*                        ~GDALTileIndexBand()                          */
+/************************************************************************/
+
+GDALTileIndexBand::~GDALTileIndexBand()
+{
+    delete poColorTable;
+}
+
+/************************************************************************/
+/*                             IReadBlock()                             */
+/************************************************************************/
+
+CPLErr GDALTileIndexBand::IReadBlock( int nBlockXOff, int nBlockYOff,
+                                      void *pImage )
+{
+    const int nXOff = nBlockXOff * nBlockXSize;
+    const int nYOff = nBlockYOff * nBlockYSize;
+    const int nReqXSize = std::min(nBlockXSize, nRasterXSize - nXOff);
+    const int nReqYSize = std::min(nBlockYSize, nRasterYSize - nYOff);
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+    return IRasterIO( GF_Read, nXOff, nYOff, nReqXSize, nReqYSize,
+                      pImage, nReqXSize, nReqYSize, eDataType,
+                      nDTSize, static_cast<GSpacing>(nDTSize) * nBlockXSize,
+                      &sExtraArg );
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr GDALTileIndexBand::IRasterIO( GDALRWFlag eRWFlag,
+                                     int nXOff, int nYOff,
+                                     int nXSize, int nYSize,
+                                     void *pData,
+                                     int nBufXSize, int nBufYSize,
+                                     GDALDataType eBufType,
+                                     GSpacing nPixelSpace,
+                                     GSpacing nLineSpace,
+                                     GDALRasterIOExtraArg* psExtraArg )
+{
+    GDALTileIndexDataset* poGDS = static_cast<GDALTileIndexDataset*>(poDS);
+
+    if( eRWFlag != GF_Read )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "GTI datasets are read-only." );
+        return CE_Failure;
+    }
+
+    if( !poGDS->CollectSources(nXOff, nYOff, nXSize, nYSize) )
+        return CE_Failure;
+
+    return poGDS->poVRTDS->GetRasterBand(nBand)->RasterIO(
+        GF_Read, nXOff, nYOff, nXSize, nYSize,
+        pData, nBufXSize, nBufYSize, eBufType,
+        nPixelSpace, nLineSpace, psExtraArg );
+}
+
+/************************************************************************/
+/*                           GetNoDataValue()                           */
+/************************************************************************/
+
+double GDALTileIndexBand::GetNoDataValue( int *pbSuccess )
+{
+    if( pbSuccess )
+        *pbSuccess = bNoDataSet;
+    return dfNoDataValue;
+}
+
+/************************************************************************/
+/*                       GetColorInterpretation()                       */
+/************************************************************************/
+
+GDALColorInterp GDALTileIndexBand::GetColorInterpretation()
+{
+    return eColorInterp;
+}
+
+/************************************************************************/
+/*                           GetColorTable()                            */
+/************************************************************************/
+
+GDALColorTable *GDALTileIndexBand::GetColorTable()
+{
+    return poColorTable;
+}
+
+/************************************************************************/
+/*                          GDALRegister_GTI()                          */
+/************************************************************************/
+
+void GDALRegister_GTI()
+
+{
+    if( GDALGetDriverByName( "GTI" ) != NULL )
+        return;
+
+    GDALDriver *poDriver = new GDALDriver();
+
+    poDriver->SetDescription( "GTI" );
+    poDriver->SetMetadataItem( GDAL_DCAP_RASTER, "YES" );
+    poDriver->SetMetadataItem( GDAL_DMD_LONGNAME, "GDAL Raster Tile Index" );
+    poDriver->SetMetadataItem( GDAL_DMD_EXTENSIONS, "gti.gpkg" );
+    poDriver->SetMetadataItem( GDAL_DMD_CONNECTION_PREFIX, GTI_PREFIX );
+    poDriver->SetMetadataItem( GDAL_DMD_HELPTOPIC, "frmt_gti.html" );
+    poDriver->SetMetadataItem( GDAL_DCAP_VIRTUALIO, "YES" );
+
+    poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
+"<OptionList>"
+"  <Option name='LAYER' type='string' description='Name of the layer of the "
+"tile index'/>"
+"  <Option name='LOCATION_FIELD' type='string' default='location' "
+"description='Name of the field with the tile names'/>"
+"  <Option name='RESX' type='float' description='Horizontal resolution'/>"
+"  <Option name='RESY' type='float' description='Vertical resolution'/>"
+"  <Option name='MINX' type='float' description='Minimum X of the extent'/>"
+"  <Option name='MINY' type='float' description='Minimum Y of the extent'/>"
+"  <Option name='MAXX' type='float' description='Maximum X of the extent'/>"
+"  <Option name='MAXY' type='float' description='Maximum Y of the extent'/>"
+"  <Option name='BAND_COUNT' type='int' description='Number of bands'/>"
+"  <Option name='DATA_TYPE' type='string' description='Data type of bands'/>"
+"  <Option name='NODATA' type='string' description='Nodata value of bands'/>"
+"  <Option name='SRS' type='string' description='Spatial reference system'/>"
+"  <Option name='RESAMPLING' type='string-select' default='near' "
+"description='Resampling method for tiles whose resolution differs'>"
+"    <Value>near</Value>"
+"    <Value>bilinear</Value>"
+"    <Value>cubic</Value>"
+"    <Value>cubicspline</Value>"
+"    <Value>lanczos</Value>"
+"    <Value>average</Value>"
+"    <Value>mode</Value>"
+"  </Option>"
+"</OptionList>" );
+
+    poDriver->pfnOpen = GDALTileIndexDataset::Open;
+    poDriver->pfnIdentify = GDALTileIndexDataset::Identify;
+
+    GetGDALDriverManager()->RegisterDriver( poDriver );
+}
@@ -29,43 +29,13 @@
 
 #include "wmsdriver.h"
 
-CPL_CVSID("$Id$")
+#include <ctime>
 
-GDALWMSCache::GDALWMSCache() :
-    m_cache_path("./gdalwmscache"),
-    // No need to do the default: m_postfix("");
-    m_cache_depth(2)
-{}
+#ifdef HAVE_SQLITE
+#include "sqlite3.h"
+#endif
 
-GDALWMSCache::~GDALWMSCache() {}
-
-CPLErr GDALWMSCache::Initialize(CPLXMLNode *config) {
-    const char *xmlcache_path = CPLGetXMLValue(config, "Path", NULL);
-    const char *usercache_path = CPLGetConfigOption("GDAL_DEFAULT_WMS_CACHE_PATH", NULL);
-    if(xmlcache_path)
-    {
-        m_cache_path = xmlcache_path;
-    }
-    else
-    {
-        if(usercache_path)
-        {
-            m_cache_path = usercache_path;
-        }
-        else
-        {
-            m_cache_path = "./gdalwmscache";
-        }
-    }
-
-    const char *cache_depth = CPLGetXMLValue(config, "Depth", "2");
-    m_cache_depth = atoi(cache_depth);
-
-    const char *cache_extension = CPLGetXMLValue(config, "Extension", "");
-    m_postfix = cache_extension;
-
-    return CE_None;
-}
+CPL_CVSID("$Id$")
 
 // Recursive makedirs, ignoring errors
 static void MakeDirs(const CPLString & path) {
@@ -75,8 +45,34 @@ static void MakeDirs(const CPLString & path) {
     VSIMkdir(p, 0744);
 }
 
+/************************************************************************/
+/*                          GDALWMSFileCache                            */
+/************************************************************************/
+
+// One file per tile, in a directory tree indexed by the MD5 of the key
+class GDALWMSFileCache : public GDALWMSCacheImpl {
+public:
+    GDALWMSFileCache(const CPLString &cache_path, int cache_depth,
+                     const CPLString &postfix) :
+        m_cache_path(cache_path),
+        m_postfix(postfix),
+        m_cache_depth(cache_depth)
+    {}
+
+    virtual CPLErr Write(const char *key, const CPLString &file_name) override;
+    virtual CPLErr Read(const char *key, CPLString *file_name) override;
+
+protected:
+    CPLString KeyToCacheFile(const char *key);
+
+protected:
+    CPLString m_cache_path;
+    CPLString m_postfix;
+    int m_cache_depth;
+};
+
 // Warns if it fails to write, but returns success
-CPLErr GDALWMSCache::Write(const char *key, const CPLString &file_name) {
+CPLErr GDALWMSFileCache::Write(const char *key, const CPLString &file_name) {
     CPLString cache_file(KeyToCacheFile(key));
     // printf("GDALWMSCache::Write(%s, %s) -> %s\n", key, file_name.c_str());
     if (CPLCopyFile(cache_file, file_name) == CE_None)
@@ -89,7 +85,7 @@ CPLErr GDALWMSCache::Write(const char *key, const CPLString &file_name) {
     return CE_None;
 }
 
-CPLErr GDALWMSCache::Read(const char *key, CPLString *file_name) {
+CPLErr GDALWMSFileCache::Read(const char *key, CPLString *file_name) {
     CPLErr ret = CE_Failure;
     CPLString cache_file(KeyToCacheFile(key));
     VSILFILE* fp = VSIFOpenL(cache_file.c_str(), "rb");
@@ -103,7 +99,7 @@ CPLErr GDALWMSCache::Read(const char *key, CPLString *file_name) {
     return ret;
 }
 
-CPLString GDALWMSCache::KeyToCacheFile(const char *key) {
+CPLString GDALWMSFileCache::KeyToCacheFile(const char *key) {
     CPLString hash(MD5String(key));
     CPLString cache_file(m_cache_path);
 
@@ -117,3 +113,371 @@ CPLString GDALWMSCache::KeyToCacheFile(const char *key) {
     cache_file.append(m_postfix);
     return cache_file;
 }
+
+#ifdef HAVE_SQLITE
+
+/************************************************************************/
+/*                         GDALWMSSQLiteCache                           */
+/************************************************************************/
+
+// All tiles packed in a single SQLite database, with a bounded size,
+// least recently used eviction and optional expiry. The database is
+// opened in WAL mode so that several processes can share it.
+class GDALWMSSQLiteCache : public GDALWMSCacheImpl {
+public:
+    GDALWMSSQLiteCache(const CPLString &db_name, GIntBig max_size,
+                       int expires);
+    virtual ~GDALWMSSQLiteCache();
+
+    virtual CPLErr Write(const char *key, const CPLString &file_name) override;
+    virtual CPLErr Read(const char *key, CPLString *file_name) override;
+    virtual void Release(const CPLString &file_name) override;
+
+protected:
+    bool Open();
+    bool Exec(const char *sql);
+    void Evict();
+
+protected:
+    CPLString m_db_name;
+    GIntBig m_max_size;
+    int m_expires;
+    sqlite3 *m_db;
+    bool m_open_failed;
+    int m_file_counter;
+    // Protects m_db, which is shared by the bands of the dataset
+    CPLMutex *m_mutex;
+};
+
+// Only refresh the access time of a tile when older than that, to
+// avoid a write transaction on every hit
+static const int ACCESS_TIME_RESOLUTION = 60;
+
+GDALWMSSQLiteCache::GDALWMSSQLiteCache(const CPLString &db_name,
+                                       GIntBig max_size, int expires) :
+    m_db_name(db_name),
+    m_max_size(max_size),
+    m_expires(expires),
+    m_db(NULL),
+    m_open_failed(false),
+    m_file_counter(0),
+    m_mutex(NULL)
+{}
+
+GDALWMSSQLiteCache::~GDALWMSSQLiteCache() {
+    if (m_db != NULL)
+        sqlite3_close(m_db);
+    if (m_mutex != NULL)
+        CPLDestroyMutex(m_mutex);
+}
+
+bool GDALWMSSQLiteCache::Exec(const char *sql) {
+    char *err = NULL;
+    if (sqlite3_exec(m_db, sql, NULL, NULL, &err) != SQLITE_OK) {
+        CPLDebug("WMS", "Cache: %s failed: %s", sql, err ? err : "");
+        sqlite3_free(err);
+        return false;
+    }
+    return true;
+}
+
+// Opens the database on first use, creating it if needed
+bool GDALWMSSQLiteCache::Open() {
+    if (m_db != NULL)
+        return true;
+    if (m_open_failed)
+        return false;
+    m_open_failed = true;
+
+    MakeDirs(m_db_name);
+    if (sqlite3_open_v2(m_db_name, &m_db,
+                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
+                        SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK) {
+        CPLError(CE_Warning, CPLE_FileIO, "Cannot open WMS cache %s: %s",
+                 m_db_name.c_str(), m_db ? sqlite3_errmsg(m_db) : "");
+        if (m_db != NULL)
+            sqlite3_close(m_db);
+        m_db = NULL;
+        return false;
+    }
+
+    // Other processes may hold the write lock for a short while
+    sqlite3_busy_timeout(m_db, atoi(CPLGetConfigOption(
+        "GDAL_WMS_CACHE_BUSY_TIMEOUT", "5000")));
+    Exec("PRAGMA journal_mode = WAL");
+    Exec("PRAGMA synchronous = NORMAL");
+    if (!Exec("BEGIN IMMEDIATE") ||
+        !Exec("CREATE TABLE IF NOT EXISTS tiles ("
+              "key TEXT PRIMARY KEY, data BLOB NOT NULL, "
+              "size INTEGER NOT NULL, created INTEGER NOT NULL, "
+              "accessed INTEGER NOT NULL)") ||
+        !Exec("CREATE INDEX IF NOT EXISTS tiles_accessed "
+              "ON tiles(accessed)") ||
+        !Exec("CREATE TABLE IF NOT EXISTS cache_info ("
+              "name TEXT PRIMARY KEY, value INTEGER NOT NULL)") ||
+        !Exec("INSERT OR IGNORE INTO cache_info VALUES ('total_size', 0)") ||
+        // Keep the total size up to date without scanning the table
+        !Exec("CREATE TRIGGER IF NOT EXISTS tiles_insert AFTER INSERT "
+              "ON tiles BEGIN UPDATE cache_info SET value = value + "
+              "NEW.size WHERE name = 'total_size'; END") ||
+        !Exec("CREATE TRIGGER IF NOT EXISTS tiles_delete AFTER DELETE "
+              "ON tiles BEGIN UPDATE cache_info SET value = value - "
+              "OLD.size WHERE name = 'total_size'; END") ||
+        !Exec("COMMIT")) {
+        CPLError(CE_Warning, CPLE_FileIO, "Cannot initialize WMS cache %s",
+                 m_db_name.c_str());
+        sqlite3_close(m_db);
+        m_db = NULL;
+        return false;
+    }
+
+    m_open_failed = false;
+    return true;
+}
+
+// Removes the least recently used tiles until the cache is back to
+// 90% of its maximum size. Must be called within a transaction.
+void GDALWMSSQLiteCache::Evict() {
+    if (m_max_size <= 0)
+        return;
+
+    GIntBig total_size = 0;
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(m_db, "SELECT value FROM cache_info "
+                           "WHERE name = 'total_size'", -1, &stmt,
+                           NULL) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+        total_size = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    if (total_size <= m_max_size)
+        return;
+
+    const GIntBig target = m_max_size / 10 * 9;
+    stmt = NULL;
+    if (sqlite3_prepare_v2(m_db, "SELECT key, size FROM tiles "
+                           "ORDER BY accessed, rowid", -1, &stmt,
+                           NULL) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return;
+    }
+    std::vector<CPLString> keys;
+    while (total_size > target && sqlite3_step(stmt) == SQLITE_ROW) {
+        keys.push_back(reinterpret_cast<const char *>(
+            sqlite3_column_text(stmt, 0)));
+        total_size -= sqlite3_column_int64(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+
+    stmt = NULL;
+    if (sqlite3_prepare_v2(m_db, "DELETE FROM tiles WHERE key = ?", -1,
+                           &stmt, NULL) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return;
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+        sqlite3_bind_text(stmt, 1, keys[i].c_str(), -1, SQLITE_STATIC);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    CPLDebug("WMS", "Cache: evicted %d tiles from %s",
+             static_cast<int>(keys.size()), m_db_name.c_str());
+}
+
+// Warns if it fails to write, but returns success
+CPLErr GDALWMSSQLiteCache::Write(const char *key, const CPLString &file_name) {
+    GByte *data = NULL;
+    vsi_l_offset size = 0;
+    if (!VSIIngestFile(NULL, file_name, &data, &size, INT_MAX))
+        return CE_None;
+
+    CPLMutexHolderD(&m_mutex);
+    bool ok = false;
+    if (Open() && Exec("BEGIN IMMEDIATE")) {
+        sqlite3_stmt *stmt = NULL;
+        const GIntBig now = static_cast<GIntBig>(time(NULL));
+        // Not INSERT OR REPLACE, so that the delete trigger is fired
+        if (sqlite3_prepare_v2(m_db, "DELETE FROM tiles WHERE key = ?", -1,
+                               &stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+        }
+        sqlite3_finalize(stmt);
+        stmt = NULL;
+        if (ok && sqlite3_prepare_v2(m_db, "INSERT INTO tiles "
+                                     "VALUES (?, ?, ?, ?, ?)", -1, &stmt,
+                                     NULL) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+            sqlite3_bind_blob(stmt, 2, data, static_cast<int>(size),
+                              SQLITE_STATIC);
+            sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(size));
+            sqlite3_bind_int64(stmt, 4, now);
+            sqlite3_bind_int64(stmt, 5, now);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+        }
+        else
+            ok = false;
+        sqlite3_finalize(stmt);
+        if (ok)
+            Evict();
+        ok = Exec(ok ? "COMMIT" : "ROLLBACK") && ok;
+    }
+    CPLFree(data);
+
+    if (!ok)
+        CPLError(CE_Warning, CPLE_FileIO, "Error writing to WMS cache %s",
+                 m_db_name.c_str());
+    return CE_None;
+}
+
+CPLErr GDALWMSSQLiteCache::Read(const char *key, CPLString *file_name) {
+    CPLMutexHolderD(&m_mutex);
+    if (!Open())
+        return CE_Failure;
+
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(m_db, "SELECT data, created, accessed "
+                           "FROM tiles WHERE key = ?", -1, &stmt,
+                           NULL) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return CE_Failure;
+    }
+    sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        sqlite3_finalize(stmt);
+        return CE_Failure;
+    }
+
+    const GIntBig now = static_cast<GIntBig>(time(NULL));
+    const GIntBig created = sqlite3_column_int64(stmt, 1);
+    const GIntBig accessed = sqlite3_column_int64(stmt, 2);
+    if (m_expires > 0 && now - created > m_expires) {
+        sqlite3_finalize(stmt);
+        stmt = NULL;
+        if (sqlite3_prepare_v2(m_db, "DELETE FROM tiles WHERE key = ?", -1,
+                               &stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+            sqlite3_step(stmt);
+        }
+        sqlite3_finalize(stmt);
+        return CE_Failure;
+    }
+
+    // The in-memory copy is owned by the /vsimem/ file until Release()
+    const int size = sqlite3_column_bytes(stmt, 0);
+    GByte *data = static_cast<GByte *>(VSI_MALLOC_VERBOSE(size > 0 ? size : 1));
+    if (data == NULL) {
+        sqlite3_finalize(stmt);
+        return CE_Failure;
+    }
+    if (size > 0)
+        memcpy(data, sqlite3_column_blob(stmt, 0), size);
+    sqlite3_finalize(stmt);
+
+    CPLString mem_file;
+    mem_file.Printf("/vsimem/wmscache/%p_%d", this, m_file_counter++);
+    VSIFCloseL(VSIFileFromMemBuffer(mem_file, data, size, TRUE));
+    *file_name = mem_file;
+
+    if (now - accessed >= ACCESS_TIME_RESOLUTION) {
+        stmt = NULL;
+        if (sqlite3_prepare_v2(m_db, "UPDATE tiles SET accessed = ? "
+                               "WHERE key = ?", -1, &stmt,
+                               NULL) == SQLITE_OK) {
+            sqlite3_bind_int64(stmt, 1, now);
+            sqlite3_bind_text(stmt, 2, key, -1, SQLITE_STATIC);
+            sqlite3_step(stmt);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return CE_None;
+}
+
+void GDALWMSSQLiteCache::Release(const CPLString &file_name) {
+    VSIUnlink(file_name);
+}
+
+#endif // HAVE_SQLITE
+
+/************************************************************************/
+/*                            GDALWMSCache                              */
+/************************************************************************/
+
+GDALWMSCache::GDALWMSCache() :
+    m_impl(NULL)
+{}
+
+GDALWMSCache::~GDALWMSCache() {
+    delete m_impl;
+}
+
+CPLErr GDALWMSCache::Initialize(CPLXMLNode *config) {
+    const char *xmlcache_path = CPLGetXMLValue(config, "Path", NULL);
+    const char *usercache_path = CPLGetConfigOption("GDAL_DEFAULT_WMS_CACHE_PATH", NULL);
+    CPLString cache_path;
+    if(xmlcache_path)
+    {
+        cache_path = xmlcache_path;
+    }
+    else
+    {
+        if(usercache_path)
+        {
+            cache_path = usercache_path;
+        }
+        else
+        {
+            cache_path = "./gdalwmscache";
+        }
+    }
+
+    delete m_impl;
+    m_impl = NULL;
+
+    const char *cache_type = CPLGetXMLValue(config, "Type", "file");
+    if (EQUAL(cache_type, "sqlite"))
+    {
+#ifdef HAVE_SQLITE
+        const GIntBig max_size = CPLAtoGIntBig(CPLGetXMLValue(config, "MaxSize", "0"));
+        const int expires = atoi(CPLGetXMLValue(config, "Expires", "0"));
+        m_impl = new GDALWMSSQLiteCache(
+            CPLFormFilename(cache_path, "gdalwmscache.sqlite", NULL),
+            max_size, expires);
+        return CE_None;
+#else
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "GDALWMS: SQLite cache requested, but GDAL built without SQLite support.");
+        return CE_Failure;
+#endif
+    }
+    else if (!EQUAL(cache_type, "file"))
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "GDALWMS: Unsupported cache type %s.", cache_type);
+        return CE_Failure;
+    }
+
+    const char *cache_depth = CPLGetXMLValue(config, "Depth", "2");
+    const char *cache_extension = CPLGetXMLValue(config, "Extension", "");
+    m_impl = new GDALWMSFileCache(cache_path, atoi(cache_depth), cache_extension);
+
+    return CE_None;
+}
+
+CPLErr GDALWMSCache::Write(const char *key, const CPLString &file_name) {
+    if (m_impl == NULL)
+        return CE_Failure;
+    return m_impl->Write(key, file_name);
+}
+
+CPLErr GDALWMSCache::Read(const char *key, CPLString *file_name) {
+    if (m_impl == NULL)
+        return CE_Failure;
+    return m_impl->Read(key, file_name);
+}
+
+void GDALWMSCache::Release(const CPLString &file_name) {
+    if (m_impl != NULL)
+        m_impl->Release(file_name);
+}
@@ -138,6 +138,7 @@ CPLErr GDALWMSRasterBand::ReadBlocks(int x, int y, void *buffer, int bx0, int by
                             if (ReadBlockFromFile(ix, iy, file_name, nBand, p, 0) == CE_None)
                                 need_this_block = false;
                         }
+                        cache->Release(file_name);
                     }
                 }
             }
@@ -220,6 +220,19 @@ void WMSDeregister(GDALDriver *);
 /*                            GDALWMSCache                              */
 /************************************************************************/
 
+// Storage backend of the cache
+class GDALWMSCacheImpl {
+public:
+    virtual ~GDALWMSCacheImpl() {}
+
+    // Store a copy of file_name under key
+    virtual CPLErr Write(const char *key, const CPLString &file_name) = 0;
+    // Sets file_name to a file holding the content stored under key
+    virtual CPLErr Read(const char *key, CPLString *file_name) = 0;
+    // Called once done with a file name returned by Read()
+    virtual void Release(const CPLString & /* file_name */) {}
+};
+
 class GDALWMSCache {
 public:
     GDALWMSCache();
@@ -230,14 +243,11 @@ public:
     CPLErr Write(const char *key, const CPLString &file_name);
     // Bad name for this function, it only tests that the file is in cache and returns the real name
     CPLErr Read(const char *key, CPLString *file_name);
+    // Must be called once done with a file name returned by Read()
+    void Release(const CPLString &file_name);
 
 protected:
-    CPLString KeyToCacheFile(const char *key);
-
-protected:
-    CPLString m_cache_path;
-    CPLString m_postfix;
-    int m_cache_depth;
+    GDALWMSCacheImpl *m_impl;
 };
 
 /************************************************************************/
@@ -514,6 +514,8 @@ GDALDatasetH CPL_DLL CPL_STDCALL GDALOpenEx( const char* pszFilename,
                                              const char* const* papszSiblingFiles ) CPL_WARN_UNUSED_RESULT;
 
 int          CPL_DLL CPL_STDCALL GDALDumpOpenDatasets( FILE * );
+char CPL_DLL **GDALGetOpenProbeStatistics( void );
+void CPL_DLL GDALResetOpenProbeStatistics( void );
 
 GDALDriverH CPL_DLL CPL_STDCALL GDALGetDriverByName( const char * );
 int CPL_DLL         CPL_STDCALL GDALGetDriverCount( void );
@@ -923,6 +925,15 @@ int CPL_DLL CPL_STDCALL GDALGetDataCoverageStatus( GDALRasterBandH hBand,
                                                    int nMaskFlagStop,
                                                    double* pdfDataPct );
 
+CPLErr CPL_DLL CPL_STDCALL GDALRasterQueryPoints( GDALRasterBandH hBand,
+                                                  int nPointCount,
+                                                  const double* padfX,
+                                                  const double* padfY,
+                                                  GDALRIOResampleAlg eResampleAlg,
+                                                  double* padfValues,
+                                                  int* pabValid,
+                                                  char** papszOptions ) CPL_WARN_UNUSED_RESULT;
+
 /* ==================================================================== */
 /*     GDALAsyncReader                                                  */
 /* ==================================================================== */
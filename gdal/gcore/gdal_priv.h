@@ -435,6 +435,7 @@ class CPL_DLL GDALDataset : public GDALMajorObject
     int                 EnterReadWrite(GDALRWFlag eRWFlag);
     void                LeaveReadWrite();
     void                InitRWLock();
+    int                 HasReadWriteMutex();
 
     void                TemporarilyDropReadWriteLock();
     void                ReacquireReadWriteLock();
@@ -660,11 +661,21 @@ class CPL_DLL GDALRasterBlock
 
     bool                 bMustDetach;
 
+    GDALRasterBlock     *poNextDirty;
+    GDALRasterBlock     *poPreviousDirty;
+    bool                 bInDirtyList;
+
     void        Detach_unlocked( void );
     void        Touch_unlocked( void );
+    void        AddToDirtyList_unlocked( void );
+    void        RemoveFromDirtyList_unlocked( void );
 
     void        RecycleFor( int nXOffIn, int nYOffIn );
 
+    static void RequestWriteBack();
+    static void WriteBackThread( void * );
+    static int  FlushWriteBackBlock();
+
   public:
                 GDALRasterBlock( GDALRasterBand *, int, int );
                 GDALRasterBlock( int nXOffIn, int nYOffIn ); /* only for lookup purpose */
@@ -729,6 +740,8 @@ class CPL_DLL GDALRasterBlock
 
     static void EnterDisableDirtyBlockFlush();
     static void LeaveDisableDirtyBlockFlush();
+    static void EnterDisableDirtyBlockFlushForThread();
+    static void LeaveDisableDirtyBlockFlushForThread();
 
 #ifdef notdef
     static void CheckNonOrphanedBlocks(GDALRasterBand* poBand);
@@ -808,6 +821,8 @@ class CPL_DLL GDALAbstractBandBlockCache
 
             GDALRasterBlock* CreateBlock(int nXBlockOff, int nYBlockOff);
             void             AddBlockToFreeList( GDALRasterBlock * );
+            void             AddKeepAlive();
+            void             DropKeepAlive();
 
             virtual bool             Init() = 0;
             virtual bool             IsInitOK() = 0;
@@ -883,6 +898,7 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
     int          EnterReadWrite(GDALRWFlag eRWFlag);
     void         LeaveReadWrite();
     void         InitRWLock();
+    int          HasReadWriteMutex();
 //! @endcond
 
   protected:
@@ -1047,6 +1063,12 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
                                int nMaskFlagStop = 0,
                                double* pdfDataPct = NULL );
 
+    CPLErr QueryPoints( int nPointCount,
+                        const double* padfX, const double* padfY,
+                        GDALRIOResampleAlg eResampleAlg,
+                        double* padfValues, int* pabValid,
+                        char** papszOptions = NULL ) CPL_WARN_UNUSED_RESULT;
+
     void ReportError(CPLErr eErrClass, CPLErrorNum err_no, const char *fmt, ...)  CPL_PRINT_FUNC_FORMAT (4, 5);
 
 private:
@@ -1538,6 +1560,8 @@ void GDALNullifyProxyPoolSingleton();
 GDALDriver* GDALGetAPIPROXYDriver();
 void GDALSetResponsiblePIDForCurrentThread(GIntBig responsiblePID);
 GIntBig GDALGetResponsiblePIDForCurrentThread();
+void GDALCleanupOpenDispatch();
+void GDALOpenInfoCleanupSiblingCache();
 
 CPLString GDALFindAssociatedFile( const char *pszBasename, const char *pszExt,
                                   char **papszSiblingFiles, int nFlags );
@@ -115,6 +115,30 @@ void GDALAbstractBandBlockCache::AddBlockToFreeList( GDALRasterBlock *poBlock )
         psListBlocksToFree = poBlock;
     }
 
+    DropKeepAlive();
+}
+
+/************************************************************************/
+/*                            AddKeepAlive()                            */
+/*                                                                      */
+/*      Prevent the band from being destroyed, without unreferencing    */
+/*      any block.  This is used by the block cache write-back thread   */
+/*      while it waits for the dataset read/write mutex.  Must be       */
+/*      called under the block cache mutex, on a band that still has    */
+/*      blocks in the LRU list.                                         */
+/************************************************************************/
+
+void GDALAbstractBandBlockCache::AddKeepAlive()
+{
+    CPLAtomicInc(&nKeepAliveCounter);
+}
+
+/************************************************************************/
+/*                           DropKeepAlive()                            */
+/************************************************************************/
+
+void GDALAbstractBandBlockCache::DropKeepAlive()
+{
     // If no more blocks in transient state, then warn WaitKeepAliveCounter()
     CPLAcquireMutex(hCondMutex, 1000);
     if( CPLAtomicDec(&nKeepAliveCounter) == 0 )
@@ -37,6 +37,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <chrono>
 #include <map>
 #include <new>
 #include <string>
@@ -2575,6 +2576,242 @@ GDALOpen( const char * pszFilename, GDALAccess eAccess )
     return hDataset;
 }
 
+/************************************************************************/
+/* ==================================================================== */
+/*            Open dispatch hints and probe statistics                  */
+/* ==================================================================== */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+namespace {
+struct GDALOpenProbeStats
+{
+    GIntBig nIdentifyCount = 0;
+    GIntBig nOpenCount = 0;
+    GIntBig nSuccessCount = 0;
+    double  dfSeconds = 0.0;
+};
+}
+
+// Protects the two maps below.
+static CPLMutex *hOpenDispatchMutex = NULL;
+// Hint key (see GDALGetOpenDriverHintKey()) -> driver short name.
+static std::map<CPLString, CPLString> *poMapOpenDriverHints = NULL;
+// Driver short name -> statistics, when GDAL_OPEN_PROBE_STATS=YES.
+static std::map<CPLString, GDALOpenProbeStats> *poMapOpenProbeStats = NULL;
+
+constexpr size_t MAX_OPEN_DRIVER_HINTS = 1000;
+constexpr int OPEN_DRIVER_HINT_HEADER_BYTES = 16;
+
+/************************************************************************/
+/*                      GDALGetOpenDriverHintKey()                      */
+/************************************************************************/
+
+/* Files sharing the same extension and leading bytes are very likely */
+/* to be handled by the same driver. */
+static CPLString GDALGetOpenDriverHintKey( const GDALOpenInfo& oOpenInfo )
+{
+    CPLString osKey;
+    if( oOpenInfo.nHeaderBytes == 0 )
+        return osKey;
+
+    osKey.Printf("%d:%s:",
+                 oOpenInfo.nOpenFlags & (GDAL_OF_KIND_MASK | GDAL_OF_UPDATE),
+                 CPLString(CPLGetExtension(oOpenInfo.pszFilename))
+                    .tolower().c_str());
+    const int nBytes =
+        std::min(OPEN_DRIVER_HINT_HEADER_BYTES, oOpenInfo.nHeaderBytes);
+    for( int i = 0; i < nBytes; i++ )
+        osKey += CPLSPrintf("%02X", oOpenInfo.pabyHeader[i]);
+    return osKey;
+}
+
+/************************************************************************/
+/*                     GDALGetOpenDriverHint()                          */
+/************************************************************************/
+
+static GDALDriver *GDALGetOpenDriverHint( const CPLString& osKey )
+{
+    if( osKey.empty() )
+        return NULL;
+
+    CPLString osDriverName;
+    {
+        CPLMutexHolderD(&hOpenDispatchMutex);
+        if( poMapOpenDriverHints == NULL )
+            return NULL;
+        std::map<CPLString, CPLString>::const_iterator oIter =
+            poMapOpenDriverHints->find(osKey);
+        if( oIter == poMapOpenDriverHints->end() )
+            return NULL;
+        osDriverName = oIter->second;
+    }
+    return GetGDALDriverManager()->GetDriverByName(osDriverName);
+}
+
+/************************************************************************/
+/*                     GDALSetOpenDriverHint()                          */
+/************************************************************************/
+
+/* Passing a NULL driver removes the hint. */
+static void GDALSetOpenDriverHint( const CPLString& osKey,
+                                   GDALDriver *poDriver )
+{
+    if( osKey.empty() )
+        return;
+
+    CPLMutexHolderD(&hOpenDispatchMutex);
+    if( poDriver == NULL )
+    {
+        if( poMapOpenDriverHints != NULL )
+            poMapOpenDriverHints->erase(osKey);
+        return;
+    }
+    if( poMapOpenDriverHints == NULL )
+        poMapOpenDriverHints = new std::map<CPLString, CPLString>();
+    else if( poMapOpenDriverHints->size() >= MAX_OPEN_DRIVER_HINTS )
+        poMapOpenDriverHints->clear();
+    (*poMapOpenDriverHints)[osKey] = poDriver->GetDescription();
+}
+
+/************************************************************************/
+/*                 GDALOpenIdentifiedBeforeHintDriver()                 */
+/************************************************************************/
+
+/* Returns true if a driver registered before the hinted driver, and of */
+/* the requested kind, positively identifies the file. The hint must not */
+/* be used then, so that the registration order still decides. */
+static bool GDALOpenIdentifiedBeforeHintDriver( GDALDriverManager *poDM,
+                                                GDALDriver *poHintDriver,
+                                                GDALOpenInfo *poOpenInfo )
+{
+    const int nOpenFlags = poOpenInfo->nOpenFlags;
+    for( int iDriver = 0; iDriver < poDM->GetDriverCount(); ++iDriver )
+    {
+        GDALDriver *poDriver = poDM->GetDriver(iDriver);
+        if( poDriver == poHintDriver )
+            break;
+        if( (nOpenFlags & GDAL_OF_RASTER) != 0 &&
+            (nOpenFlags & GDAL_OF_VECTOR) == 0 &&
+            poDriver->GetMetadataItem(GDAL_DCAP_RASTER) == NULL )
+            continue;
+        if( (nOpenFlags & GDAL_OF_VECTOR) != 0 &&
+            (nOpenFlags & GDAL_OF_RASTER) == 0 &&
+            poDriver->GetMetadataItem(GDAL_DCAP_VECTOR) == NULL )
+            continue;
+        if( poDriver->pfnIdentify && poDriver->pfnIdentify(poOpenInfo) > 0 )
+            return true;
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                     GDALAddOpenProbeStats()                          */
+/************************************************************************/
+
+static void GDALAddOpenProbeStats( GDALDriver *poDriver,
+                                   bool bIdentifyCalled, bool bOpenCalled,
+                                   bool bSuccess, double dfSeconds,
+                                   const char *pszFilename )
+{
+    CPLDebug("GDAL", "Open probe of %s by %s: %s%s%s, %.3f ms",
+             pszFilename, poDriver->GetDescription(),
+             bIdentifyCalled ? "identify" : "",
+             bIdentifyCalled && bOpenCalled ? "+" : "",
+             bOpenCalled ? (bSuccess ? "open (success)" : "open (failed)") :
+                           "",
+             dfSeconds * 1000.0);
+
+    CPLMutexHolderD(&hOpenDispatchMutex);
+    if( poMapOpenProbeStats == NULL )
+        poMapOpenProbeStats = new std::map<CPLString, GDALOpenProbeStats>();
+    GDALOpenProbeStats& sStats =
+        (*poMapOpenProbeStats)[poDriver->GetDescription()];
+    if( bIdentifyCalled )
+        sStats.nIdentifyCount++;
+    if( bOpenCalled )
+        sStats.nOpenCount++;
+    if( bSuccess )
+        sStats.nSuccessCount++;
+    sStats.dfSeconds += dfSeconds;
+}
+
+/************************************************************************/
+/*                      GDALCleanupOpenDispatch()                       */
+/************************************************************************/
+
+void GDALCleanupOpenDispatch()
+{
+    delete poMapOpenDriverHints;
+    poMapOpenDriverHints = NULL;
+    delete poMapOpenProbeStats;
+    poMapOpenProbeStats = NULL;
+    if( hOpenDispatchMutex != NULL )
+    {
+        CPLDestroyMutex(hOpenDispatchMutex);
+        hOpenDispatchMutex = NULL;
+    }
+    GDALOpenInfoCleanupSiblingCache();
+}
+//! @endcond
+
+/************************************************************************/
+/*                    GDALGetOpenProbeStatistics()                      */
+/************************************************************************/
+
+/**
+ * \brief Return the statistics of driver probes done by GDALOpenEx().
+ *
+ * Statistics are only collected when the GDAL_OPEN_PROBE_STATS
+ * configuration option is set to YES. Each probe is also traced as a
+ * CPLDebug() message in that case.
+ *
+ * The returned list has one DRIVER=identify_count,open_count,success_count,
+ * milliseconds entry per driver that has been probed, where milliseconds
+ * is the cumulated time spent in the Identify() and Open() callbacks of the
+ * driver.
+ *
+ * @return a list to free with CSLDestroy(), or NULL.
+ * @since GDAL 2.3
+ */
+char **GDALGetOpenProbeStatistics( void )
+{
+    CPLMutexHolderD(&hOpenDispatchMutex);
+    if( poMapOpenProbeStats == NULL )
+        return NULL;
+
+    CPLStringList aosList;
+    for( std::map<CPLString, GDALOpenProbeStats>::const_iterator oIter =
+             poMapOpenProbeStats->begin();
+         oIter != poMapOpenProbeStats->end(); ++oIter )
+    {
+        aosList.SetNameValue(
+            oIter->first,
+            CPLSPrintf(CPL_FRMT_GIB "," CPL_FRMT_GIB "," CPL_FRMT_GIB ",%.3f",
+                       oIter->second.nIdentifyCount,
+                       oIter->second.nOpenCount,
+                       oIter->second.nSuccessCount,
+                       oIter->second.dfSeconds * 1000.0));
+    }
+    return aosList.StealList();
+}
+
+/************************************************************************/
+/*                   GDALResetOpenProbeStatistics()                     */
+/************************************************************************/
+
+/**
+ * \brief Reset the statistics returned by GDALGetOpenProbeStatistics().
+ *
+ * @since GDAL 2.3
+ */
+void GDALResetOpenProbeStatistics( void )
+{
+    CPLMutexHolderD(&hOpenDispatchMutex);
+    delete poMapOpenProbeStats;
+    poMapOpenProbeStats = NULL;
+}
+
 /************************************************************************/
 /*                             GDALOpenEx()                             */
 /************************************************************************/
@@ -2656,6 +2893,16 @@ GDALOpen( const char * pszFilename, GDALAccess eAccess )
  * filenames that are auxiliary to the main filename. If NULL is passed, a
  * probing of the file system will be done.
  *
+ * Starting with GDAL 2.3, the driver that opened a file is remembered,
+ * for the extension and the first bytes of the file, and tried first for
+ * the next files that have the same characteristics, provided its Identify()
+ * callback positively recognizes them and no driver registered before it
+ * does. Hints are not used when papszAllowedDrivers or papszOpenOptions are
+ * set. This can be disabled by setting the
+ * GDAL_OPEN_DRIVER_HINTS configuration option to NO. The cost of the driver
+ * probes can be collected with the GDAL_OPEN_PROBE_STATS configuration option
+ * (see GDALGetOpenProbeStatistics()).
+ *
  * @return A GDALDatasetH handle or NULL on failure.  For C++ applications
  * this handle can be cast to a GDALDataset *.
  *
@@ -2759,17 +3006,50 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
 
     oOpenInfo.papszOpenOptions = papszOpenOptionsCleaned;
 
-    for( int iDriver = -1; iDriver < poDM->GetDriverCount(); ++iDriver )
+    // Driver that opened a similar file previously: it is tried first, right
+    // after the API proxy driver. Hints are neither used nor recorded when
+    // the drivers are restricted or open options are passed, as the driver
+    // chosen then does not reflect the normal probing order.
+    const bool bUseDriverHints =
+        papszAllowedDrivers == NULL &&
+        CSLCount(const_cast<char **>(papszOpenOptions)) == 0 &&
+        CPLTestBool(CPLGetConfigOption("GDAL_OPEN_DRIVER_HINTS", "YES"));
+    const CPLString osHintKey(
+        bUseDriverHints ? GDALGetOpenDriverHintKey(oOpenInfo) : CPLString());
+    GDALDriver *poHintDriver = GDALGetOpenDriverHint(osHintKey);
+    GDALDriver * const poRecordedHintDriver = poHintDriver;
+    if( poHintDriver != NULL &&
+        GDALOpenIdentifiedBeforeHintDriver(poDM, poHintDriver, &oOpenInfo) )
+    {
+        poHintDriver = NULL;
+    }
+    bool bHintDriverTried = false;
+
+    const bool bProbeStats =
+        CPLTestBool(CPLGetConfigOption("GDAL_OPEN_PROBE_STATS", "NO"));
+
+    for( int iDriver = -2; iDriver < poDM->GetDriverCount(); ++iDriver )
     {
         GDALDriver *poDriver = NULL;
 
-        if( iDriver < 0 )
+        if( iDriver == -2 )
         {
             poDriver = GDALGetAPIPROXYDriver();
         }
         else
         {
-            poDriver = poDM->GetDriver(iDriver);
+            if( iDriver == -1 )
+            {
+                poDriver = poHintDriver;
+                if( poDriver == NULL )
+                    continue;
+            }
+            else
+            {
+                poDriver = poDM->GetDriver(iDriver);
+                if( poDriver == poHintDriver && bHintDriverTried )
+                    continue;
+            }
             if (papszAllowedDrivers != NULL &&
                 CSLFindString(papszAllowedDrivers,
                               GDALGetDriverShortName(poDriver)) == -1)
@@ -2807,8 +3087,33 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
             papszTmpOpenOptionsToValidate = papszOptionsToValidate;
         }
 
+        const std::chrono::steady_clock::time_point oProbeStart =
+            bProbeStats ? std::chrono::steady_clock::now() :
+                          std::chrono::steady_clock::time_point();
+
         const bool bIdentifyRes =
             poDriver->pfnIdentify && poDriver->pfnIdentify(&oOpenInfo) > 0;
+
+        // The hinted driver is only used if it positively recognizes the
+        // file. Otherwise it is tried at its normal position.
+        if( iDriver == -1 && !bIdentifyRes )
+        {
+            if( bProbeStats )
+            {
+                GDALAddOpenProbeStats(poDriver, true, false, false,
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - oProbeStart)
+                        .count(),
+                    pszFilename);
+            }
+            CSLDestroy(papszTmpOpenOptions);
+            CSLDestroy(papszTmpOpenOptionsToValidate);
+            oOpenInfo.papszOpenOptions = papszOpenOptionsCleaned;
+            continue;
+        }
+        if( iDriver == -1 )
+            bHintDriverTried = true;
+
         if( bIdentifyRes )
         {
             GDALValidateOpenOptions(poDriver, papszOptionsToValidate);
@@ -2834,18 +3139,52 @@ GDALDatasetH CPL_STDCALL GDALOpenEx( const char *pszFilename,
         }
         else
         {
+            if( bProbeStats && poDriver->pfnIdentify )
+            {
+                GDALAddOpenProbeStats(poDriver, true, false, false,
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - oProbeStart)
+                        .count(),
+                    pszFilename);
+            }
             CSLDestroy(papszTmpOpenOptions);
             CSLDestroy(papszTmpOpenOptionsToValidate);
             oOpenInfo.papszOpenOptions = papszOpenOptionsCleaned;
             continue;
         }
 
+        if( bProbeStats )
+        {
+            GDALAddOpenProbeStats(poDriver, poDriver->pfnIdentify != NULL,
+                true, poDS != NULL,
+                std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - oProbeStart).count(),
+                pszFilename);
+        }
+
         CSLDestroy(papszTmpOpenOptions);
         CSLDestroy(papszTmpOpenOptionsToValidate);
         oOpenInfo.papszOpenOptions = papszOpenOptionsCleaned;
 
         if( poDS != NULL )
         {
+            // Only remember drivers whose Identify() positively recognizes
+            // the file, as only those can be used as a hint. If there was
+            // a hint for this file but another driver opened it, the hint
+            // is stale and is dropped rather than replaced.
+            if( bUseDriverHints && iDriver >= 0 )
+            {
+                if( poRecordedHintDriver == NULL )
+                {
+                    if( bIdentifyRes )
+                        GDALSetOpenDriverHint(osHintKey, poDriver);
+                }
+                else if( poDriver != poRecordedHintDriver )
+                {
+                    GDALSetOpenDriverHint(osHintKey, NULL);
+                }
+            }
+
             poDS->nOpenFlags = nOpenFlags;
 
             if( strlen(poDS->GetDescription()) == 0 )
@@ -6767,6 +7106,23 @@ void GDALDataset::InitRWLock()
     }
 }
 
+/************************************************************************/
+/*                          HasReadWriteMutex()                         */
+/*                                                                      */
+/*      Whether all writes of blocks of this dataset, from whatever     */
+/*      thread, go through the read/write mutex.  Only meaningful       */
+/*      once a block has been marked dirty.                             */
+/************************************************************************/
+
+int GDALDataset::HasReadWriteMutex()
+{
+    GDALDatasetPrivate *psPrivate =
+        static_cast<GDALDatasetPrivate *>(m_hPrivateData);
+    return psPrivate != NULL && eAccess == GA_Update &&
+           psPrivate->eStateReadWriteMutex == RW_MUTEX_STATE_ALLOWED &&
+           psPrivate->hMutex != NULL;
+}
+
 /************************************************************************/
 /*                       DisableReadWriteMutex()                        */
 /************************************************************************/
@@ -31,6 +31,7 @@
 #include "gdal.h"
 
 #include "cpl_conv.h"
+#include "cpl_csv.h"
 #include "cpl_error.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
@@ -85,6 +86,7 @@ void GDALDestroy(void)
     /* Needed in case no driver manager has been instantiated. */
     CPLFreeConfig();
     CPLFinalizeTLS();
+    CSVCleanupSharedMutex();
     CPLCleanupErrorMutex();
     CPLCleanupMasterMutex();
 }
@@ -237,6 +237,11 @@ GDALDriverManager::~GDALDriverManager()
 /* -------------------------------------------------------------------- */
     PamCleanProxyDB();
 
+/* -------------------------------------------------------------------- */
+/*      Cleanup the open driver hints and probe statistics.             */
+/* -------------------------------------------------------------------- */
+    GDALCleanupOpenDispatch();
+
 /* -------------------------------------------------------------------- */
 /*      Blow away all the finder hints paths.  We really should not     */
 /*      be doing all of them, but it is currently hard to keep track    */
@@ -32,22 +32,52 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
 
 #include <algorithm>
+#include <map>
 #include <vector>
 
 #include "cpl_config.h"
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
 #include "gdal.h"
 
 CPL_CVSID("$Id$")
 
+// Directories whose content could not be used as a sibling list (listing
+// failed, or has too many files), with the time of the failed attempt.
+// This avoids listing again big or remote directories when opening many
+// files from them. Sibling files (.aux.xml, .ovr, ...) of files in those
+// directories are still probed with VSIStat() on each open: negative
+// results are deliberately not cached, as GDAL itself creates such files.
+static CPLMutex *hSiblingCacheMutex = NULL;
+static std::map<CPLString, time_t> *poMapUnlistableDirs = NULL;
+constexpr size_t MAX_UNLISTABLE_DIRS = 1000;
+
+//! @cond Doxygen_Suppress
+/************************************************************************/
+/*                  GDALOpenInfoCleanupSiblingCache()                   */
+/************************************************************************/
+
+void GDALOpenInfoCleanupSiblingCache()
+{
+    delete poMapUnlistableDirs;
+    poMapUnlistableDirs = NULL;
+    if( hSiblingCacheMutex != NULL )
+    {
+        CPLDestroyMutex(hSiblingCacheMutex);
+        hSiblingCacheMutex = NULL;
+    }
+}
+//! @endcond
+
 /************************************************************************/
 /* ==================================================================== */
 /*                             GDALOpenInfo                             */
@@ -291,13 +321,51 @@ char** GDALOpenInfo::GetSiblingFiles()
     CPLString osDir = CPLGetDirname( pszFilename );
     const int nMaxFiles =
         atoi(CPLGetConfigOption("GDAL_READDIR_LIMIT_ON_OPEN", "1000"));
-    papszSiblingFiles = VSIReadDirEx( osDir, nMaxFiles );
-    if( nMaxFiles > 0 && CSLCount(papszSiblingFiles) > nMaxFiles )
+
+    // Negative cache of directories that could not be listed recently.
+    const int nNegativeCacheDelay = atoi(
+        CPLGetConfigOption("GDAL_READDIR_NEGATIVE_CACHE_DELAY", "60"));
+    const CPLString osCacheKey(
+        CPLSPrintf("%d:%s", nMaxFiles, osDir.c_str()));
+    bool bKnownUnlistable = false;
+    if( nNegativeCacheDelay > 0 )
     {
-        CPLDebug("GDAL", "GDAL_READDIR_LIMIT_ON_OPEN reached on %s",
-                 osDir.c_str());
-        CSLDestroy(papszSiblingFiles);
-        papszSiblingFiles = NULL;
+        CPLMutexHolderD(&hSiblingCacheMutex);
+        if( poMapUnlistableDirs != NULL )
+        {
+            std::map<CPLString, time_t>::iterator oIter =
+                poMapUnlistableDirs->find(osCacheKey);
+            if( oIter != poMapUnlistableDirs->end() )
+            {
+                if( time(NULL) - oIter->second < nNegativeCacheDelay )
+                    bKnownUnlistable = true;
+                else
+                    poMapUnlistableDirs->erase(oIter);
+            }
+        }
+    }
+
+    if( !bKnownUnlistable )
+    {
+        papszSiblingFiles = VSIReadDirEx( osDir, nMaxFiles );
+        if( nMaxFiles > 0 && CSLCount(papszSiblingFiles) > nMaxFiles )
+        {
+            CPLDebug("GDAL", "GDAL_READDIR_LIMIT_ON_OPEN reached on %s",
+                     osDir.c_str());
+            CSLDestroy(papszSiblingFiles);
+            papszSiblingFiles = NULL;
+        }
+    }
+
+    if( papszSiblingFiles == NULL && !bKnownUnlistable &&
+        nNegativeCacheDelay > 0 )
+    {
+        CPLMutexHolderD(&hSiblingCacheMutex);
+        if( poMapUnlistableDirs == NULL )
+            poMapUnlistableDirs = new std::map<CPLString, time_t>();
+        else if( poMapUnlistableDirs->size() >= MAX_UNLISTABLE_DIRS )
+            poMapUnlistableDirs->clear();
+        (*poMapUnlistableDirs)[osCacheKey] = time(NULL);
     }
 
     /* Small optimization to avoid unnecessary stat'ing from PAux or ENVI */
@@ -0,0 +1,534 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Core
+ * Purpose:  Batch multi-point value query on a raster band.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "gdal.h"
+#include "gdal_priv.h"
+
+#include <cmath>
+#include <cstddef>
+
+#include <algorithm>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
+
+CPL_CVSID("$Id$")
+
+//! @cond Doxygen_Suppress
+
+namespace {
+
+/************************************************************************/
+/*                         GDALQueryPointsJob                           */
+/************************************************************************/
+
+/* A window of the band, read once, and the points whose anchor pixel */
+/* falls in the block it was built for. */
+struct GDALQueryPointsJob
+{
+    int                 nXOff = 0;
+    int                 nYOff = 0;
+    int                 nXSize = 0;
+    int                 nYSize = 0;
+    int                 nRasterXSize = 0;
+    int                 nRasterYSize = 0;
+    GDALRIOResampleAlg  eResampleAlg = GRIORA_NearestNeighbour;
+    bool                bHasNoData = false;
+    double              dfNoData = 0.0;
+    std::vector<double> adfWindow;
+
+    const double*       padfPixel = NULL;
+    const double*       padfLine = NULL;
+    const int*          panIndices = NULL;
+    int                 nIndexCount = 0;
+    double*             padfValues = NULL;
+
+    double              GetPixel( int iX, int iY ) const;
+    bool                IsNoData( double dfVal ) const;
+    double              Interpolate( double dfPixel, double dfLine ) const;
+    void                Process();
+};
+
+/************************************************************************/
+/*                              GetPixel()                              */
+/************************************************************************/
+
+double GDALQueryPointsJob::GetPixel( int iX, int iY ) const
+{
+    // Replicate edge pixels for kernels that overlap the raster border.
+    iX = std::max(0, std::min(nRasterXSize - 1, iX)) - nXOff;
+    iY = std::max(0, std::min(nRasterYSize - 1, iY)) - nYOff;
+    CPLAssert( iX >= 0 && iX < nXSize && iY >= 0 && iY < nYSize );
+    return adfWindow[static_cast<size_t>(iY) * nXSize + iX];
+}
+
+/************************************************************************/
+/*                              IsNoData()                              */
+/************************************************************************/
+
+bool GDALQueryPointsJob::IsNoData( double dfVal ) const
+{
+    if( CPLIsNan(dfVal) )
+        return true;
+    return bHasNoData &&
+           (dfVal == dfNoData || (CPLIsNan(dfNoData) && CPLIsNan(dfVal)));
+}
+
+/************************************************************************/
+/*                           CubicKernel()                              */
+/************************************************************************/
+
+/* Keys cubic convolution kernel with a = -0.5, as used by the warper. */
+static double CubicKernel( double dfX )
+{
+    const double dfAbsX = fabs(dfX);
+    if( dfAbsX <= 1.0 )
+        return dfAbsX * dfAbsX * (1.5 * dfAbsX - 2.5) + 1.0;
+    if( dfAbsX < 2.0 )
+        return ((-0.5 * dfAbsX + 2.5) * dfAbsX - 4.0) * dfAbsX + 2.0;
+    return 0.0;
+}
+
+/************************************************************************/
+/*                             Interpolate()                            */
+/************************************************************************/
+
+double GDALQueryPointsJob::Interpolate( double dfPixel, double dfLine ) const
+{
+    if( eResampleAlg == GRIORA_NearestNeighbour )
+    {
+        return GetPixel( static_cast<int>(floor(dfPixel)),
+                         static_cast<int>(floor(dfLine)) );
+    }
+
+    // Pixel centers are at half-integer coordinates.
+    const double dfSrcX = dfPixel - 0.5;
+    const double dfSrcY = dfLine - 0.5;
+    const int iSrcX = static_cast<int>(floor(dfSrcX));
+    const int iSrcY = static_cast<int>(floor(dfSrcY));
+    const double dfDeltaX = dfSrcX - iSrcX;
+    const double dfDeltaY = dfSrcY - iSrcY;
+
+    int nKernelMin = 0;
+    int nKernelMax = 1;
+    if( eResampleAlg == GRIORA_Cubic )
+    {
+        nKernelMin = -1;
+        nKernelMax = 2;
+    }
+
+    double dfAccumulator = 0.0;
+    double dfWeightSum = 0.0;
+    for( int j = nKernelMin; j <= nKernelMax; j++ )
+    {
+        const double dfWeightY =
+            eResampleAlg == GRIORA_Cubic ? CubicKernel(j - dfDeltaY) :
+            (j == 0 ? 1.0 - dfDeltaY : dfDeltaY);
+        for( int i = nKernelMin; i <= nKernelMax; i++ )
+        {
+            const double dfWeightX =
+                eResampleAlg == GRIORA_Cubic ? CubicKernel(i - dfDeltaX) :
+                (i == 0 ? 1.0 - dfDeltaX : dfDeltaX);
+            const double dfWeight = dfWeightX * dfWeightY;
+            if( dfWeight == 0.0 )
+                continue;
+            const double dfVal = GetPixel(iSrcX + i, iSrcY + j);
+            if( IsNoData(dfVal) )
+                continue;
+            dfAccumulator += dfWeight * dfVal;
+            dfWeightSum += dfWeight;
+        }
+    }
+
+    // Renormalize so that nodata contributors do not darken the result.
+    if( fabs(dfWeightSum) < 1e-10 )
+        return bHasNoData ? dfNoData : 0.0;
+    return dfAccumulator / dfWeightSum;
+}
+
+/************************************************************************/
+/*                               Process()                              */
+/************************************************************************/
+
+void GDALQueryPointsJob::Process()
+{
+    for( int i = 0; i < nIndexCount; i++ )
+    {
+        const int iPoint = panIndices[i];
+        padfValues[iPoint] = Interpolate(padfPixel[iPoint], padfLine[iPoint]);
+    }
+}
+
+/************************************************************************/
+/*                        GDALQueryPointsJobFunc()                      */
+/************************************************************************/
+
+static void GDALQueryPointsJobFunc( void* pData )
+{
+    GDALQueryPointsJob* psJob = static_cast<GDALQueryPointsJob*>(pData);
+    psJob->Process();
+    delete psJob;
+}
+
+} // namespace
+
+//! @endcond
+
+/************************************************************************/
+/*                             QueryPoints()                            */
+/************************************************************************/
+
+/**
+ * \brief Fetch the values of the band at a set of points.
+ *
+ * The points are grouped by the block that contains them, so that each
+ * block is read only once whatever the order of the input coordinates.
+ * Values are returned in the order of the input points.
+ *
+ * Coordinates are expressed in pixel/line space (where the top left corner
+ * of the top left pixel is at 0,0), or in georeferenced space when the
+ * COORDINATES=GEOREF option is set, in which case the geotransform of the
+ * dataset that owns the band is used to convert them.
+ *
+ * With GRIORA_Bilinear or GRIORA_Cubic, values are interpolated from the
+ * neighbouring pixel centers. Pixels at nodata are excluded from the
+ * interpolation kernel, and the remaining weights are renormalized.
+ * Other resampling methods are not supported.
+ *
+ * Only the real part of complex bands is returned.
+ *
+ * The following options are supported:
+ * <ul>
+ * <li>COORDINATES=PIXEL/GEOREF: how to interpret padfX and padfY.
+ *     Defaults to PIXEL.</li>
+ * <li>NUM_THREADS=number_of_threads/ALL_CPUS: number of worker threads used
+ *     to interpolate values while blocks are being read. Defaults to 1.</li>
+ * </ul>
+ *
+ * This method is the same as the C function GDALRasterQueryPoints().
+ *
+ * @param nPointCount number of points.
+ * @param padfX array of nPointCount X (pixel or easting) coordinates.
+ * @param padfY array of nPointCount Y (line or northing) coordinates.
+ * @param eResampleAlg GRIORA_NearestNeighbour, GRIORA_Bilinear or
+ *                     GRIORA_Cubic.
+ * @param padfValues output array of nPointCount values. Points outside of
+ *                   the raster get the nodata value if there is one, or 0.
+ * @param pabValid optional output array of nPointCount flags, set to TRUE
+ *                 for points that fall inside the raster. May be NULL.
+ * @param papszOptions NULL terminated list of options, or NULL.
+ *
+ * @return CE_None on success or CE_Failure if an error occurred.
+ *
+ * @since GDAL 2.3
+ */
+
+CPLErr GDALRasterBand::QueryPoints( int nPointCount,
+                                    const double* padfX, const double* padfY,
+                                    GDALRIOResampleAlg eResampleAlg,
+                                    double* padfValues, int* pabValid,
+                                    char** papszOptions )
+{
+    if( nPointCount < 0 )
+    {
+        ReportError( CE_Failure, CPLE_IllegalArg,
+                     "Invalid point count: %d", nPointCount );
+        return CE_Failure;
+    }
+    if( nPointCount == 0 )
+        return CE_None;
+    if( padfX == NULL || padfY == NULL || padfValues == NULL )
+    {
+        ReportError( CE_Failure, CPLE_IllegalArg,
+                     "padfX, padfY and padfValues must not be NULL" );
+        return CE_Failure;
+    }
+    if( eResampleAlg != GRIORA_NearestNeighbour &&
+        eResampleAlg != GRIORA_Bilinear &&
+        eResampleAlg != GRIORA_Cubic )
+    {
+        ReportError( CE_Failure, CPLE_NotSupported,
+                     "Only nearest, bilinear and cubic resampling are "
+                     "supported" );
+        return CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Convert coordinates to pixel/line space.                        */
+/* -------------------------------------------------------------------- */
+    std::vector<double> adfPixel;
+    std::vector<double> adfLine;
+    try
+    {
+        adfPixel.resize(nPointCount);
+        adfLine.resize(nPointCount);
+    }
+    catch( const std::bad_alloc& )
+    {
+        ReportError( CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate working arrays" );
+        return CE_Failure;
+    }
+
+    const char* pszCoordinates =
+        CSLFetchNameValueDef(papszOptions, "COORDINATES", "PIXEL");
+    if( EQUAL(pszCoordinates, "GEOREF") )
+    {
+        double adfGeoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+        double adfInvGeoTransform[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+        if( poDS == NULL ||
+            poDS->GetGeoTransform(adfGeoTransform) != CE_None ||
+            !GDALInvGeoTransform(adfGeoTransform, adfInvGeoTransform) )
+        {
+            ReportError( CE_Failure, CPLE_AppDefined,
+                         "Cannot get an invertible geotransform to convert "
+                         "georeferenced coordinates" );
+            return CE_Failure;
+        }
+        for( int i = 0; i < nPointCount; i++ )
+        {
+            adfPixel[i] = adfInvGeoTransform[0]
+                        + adfInvGeoTransform[1] * padfX[i]
+                        + adfInvGeoTransform[2] * padfY[i];
+            adfLine[i] = adfInvGeoTransform[3]
+                       + adfInvGeoTransform[4] * padfX[i]
+                       + adfInvGeoTransform[5] * padfY[i];
+        }
+    }
+    else if( EQUAL(pszCoordinates, "PIXEL") )
+    {
+        std::copy(padfX, padfX + nPointCount, adfPixel.begin());
+        std::copy(padfY, padfY + nPointCount, adfLine.begin());
+    }
+    else
+    {
+        ReportError( CE_Failure, CPLE_NotSupported,
+                     "Unsupported value for COORDINATES: %s", pszCoordinates );
+        return CE_Failure;
+    }
+
+    int bHasNoData = FALSE;
+    const double dfNoData = GetNoDataValue(&bHasNoData);
+    const double dfInvalidValue = bHasNoData ? dfNoData : 0.0;
+
+/* -------------------------------------------------------------------- */
+/*      Sort the valid points by the block of their anchor pixel.       */
+/* -------------------------------------------------------------------- */
+    const int nXBlocks = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
+    std::vector<GIntBig> anBlockIds;
+    std::vector<int> anIndices;
+    try
+    {
+        anBlockIds.resize(nPointCount);
+        anIndices.reserve(nPointCount);
+    }
+    catch( const std::bad_alloc& )
+    {
+        ReportError( CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate working arrays" );
+        return CE_Failure;
+    }
+
+    for( int i = 0; i < nPointCount; i++ )
+    {
+        const double dfPixel = adfPixel[i];
+        const double dfLine = adfLine[i];
+        // Written so that NaN coordinates are rejected.
+        const bool bInside = dfPixel >= 0.0 && dfPixel < nRasterXSize &&
+                             dfLine >= 0.0 && dfLine < nRasterYSize;
+        if( pabValid != NULL )
+            pabValid[i] = bInside;
+        if( !bInside )
+        {
+            padfValues[i] = dfInvalidValue;
+            continue;
+        }
+        const int iX = std::min(nRasterXSize - 1, static_cast<int>(dfPixel));
+        const int iY = std::min(nRasterYSize - 1, static_cast<int>(dfLine));
+        anBlockIds[i] = static_cast<GIntBig>(iY / nBlockYSize) *
+                            nXBlocks + iX / nBlockXSize;
+        anIndices.push_back(i);
+    }
+
+    std::stable_sort(anIndices.begin(), anIndices.end(),
+                     [&anBlockIds](int a, int b)
+                     { return anBlockIds[a] < anBlockIds[b]; });
+
+/* -------------------------------------------------------------------- */
+/*      Setup the worker pool if requested.                             */
+/* -------------------------------------------------------------------- */
+    const char* pszNumThreads =
+        CSLFetchNameValueDef(papszOptions, "NUM_THREADS", "1");
+    int nThreads = EQUAL(pszNumThreads, "ALL_CPUS") ? CPLGetNumCPUs() :
+                                                      atoi(pszNumThreads);
+    nThreads = std::max(1, std::min(nThreads, 128));
+
+    CPLWorkerThreadPool* poPool = NULL;
+    if( nThreads > 1 && anIndices.size() > 1 )
+    {
+        poPool = new CPLWorkerThreadPool();
+        if( !poPool->Setup(nThreads, NULL, NULL) )
+        {
+            delete poPool;
+            poPool = NULL;
+        }
+    }
+
+    // Kernel reach beyond the anchor pixel.
+    const int nMargin = eResampleAlg == GRIORA_Cubic ? 2 :
+                        eResampleAlg == GRIORA_Bilinear ? 1 : 0;
+
+/* -------------------------------------------------------------------- */
+/*      Read each block (plus the kernel margin) once.                  */
+/* -------------------------------------------------------------------- */
+    CPLErr eErr = CE_None;
+    size_t iStart = 0;
+    while( iStart < anIndices.size() && eErr == CE_None )
+    {
+        const GIntBig nBlockId = anBlockIds[anIndices[iStart]];
+        size_t iEnd = iStart + 1;
+        while( iEnd < anIndices.size() &&
+               anBlockIds[anIndices[iEnd]] == nBlockId )
+            iEnd++;
+
+        const int nXBlock = static_cast<int>(nBlockId % nXBlocks);
+        const int nYBlock = static_cast<int>(nBlockId / nXBlocks);
+
+        GDALQueryPointsJob* psJob = new GDALQueryPointsJob();
+        psJob->nRasterXSize = nRasterXSize;
+        psJob->nRasterYSize = nRasterYSize;
+        psJob->eResampleAlg = eResampleAlg;
+        psJob->bHasNoData = CPL_TO_BOOL(bHasNoData);
+        psJob->dfNoData = dfNoData;
+        psJob->padfPixel = &adfPixel[0];
+        psJob->padfLine = &adfLine[0];
+        psJob->panIndices = &anIndices[iStart];
+        psJob->nIndexCount = static_cast<int>(iEnd - iStart);
+        psJob->padfValues = padfValues;
+
+        if( nMargin == 0 && psJob->nIndexCount == 1 )
+        {
+            // A single nearest neighbour sample: no need to read the
+            // whole block.
+            const int iPoint = anIndices[iStart];
+            psJob->nXOff = std::min(nRasterXSize - 1,
+                                    static_cast<int>(adfPixel[iPoint]));
+            psJob->nYOff = std::min(nRasterYSize - 1,
+                                    static_cast<int>(adfLine[iPoint]));
+            psJob->nXSize = 1;
+            psJob->nYSize = 1;
+        }
+        else
+        {
+            psJob->nXOff = std::max(0, nXBlock * nBlockXSize - nMargin);
+            psJob->nYOff = std::max(0, nYBlock * nBlockYSize - nMargin);
+            psJob->nXSize = std::min(nRasterXSize,
+                (nXBlock + 1) * nBlockXSize + nMargin) - psJob->nXOff;
+            psJob->nYSize = std::min(nRasterYSize,
+                (nYBlock + 1) * nBlockYSize + nMargin) - psJob->nYOff;
+        }
+
+        try
+        {
+            psJob->adfWindow.resize(
+                static_cast<size_t>(psJob->nXSize) * psJob->nYSize);
+        }
+        catch( const std::bad_alloc& )
+        {
+            ReportError( CE_Failure, CPLE_OutOfMemory,
+                         "Cannot allocate %d x %d window",
+                         psJob->nXSize, psJob->nYSize );
+            delete psJob;
+            eErr = CE_Failure;
+            break;
+        }
+
+        eErr = RasterIO( GF_Read, psJob->nXOff, psJob->nYOff,
+                         psJob->nXSize, psJob->nYSize,
+                         &psJob->adfWindow[0], psJob->nXSize, psJob->nYSize,
+                         GDT_Float64, 0, 0, NULL );
+        if( eErr != CE_None )
+        {
+            delete psJob;
+            break;
+        }
+
+        if( poPool != NULL )
+        {
+            // Bound the number of windows held in memory.
+            poPool->WaitCompletion(2 * nThreads);
+            poPool->SubmitJob(GDALQueryPointsJobFunc, psJob);
+        }
+        else
+        {
+            GDALQueryPointsJobFunc(psJob);
+        }
+
+        iStart = iEnd;
+    }
+
+    if( poPool != NULL )
+    {
+        poPool->WaitCompletion();
+        delete poPool;
+    }
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                        GDALRasterQueryPoints()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the values of the band at a set of points.
+ *
+ * @see GDALRasterBand::QueryPoints()
+ * @since GDAL 2.3
+ */
+
+CPLErr CPL_STDCALL GDALRasterQueryPoints( GDALRasterBandH hBand,
+                                          int nPointCount,
+                                          const double* padfX,
+                                          const double* padfY,
+                                          GDALRIOResampleAlg eResampleAlg,
+                                          double* padfValues,
+                                          int* pabValid,
+                                          char** papszOptions )
+{
+    VALIDATE_POINTER1( hBand, "GDALRasterQueryPoints", CE_Failure );
+
+    GDALRasterBand *poBand = static_cast<GDALRasterBand *>(hBand);
+    return poBand->QueryPoints( nPointCount, padfX, padfY, eResampleAlg,
+                                padfValues, pabValid, papszOptions );
+}
@@ -6998,6 +6998,17 @@ void GDALRasterBand::InitRWLock()
         poDS->InitRWLock();
 }
 
+/************************************************************************/
+/*                          HasReadWriteMutex()                         */
+/************************************************************************/
+
+int GDALRasterBand::HasReadWriteMutex()
+{
+    if( poDS != NULL )
+        return poDS->HasReadWriteMutex();
+    return FALSE;
+}
+
 //! @endcond
 
 /**
@@ -33,6 +33,7 @@
 #include "gdal_priv.h"
 
 #include <climits>
+#include <cstdlib>
 #include <cstring>
 
 #include "cpl_atomic_ops.h"
@@ -54,6 +55,34 @@ static GDALRasterBlock *poNewest = NULL;  // Head.
 
 static int nDisableDirtyBlockFlushCounter = 0;
 
+// Background write-back of dirty blocks (GDAL_CACHE_WRITEBACK=YES).
+static bool bWriteBackInitialized = false;
+static bool bWriteBackEnabled = false;
+static int nWriteBackHighWaterMarkPct = 50;
+static CPLMutex *hWriteBackMutex = NULL;
+static CPLCond *hWriteBackCond = NULL;
+static CPLJoinableThread *hWriteBackThread = NULL;
+static volatile bool bWriteBackRequested = false;
+static volatile bool bStopWriteBack = false;
+
+// Dirty blocks the write-back thread can write, in the order they were
+// marked dirty, and their total size.  Protected by the block cache lock.
+static GDALRasterBlock *poOldestDirty = NULL;  // Tail.
+static GDALRasterBlock *poNewestDirty = NULL;  // Head.
+static volatile GIntBig nDirtyCacheUsed = 0;
+
+/************************************************************************/
+/*                  IsDirtyBlockFlushDisabledForThread()                */
+/************************************************************************/
+
+static bool IsDirtyBlockFlushDisabledForThread()
+{
+    int bMemoryErrorOccurred = FALSE;
+    const int* pnCounter = static_cast<int *>(
+        CPLGetTLSEx(CTLS_DISABLEDIRTYBLOCKFLUSH, &bMemoryErrorOccurred));
+    return pnCounter != NULL && *pnCounter > 0;
+}
+
 #if 0
 static CPLMutex *hRBLock = NULL;
 #define INITIALIZE_LOCK CPLMutexHolderD( &hRBLock )
@@ -100,6 +129,63 @@ static CPLLockType GetLockType()
 
 //#define ENABLE_DEBUG
 
+/************************************************************************/
+/*                         IsWriteBackEnabled()                         */
+/************************************************************************/
+
+static bool IsWriteBackEnabled()
+{
+    if( !bWriteBackInitialized )
+    {
+        CPLMutexHolderD( &hWriteBackMutex );
+        if( !bWriteBackInitialized )
+        {
+            bWriteBackEnabled = CPLTestBool(
+                CPLGetConfigOption("GDAL_CACHE_WRITEBACK", "NO"));
+            nWriteBackHighWaterMarkPct = atoi(
+                CPLGetConfigOption("GDAL_CACHE_WRITEBACK_HIGH_WATER_MARK",
+                                   "50"));
+            if( nWriteBackHighWaterMarkPct < 0 )
+                nWriteBackHighWaterMarkPct = 0;
+            else if( nWriteBackHighWaterMarkPct > 100 )
+                nWriteBackHighWaterMarkPct = 100;
+            bWriteBackInitialized = true;
+        }
+    }
+    return bWriteBackEnabled;
+}
+
+/************************************************************************/
+/*                         StopWriteBackThread()                        */
+/************************************************************************/
+
+static void StopWriteBackThread()
+{
+    if( hWriteBackMutex == NULL )
+        return;
+
+    CPLJoinableThread *hThread = NULL;
+    {
+        CPLMutexHolderD( &hWriteBackMutex );
+        bStopWriteBack = true;
+        if( hWriteBackCond != NULL )
+            CPLCondSignal( hWriteBackCond );
+        hThread = hWriteBackThread;
+        hWriteBackThread = NULL;
+    }
+    if( hThread != NULL )
+        CPLJoinThread( hThread );
+
+    if( hWriteBackCond != NULL )
+        CPLDestroyCond( hWriteBackCond );
+    hWriteBackCond = NULL;
+    CPLDestroyMutex( hWriteBackMutex );
+    hWriteBackMutex = NULL;
+    bWriteBackInitialized = false;
+    bWriteBackRequested = false;
+    bStopWriteBack = false;
+}
+
 /************************************************************************/
 /*                          GDALSetCacheMax()                           */
 /************************************************************************/
@@ -395,6 +481,17 @@ int CPL_STDCALL GDALFlushCacheBlock()
  * be discarded.  Other (Clean) blocks may just be discarded if their memory
  * needs to be recovered.
  *
+ * Dirty blocks are normally written by the thread that needs room in the
+ * cache, in the middle of its own RasterIO() requests.  Starting with
+ * GDAL 2.3, setting the GDAL_CACHE_WRITEBACK configuration option to YES
+ * starts a background thread that writes the oldest dirty blocks as soon
+ * as they use more than GDAL_CACHE_WRITEBACK_HIGH_WATER_MARK percent
+ * (50 by default) of the cache.  When the cache is full of dirty blocks
+ * anyway, the thread that needs room still writes them itself, which
+ * slows down producers to the pace of the writes.  Only blocks of datasets
+ * opened in update mode, whose writes are serialized by their read/write
+ * mutex, are written by the background thread.
+ *
  * In normal situations applications do not interact directly with the
  * GDALRasterBlock - instead it it utilized by the RasterIO() interfaces
  * to implement caching.
@@ -431,6 +528,8 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
 
 {
     GDALRasterBlock *poTarget;
+    const bool bDirtyFlushDisabledForThread =
+        IsDirtyBlockFlushDisabledForThread();
 
     {
         INITIALIZE_LOCK;
@@ -438,7 +537,11 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
 
         while( poTarget != NULL )
         {
-            if( !bDirtyBlocksOnly ||
+            if( poTarget->GetDirty() && bDirtyFlushDisabledForThread )
+            {
+                // Skip it.
+            }
+            else if( !bDirtyBlocksOnly ||
                 (poTarget->GetDirty() && nDisableDirtyBlockFlushCounter == 0) )
             {
                 if( CPLAtomicCompareAndExchange(
@@ -550,6 +653,66 @@ void GDALRasterBlock::LeaveDisableDirtyBlockFlush()
     CPLAtomicDec(&nDisableDirtyBlockFlushCounter);
 }
 
+/************************************************************************/
+/*               EnterDisableDirtyBlockFlushForThread()                 */
+/************************************************************************/
+
+/**
+ * \brief Starts preventing dirty blocks from being flushed by the current
+ * thread.
+ *
+ * Contrary to EnterDisableDirtyBlockFlush(), this only affects block cache
+ * evictions triggered from the calling thread. This is useful for a helper
+ * thread that reads from a dataset while another thread writes into a
+ * different dataset : the helper thread must not call IWriteBlock() on the
+ * datasets of the writing thread, but the writing thread can still flush its
+ * own dirty blocks.
+ *
+ * This call must be paired with a corresponding
+ * LeaveDisableDirtyBlockFlushForThread() in the same thread.
+ *
+ * @since GDAL 2.3
+ */
+
+void GDALRasterBlock::EnterDisableDirtyBlockFlushForThread()
+{
+    int bMemoryErrorOccurred = FALSE;
+    int* pnCounter = static_cast<int *>(
+        CPLGetTLSEx(CTLS_DISABLEDIRTYBLOCKFLUSH, &bMemoryErrorOccurred));
+    if( bMemoryErrorOccurred )
+        return;
+    if( pnCounter == NULL )
+    {
+        pnCounter = static_cast<int *>(VSI_CALLOC_VERBOSE(1, sizeof(int)));
+        if( pnCounter == NULL )
+            return;
+        CPLSetTLS(CTLS_DISABLEDIRTYBLOCKFLUSH, pnCounter, TRUE);
+    }
+    (*pnCounter)++;
+}
+
+/************************************************************************/
+/*               LeaveDisableDirtyBlockFlushForThread()                 */
+/************************************************************************/
+
+/**
+ * \brief Ends preventing dirty blocks from being flushed by the current
+ * thread.
+ *
+ * Undoes the effect of EnterDisableDirtyBlockFlushForThread().
+ *
+ * @since GDAL 2.3
+ */
+
+void GDALRasterBlock::LeaveDisableDirtyBlockFlushForThread()
+{
+    int bMemoryErrorOccurred = FALSE;
+    int* pnCounter = static_cast<int *>(
+        CPLGetTLSEx(CTLS_DISABLEDIRTYBLOCKFLUSH, &bMemoryErrorOccurred));
+    if( pnCounter != NULL && *pnCounter > 0 )
+        (*pnCounter)--;
+}
+
 /************************************************************************/
 /*                          GDALRasterBlock()                           */
 /************************************************************************/
@@ -582,7 +745,10 @@ GDALRasterBlock::GDALRasterBlock( GDALRasterBand *poBandIn,
     poBand(poBandIn),
     poNext(NULL),
     poPrevious(NULL),
-    bMustDetach(true)
+    bMustDetach(true),
+    poNextDirty(NULL),
+    poPreviousDirty(NULL),
+    bInDirtyList(false)
 {
     CPLAssert( poBandIn != NULL );
     poBand->GetBlockSize( &nXSize, &nYSize );
@@ -618,7 +784,10 @@ GDALRasterBlock::GDALRasterBlock( int nXOffIn, int nYOffIn ) :
     poBand(NULL),
     poNext(NULL),
     poPrevious(NULL),
-    bMustDetach(false)
+    bMustDetach(false),
+    poNextDirty(NULL),
+    poPreviousDirty(NULL),
+    bInDirtyList(false)
 {}
 
 /************************************************************************/
@@ -641,6 +810,10 @@ void GDALRasterBlock::RecycleFor( int nXOffIn, int nYOffIn )
     poNext = NULL;
     poPrevious = NULL;
 
+    poNextDirty = NULL;
+    poPreviousDirty = NULL;
+    bInDirtyList = false;
+
     nXOff = nXOffIn;
     nYOff = nYOffIn;
     bMustDetach = true;
@@ -661,6 +834,12 @@ GDALRasterBlock::~GDALRasterBlock()
 {
     Detach();
 
+    if( bInDirtyList )
+    {
+        TAKE_LOCK;
+        RemoveFromDirtyList_unlocked();
+    }
+
     if( pData != NULL )
     {
         VSIFreeAligned( pData );
@@ -719,6 +898,8 @@ void GDALRasterBlock::Detach_unlocked()
     if( pData )
         nCacheUsed -= GetBlockSize();
 
+    RemoveFromDirtyList_unlocked();
+
 #ifdef ENABLE_DEBUG
     Verify();
 #endif
@@ -930,6 +1111,9 @@ CPLErr GDALRasterBlock::Internalize()
     // No risk of overflow as it is checked in GDALRasterBand::InitBlockInfo().
     const int nSizeInBytes = GetBlockSize();
 
+    const bool bDirtyFlushDisabledForThread =
+        IsDirtyBlockFlushDisabledForThread();
+
 /* -------------------------------------------------------------------- */
 /*      Flush old blocks if we are nearing our memory limit.            */
 /* -------------------------------------------------------------------- */
@@ -951,7 +1135,8 @@ CPLErr GDALRasterBlock::Internalize()
                 while( poTarget != NULL )
                 {
                     if( !poTarget->GetDirty() ||
-                        nDisableDirtyBlockFlushCounter == 0 )
+                        (nDisableDirtyBlockFlushCounter == 0 &&
+                         !bDirtyFlushDisabledForThread) )
                     {
                         if( CPLAtomicCompareAndExchange(
                                 &(poTarget->nLockCount), 0, -1) )
@@ -1038,6 +1223,16 @@ CPLErr GDALRasterBlock::Internalize()
     }
     while(bLoopAgain);
 
+/* -------------------------------------------------------------------- */
+/*      Wake up the write-back thread if we are above the high water    */
+/*      mark, so that dirty blocks are written while we go on.          */
+/* -------------------------------------------------------------------- */
+    if( IsWriteBackEnabled() &&
+        nDirtyCacheUsed > nCurCacheMax / 100 * nWriteBackHighWaterMarkPct )
+    {
+        RequestWriteBack();
+    }
+
     if( pNewData == NULL )
     {
         pNewData = VSI_MALLOC_ALIGNED_AUTO_VERBOSE( nSizeInBytes );
@@ -1052,6 +1247,182 @@ CPLErr GDALRasterBlock::Internalize()
     return CE_None;
 }
 
+/************************************************************************/
+/*                          RequestWriteBack()                          */
+/*                                                                      */
+/*      Wake up the write-back thread, starting it the first time.      */
+/************************************************************************/
+
+void GDALRasterBlock::RequestWriteBack()
+{
+    // Can be safely tested outside the lock: the thread will rescan the
+    // whole cache anyway.
+    if( bWriteBackRequested )
+        return;
+
+    CPLMutexHolderD( &hWriteBackMutex );
+    if( bStopWriteBack )
+        return;
+    if( hWriteBackCond == NULL )
+        hWriteBackCond = CPLCreateCond();
+    if( hWriteBackCond == NULL )
+        return;
+    if( hWriteBackThread == NULL )
+    {
+        hWriteBackThread = CPLCreateJoinableThread(WriteBackThread, NULL);
+        if( hWriteBackThread == NULL )
+            return;
+    }
+    bWriteBackRequested = true;
+    CPLCondSignal( hWriteBackCond );
+}
+
+/************************************************************************/
+/*                          WriteBackThread()                           */
+/*                                                                      */
+/*      Body of the write-back thread.  Each time it is woken up, it    */
+/*      writes the oldest dirty blocks until the amount of dirty data   */
+/*      in the cache goes below the high water mark.                    */
+/************************************************************************/
+
+void GDALRasterBlock::WriteBackThread( void * /* pUnused */ )
+{
+    // Room needed by the IWriteBlock() implementations run from this
+    // thread must only be taken on clean blocks.
+    EnterDisableDirtyBlockFlushForThread();
+
+    CPLAcquireMutex( hWriteBackMutex, 1000.0 );
+    while( !bStopWriteBack )
+    {
+        if( !bWriteBackRequested )
+        {
+            CPLCondWait( hWriteBackCond, hWriteBackMutex );
+            continue;
+        }
+        bWriteBackRequested = false;
+        CPLReleaseMutex( hWriteBackMutex );
+
+        while( !bStopWriteBack && FlushWriteBackBlock() )
+        {
+            /* go on */
+        }
+
+        CPLAcquireMutex( hWriteBackMutex, 1000.0 );
+    }
+    CPLReleaseMutex( hWriteBackMutex );
+
+    LeaveDisableDirtyBlockFlushForThread();
+}
+
+/************************************************************************/
+/*                        FlushWriteBackBlock()                         */
+/*                                                                      */
+/*      Write and release the oldest dirty block, if the amount of      */
+/*      dirty data is above the high water mark.                        */
+/*                                                                      */
+/*      Only blocks of datasets whose writes are serialized by the      */
+/*      read/write mutex are considered.  The mutex is taken before     */
+/*      the block is removed from its band, so that a reader cannot     */
+/*      fetch the previous content of the block from disk while it is   */
+/*      being written.  In the meantime, the band is kept alive with    */
+/*      its keep alive counter, as done for the blocks in transient     */
+/*      state in Internalize().                                         */
+/*                                                                      */
+/*      Returns TRUE if another block might be flushed.                 */
+/************************************************************************/
+
+int GDALRasterBlock::FlushWriteBackBlock()
+
+{
+    const GIntBig nHighWaterMark =
+        GDALGetCacheMax64() / 100 * nWriteBackHighWaterMarkPct;
+
+    GDALRasterBand *poBand = NULL;
+    int nXBlockOff = 0;
+    int nYBlockOff = 0;
+    {
+        TAKE_LOCK;
+
+        if( nDisableDirtyBlockFlushCounter > 0 ||
+            nDirtyCacheUsed <= nHighWaterMark )
+            return FALSE;
+
+        GDALRasterBlock *poCandidate = poOldestDirty;
+        while( poCandidate != NULL )
+        {
+            GDALRasterBlock *poNextCandidate = poCandidate->poPreviousDirty;
+            if( !poCandidate->poBand->HasReadWriteMutex() )
+            {
+                // The read/write mutex of the dataset has been disabled
+                // since the block was marked dirty.
+                poCandidate->RemoveFromDirtyList_unlocked();
+            }
+            else if( poCandidate->nLockCount == 0 )
+            {
+                break;
+            }
+            poCandidate = poNextCandidate;
+        }
+
+        if( poCandidate == NULL )
+            return FALSE;
+
+        poBand = poCandidate->poBand;
+        nXBlockOff = poCandidate->nXOff;
+        nYBlockOff = poCandidate->nYOff;
+        poBand->poBandBlockCache->AddKeepAlive();
+    }
+
+    if( !poBand->EnterReadWrite(GF_Write) )
+    {
+        poBand->poBandBlockCache->DropKeepAlive();
+        return FALSE;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Fetch the block again, now that nobody else can write into      */
+/*      this dataset, and remove it from the cache if nobody else has   */
+/*      it locked.                                                      */
+/* -------------------------------------------------------------------- */
+    GDALRasterBlock *poBlock =
+        poBand->TryGetLockedBlockRef(nXBlockOff, nYBlockOff);
+    bool bDetached = false;
+    if( poBlock != NULL )
+    {
+        TAKE_LOCK;
+        if( poBlock->GetDirty() &&
+            CPLAtomicCompareAndExchange(&(poBlock->nLockCount), 1, -1) )
+        {
+            poBlock->Detach_unlocked();
+            poBand->UnreferenceBlock(poBlock);
+            bDetached = true;
+        }
+        else
+        {
+            poBlock->DropLock();
+        }
+    }
+
+    if( bDetached )
+    {
+        const CPLErr eErr = poBlock->Write();
+        if( eErr != CE_None )
+        {
+            // Save the error for later reporting.
+            poBand->SetFlushBlockErr(eErr);
+        }
+
+        VSIFreeAligned(poBlock->pData);
+        poBlock->pData = NULL;
+        poBand->AddBlockToFreeList(poBlock);
+    }
+
+    poBand->LeaveReadWrite();
+    poBand->poBandBlockCache->DropKeepAlive();
+
+    return TRUE;
+}
+
 /************************************************************************/
 /*                             MarkDirty()                              */
 /************************************************************************/
@@ -1067,7 +1438,18 @@ void GDALRasterBlock::MarkDirty()
 {
     bDirty = true;
     if( poBand )
+    {
         poBand->InitRWLock();
+
+        // Keep track of the blocks the write-back thread can write.
+        if( !bInDirtyList && pData != NULL && IsWriteBackEnabled() &&
+            poBand->HasReadWriteMutex() )
+        {
+            TAKE_LOCK;
+            if( bDirty && !bInDirtyList )
+                AddToDirtyList_unlocked();
+        }
+    }
 }
 
 /************************************************************************/
@@ -1081,7 +1463,63 @@ void GDALRasterBlock::MarkDirty()
  * to disk before it can be flushed.
  */
 
-void GDALRasterBlock::MarkClean() { bDirty = false; }
+void GDALRasterBlock::MarkClean()
+{
+    bDirty = false;
+    if( bInDirtyList )
+    {
+        TAKE_LOCK;
+        RemoveFromDirtyList_unlocked();
+    }
+}
+
+/************************************************************************/
+/*                      AddToDirtyList_unlocked()                       */
+/*                                                                      */
+/*      Must be called with the block cache lock held.                  */
+/************************************************************************/
+
+void GDALRasterBlock::AddToDirtyList_unlocked()
+{
+    CPLAssert( !bInDirtyList );
+
+    poPreviousDirty = NULL;
+    poNextDirty = poNewestDirty;
+    if( poNewestDirty != NULL )
+        poNewestDirty->poPreviousDirty = this;
+    poNewestDirty = this;
+    if( poOldestDirty == NULL )
+        poOldestDirty = this;
+
+    bInDirtyList = true;
+    nDirtyCacheUsed += GetBlockSize();
+}
+
+/************************************************************************/
+/*                    RemoveFromDirtyList_unlocked()                    */
+/*                                                                      */
+/*      Must be called with the block cache lock held.                  */
+/************************************************************************/
+
+void GDALRasterBlock::RemoveFromDirtyList_unlocked()
+{
+    if( !bInDirtyList )
+        return;
+
+    if( poOldestDirty == this )
+        poOldestDirty = poPreviousDirty;
+    if( poNewestDirty == this )
+        poNewestDirty = poNextDirty;
+    if( poPreviousDirty != NULL )
+        poPreviousDirty->poNextDirty = poNextDirty;
+    if( poNextDirty != NULL )
+        poNextDirty->poPreviousDirty = poPreviousDirty;
+
+    poPreviousDirty = NULL;
+    poNextDirty = NULL;
+    bInDirtyList = false;
+    nDirtyCacheUsed -= GetBlockSize();
+}
 
 /************************************************************************/
 /*                          DestroyRBMutex()                           */
@@ -1090,6 +1528,7 @@ void GDALRasterBlock::MarkClean() { bDirty = false; }
 /*! @cond Doxygen_Suppress */
 void GDALRasterBlock::DestroyRBMutex()
 {
+    StopWriteBackThread();
     if( hRBLock != NULL )
         DESTROY_LOCK;
     hRBLock = NULL;
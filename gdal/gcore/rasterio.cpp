@@ -42,10 +42,12 @@
 #include <algorithm>
 #include <limits>
 #include <stdexcept>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_cpu_features.h"
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
@@ -4257,6 +4259,247 @@ static void GDALCopyWholeRasterGetSwathSize(
     *pnSwathLines = nSwathLines;
 }
 
+/************************************************************************/
+/*                 GDALCopyWholeRasterGetPipelineDepth()                */
+/************************************************************************/
+
+// Returns the number of swath buffers to use for a pipelined copy, or 0
+// if reading and writing must be done sequentially in the calling thread.
+static int GDALCopyWholeRasterGetPipelineDepth(
+                                        const char * const * papszOptions )
+{
+    const char* pszPipeline = CSLFetchNameValueDef(
+        const_cast<char **>(papszOptions), "PIPELINE",
+        CPLGetConfigOption("GDAL_COPY_WHOLE_RASTER_PIPELINE", "NO") );
+    if( EQUAL(pszPipeline, "YES") || EQUAL(pszPipeline, "ON") ||
+        EQUAL(pszPipeline, "TRUE") )
+        return 2;
+    const int nBuffers = atoi(pszPipeline);
+    if( nBuffers <= 1 )
+        return 0;
+    return std::min(nBuffers, 16);
+}
+
+/************************************************************************/
+/*                    GDALCopyWholeRasterPipeline                       */
+/************************************************************************/
+
+namespace {
+
+struct GDALCopyWholeRasterSwath
+{
+    int    nBand;       // 0 for all bands at once (pixel interleaved case).
+    int    iX;
+    int    iY;
+    int    nXSize;
+    int    nYSize;
+    bool   bHasData;
+    bool   bRead;
+    CPLErr eErr;
+};
+
+struct GDALCopyWholeRasterPipeline
+{
+    GDALDataset    *poSrcDS;
+    GDALRasterBand *poSrcBand;
+    GDALDataType    eDT;
+    int             nBandCount;
+
+    std::vector<GDALCopyWholeRasterSwath> asSwaths;
+    std::vector<void*> apBuffers;
+
+    CPLMutex       *hMutex;
+    CPLCond        *hCond;
+    size_t          nNextToRead;
+    size_t          nWritten;
+    bool            bStop;
+};
+
+}  // namespace
+
+/************************************************************************/
+/*                   GDALCopyWholeRasterReaderThread()                  */
+/************************************************************************/
+
+static void GDALCopyWholeRasterReaderThread( void* pData )
+{
+    GDALCopyWholeRasterPipeline* psPipeline =
+        static_cast<GDALCopyWholeRasterPipeline*>(pData);
+    const size_t nBuffers = psPipeline->apBuffers.size();
+
+    // The writing thread owns the dirty blocks of the target dataset.
+    GDALRasterBlock::EnterDisableDirtyBlockFlushForThread();
+
+    CPLAcquireMutex(psPipeline->hMutex, 1000.0);
+    while( true )
+    {
+        while( !psPipeline->bStop &&
+               psPipeline->nNextToRead < psPipeline->asSwaths.size() &&
+               psPipeline->nNextToRead >= psPipeline->nWritten + nBuffers )
+        {
+            CPLCondWait(psPipeline->hCond, psPipeline->hMutex);
+        }
+        if( psPipeline->bStop ||
+            psPipeline->nNextToRead == psPipeline->asSwaths.size() )
+        {
+            break;
+        }
+        const size_t iSwath = psPipeline->nNextToRead;
+        GDALCopyWholeRasterSwath& sSwath = psPipeline->asSwaths[iSwath];
+        void* pBuffer = psPipeline->apBuffers[iSwath % nBuffers];
+        CPLReleaseMutex(psPipeline->hMutex);
+
+        CPLErr eErr = CE_None;
+        if( sSwath.bHasData && psPipeline->poSrcDS != NULL )
+        {
+            eErr = psPipeline->poSrcDS->RasterIO(
+                GF_Read, sSwath.iX, sSwath.iY, sSwath.nXSize, sSwath.nYSize,
+                pBuffer, sSwath.nXSize, sSwath.nYSize, psPipeline->eDT,
+                sSwath.nBand == 0 ? psPipeline->nBandCount : 1,
+                sSwath.nBand == 0 ? NULL : &sSwath.nBand,
+                0, 0, 0, NULL );
+        }
+        else if( sSwath.bHasData )
+        {
+            eErr = psPipeline->poSrcBand->RasterIO(
+                GF_Read, sSwath.iX, sSwath.iY, sSwath.nXSize, sSwath.nYSize,
+                pBuffer, sSwath.nXSize, sSwath.nYSize, psPipeline->eDT,
+                0, 0, NULL );
+        }
+
+        CPLAcquireMutex(psPipeline->hMutex, 1000.0);
+        sSwath.eErr = eErr;
+        sSwath.bRead = true;
+        psPipeline->nNextToRead++;
+        if( eErr != CE_None )
+            psPipeline->bStop = true;
+        CPLCondSignal(psPipeline->hCond);
+    }
+    CPLReleaseMutex(psPipeline->hMutex);
+
+    GDALRasterBlock::LeaveDisableDirtyBlockFlushForThread();
+}
+
+/************************************************************************/
+/*                    GDALCopyWholeRasterPipelined()                    */
+/************************************************************************/
+
+// Reads the swaths from the source in a helper thread, while the calling
+// thread writes the previously read swaths into the target, so that
+// reading and writing (and typically decompression and compression)
+// overlap. Progress is only reported from the calling thread.
+static CPLErr GDALCopyWholeRasterPipelined(
+    GDALDataset* poSrcDS, GDALDataset* poDstDS,
+    GDALRasterBand* poSrcBand, GDALRasterBand* poDstBand,
+    const std::vector<GDALCopyWholeRasterSwath>& asSwaths,
+    GDALDataType eDT, int nBandCount,
+    int nBuffers, size_t nBufferSize,
+    GDALProgressFunc pfnProgress, void *pProgressData )
+{
+    GDALCopyWholeRasterPipeline sPipeline;
+    sPipeline.poSrcDS = poSrcDS;
+    sPipeline.poSrcBand = poSrcBand;
+    sPipeline.eDT = eDT;
+    sPipeline.nBandCount = nBandCount;
+    sPipeline.asSwaths = asSwaths;
+    sPipeline.nNextToRead = 0;
+    sPipeline.nWritten = 0;
+    sPipeline.bStop = false;
+
+    CPLErr eErr = CE_None;
+    for( int i = 0; i < nBuffers; i++ )
+    {
+        void* pBuffer = VSI_MALLOC_VERBOSE(nBufferSize);
+        if( pBuffer == NULL )
+        {
+            eErr = CE_Failure;
+            break;
+        }
+        sPipeline.apBuffers.push_back(pBuffer);
+    }
+
+    sPipeline.hMutex = CPLCreateMutex();
+    if( sPipeline.hMutex )
+        CPLReleaseMutex(sPipeline.hMutex);
+    sPipeline.hCond = CPLCreateCond();
+    CPLJoinableThread* hThread = NULL;
+    if( eErr == CE_None && sPipeline.hMutex != NULL &&
+        sPipeline.hCond != NULL )
+    {
+        hThread = CPLCreateJoinableThread(GDALCopyWholeRasterReaderThread,
+                                          &sPipeline);
+    }
+    if( hThread == NULL )
+    {
+        if( eErr == CE_None )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Cannot start reader thread for pipelined copy");
+        }
+        eErr = CE_Failure;
+    }
+
+    const size_t nSwaths = sPipeline.asSwaths.size();
+    for( size_t iSwath = 0; eErr == CE_None && iSwath < nSwaths; iSwath++ )
+    {
+        CPLAcquireMutex(sPipeline.hMutex, 1000.0);
+        while( !sPipeline.asSwaths[iSwath].bRead )
+            CPLCondWait(sPipeline.hCond, sPipeline.hMutex);
+        GDALCopyWholeRasterSwath sSwath = sPipeline.asSwaths[iSwath];
+        CPLReleaseMutex(sPipeline.hMutex);
+
+        eErr = sSwath.eErr;
+        void* pBuffer = sPipeline.apBuffers[iSwath % nBuffers];
+        if( eErr == CE_None && sSwath.bHasData && poDstDS != NULL )
+        {
+            eErr = poDstDS->RasterIO(
+                GF_Write, sSwath.iX, sSwath.iY, sSwath.nXSize, sSwath.nYSize,
+                pBuffer, sSwath.nXSize, sSwath.nYSize, eDT,
+                sSwath.nBand == 0 ? nBandCount : 1,
+                sSwath.nBand == 0 ? NULL : &sSwath.nBand,
+                0, 0, 0, NULL );
+        }
+        else if( eErr == CE_None && sSwath.bHasData )
+        {
+            eErr = poDstBand->RasterIO(
+                GF_Write, sSwath.iX, sSwath.iY, sSwath.nXSize, sSwath.nYSize,
+                pBuffer, sSwath.nXSize, sSwath.nYSize, eDT,
+                0, 0, NULL );
+        }
+
+        CPLAcquireMutex(sPipeline.hMutex, 1000.0);
+        sPipeline.nWritten++;
+        CPLCondSignal(sPipeline.hCond);
+        CPLReleaseMutex(sPipeline.hMutex);
+
+        if( eErr == CE_None &&
+            !pfnProgress( (iSwath + 1) / static_cast<double>(nSwaths),
+                          NULL, pProgressData ) )
+        {
+            eErr = CE_Failure;
+            CPLError( CE_Failure, CPLE_UserInterrupt,
+                      "User terminated CreateCopy()" );
+        }
+    }
+
+    if( hThread != NULL )
+    {
+        CPLAcquireMutex(sPipeline.hMutex, 1000.0);
+        sPipeline.bStop = true;
+        CPLCondSignal(sPipeline.hCond);
+        CPLReleaseMutex(sPipeline.hMutex);
+        CPLJoinThread(hThread);
+    }
+    if( sPipeline.hCond )
+        CPLDestroyCond(sPipeline.hCond);
+    if( sPipeline.hMutex )
+        CPLDestroyMutex(sPipeline.hMutex);
+    for( size_t i = 0; i < sPipeline.apBuffers.size(); i++ )
+        VSIFree(sPipeline.apBuffers[i]);
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                     GDALDatasetCopyWholeRaster()                     */
 /************************************************************************/
@@ -4281,6 +4524,13 @@ static void GDALCopyWholeRasterGetSwathSize(
  * achieve best compression.</li>
  * <li>"SKIP_HOLES=YES" to skip chunks for which GDALGetDataCoverageStatus()
  * returns GDAL_DATA_COVERAGE_STATUS_EMPTY (GDAL &gt;= 2.2)</li>
+ * <li>"PIPELINE=YES/NO/number_of_buffers" to read the next swaths from the
+ * source in a helper thread while the current swath is written to the target.
+ * YES uses 2 swath buffers (double buffering), and a number between 2 and 16
+ * can be given instead. Memory use is multiplied by the number of buffers.
+ * Defaults to the value of the GDAL_COPY_WHOLE_RASTER_PIPELINE configuration
+ * option, or NO. The source and target datasets must not share resources
+ * that cannot be accessed from two threads at once. (GDAL &gt;= 2.3)</li>
  * </ul>
  * More options may be supported in the future.
  *
@@ -4394,6 +4644,79 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
     if( bInterleave)
         nPixelSize *= nBandCount;
 
+    const bool bCheckHoles = CPLTestBool( CSLFetchNameValueDef(
+                                        papszOptions, "SKIP_HOLES", "NO" ) );
+
+/* ==================================================================== */
+/*      Pipelined case: read in a helper thread, write in this one.     */
+/* ==================================================================== */
+    const int nPipelineDepth =
+        GDALCopyWholeRasterGetPipelineDepth( papszOptions );
+    if( nPipelineDepth > 0 )
+    {
+        CPLDebug( "GDAL",
+                  "GDALDatasetCopyWholeRaster(): %d*%d swaths, "
+                  "bInterleave=%d, pipeline of %d buffers",
+                  nSwathCols, nSwathLines, static_cast<int>(bInterleave),
+                  nPipelineDepth );
+
+        poSrcDS->AdviseRead( 0, 0, nXSize, nYSize, nXSize, nYSize, eDT,
+                             nBandCount, NULL, NULL );
+
+        // Hole detection is done before starting the reader thread, as
+        // the source dataset must not be accessed concurrently.
+        std::vector<GDALCopyWholeRasterSwath> asSwaths;
+        const int nIters = bInterleave ? 1 : nBandCount;
+        for( int iBand = 0; iBand < nIters; iBand++ )
+        {
+            for( int iY = 0; iY < nYSize; iY += nSwathLines )
+            {
+                for( int iX = 0; iX < nXSize; iX += nSwathCols )
+                {
+                    GDALCopyWholeRasterSwath sSwath;
+                    sSwath.nBand = bInterleave ? 0 : iBand + 1;
+                    sSwath.iX = iX;
+                    sSwath.iY = iY;
+                    sSwath.nXSize = std::min(nSwathCols, nXSize - iX);
+                    sSwath.nYSize = std::min(nSwathLines, nYSize - iY);
+                    sSwath.bRead = false;
+                    sSwath.eErr = CE_None;
+
+                    // Same decision as the non-pipelined loops below.
+                    int nStatus = GDAL_DATA_COVERAGE_STATUS_DATA;
+                    if( bCheckHoles && !bInterleave )
+                    {
+                        nStatus = poSrcDS->GetRasterBand(iBand + 1)->
+                            GetDataCoverageStatus(
+                                iX, iY, sSwath.nXSize, sSwath.nYSize,
+                                GDAL_DATA_COVERAGE_STATUS_DATA);
+                    }
+                    else if( bCheckHoles )
+                    {
+                        for( int i = 0; i < nBandCount; i++ )
+                        {
+                            nStatus |= poSrcDS->GetRasterBand(i + 1)->
+                                GetDataCoverageStatus(
+                                    iX, iY, sSwath.nXSize, sSwath.nYSize,
+                                    GDAL_DATA_COVERAGE_STATUS_DATA);
+                            if( nStatus & GDAL_DATA_COVERAGE_STATUS_DATA )
+                                break;
+                        }
+                    }
+                    sSwath.bHasData =
+                        (nStatus & GDAL_DATA_COVERAGE_STATUS_DATA) != 0;
+                    asSwaths.push_back(sSwath);
+                }
+            }
+        }
+
+        return GDALCopyWholeRasterPipelined(
+            poSrcDS, poDstDS, NULL, NULL, asSwaths, eDT, nBandCount,
+            nPipelineDepth,
+            static_cast<size_t>(nSwathCols) * nSwathLines * nPixelSize,
+            pfnProgress, pProgressData );
+    }
+
     void *pSwathBuf = VSI_MALLOC3_VERBOSE(nSwathCols, nSwathLines, nPixelSize );
     if( pSwathBuf == NULL )
     {
@@ -4414,8 +4737,6 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
 /*      Band oriented (uninterleaved) case.                             */
 /* ==================================================================== */
     CPLErr eErr = CE_None;
-    const bool bCheckHoles = CPLTestBool( CSLFetchNameValueDef(
-                                        papszOptions, "SKIP_HOLES", "NO" ) );
 
     if( !bInterleave )
     {
@@ -4610,6 +4931,8 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
  * achieve best compression.</li>
  * <li>"SKIP_HOLES=YES" to skip chunks for which GDALGetDataCoverageStatus()
  * returns GDAL_DATA_COVERAGE_STATUS_EMPTY (GDAL &gt;= 2.2)</li>
+ * <li>"PIPELINE=YES/NO/number_of_buffers": see GDALDatasetCopyWholeRaster()
+ * (GDAL &gt;= 2.3)</li>
  * </ul>
  *
  * @param hSrcBand the source band
@@ -4687,6 +5010,57 @@ CPLErr CPL_STDCALL GDALRasterBandCopyWholeRaster(
 
     const int nPixelSize = GDALGetDataTypeSizeBytes(eDT);
 
+    const bool bCheckHoles = CPLTestBool( CSLFetchNameValueDef(
+                    papszOptions, "SKIP_HOLES", "NO" ) );
+
+/* ==================================================================== */
+/*      Pipelined case: read in a helper thread, write in this one.     */
+/* ==================================================================== */
+    const int nPipelineDepth =
+        GDALCopyWholeRasterGetPipelineDepth( papszOptions );
+    if( nPipelineDepth > 0 )
+    {
+        CPLDebug( "GDAL",
+                  "GDALRasterBandCopyWholeRaster(): %d*%d swaths, "
+                  "pipeline of %d buffers",
+                  nSwathCols, nSwathLines, nPipelineDepth );
+
+        poSrcBand->AdviseRead( 0, 0, nXSize, nYSize, nXSize, nYSize, eDT,
+                               NULL );
+
+        std::vector<GDALCopyWholeRasterSwath> asSwaths;
+        for( int iY = 0; iY < nYSize; iY += nSwathLines )
+        {
+            for( int iX = 0; iX < nXSize; iX += nSwathCols )
+            {
+                GDALCopyWholeRasterSwath sSwath;
+                sSwath.nBand = 1;
+                sSwath.iX = iX;
+                sSwath.iY = iY;
+                sSwath.nXSize = std::min(nSwathCols, nXSize - iX);
+                sSwath.nYSize = std::min(nSwathLines, nYSize - iY);
+                sSwath.bRead = false;
+                sSwath.eErr = CE_None;
+                sSwath.bHasData = true;
+                if( bCheckHoles )
+                {
+                    const int nStatus = poSrcBand->GetDataCoverageStatus(
+                        iX, iY, sSwath.nXSize, sSwath.nYSize,
+                        GDAL_DATA_COVERAGE_STATUS_DATA);
+                    sSwath.bHasData =
+                        (nStatus & GDAL_DATA_COVERAGE_STATUS_DATA) != 0;
+                }
+                asSwaths.push_back(sSwath);
+            }
+        }
+
+        return GDALCopyWholeRasterPipelined(
+            NULL, NULL, poSrcBand, poDstBand, asSwaths, eDT, 1,
+            nPipelineDepth,
+            static_cast<size_t>(nSwathCols) * nSwathLines * nPixelSize,
+            pfnProgress, pProgressData );
+    }
+
     void *pSwathBuf = VSI_MALLOC3_VERBOSE(nSwathCols, nSwathLines, nPixelSize );
     if( pSwathBuf == NULL )
     {
@@ -4697,9 +5071,6 @@ CPLErr CPL_STDCALL GDALRasterBandCopyWholeRaster(
               "GDALRasterBandCopyWholeRaster(): %d*%d swaths",
               nSwathCols, nSwathLines );
 
-    const bool bCheckHoles = CPLTestBool( CSLFetchNameValueDef(
-                    papszOptions, "SKIP_HOLES", "NO" ) );
-
     // Advise the source raster that we are going to read it completely
     poSrcBand->AdviseRead( 0, 0, nXSize, nYSize, nXSize, nYSize, eDT, NULL );
 
@@ -42,6 +42,7 @@
 #include <string>
 #include <vector>
 #include <limits>
+#include <map>
 
 #include "cpl_conv.h"
 #include "cpl_csv.h"
@@ -77,6 +78,8 @@ static const char * const apszDatumEquiv[] =
 };
 
 static CPLMutex* hFindMatchesMutex = NULL;
+static CPLMutex* hEPSGCacheMutex = NULL;
+static std::map<CPLString, OGRSpatialReference*>* poEPSGCache = NULL;
 static std::vector<OGRSpatialReference*>* papoSRSCache_PROJCS = NULL;
 static std::vector<OGRSpatialReference*>* papoSRSCache_GEOGCS = NULL;
 
@@ -2114,8 +2117,10 @@ static OGRErr SetEPSGGeocCS( OGRSpatialReference * poSRS, int nGCSCode )
  * See CPLFindFile() for details.
  *
  * This method is relatively expensive, and generally involves quite a bit
- * of text file scanning.  Reasonable efforts should be made to avoid calling
- * it many times for the same coordinate system.
+ * of text file scanning.  Starting with GDAL 2.3, successfully imported
+ * definitions are kept in a process-wide cache, so that further imports of
+ * the same code, from any thread, only copy the cached definition.  This
+ * can be disabled by setting the OSR_EPSG_CACHE configuration option to NO.
  *
  * This method is similar to importFromEPSGA() except that EPSG preferred
  * axis ordering will *not* be applied for geographic coordinate systems.
@@ -2199,7 +2204,44 @@ OGRErr CPL_STDCALL OSRImportFromEPSG( OGRSpatialReferenceH hSRS, int nCode )
 OGRErr OGRSpatialReference::importFromEPSGA( int nCode )
 
 {
-    return importFromEPSGAInternal(nCode, NULL);
+/* -------------------------------------------------------------------- */
+/*      Building a SRS from the EPSG tables is costly, so successful    */
+/*      imports are kept in a process-wide cache.  The key includes     */
+/*      the location of the support files, in case GDAL_DATA or the    */
+/*      CSV filename hook change in the meantime.                       */
+/* -------------------------------------------------------------------- */
+    const bool bUseCache =
+        CPLTestBool(CPLGetConfigOption("OSR_EPSG_CACHE", "YES"));
+    CPLString osKey;
+    if( bUseCache )
+    {
+        osKey.Printf("%d:%s", nCode, CSVFilename( "gcs.csv" ));
+
+        CPLMutexHolderD(&hEPSGCacheMutex);
+        if( poEPSGCache != NULL )
+        {
+            std::map<CPLString, OGRSpatialReference*>::const_iterator oIter =
+                poEPSGCache->find(osKey);
+            if( oIter != poEPSGCache->end() )
+            {
+                *this = *(oIter->second);
+                return OGRERR_NONE;
+            }
+        }
+    }
+
+    const OGRErr eErr = importFromEPSGAInternal(nCode, NULL);
+
+    if( bUseCache && eErr == OGRERR_NONE )
+    {
+        CPLMutexHolderD(&hEPSGCacheMutex);
+        if( poEPSGCache == NULL )
+            poEPSGCache = new std::map<CPLString, OGRSpatialReference*>();
+        if( poEPSGCache->find(osKey) == poEPSGCache->end() )
+            (*poEPSGCache)[osKey] = Clone();
+    }
+
+    return eErr;
 }
 
 /************************************************************************/
@@ -2896,6 +2938,20 @@ int OSREPSGTreatsAsNorthingEasting( OGRSpatialReferenceH hSRS )
 
 void CleanupFindMatchesCacheAndMutex()
 {
+    if( hEPSGCacheMutex != NULL )
+    {
+        CPLDestroyMutex(hEPSGCacheMutex);
+        hEPSGCacheMutex = NULL;
+    }
+    if( poEPSGCache )
+    {
+        std::map<CPLString, OGRSpatialReference*>::iterator oIter =
+            poEPSGCache->begin();
+        for( ; oIter != poEPSGCache->end(); ++oIter )
+            delete oIter->second;
+        delete poEPSGCache;
+        poEPSGCache = NULL;
+    }
     if( hFindMatchesMutex != NULL )
     {
         CPLDestroyMutex(hFindMatchesMutex);
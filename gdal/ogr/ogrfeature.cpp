@@ -2212,20 +2212,25 @@ const char *OGRFeature::GetFieldAsString( int iField )
     else if( eType == OFTReal )
     {
         char szFormat[64] = {};
+        int nPrecision = 15;
+        char chConversionSpecifier = 'g';
 
         if( poFDefn->GetWidth() != 0 )
         {
-            snprintf( szFormat, sizeof(szFormat), "%%.%df",
-                poFDefn->GetPrecision() );
+            nPrecision = poFDefn->GetPrecision();
+            chConversionSpecifier = 'f';
         }
-        else
+
+        if( CPLFormatDoubleFast( szTempBuffer, TEMP_BUFFER_SIZE,
+                                 pauFields[iField].Real, nPrecision,
+                                 chConversionSpecifier ) < 0 )
         {
-            strcpy( szFormat, "%.15g" );
+            snprintf( szFormat, sizeof(szFormat), "%%.%d%c",
+                      nPrecision, chConversionSpecifier );
+            CPLsnprintf( szTempBuffer, TEMP_BUFFER_SIZE,
+                         szFormat, pauFields[iField].Real );
         }
 
-        CPLsnprintf( szTempBuffer, TEMP_BUFFER_SIZE,
-                  szFormat, pauFields[iField].Real );
-
         m_pszTmpFieldValue = VSI_STRDUP_VERBOSE( szTempBuffer );
         if( m_pszTmpFieldValue == NULL )
             return "";
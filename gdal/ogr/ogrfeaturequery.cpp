@@ -411,9 +411,11 @@ int OGRFeatureQuery::CanUseIndex( swq_expr_node *psExpr,
 /*      available indices, or an "OGRNullFID" terminated list of        */
 /*      FIDs if it can.                                                 */
 /*                                                                      */
-/*      For now we only support equality tests on a single indexed      */
-/*      attribute field.  Eventually we should make this support        */
-/*      multi-part queries with ranges.                                 */
+/*      Equality, IN, range (<, <=, >, >=, BETWEEN) and prefix LIKE     */
+/*      tests on indexed attribute fields are supported, combined with  */
+/*      AND and OR.  Range and prefix lookups may return a superset of  */
+/*      the matching features, so the caller must still evaluate the    */
+/*      query against the features it fetches.                          */
 /************************************************************************/
 
 static int CompareGIntBig( const void *pa, const void *pb )
@@ -570,6 +572,168 @@ GIntBig* OGRANDGIntBigArray( GIntBig panFIDList1[], GIntBig nFIDCount1,
     return panFIDList;
 }
 
+/************************************************************************/
+/*                     OGRFeatureQueryGetIndexKey()                     */
+/*                                                                      */
+/*      Convert a constant of the query to the type of an indexed       */
+/*      field.                                                          */
+/************************************************************************/
+
+static bool OGRFeatureQueryGetIndexKey( OGRFieldDefn *poFieldDefn,
+                                        swq_expr_node *poValue,
+                                        OGRField *psKey )
+{
+    if( poValue->is_null )
+        return false;
+
+    switch( poFieldDefn->GetType() )
+    {
+      case OFTInteger:
+        if( poValue->field_type == SWQ_FLOAT )
+        {
+            if( CPLIsNan(poValue->float_value) )
+                return false;
+            psKey->Integer = static_cast<int>(
+                std::max(static_cast<double>(INT_MIN),
+                         std::min(static_cast<double>(INT_MAX),
+                                  poValue->float_value)));
+        }
+        else
+            psKey->Integer = static_cast<int>(poValue->int_value);
+        return true;
+
+      case OFTInteger64:
+        if( poValue->field_type == SWQ_FLOAT )
+        {
+            if( CPLIsNan(poValue->float_value) )
+                return false;
+            psKey->Integer64 = static_cast<GIntBig>(
+                std::max(-9.2233720368547758e18,
+                         std::min(9.2233720368547758e18,
+                                  poValue->float_value)));
+        }
+        else
+            psKey->Integer64 = poValue->int_value;
+        return true;
+
+      case OFTReal:
+        psKey->Real = poValue->float_value;
+        return true;
+
+      case OFTString:
+        psKey->String = poValue->string_value;
+        return true;
+
+      case OFTDate:
+        return poValue->string_value != NULL &&
+               OGRParseDate(poValue->string_value, psKey, 0) == TRUE;
+
+      default:
+        return false;
+    }
+}
+
+/************************************************************************/
+/*                       OGRFeatureQueryGetRange()                      */
+/*                                                                      */
+/*      Recognize a comparison of a column with constants that          */
+/*      selects a range of values, and return the column and the        */
+/*      bounds of the range (NULL for an open side).  Bounds are        */
+/*      treated as inclusive.                                           */
+/************************************************************************/
+
+static bool OGRFeatureQueryGetRange( swq_expr_node *psExpr, int &nField,
+                                     swq_expr_node *&poMin,
+                                     swq_expr_node *&poMax )
+{
+    if( psExpr->eNodeType != SNT_OPERATION )
+        return false;
+
+    if( psExpr->nOperation == SWQ_BETWEEN )
+    {
+        if( psExpr->nSubExprCount != 3 ||
+            psExpr->papoSubExpr[0]->eNodeType != SNT_COLUMN ||
+            psExpr->papoSubExpr[1]->eNodeType != SNT_CONSTANT ||
+            psExpr->papoSubExpr[2]->eNodeType != SNT_CONSTANT )
+            return false;
+
+        nField = psExpr->papoSubExpr[0]->field_index;
+        poMin = psExpr->papoSubExpr[1];
+        poMax = psExpr->papoSubExpr[2];
+        return true;
+    }
+
+    if( !(psExpr->nOperation == SWQ_GT || psExpr->nOperation == SWQ_GE ||
+          psExpr->nOperation == SWQ_LT || psExpr->nOperation == SWQ_LE) ||
+        psExpr->nSubExprCount != 2 )
+        return false;
+
+    swq_expr_node *poColumn = psExpr->papoSubExpr[0];
+    swq_expr_node *poValue = psExpr->papoSubExpr[1];
+    bool bColumnFirst = true;
+    if( poColumn->eNodeType == SNT_CONSTANT &&
+        poValue->eNodeType == SNT_COLUMN )
+    {
+        std::swap(poColumn, poValue);
+        bColumnFirst = false;
+    }
+    if( poColumn->eNodeType != SNT_COLUMN ||
+        poValue->eNodeType != SNT_CONSTANT )
+        return false;
+
+    // "column > value" and "value < column" give a lower bound.
+    const bool bLowerBound =
+        (psExpr->nOperation == SWQ_GT || psExpr->nOperation == SWQ_GE)
+        == bColumnFirst;
+
+    nField = poColumn->field_index;
+    poMin = bLowerBound ? poValue : NULL;
+    poMax = bLowerBound ? NULL : poValue;
+    return true;
+}
+
+/************************************************************************/
+/*                    OGRFeatureQueryEvaluateRange()                    */
+/************************************************************************/
+
+static GIntBig *OGRFeatureQueryEvaluateRange( OGRLayer *poLayer, int nField,
+                                              swq_expr_node *poMin,
+                                              swq_expr_node *poMax,
+                                              GIntBig& nFIDCount )
+{
+    const int nIdx =
+        OGRFeatureFetcherFixFieldIndex(poLayer->GetLayerDefn(), nField);
+
+    OGRAttrIndex *poIndex = poLayer->GetIndex()->GetFieldIndex(nIdx);
+    if( poIndex == NULL )
+        return NULL;
+
+    OGRFieldDefn *poFieldDefn = poLayer->GetLayerDefn()->GetFieldDefn(nIdx);
+    OGRField sMin;
+    OGRField sMax;
+    if( (poMin != NULL &&
+         !OGRFeatureQueryGetIndexKey(poFieldDefn, poMin, &sMin)) ||
+        (poMax != NULL &&
+         !OGRFeatureQueryGetIndexKey(poFieldDefn, poMax, &sMax)) )
+        return NULL;
+
+    int nFIDCount32 = 0;
+    GIntBig *panFIDs =
+        poIndex->GetRangeMatches(poMin != NULL ? &sMin : NULL,
+                                 poMax != NULL ? &sMax : NULL, &nFIDCount32);
+    if( panFIDs == NULL )
+        return NULL;
+
+    nFIDCount = nFIDCount32;
+    if( nFIDCount > 1 )
+    {
+        // The returned FIDs are in key order, and expected to be sorted.
+        qsort(panFIDs, static_cast<size_t>(nFIDCount),
+              sizeof(GIntBig), CompareGIntBig);
+    }
+    return panFIDs;
+}
+
 GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
                                                   OGRLayer *poLayer,
                                                   GIntBig& nFIDCount )
@@ -579,6 +743,31 @@ GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
         psExpr->eNodeType != SNT_OPERATION )
         return NULL;
 
+    // A lower and an upper bound on the same field, such as
+    // "height > 50 AND height < 100", make a single range lookup.
+    if( psExpr->nOperation == SWQ_AND && psExpr->nSubExprCount == 2 )
+    {
+        int nField1 = -1;
+        int nField2 = -1;
+        swq_expr_node *poMin1 = NULL;
+        swq_expr_node *poMax1 = NULL;
+        swq_expr_node *poMin2 = NULL;
+        swq_expr_node *poMax2 = NULL;
+        if( OGRFeatureQueryGetRange(psExpr->papoSubExpr[0], nField1,
+                                    poMin1, poMax1) &&
+            OGRFeatureQueryGetRange(psExpr->papoSubExpr[1], nField2,
+                                    poMin2, poMax2) &&
+            nField1 == nField2 &&
+            (poMin1 == NULL || poMin2 == NULL) &&
+            (poMax1 == NULL || poMax2 == NULL) )
+        {
+            return OGRFeatureQueryEvaluateRange(
+                poLayer, nField1,
+                poMin1 != NULL ? poMin1 : poMin2,
+                poMax1 != NULL ? poMax1 : poMax2, nFIDCount);
+        }
+    }
+
     if( (psExpr->nOperation == SWQ_OR || psExpr->nOperation == SWQ_AND) &&
          psExpr->nSubExprCount == 2 )
     {
@@ -604,7 +793,17 @@ GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
         return panFIDList;
     }
 
-    if( !(psExpr->nOperation == SWQ_EQ || psExpr->nOperation == SWQ_IN)
+    {
+        int nField = -1;
+        swq_expr_node *poMin = NULL;
+        swq_expr_node *poMax = NULL;
+        if( OGRFeatureQueryGetRange(psExpr, nField, poMin, poMax) )
+            return OGRFeatureQueryEvaluateRange(poLayer, nField,
+                                                poMin, poMax, nFIDCount);
+    }
+
+    if( !(psExpr->nOperation == SWQ_EQ || psExpr->nOperation == SWQ_IN ||
+          psExpr->nOperation == SWQ_LIKE)
         || psExpr->nSubExprCount < 2 )
         return NULL;
 
@@ -628,6 +827,42 @@ GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
     OGRFieldDefn *poFieldDefn =
         poLayer->GetLayerDefn()->GetFieldDefn(nIdx);
 
+    // Handle the case of a LIKE operation whose pattern starts with a
+    // fixed prefix.
+    if( psExpr->nOperation == SWQ_LIKE )
+    {
+        if( psExpr->nSubExprCount > 3 ||
+            poValue->field_type != SWQ_STRING || poValue->is_null ||
+            (psExpr->nSubExprCount == 3 &&
+             psExpr->papoSubExpr[2]->eNodeType != SNT_CONSTANT) )
+            return NULL;
+
+        const char chEscape = psExpr->nSubExprCount == 3 ?
+            psExpr->papoSubExpr[2]->string_value[0] : '\0';
+        CPLString osPrefix;
+        for( const char *pszIter = poValue->string_value;
+             *pszIter != '\0' && *pszIter != '%' && *pszIter != '_' &&
+             *pszIter != chEscape; pszIter++ )
+        {
+            osPrefix += *pszIter;
+        }
+        if( osPrefix.empty() )
+            return NULL;
+
+        int nFIDCount32 = 0;
+        GIntBig *panFIDs = poIndex->GetPrefixMatches(osPrefix, &nFIDCount32);
+        if( panFIDs == NULL )
+            return NULL;
+        nFIDCount = nFIDCount32;
+        if( nFIDCount > 1 )
+        {
+            // The returned FIDs are expected to be in sorted order.
+            qsort(panFIDs, static_cast<size_t>(nFIDCount),
+                  sizeof(GIntBig), CompareGIntBig);
+        }
+        return panFIDs;
+    }
+
     // Handle the case of an IN operation.
     if( psExpr->nOperation == SWQ_IN )
     {
@@ -637,35 +872,11 @@ GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
 
         for( int iIN = 1; iIN < psExpr->nSubExprCount; iIN++ )
         {
-            switch( poFieldDefn->GetType() )
+            if( !OGRFeatureQueryGetIndexKey(poFieldDefn,
+                                            psExpr->papoSubExpr[iIN],
+                                            &sValue) )
             {
-              case OFTInteger:
-                if( psExpr->papoSubExpr[iIN]->field_type == SWQ_FLOAT )
-                    sValue.Integer =
-                        static_cast<int>(psExpr->papoSubExpr[iIN]->float_value);
-                else
-                    sValue.Integer =
-                        static_cast<int>(psExpr->papoSubExpr[iIN]->int_value);
-                break;
-
-              case OFTInteger64:
-                if( psExpr->papoSubExpr[iIN]->field_type == SWQ_FLOAT )
-                    sValue.Integer64 = static_cast<GIntBig>(
-                        psExpr->papoSubExpr[iIN]->float_value);
-                else
-                    sValue.Integer64 = psExpr->papoSubExpr[iIN]->int_value;
-                break;
-
-              case OFTReal:
-                sValue.Real = psExpr->papoSubExpr[iIN]->float_value;
-                break;
-
-              case OFTString:
-                sValue.String = psExpr->papoSubExpr[iIN]->string_value;
-                break;
-
-              default:
-                CPLAssert(false);
+                CPLFree(panFIDs);
                 return NULL;
             }
 
@@ -685,34 +896,8 @@ GIntBig *OGRFeatureQuery::EvaluateAgainstIndices( swq_expr_node *psExpr,
     }
 
     // Handle equality test.
-    switch( poFieldDefn->GetType() )
-    {
-      case OFTInteger:
-        if( poValue->field_type == SWQ_FLOAT )
-            sValue.Integer = static_cast<int>(poValue->float_value);
-        else
-            sValue.Integer = static_cast<int>(poValue->int_value);
-        break;
-
-      case OFTInteger64:
-        if( poValue->field_type == SWQ_FLOAT )
-            sValue.Integer64 = static_cast<GIntBig>(poValue->float_value);
-        else
-            sValue.Integer64 = poValue->int_value;
-        break;
-
-      case OFTReal:
-        sValue.Real = poValue->float_value;
-        break;
-
-      case OFTString:
-        sValue.String = poValue->string_value;
-        break;
-
-      default:
-        CPLAssert(false);
+    if( !OGRFeatureQueryGetIndexKey(poFieldDefn, poValue, &sValue) )
         return NULL;
-    }
 
     int nLength = 0;
     int nFIDCount32 = 0;
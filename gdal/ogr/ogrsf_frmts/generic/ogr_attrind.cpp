@@ -77,4 +77,31 @@ OGRAttrIndex::OGRAttrIndex() {}
 
 OGRAttrIndex::~OGRAttrIndex() {}
 
+/************************************************************************/
+/*                          GetRangeMatches()                           */
+/*                                                                      */
+/*      Return the features whose key is in [psMinKey, psMaxKey]. A    */
+/*      NULL bound leaves that side of the range open.                  */
+/************************************************************************/
+
+GIntBig *OGRAttrIndex::GetRangeMatches( OGRField * /* psMinKey */,
+                                        OGRField * /* psMaxKey */,
+                                        int * /* pnFIDCount */ )
+{
+    return NULL;
+}
+
+/************************************************************************/
+/*                          GetPrefixMatches()                          */
+/*                                                                      */
+/*      Return the features whose string key starts with pszPrefix,    */
+/*      ignoring case like the LIKE operator.                           */
+/************************************************************************/
+
+GIntBig *OGRAttrIndex::GetPrefixMatches( const char * /* pszPrefix */,
+                                         int * /* pnFIDCount */ )
+{
+    return NULL;
+}
+
 //! @endcond
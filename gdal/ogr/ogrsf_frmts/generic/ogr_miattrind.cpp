@@ -32,6 +32,9 @@
 #include "mitab/mitab_priv.h"
 #include "cpl_minixml.h"
 
+#include <algorithm>
+#include <vector>
+
 CPL_CVSID("$Id$")
 
 /************************************************************************/
@@ -60,6 +63,14 @@ public:
     GIntBig     GetFirstMatch( OGRField *psKey ) override;
     GIntBig    *GetAllMatches( OGRField *psKey ) override;
     GIntBig    *GetAllMatches( OGRField *psKey, GIntBig* panFIDList, int* nFIDCount, int* nLength ) override;
+    GIntBig    *GetRangeMatches( OGRField *psMinKey, OGRField *psMaxKey,
+                                 int *pnFIDCount ) override;
+    GIntBig    *GetPrefixMatches( const char *pszPrefix,
+                                  int *pnFIDCount ) override;
+
+    bool        ScanRange( const GByte *pabyMinKey, const GByte *pabyMaxKey,
+                           int nMaxKeyLength, GIntBig *&panFIDList,
+                           int &nFIDCount, int &nLength );
 
     OGRErr      AddEntry( OGRField *psKey, GIntBig nFID ) override;
     OGRErr      RemoveEntry( OGRField *psKey, GIntBig nFID ) override;
@@ -488,6 +499,10 @@ OGRErr OGRMILayerAttrIndex::CreateIndex( int iField )
             nFieldWidth = 64;
         break;
 
+      case OFTDate:
+        eTABFT = TABFDate;
+        break;
+
       default:
         CPLError( CE_Failure, CPLE_AppDefined,
                   "Indexing not support for the field type of field %s.",
@@ -756,6 +771,14 @@ GByte *OGRMIAttrIndex::BuildKey( OGRField *psKey )
         ret = poINDFile->BuildKey( iIndex, psKey->String );
         break;
 
+      case OFTDate:
+        // Same encoding as the date indexes written by the MITAB driver.
+        ret = poINDFile->BuildKey( iIndex,
+                                   psKey->Date.Year * 0x10000 +
+                                   psKey->Date.Month * 0x100 +
+                                   psKey->Date.Day );
+        break;
+
       default:
         CPLAssert( false );
         break;
@@ -817,6 +840,200 @@ GIntBig *OGRMIAttrIndex::GetAllMatches( OGRField *psKey )
     return GetAllMatches( psKey, NULL, &nFIDCount, &nLength );
 }
 
+/************************************************************************/
+/*                             ScanRange()                              */
+/*                                                                      */
+/*      Append to panFIDList the FIDs of the index entries whose key    */
+/*      is >= pabyMinKey and whose nMaxKeyLength first bytes are <=     */
+/*      those of pabyMaxKey, in key order.                              */
+/************************************************************************/
+
+bool OGRMIAttrIndex::ScanRange( const GByte *pabyMinKey,
+                                const GByte *pabyMaxKey, int nMaxKeyLength,
+                                GIntBig *&panFIDList,
+                                int &nFIDCount, int &nLength )
+{
+    GByte *pabyMax = const_cast<GByte *>(pabyMaxKey);
+    GIntBig nFID =
+        poINDFile->FindFirstInRange( iIndex, const_cast<GByte *>(pabyMinKey),
+                                     pabyMax, nMaxKeyLength );
+    while( nFID > 0 )
+    {
+        if( nFIDCount >= nLength - 1 )
+        {
+            nLength = nLength * 2 + 10;
+            panFIDList = (GIntBig *)
+                CPLRealloc(panFIDList, sizeof(GIntBig) * nLength);
+        }
+        panFIDList[nFIDCount++] = nFID - 1;
+
+        nFID = poINDFile->FindNextInRange( iIndex, pabyMax, nMaxKeyLength );
+    }
+
+    return nFID == 0;
+}
+
+/************************************************************************/
+/*                          GetRangeMatches()                           */
+/************************************************************************/
+
+GIntBig *OGRMIAttrIndex::GetRangeMatches( OGRField *psMinKey,
+                                          OGRField *psMaxKey,
+                                          int *pnFIDCount )
+{
+    const int nKeyLength = poINDFile->GetKeyLength( iIndex );
+    if( nKeyLength <= 0 )
+        return NULL;
+
+    std::vector<GByte> abyMinKey( nKeyLength );
+    std::vector<GByte> abyMaxKey( nKeyLength );
+    const OGRFieldType eType = poFldDefn->GetType();
+
+    int nLength = 2;
+    int nFIDCount = 0;
+    GIntBig *panFIDList = (GIntBig *) CPLMalloc(sizeof(GIntBig) * nLength);
+    bool bOK = true;
+
+    if( eType == OFTInteger64 )
+    {
+/* -------------------------------------------------------------------- */
+/*      The keys of 64 bit values are built from their truncation to    */
+/*      32 bits, so values that do not fit are indexed under unrelated */
+/*      keys, and would be missed by a range scan.                      */
+/* -------------------------------------------------------------------- */
+        CPLFree( panFIDList );
+        return NULL;
+    }
+    else if( eType == OFTInteger || eType == OFTDate )
+    {
+/* -------------------------------------------------------------------- */
+/*      Integer and date keys only sort like the values they encode     */
+/*      for non-negative values: TABINDFile::BuildKey() truncates       */
+/*      negative values towards zero, so their keys end up interleaved  */
+/*      with the positive ones.  Only scan ranges with a non-negative   */
+/*      lower bound; the negative keys that fall in it only make the    */
+/*      result a superset.                                              */
+/* -------------------------------------------------------------------- */
+        if( eType != OFTDate &&
+            (psMinKey == NULL || psMinKey->Integer < 0) )
+        {
+            CPLFree( panFIDList );
+            return NULL;
+        }
+
+        if( psMinKey != NULL )
+            memcpy( &abyMinKey[0], BuildKey( psMinKey ), nKeyLength );
+        if( psMaxKey != NULL )
+            memcpy( &abyMaxKey[0], BuildKey( psMaxKey ), nKeyLength );
+        bOK = ScanRange( psMinKey ? &abyMinKey[0] : NULL,
+                         psMaxKey ? &abyMaxKey[0] : NULL, nKeyLength,
+                         panFIDList, nFIDCount, nLength );
+    }
+    else if( eType == OFTReal )
+    {
+/* -------------------------------------------------------------------- */
+/*      Real keys are the MSB encoding of the opposite of the value:    */
+/*      the keys of negative values come first, by decreasing value,   */
+/*      and are followed by the keys of positive values (starting at    */
+/*      0x80), by increasing value.  Scan both parts separately.        */
+/* -------------------------------------------------------------------- */
+        if( psMinKey == NULL || psMinKey->Real <= 0.0 )
+        {
+            if( psMaxKey != NULL && psMaxKey->Real < 0.0 )
+                memcpy( &abyMinKey[0], BuildKey( psMaxKey ), nKeyLength );
+            else
+                memset( &abyMinKey[0], 0, nKeyLength );
+
+            if( psMinKey != NULL && psMinKey->Real < 0.0 )
+                memcpy( &abyMaxKey[0], BuildKey( psMinKey ), nKeyLength );
+            else if( psMinKey != NULL )
+                memset( &abyMaxKey[0], 0, nKeyLength );
+            else
+            {
+                memset( &abyMaxKey[0], 0xFF, nKeyLength );
+                abyMaxKey[0] = 0x7F;
+            }
+
+            bOK = ScanRange( &abyMinKey[0], &abyMaxKey[0], nKeyLength,
+                             panFIDList, nFIDCount, nLength );
+        }
+
+        if( bOK && (psMaxKey == NULL || psMaxKey->Real >= 0.0) )
+        {
+            if( psMinKey != NULL && psMinKey->Real > 0.0 )
+                memcpy( &abyMinKey[0], BuildKey( psMinKey ), nKeyLength );
+            else
+            {
+                memset( &abyMinKey[0], 0, nKeyLength );
+                abyMinKey[0] = 0x80;
+            }
+
+            if( psMaxKey != NULL )
+                memcpy( &abyMaxKey[0], BuildKey( psMaxKey ), nKeyLength );
+
+            bOK = ScanRange( &abyMinKey[0],
+                             psMaxKey ? &abyMaxKey[0] : NULL, nKeyLength,
+                             panFIDList, nFIDCount, nLength );
+        }
+    }
+    else
+    {
+        // String keys are upper-cased, so they do not sort like the
+        // case-sensitive comparisons of OGR SQL.
+        bOK = false;
+    }
+
+    if( !bOK )
+    {
+        CPLFree( panFIDList );
+        return NULL;
+    }
+
+    panFIDList[nFIDCount] = OGRNullFID;
+    *pnFIDCount = nFIDCount;
+    return panFIDList;
+}
+
+/************************************************************************/
+/*                          GetPrefixMatches()                          */
+/************************************************************************/
+
+GIntBig *OGRMIAttrIndex::GetPrefixMatches( const char *pszPrefix,
+                                           int *pnFIDCount )
+{
+    const int nKeyLength = poINDFile->GetKeyLength( iIndex );
+    if( poFldDefn->GetType() != OFTString || nKeyLength <= 0 )
+        return NULL;
+
+/* -------------------------------------------------------------------- */
+/*      String keys are upper-cased and padded with zeros, so the key   */
+/*      of the prefix is the smallest key starting with it, and the     */
+/*      matches are all the following keys starting with it.  Longer    */
+/*      prefixes are truncated like the keys.                           */
+/* -------------------------------------------------------------------- */
+    const int nPrefixLength =
+        std::min( static_cast<int>(strlen(pszPrefix)), nKeyLength );
+    if( nPrefixLength == 0 )
+        return NULL;
+
+    std::vector<GByte> abyKey( nKeyLength );
+    memcpy( &abyKey[0], poINDFile->BuildKey( iIndex, pszPrefix ), nKeyLength );
+
+    int nLength = 2;
+    int nFIDCount = 0;
+    GIntBig *panFIDList = (GIntBig *) CPLMalloc(sizeof(GIntBig) * nLength);
+    if( !ScanRange( &abyKey[0], &abyKey[0], nPrefixLength,
+                    panFIDList, nFIDCount, nLength ) )
+    {
+        CPLFree( panFIDList );
+        return NULL;
+    }
+
+    panFIDList[nFIDCount] = OGRNullFID;
+    *pnFIDCount = nFIDCount;
+    return panFIDList;
+}
+
 /************************************************************************/
 /*                               Clear()                                */
 /************************************************************************/
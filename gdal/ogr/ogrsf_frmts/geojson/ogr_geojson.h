@@ -162,6 +162,7 @@ class OGRGeoJSONWriteLayer : public OGRLayer
     bool bRFC7946_;
     OGRCoordinateTransformation* poCT_;
     OGRGeoJSONWriteOptions oWriteOptions_;
+    CPLString osGeometryBuffer_;
 };
 
 /************************************************************************/
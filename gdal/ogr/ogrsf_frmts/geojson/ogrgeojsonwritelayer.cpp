@@ -183,16 +183,20 @@ OGRErr OGRGeoJSONWriteLayer::ICreateFeature( OGRFeature* poFeature )
         poFeatureToWrite = poFeature;
     }
 
+    // The geometry is serialized in osGeometryBuffer_, reused between
+    // features, rather than as a tree of json-c objects.
     json_object* poObj =
-        OGRGeoJSONWriteFeature( poFeatureToWrite, oWriteOptions_ );
+        OGRGeoJSONWriteFeature( poFeatureToWrite, oWriteOptions_,
+                                &osGeometryBuffer_ );
     CPLAssert( NULL != poObj );
 
     if( nOutCounter_ > 0 )
     {
         /* Separate "Feature" entries in "FeatureCollection" object. */
-        VSIFPrintfL( fp, ",\n" );
+        VSIFWriteL( ",\n", 2, 1, fp );
     }
-    VSIFPrintfL( fp, "%s", json_object_to_json_string( poObj ) );
+    const char* pszJSon = json_object_to_json_string( poObj );
+    VSIFWriteL( pszJSon, strlen(pszJSon), 1, fp );
 
     json_object_put( poObj );
 
@@ -56,6 +56,103 @@ void OGRGeoJSONWriteOptions::SetRFC7946Settings()
 }
 /*! @endcond */
 
+/************************************************************************/
+/*                OGRGeoJSONFormatDoubleWithPrecision()                 */
+/************************************************************************/
+
+static int OGRGeoJSONFormatDoubleWithPrecision( char* szBuffer,
+                                                size_t nBufferSize,
+                                                double dfVal,
+                                                int nPrecision )
+{
+    OGRFormatDouble( szBuffer, nBufferSize, dfVal, '.',
+                     (nPrecision < 0) ? 15 : nPrecision );
+    if( szBuffer[0] == 't' /*oobig */ )
+    {
+        CPLsnprintf(szBuffer, nBufferSize, "%.18g", dfVal);
+    }
+    return static_cast<int>(strlen(szBuffer));
+}
+
+/************************************************************************/
+/*            OGRGeoJSONFormatDoubleWithSignificantFigures()            */
+/************************************************************************/
+
+static int OGRGeoJSONFormatDoubleWithSignificantFigures( char* szBuffer,
+                                                         size_t nBufferSize,
+                                                         double dfVal,
+                                                         int nSignificantFigures )
+{
+    int nSize = 0;
+    if( CPLIsNan(dfVal))
+        nSize = CPLsnprintf(szBuffer, nBufferSize, "NaN");
+    else if( CPLIsInf(dfVal) )
+    {
+        if( dfVal > 0 )
+            nSize = CPLsnprintf(szBuffer, nBufferSize, "Infinity");
+        else
+            nSize = CPLsnprintf(szBuffer, nBufferSize, "-Infinity");
+    }
+    else
+    {
+        char szFormatting[32] = {};
+        const int nInitialSignificantFigures =
+            nSignificantFigures >= 0 ? nSignificantFigures : 17;
+        CPLsnprintf(szFormatting, sizeof(szFormatting),
+                    "%%.%dg", nInitialSignificantFigures);
+        nSize = CPLsnprintf(szBuffer, nBufferSize,
+                            szFormatting, dfVal);
+        const char* pszDot = NULL;
+        if( nSize+2 < static_cast<int>(nBufferSize) &&
+            (pszDot = strchr(szBuffer, '.')) == NULL )
+        {
+            nSize += CPLsnprintf(szBuffer + nSize, nBufferSize - nSize,
+                                 ".0");
+        }
+
+        // Try to avoid .xxxx999999y or .xxxx000000y rounding issues by
+        // decreasing a bit precision.
+        if( nInitialSignificantFigures > 10 &&
+            pszDot != NULL &&
+            (strstr(pszDot, "999999") != NULL ||
+             strstr(pszDot, "000000") != NULL) )
+        {
+            bool bOK = false;
+            for( int i = 1; i <= 3; i++ )
+            {
+                CPLsnprintf(szFormatting, sizeof(szFormatting),
+                            "%%.%dg", nInitialSignificantFigures- i);
+                nSize = CPLsnprintf(szBuffer, nBufferSize,
+                                    szFormatting, dfVal);
+                pszDot = strchr(szBuffer, '.');
+                if( pszDot != NULL &&
+                    strstr(pszDot, "999999") == NULL &&
+                    strstr(pszDot, "000000") == NULL )
+                {
+                    bOK = true;
+                    break;
+                }
+            }
+            if( !bOK )
+            {
+                CPLsnprintf(szFormatting, sizeof(szFormatting),
+                            "%%.%dg", nInitialSignificantFigures);
+                nSize = CPLsnprintf(szBuffer, nBufferSize,
+                                    szFormatting, dfVal);
+                if( nSize+2 < static_cast<int>(nBufferSize) &&
+                    strchr(szBuffer, '.') == NULL )
+                {
+                    nSize +=
+                        CPLsnprintf(szBuffer + nSize, nBufferSize - nSize,
+                                    ".0");
+                }
+            }
+        }
+    }
+
+    return nSize;
+}
+
 /************************************************************************/
 /*                        json_object_new_coord()                       */
 /************************************************************************/
@@ -504,12 +601,33 @@ OGREnvelope3D OGRGeoJSONGetBBox( OGRGeometry* poGeometry,
     return sEnvelope;
 }
 
+/************************************************************************/
+/*                 OGRGeoJSONPrerenderedGeometryToString()              */
+/************************************************************************/
+
+static int OGRGeoJSONPrerenderedGeometryToString( struct json_object *jso,
+                                                  struct printbuf *pb,
+                                                  int /* level */,
+                                                  int /* flags */)
+{
+    const CPLString* posText =
+        static_cast<const CPLString*>(jso->_userdata);
+    return printbuf_memappend(pb, posText->c_str(),
+                              static_cast<int>(posText->size()));
+}
+
 /************************************************************************/
 /*                           OGRGeoJSONWriteFeature                     */
+/*                                                                      */
+/*      If posGeometryBuffer is not NULL, the geometry is directly      */
+/*      serialized into it, and the returned object must be converted  */
+/*      to a string with json_object_to_json_string() before the        */
+/*      buffer is modified or destroyed.                                */
 /************************************************************************/
 
 json_object* OGRGeoJSONWriteFeature( OGRFeature* poFeature,
-                                     const OGRGeoJSONWriteOptions& oOptions )
+                                     const OGRGeoJSONWriteOptions& oOptions,
+                                     CPLString* posGeometryBuffer )
 {
     CPLAssert( NULL != poFeature );
 
@@ -644,7 +762,26 @@ json_object* OGRGeoJSONWriteFeature( OGRFeature* poFeature,
     OGRGeometry* poGeometry = poFeature->GetGeometryRef();
     if( NULL != poGeometry )
     {
-        poObjGeom = OGRGeoJSONWriteGeometry( poGeometry, oOptions );
+        // Without native geometry to patch, avoid building a json-c object
+        // per coordinate.
+        const bool bStreamGeometry =
+            posGeometryBuffer != NULL && poNativeGeom == NULL;
+        if( bStreamGeometry )
+        {
+            posGeometryBuffer->clear();
+            if( OGRGeoJSONAppendGeometry( *posGeometryBuffer, poGeometry,
+                                          oOptions ) )
+            {
+                poObjGeom = json_object_new_object();
+                json_object_set_serializer(
+                    poObjGeom, OGRGeoJSONPrerenderedGeometryToString,
+                    posGeometryBuffer, NULL );
+            }
+        }
+        else
+        {
+            poObjGeom = OGRGeoJSONWriteGeometry( poGeometry, oOptions );
+        }
 
         if( bWriteBBOX && !poGeometry->IsEmpty() )
         {
@@ -677,7 +814,8 @@ json_object* OGRGeoJSONWriteFeature( OGRFeature* poFeature,
 
         bool bOutPatchableCoords = false;
         bool bOutCompatibleCoords = false;
-        if( OGRGeoJSONIsPatchableGeometry( poObjGeom, poNativeGeom,
+        if( !bStreamGeometry &&
+            OGRGeoJSONIsPatchableGeometry( poObjGeom, poNativeGeom,
                                            bOutPatchableCoords,
                                            bOutCompatibleCoords ) )
         {
@@ -1289,6 +1427,230 @@ json_object* OGRGeoJSONWriteRingCoords( OGRLinearRing* poLine,
     return poObjCoords;
 }
 
+/************************************************************************/
+/*                   Streaming geometry serialization                   */
+/*                                                                      */
+/*      The functions below produce the same text as                    */
+/*      json_object_to_json_string() on the objects built by the        */
+/*      OGRGeoJSONWrite*() functions above, but directly append it to   */
+/*      a string, without building a json-c object per coordinate.      */
+/*      On failure, the string is restored to its initial content.      */
+/************************************************************************/
+
+static void OGRGeoJSONAppendCoord( CPLString& osOut, double dfVal,
+                                   const OGRGeoJSONWriteOptions& oOptions )
+{
+    char szBuffer[75] = {};
+    int nSize = 0;
+    if( oOptions.nCoordPrecision >= 0 || oOptions.nSignificantFigures < 0 )
+        nSize = OGRGeoJSONFormatDoubleWithPrecision(
+            szBuffer, sizeof(szBuffer), dfVal, oOptions.nCoordPrecision);
+    else
+        nSize = OGRGeoJSONFormatDoubleWithSignificantFigures(
+            szBuffer, sizeof(szBuffer), dfVal, oOptions.nSignificantFigures);
+    osOut.append(szBuffer, nSize);
+}
+
+static bool OGRGeoJSONAppendCoords( CPLString& osOut,
+                                    double dfX, double dfY,
+                                    const double* pdfZ,
+                                    const OGRGeoJSONWriteOptions& oOptions )
+{
+    if( CPLIsInf(dfX) || CPLIsInf(dfY) ||
+        CPLIsNan(dfX) || CPLIsNan(dfY) ||
+        (pdfZ != NULL && (CPLIsInf(*pdfZ) || CPLIsNan(*pdfZ))) )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Infinite or NaN coordinate encountered");
+        return false;
+    }
+    osOut += "[ ";
+    OGRGeoJSONAppendCoord( osOut, dfX, oOptions );
+    osOut += ", ";
+    OGRGeoJSONAppendCoord( osOut, dfY, oOptions );
+    if( pdfZ != NULL )
+    {
+        osOut += ", ";
+        OGRGeoJSONAppendCoord( osOut, *pdfZ, oOptions );
+    }
+    osOut += " ]";
+    return true;
+}
+
+static bool OGRGeoJSONAppendPoint( CPLString& osOut, OGRPoint* poPoint,
+                                   const OGRGeoJSONWriteOptions& oOptions )
+{
+    if( wkbHasZ(poPoint->getGeometryType()) )
+    {
+        const double dfZ = poPoint->getZ();
+        return OGRGeoJSONAppendCoords( osOut, poPoint->getX(), poPoint->getY(),
+                                       &dfZ, oOptions );
+    }
+    if( !poPoint->IsEmpty() )
+    {
+        return OGRGeoJSONAppendCoords( osOut, poPoint->getX(), poPoint->getY(),
+                                       NULL, oOptions );
+    }
+    return false;
+}
+
+static bool OGRGeoJSONAppendLineCoords( CPLString& osOut,
+                                        OGRSimpleCurve* poLine,
+                                        bool bInvertOrder,
+                                        const OGRGeoJSONWriteOptions& oOptions )
+{
+    const size_t nStart = osOut.size();
+    const int nCount = poLine->getNumPoints();
+    const bool bHasZ = wkbHasZ(poLine->getGeometryType());
+    osOut += "[";
+    for( int i = 0; i < nCount; ++i )
+    {
+        const int nIdx = (bInvertOrder) ? nCount - 1 - i: i;
+        osOut += (i > 0) ? ", " : " ";
+        double dfZ = 0.0;
+        if( bHasZ )
+            dfZ = poLine->getZ(nIdx);
+        if( !OGRGeoJSONAppendCoords( osOut, poLine->getX(nIdx),
+                                     poLine->getY(nIdx),
+                                     bHasZ ? &dfZ : NULL, oOptions ) )
+        {
+            osOut.resize(nStart);
+            return false;
+        }
+    }
+    osOut += " ]";
+    return true;
+}
+
+static bool OGRGeoJSONAppendPolygon( CPLString& osOut, OGRPolygon* poPolygon,
+                                     const OGRGeoJSONWriteOptions& oOptions )
+{
+    const size_t nStart = osOut.size();
+    osOut += "[";
+    bool bFirst = true;
+    for( int i = 0; i <= poPolygon->getNumInteriorRings(); ++i )
+    {
+        OGRLinearRing* poRing = (i == 0) ? poPolygon->getExteriorRing() :
+                                           poPolygon->getInteriorRing(i - 1);
+        if( poRing == NULL )
+        {
+            if( i == 0 )
+                break;
+            continue;
+        }
+        const bool bIsExteriorRing = (i == 0);
+        const bool bInvertOrder = oOptions.bPolygonRightHandRule &&
+                        ((bIsExteriorRing && poRing->isClockwise()) ||
+                         (!bIsExteriorRing && !poRing->isClockwise()));
+        osOut += bFirst ? " " : ", ";
+        bFirst = false;
+        if( !OGRGeoJSONAppendLineCoords( osOut, poRing, bInvertOrder,
+                                         oOptions ) )
+        {
+            osOut.resize(nStart);
+            return false;
+        }
+    }
+    osOut += " ]";
+    return true;
+}
+
+static bool OGRGeoJSONAppendCoordinates( CPLString& osOut,
+                                         OGRGeometry* poGeometry,
+                                         const OGRGeoJSONWriteOptions& oOptions )
+{
+    const OGRwkbGeometryType eFType =
+        wkbFlatten(poGeometry->getGeometryType());
+    if( eFType == wkbPoint )
+        return OGRGeoJSONAppendPoint( osOut,
+                                      static_cast<OGRPoint*>(poGeometry),
+                                      oOptions );
+    if( eFType == wkbLineString )
+        return OGRGeoJSONAppendLineCoords(
+            osOut, static_cast<OGRLineString*>(poGeometry), false, oOptions );
+    if( eFType == wkbPolygon )
+        return OGRGeoJSONAppendPolygon( osOut,
+                                        static_cast<OGRPolygon*>(poGeometry),
+                                        oOptions );
+    if( eFType != wkbMultiPoint && eFType != wkbMultiLineString &&
+        eFType != wkbMultiPolygon )
+        return false;
+
+    OGRGeometryCollection* poGC = static_cast<OGRGeometryCollection*>(poGeometry);
+    const size_t nStart = osOut.size();
+    osOut += "[";
+    for( int i = 0; i < poGC->getNumGeometries(); ++i )
+    {
+        osOut += (i > 0) ? ", " : " ";
+        if( !OGRGeoJSONAppendCoordinates( osOut, poGC->getGeometryRef(i),
+                                          oOptions ) )
+        {
+            osOut.resize(nStart);
+            return false;
+        }
+    }
+    osOut += " ]";
+    return true;
+}
+
+/************************************************************************/
+/*                       OGRGeoJSONAppendGeometry()                     */
+/************************************************************************/
+
+/** Append the GeoJSON text of a geometry to a string.
+ *
+ * The text is the same as json_object_to_json_string() on the result of
+ * OGRGeoJSONWriteGeometry().
+ *
+ * @return false, without modifying osOut, if OGRGeoJSONWriteGeometry() would
+ * have returned NULL.
+ */
+bool OGRGeoJSONAppendGeometry( CPLString& osOut,
+                               OGRGeometry* poGeometry,
+                               const OGRGeoJSONWriteOptions& oOptions )
+{
+    const OGRwkbGeometryType eFType =
+        wkbFlatten(poGeometry->getGeometryType());
+    if( eFType == wkbPoint && poGeometry->IsEmpty() )
+        return false;
+
+    const size_t nStart = osOut.size();
+    osOut += "{ \"type\": \"";
+    osOut += OGRGeoJSONGetGeometryName( poGeometry );
+    if( eFType == wkbGeometryCollection )
+    {
+        osOut += "\", \"geometries\": [";
+        OGRGeometryCollection* poGC =
+            static_cast<OGRGeometryCollection*>(poGeometry);
+        for( int i = 0; i < poGC->getNumGeometries(); ++i )
+        {
+            osOut += (i > 0) ? ", " : " ";
+            if( !OGRGeoJSONAppendGeometry( osOut, poGC->getGeometryRef(i),
+                                           oOptions ) )
+                osOut += "null";
+        }
+        osOut += " ] }";
+        return true;
+    }
+
+    osOut += "\", \"coordinates\": ";
+    if( !OGRGeoJSONAppendCoordinates( osOut, poGeometry, oOptions ) )
+    {
+        if( eFType != wkbPoint && eFType != wkbLineString &&
+            eFType != wkbPolygon && eFType != wkbMultiPoint &&
+            eFType != wkbMultiLineString && eFType != wkbMultiPolygon )
+        {
+            CPLDebug( "GeoJSON",
+                      "Unsupported geometry type detected. "
+                      "Feature gets NULL geometry assigned." );
+        }
+        osOut.resize(nStart);
+        return false;
+    }
+    osOut += " }";
+    return true;
+}
+
 /************************************************************************/
 /*                           OGR_G_ExportToJson                         */
 /************************************************************************/
@@ -1383,13 +1745,9 @@ static int OGR_json_double_with_precision_to_string( struct json_object *jso,
     const int nPrecision =
         static_cast<int>(reinterpret_cast<GUIntptr_t>(jso->_userdata));
     char szBuffer[75] = {};
-    OGRFormatDouble( szBuffer, sizeof(szBuffer), jso->o.c_double, '.',
-                     (nPrecision < 0) ? 15 : nPrecision );
-    if( szBuffer[0] == 't' /*oobig */ )
-    {
-        CPLsnprintf(szBuffer, sizeof(szBuffer), "%.18g", jso->o.c_double);
-    }
-    return printbuf_memappend(pb, szBuffer, static_cast<int>(strlen(szBuffer)));
+    const int nSize = OGRGeoJSONFormatDoubleWithPrecision(
+        szBuffer, sizeof(szBuffer), jso->o.c_double, nPrecision);
+    return printbuf_memappend(pb, szBuffer, nSize);
 }
 
 /************************************************************************/
@@ -1415,75 +1773,10 @@ OGR_json_double_with_significant_figures_to_string( struct json_object *jso,
                                                     int /* level */,
                                                     int /* flags */)
 {
+    const int nSignificantFigures = (int) (GUIntptr_t) jso->_userdata;
     char szBuffer[75] = {};
-    int nSize = 0;
-    if( CPLIsNan(jso->o.c_double))
-        nSize = CPLsnprintf(szBuffer, sizeof(szBuffer), "NaN");
-    else if( CPLIsInf(jso->o.c_double) )
-    {
-        if( jso->o.c_double > 0 )
-            nSize = CPLsnprintf(szBuffer, sizeof(szBuffer), "Infinity");
-        else
-            nSize = CPLsnprintf(szBuffer, sizeof(szBuffer), "-Infinity");
-    }
-    else
-    {
-        char szFormatting[32] = {};
-        const int nSignificantFigures = (int) (GUIntptr_t) jso->_userdata;
-        const int nInitialSignificantFigures =
-            nSignificantFigures >= 0 ? nSignificantFigures : 17;
-        CPLsnprintf(szFormatting, sizeof(szFormatting),
-                    "%%.%dg", nInitialSignificantFigures);
-        nSize = CPLsnprintf(szBuffer, sizeof(szBuffer),
-                            szFormatting, jso->o.c_double);
-        const char* pszDot = NULL;
-        if( nSize+2 < static_cast<int>(sizeof(szBuffer)) &&
-            (pszDot = strchr(szBuffer, '.')) == NULL )
-        {
-            nSize += CPLsnprintf(szBuffer + nSize, sizeof(szBuffer) - nSize,
-                                 ".0");
-        }
-
-        // Try to avoid .xxxx999999y or .xxxx000000y rounding issues by
-        // decreasing a bit precision.
-        if( nInitialSignificantFigures > 10 &&
-            pszDot != NULL &&
-            (strstr(pszDot, "999999") != NULL ||
-             strstr(pszDot, "000000") != NULL) )
-        {
-            bool bOK = false;
-            for( int i = 1; i <= 3; i++ )
-            {
-                CPLsnprintf(szFormatting, sizeof(szFormatting),
-                            "%%.%dg", nInitialSignificantFigures- i);
-                nSize = CPLsnprintf(szBuffer, sizeof(szBuffer),
-                                    szFormatting, jso->o.c_double);
-                pszDot = strchr(szBuffer, '.');
-                if( pszDot != NULL &&
-                    strstr(pszDot, "999999") == NULL &&
-                    strstr(pszDot, "000000") == NULL )
-                {
-                    bOK = true;
-                    break;
-                }
-            }
-            if( !bOK )
-            {
-                CPLsnprintf(szFormatting, sizeof(szFormatting),
-                            "%%.%dg", nInitialSignificantFigures);
-                nSize = CPLsnprintf(szBuffer, sizeof(szBuffer),
-                                    szFormatting, jso->o.c_double);
-                if( nSize+2 < static_cast<int>(sizeof(szBuffer)) &&
-                    strchr(szBuffer, '.') == NULL )
-                {
-                    nSize +=
-                        CPLsnprintf(szBuffer + nSize, sizeof(szBuffer) - nSize,
-                                    ".0");
-                }
-            }
-        }
-    }
-
+    const int nSize = OGRGeoJSONFormatDoubleWithSignificantFigures(
+        szBuffer, sizeof(szBuffer), jso->o.c_double, nSignificantFigures);
     return printbuf_memappend(pb, szBuffer, nSize);
 }
 
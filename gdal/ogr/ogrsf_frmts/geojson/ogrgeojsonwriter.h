@@ -40,6 +40,7 @@
 /*                         FORWARD DECLARATIONS                         */
 /************************************************************************/
 #ifdef __cplusplus
+class CPLString;
 class OGRFeature;
 class OGRGeometry;
 class OGRPoint;
@@ -95,7 +96,8 @@ class OGRGeoJSONWriteOptions
 
 OGREnvelope3D OGRGeoJSONGetBBox( OGRGeometry* poGeometry,
                                  const OGRGeoJSONWriteOptions& oOptions );
-json_object* OGRGeoJSONWriteFeature( OGRFeature* poFeature, const OGRGeoJSONWriteOptions& oOptions );
+json_object* OGRGeoJSONWriteFeature( OGRFeature* poFeature, const OGRGeoJSONWriteOptions& oOptions,
+                                     CPLString* posGeometryBuffer = NULL );
 json_object* OGRGeoJSONWriteAttributes( OGRFeature* poFeature,
                                         bool bWriteIdIfFoundInAttributes = true,
                                         const OGRGeoJSONWriteOptions& oOptions = OGRGeoJSONWriteOptions() );
@@ -108,6 +110,7 @@ json_object* OGRGeoJSONWriteMultiPoint( OGRMultiPoint* poGeometry, const OGRGeoJ
 json_object* OGRGeoJSONWriteMultiLineString( OGRMultiLineString* poGeometry, const OGRGeoJSONWriteOptions& oOptions );
 json_object* OGRGeoJSONWriteMultiPolygon( OGRMultiPolygon* poGeometry, const OGRGeoJSONWriteOptions& oOptions );
 json_object* OGRGeoJSONWriteGeometryCollection( OGRGeometryCollection* poGeometry, const OGRGeoJSONWriteOptions& oOptions );
+bool OGRGeoJSONAppendGeometry( CPLString& osOut, OGRGeometry* poGeometry, const OGRGeoJSONWriteOptions& oOptions );
 
 json_object* OGRGeoJSONWriteCoords( double const& fX, double const& fY, const OGRGeoJSONWriteOptions& oOptions );
 json_object* OGRGeoJSONWriteCoords( double const& fX, double const& fY, double const& fZ, const OGRGeoJSONWriteOptions& oOptions );
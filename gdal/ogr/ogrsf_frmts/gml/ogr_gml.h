@@ -36,13 +36,16 @@
 #include "gmlreader.h"
 #include "gmlutils.h"
 
+#include <vector>
+
 class OGRGMLDataSource;
 
 typedef enum
 {
     STANDARD,
     SEQUENTIAL_LAYERS,
-    INTERLEAVED_LAYERS
+    INTERLEAVED_LAYERS,
+    SPOOLED_LAYERS
 } ReadMode;
 
 /************************************************************************/
@@ -154,8 +157,16 @@ class OGRGMLDataSource : public OGRDataSource
     GMLFeature         *poStoredGMLFeature;
     OGRGMLLayer        *poLastReadLayer;
 
+    // SPOOLED_LAYERS read mode: features of each layer serialized in a
+    // temporary file during a single pass on the GML file.
+    bool                bLayersSpooled;
+    std::vector<VSILFILE*> apfpSpool;
+    std::vector<CPLString> aosSpoolFilenames;
+
     bool                bEmptyAsNull;
 
+    bool                SpoolLayers();
+
     void                FindAndParseTopElements(VSILFILE* fp);
     void                SetExtents(double dfMinX, double dfMinY, double dfMaxX, double dfMaxY);
 
@@ -210,6 +221,9 @@ class OGRGMLDataSource : public OGRDataSource
     OGRGMLLayer*        GetLastReadLayer() const { return poLastReadLayer; }
     void                SetLastReadLayer(OGRGMLLayer* poLayer) { poLastReadLayer = poLayer; }
 
+    GMLFeature         *GetNextSpooledFeature( OGRGMLLayer* poLayer );
+    void                RewindSpooledLayer( OGRGMLLayer* poLayer );
+
     const char         *GetAppPrefix() const;
     bool                RemoveAppPrefix() const;
     bool                WriteFeatureBoundedBy() const;
@@ -38,6 +38,7 @@
 #include "ogr_gml.h"
 
 #include <algorithm>
+#include <map>
 #include <vector>
 
 #include "cpl_conv.h"
@@ -111,6 +112,7 @@ OGRGMLDataSource::OGRGMLDataSource() :
     eReadMode(STANDARD),
     poStoredGMLFeature(NULL),
     poLastReadLayer(NULL),
+    bLayersSpooled(false),
     bEmptyAsNull(true)
 {}
 
@@ -255,6 +257,15 @@ OGRGMLDataSource::~OGRGMLDataSource()
 
     delete poStoredGMLFeature;
 
+    for( size_t i = 0; i < apfpSpool.size(); i++ )
+    {
+        if( apfpSpool[i] != NULL )
+        {
+            VSIFCloseL(apfpSpool[i]);
+            VSIUnlink(aosSpoolFilenames[i]);
+        }
+    }
+
     if (osXSDFilename.compare(
             CPLSPrintf("/vsimem/tmp_gml_xsd_%p.xsd", this)) == 0)
         VSIUnlink(osXSDFilename);
@@ -593,6 +604,8 @@ bool OGRGMLDataSource::Open( GDALOpenInfo *poOpenInfo )
         eReadMode = SEQUENTIAL_LAYERS;
     else if (EQUAL(pszReadMode, "INTERLEAVED_LAYERS"))
         eReadMode = INTERLEAVED_LAYERS;
+    else if (EQUAL(pszReadMode, "SPOOLED_LAYERS"))
+        eReadMode = SPOOLED_LAYERS;
     else
     {
         CPLDebug("GML",
@@ -1298,9 +1311,302 @@ bool OGRGMLDataSource::Open( GDALOpenInfo *poOpenInfo )
         nLayers++;
     }
 
+    // Spooling is only worth it if there are several layers.
+    if( eReadMode == SPOOLED_LAYERS && nLayers < 2 )
+        eReadMode = STANDARD;
+
+    return true;
+}
+
+/************************************************************************/
+/*                       Spooled feature serialization                  */
+/*                                                                      */
+/*      Features are written in native byte order, as the spool files   */
+/*      only live during the lifetime of the datasource.                */
+/************************************************************************/
+
+static void GMLSpoolAppendUInt32( CPLString& osBuffer, GUInt32 nVal )
+{
+    osBuffer.append(reinterpret_cast<const char*>(&nVal), sizeof(nVal));
+}
+
+static void GMLSpoolAppendString( CPLString& osBuffer, const char* pszStr )
+{
+    if( pszStr == NULL )
+    {
+        GMLSpoolAppendUInt32(osBuffer, 0xFFFFFFFFU);
+        return;
+    }
+    const size_t nLen = strlen(pszStr);
+    GMLSpoolAppendUInt32(osBuffer, static_cast<GUInt32>(nLen));
+    osBuffer.append(pszStr, nLen);
+}
+
+// Serialize a chain of sibling nodes, with their children.
+static void GMLSpoolAppendXMLNodeList( CPLString& osBuffer,
+                                       const CPLXMLNode* psNode )
+{
+    GUInt32 nCount = 0;
+    for( const CPLXMLNode* psIter = psNode; psIter; psIter = psIter->psNext )
+        nCount++;
+    GMLSpoolAppendUInt32(osBuffer, nCount);
+    for( const CPLXMLNode* psIter = psNode; psIter; psIter = psIter->psNext )
+    {
+        GMLSpoolAppendUInt32(osBuffer, static_cast<GUInt32>(psIter->eType));
+        GMLSpoolAppendString(osBuffer, psIter->pszValue);
+        GMLSpoolAppendXMLNodeList(osBuffer, psIter->psChild);
+    }
+}
+
+static bool GMLSpoolReadUInt32( VSILFILE* fp, GUInt32& nVal )
+{
+    return VSIFReadL(&nVal, sizeof(nVal), 1, fp) == 1;
+}
+
+static bool GMLSpoolReadString( VSILFILE* fp, char** ppszStr )
+{
+    *ppszStr = NULL;
+    GUInt32 nLen = 0;
+    if( !GMLSpoolReadUInt32(fp, nLen) )
+        return false;
+    if( nLen == 0xFFFFFFFFU )
+        return true;
+    char* pszStr = static_cast<char*>(VSI_MALLOC_VERBOSE(nLen + 1));
+    if( pszStr == NULL )
+        return false;
+    if( nLen > 0 && VSIFReadL(pszStr, nLen, 1, fp) != 1 )
+    {
+        CPLFree(pszStr);
+        return false;
+    }
+    pszStr[nLen] = '\0';
+    *ppszStr = pszStr;
+    return true;
+}
+
+static bool GMLSpoolReadXMLNodeList( VSILFILE* fp, CPLXMLNode** ppsFirst )
+{
+    *ppsFirst = NULL;
+    GUInt32 nCount = 0;
+    if( !GMLSpoolReadUInt32(fp, nCount) )
+        return false;
+    CPLXMLNode* psLast = NULL;
+    for( GUInt32 i = 0; i < nCount; i++ )
+    {
+        GUInt32 nType = 0;
+        char* pszValue = NULL;
+        if( !GMLSpoolReadUInt32(fp, nType) ||
+            !GMLSpoolReadString(fp, &pszValue) )
+        {
+            CPLDestroyXMLNode(*ppsFirst);
+            *ppsFirst = NULL;
+            return false;
+        }
+        CPLXMLNode* psNode =
+            static_cast<CPLXMLNode*>(CPLCalloc(sizeof(CPLXMLNode), 1));
+        psNode->eType = static_cast<CPLXMLNodeType>(nType);
+        psNode->pszValue = pszValue ? pszValue : CPLStrdup("");
+        if( psLast == NULL )
+            *ppsFirst = psNode;
+        else
+            psLast->psNext = psNode;
+        psLast = psNode;
+        if( !GMLSpoolReadXMLNodeList(fp, &(psNode->psChild)) )
+        {
+            CPLDestroyXMLNode(*ppsFirst);
+            *ppsFirst = NULL;
+            return false;
+        }
+    }
     return true;
 }
 
+/************************************************************************/
+/*                            SpoolLayers()                             */
+/*                                                                      */
+/*      Read the whole GML file once, and dispatch its features into    */
+/*      one temporary file per layer.                                   */
+/************************************************************************/
+
+bool OGRGMLDataSource::SpoolLayers()
+{
+    bLayersSpooled = true;
+
+    std::map<GMLFeatureClass*, int> oMapClassToLayer;
+    for( int i = 0; i < nLayers; i++ )
+        oMapClassToLayer[poReader->GetClass(i)] = i;
+
+    apfpSpool.resize(nLayers, NULL);
+    aosSpoolFilenames.resize(nLayers);
+    std::vector<GIntBig> anFeatureCount(nLayers, 0);
+
+    delete poStoredGMLFeature;
+    poStoredGMLFeature = NULL;
+    poReader->ResetReading();
+    poReader->SetFilteredClassName(NULL);
+
+    CPLDebug("GML", "Spooling features of %d layers", nLayers);
+
+    CPLString osBuffer;
+    GMLFeature *poGMLFeature = NULL;
+    while( (poGMLFeature = poReader->NextFeature()) != NULL )
+    {
+        std::map<GMLFeatureClass*, int>::const_iterator oIter =
+            oMapClassToLayer.find(poGMLFeature->GetClass());
+        if( oIter == oMapClassToLayer.end() )
+        {
+            delete poGMLFeature;
+            continue;
+        }
+        const int iLayer = oIter->second;
+
+        if( apfpSpool[iLayer] == NULL )
+        {
+            aosSpoolFilenames[iLayer] =
+                CPLGenerateTempFilename(CPLSPrintf("ogr_gml_spool_%d", iLayer));
+            apfpSpool[iLayer] = VSIFOpenL(aosSpoolFilenames[iLayer], "wb+");
+            if( apfpSpool[iLayer] == NULL )
+            {
+                CPLError(CE_Failure, CPLE_FileIO,
+                         "Cannot create spool file %s",
+                         aosSpoolFilenames[iLayer].c_str());
+                delete poGMLFeature;
+                return false;
+            }
+        }
+
+        osBuffer.clear();
+        GMLSpoolAppendString(osBuffer, poGMLFeature->GetFID());
+        const int nPropertyCount =
+            poGMLFeature->GetClass()->GetPropertyCount();
+        GMLSpoolAppendUInt32(osBuffer, static_cast<GUInt32>(nPropertyCount));
+        for( int iProp = 0; iProp < nPropertyCount; iProp++ )
+        {
+            const GMLProperty *psProperty = poGMLFeature->GetProperty(iProp);
+            const int nSubProperties =
+                psProperty ? psProperty->nSubProperties : 0;
+            GMLSpoolAppendUInt32(osBuffer,
+                                 static_cast<GUInt32>(nSubProperties));
+            for( int iSub = 0; iSub < nSubProperties; iSub++ )
+                GMLSpoolAppendString(osBuffer,
+                                     psProperty->papszSubProperties[iSub]);
+        }
+        const int nGeometryCount = poGMLFeature->GetGeometryCount();
+        GMLSpoolAppendUInt32(osBuffer, static_cast<GUInt32>(nGeometryCount));
+        for( int iGeom = 0; iGeom < nGeometryCount; iGeom++ )
+            GMLSpoolAppendXMLNodeList(osBuffer,
+                                      poGMLFeature->GetGeometryRef(iGeom));
+        delete poGMLFeature;
+
+        if( VSIFWriteL(osBuffer.data(), osBuffer.size(), 1,
+                       apfpSpool[iLayer]) != 1 )
+        {
+            CPLError(CE_Failure, CPLE_FileIO,
+                     "Cannot write in spool file %s",
+                     aosSpoolFilenames[iLayer].c_str());
+            return false;
+        }
+        anFeatureCount[iLayer]++;
+    }
+
+    for( int i = 0; i < nLayers; i++ )
+    {
+        GMLFeatureClass *poClass = poReader->GetClass(i);
+        if( poClass->GetFeatureCount() < 0 )
+            poClass->SetFeatureCount(anFeatureCount[i]);
+        if( apfpSpool[i] != NULL )
+            VSIFSeekL(apfpSpool[i], 0, SEEK_SET);
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                        RewindSpooledLayer()                          */
+/************************************************************************/
+
+void OGRGMLDataSource::RewindSpooledLayer( OGRGMLLayer* poLayer )
+{
+    if( !bLayersSpooled )
+        return;
+    for( int i = 0; i < nLayers; i++ )
+    {
+        if( papoLayers[i] == poLayer )
+        {
+            if( apfpSpool[i] != NULL )
+                VSIFSeekL(apfpSpool[i], 0, SEEK_SET);
+            break;
+        }
+    }
+}
+
+/************************************************************************/
+/*                       GetNextSpooledFeature()                        */
+/************************************************************************/
+
+GMLFeature *OGRGMLDataSource::GetNextSpooledFeature( OGRGMLLayer* poLayer )
+{
+    if( !bLayersSpooled && !SpoolLayers() )
+        return NULL;
+
+    int iLayer = 0;
+    for( ; iLayer < nLayers && papoLayers[iLayer] != poLayer; iLayer++ ) {}
+    if( iLayer == nLayers || iLayer >= static_cast<int>(apfpSpool.size()) ||
+        apfpSpool[iLayer] == NULL )
+        return NULL;
+
+    VSILFILE* fp = apfpSpool[iLayer];
+    char* pszFID = NULL;
+    if( !GMLSpoolReadString(fp, &pszFID) )
+        return NULL;
+
+    GMLFeatureClass *poClass = poReader->GetClass(iLayer);
+    GMLFeature *poGMLFeature = new GMLFeature(poClass);
+    if( pszFID != NULL )
+        poGMLFeature->SetFID(pszFID);
+    CPLFree(pszFID);
+
+    bool bOK = true;
+    GUInt32 nPropertyCount = 0;
+    bOK = GMLSpoolReadUInt32(fp, nPropertyCount);
+    for( GUInt32 iProp = 0; bOK && iProp < nPropertyCount; iProp++ )
+    {
+        GUInt32 nSubProperties = 0;
+        bOK = GMLSpoolReadUInt32(fp, nSubProperties);
+        for( GUInt32 iSub = 0; bOK && iSub < nSubProperties; iSub++ )
+        {
+            char* pszValue = NULL;
+            bOK = GMLSpoolReadString(fp, &pszValue);
+            if( bOK )
+                poGMLFeature->SetPropertyDirectly(
+                    static_cast<int>(iProp),
+                    pszValue ? pszValue : CPLStrdup(""));
+        }
+    }
+
+    GUInt32 nGeometryCount = 0;
+    if( bOK )
+        bOK = GMLSpoolReadUInt32(fp, nGeometryCount);
+    for( GUInt32 iGeom = 0; bOK && iGeom < nGeometryCount; iGeom++ )
+    {
+        CPLXMLNode* psGeom = NULL;
+        bOK = GMLSpoolReadXMLNodeList(fp, &psGeom);
+        if( bOK && psGeom != NULL )
+            poGMLFeature->SetGeometryDirectly(static_cast<int>(iGeom), psGeom);
+    }
+
+    if( !bOK )
+    {
+        CPLError(CE_Failure, CPLE_FileIO,
+                 "Cannot read spool file %s",
+                 aosSpoolFilenames[iLayer].c_str());
+        delete poGMLFeature;
+        return NULL;
+    }
+
+    return poGMLFeature;
+}
+
 /************************************************************************/
 /*                          BuildJointClassFromXSD()                    */
 /************************************************************************/
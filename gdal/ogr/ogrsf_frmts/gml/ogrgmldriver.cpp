@@ -169,6 +169,7 @@ void RegisterOGRGML()
 "    <Value>STANDARD</Value>"
 "    <Value>SEQUENTIAL_LAYERS</Value>"
 "    <Value>INTERLEAVED_LAYERS</Value>"
+"    <Value>SPOOLED_LAYERS</Value>"
 "  </Option>"
 "  <Option name='EXPOSE_GML_ID' type='string-select' description='Whether to make feature gml:id as a gml_id attribute' default='AUTO'>"
 "    <Value>AUTO</Value>"
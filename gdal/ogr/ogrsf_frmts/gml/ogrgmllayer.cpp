@@ -94,6 +94,15 @@ void OGRGMLLayer::ResetReading()
     if (bWriter)
         return;
 
+    if (poDS->GetReadMode() == SPOOLED_LAYERS)
+    {
+        // Each layer reads its own spool file, so no need to restart the
+        // parsing of the GML file.
+        iNextGMLId = 0;
+        poDS->RewindSpooledLayer(this);
+        return;
+    }
+
     if (poDS->GetReadMode() == INTERLEAVED_LAYERS ||
         poDS->GetReadMode() == SEQUENTIAL_LAYERS)
     {
@@ -147,7 +156,8 @@ OGRFeature *OGRGMLLayer::GetNextFeature()
 
     if( poDS->GetLastReadLayer() != this )
     {
-        if( poDS->GetReadMode() != INTERLEAVED_LAYERS )
+        if( poDS->GetReadMode() != INTERLEAVED_LAYERS &&
+            poDS->GetReadMode() != SPOOLED_LAYERS )
             ResetReading();
         poDS->SetLastReadLayer(this);
     }
@@ -159,7 +169,14 @@ OGRFeature *OGRGMLLayer::GetNextFeature()
     while( true )
     {
         GMLFeature *poGMLFeature = poDS->PeekStoredGMLFeature();
-        if (poGMLFeature != NULL)
+        if (poDS->GetReadMode() == SPOOLED_LAYERS)
+        {
+            poGMLFeature = poDS->GetNextSpooledFeature(this);
+            if( poGMLFeature == NULL )
+                return NULL;
+            m_nFeaturesRead++;
+        }
+        else if (poGMLFeature != NULL)
         {
             poDS->SetStoredGMLFeature(NULL);
         }
@@ -76,6 +76,8 @@ GDALGPKGMBTilesLikePseudoDataset::GDALGPKGMBTilesLikePseudoDataset() :
         CPLTestBool(CPLGetConfigOption("GPKG_FORCE_TEMPDB_COMPACTION", "NO"))),
     m_nAge(0),
     m_nTileInsertionCount(0),
+    m_poWorkerThreadPool(NULL),
+    m_hWorkerThreadPoolMutex(NULL),
     m_poParentDS(NULL),
     m_bInWriteTile(false)
 {
@@ -112,6 +114,76 @@ GDALGPKGMBTilesLikePseudoDataset::~GDALGPKGMBTilesLikePseudoDataset()
     CPLFree(m_pabyCachedTiles);
     delete m_poCT;
     CPLFree(m_pabyHugeColorArray);
+
+    if( m_poWorkerThreadPool != NULL )
+    {
+        // Pending jobs should have been inserted by FlushTiles() already.
+        m_poWorkerThreadPool->WaitCompletion(0);
+        delete m_poWorkerThreadPool;
+        for( size_t i = 0; i < m_asEncodingJobs.size(); i++ )
+        {
+            GPKGTileEncodingJob* psJob = &m_asEncodingJobs[i];
+            CPLFree(psJob->pabyTileData);
+            CPLFree(psJob->pabyBlob);
+            delete psJob->poCT;
+            CSLDestroy(psJob->papszDriverOptions);
+            CPLFree(psJob->pabyHugeColorArray);
+            CPLFree(psJob->pszTmpFilename);
+        }
+        CPLDestroyMutex(m_hWorkerThreadPoolMutex);
+    }
+}
+
+/************************************************************************/
+/*                          InitWorkerThreads()                         */
+/************************************************************************/
+
+void GDALGPKGMBTilesLikePseudoDataset::InitWorkerThreads(char** papszOptions)
+{
+    if( m_poParentDS != NULL || m_poWorkerThreadPool != NULL )
+        return;
+
+    const char* pszValue = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszValue == NULL )
+        pszValue = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
+    if( pszValue == NULL )
+        return;
+
+    const int nThreads =
+        EQUAL(pszValue, "ALL_CPUS") ? CPLGetNumCPUs() : atoi(pszValue);
+    if( nThreads > 1 )
+    {
+        CPLDebug("GPKG", "Using %d worker threads", nThreads);
+        m_poWorkerThreadPool = new CPLWorkerThreadPool();
+        if( !m_poWorkerThreadPool->Setup(nThreads, NULL, NULL) )
+        {
+            delete m_poWorkerThreadPool;
+            m_poWorkerThreadPool = NULL;
+            return;
+        }
+
+        // One job more than threads, so that the main thread can insert
+        // tiles while all threads are encoding.
+        m_asEncodingJobs.resize(nThreads + 1);
+        memset(&m_asEncodingJobs[0], 0,
+               m_asEncodingJobs.size() * sizeof(GPKGTileEncodingJob));
+        for( size_t i = 0; i < m_asEncodingJobs.size(); i++ )
+        {
+            m_asEncodingJobs[i].pszTmpFilename =
+                CPLStrdup(CPLSPrintf("/vsimem/gpkg_encode_tile_%p",
+                                     &m_asEncodingJobs[i]));
+        }
+        m_hWorkerThreadPoolMutex = CPLCreateMutex();
+        CPLReleaseMutex(m_hWorkerThreadPoolMutex);
+    }
+    else if( nThreads < 0 ||
+             (!EQUAL(pszValue, "0") &&
+              !EQUAL(pszValue, "1") &&
+              !EQUAL(pszValue, "ALL_CPUS")) )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Invalid value for NUM_THREADS: %s", pszValue);
+    }
 }
 
 /************************************************************************/
@@ -191,6 +263,9 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::FlushTiles()
         }
     }
 
+    if( poMainDS->FlushEncodingJobs() != CE_None )
+        eErr = CE_Failure;
+
     if( poMainDS->m_nTileInsertionCount > 0 )
     {
         if( poMainDS->ICommitTransaction() != OGRERR_NONE )
@@ -898,6 +973,9 @@ GByte* GDALGPKGMBTilesLikePseudoDataset::ReadTile( int nRow, int nCol, GByte *pa
     CPLDebug( "GPKG", "ReadTile(row=%d, col=%d)", nRow, nCol );
 #endif
 
+    if( WaitCompletionForTile(nRow, nCol) != CE_None )
+        return NULL;
+
     char *pszSQL = sqlite3_mprintf( "SELECT tile_data%s FROM \"%w\" "
         "WHERE zoom_level = %d AND tile_row = %d AND tile_column = %d%s",
         m_eDT != GDT_Byte ? ", id" : "", // MBTiles do not have an id
@@ -1218,6 +1296,244 @@ retry:
     return CE_None;
 }
 
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr GDALGPKGMBTilesLikeRasterBand::IRasterIO( GDALRWFlag eRWFlag,
+                                int nXOff, int nYOff, int nXSize, int nYSize,
+                                void * pData, int nBufXSize, int nBufYSize,
+                                GDALDataType eBufType,
+                                GSpacing nPixelSpace, GSpacing nLineSpace,
+                                GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag == GF_Read )
+    {
+        m_poTPD->PrefetchTiles(nXOff, nYOff, nXSize, nYSize,
+                               nBufXSize, nBufYSize);
+    }
+    return GDALPamRasterBand::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                                        pData, nBufXSize, nBufYSize, eBufType,
+                                        nPixelSpace, nLineSpace, psExtraArg);
+}
+
+/************************************************************************/
+/*                        ThreadDecodeTileFunc()                        */
+/************************************************************************/
+
+void GDALGPKGMBTilesLikePseudoDataset::ThreadDecodeTileFunc(void* pData)
+{
+    GPKGTileDecodingJob* psJob = static_cast<GPKGTileDecodingJob*>(pData);
+    if( psJob->pabyBlob == NULL )
+    {
+        psJob->poDS->FillEmptyTile(psJob->pabyTileData);
+        return;
+    }
+
+    CPLString osMemFileName;
+    osMemFileName.Printf("/vsimem/gpkg_decode_tile_%p", psJob);
+    VSILFILE * fp = VSIFileFromMemBuffer(
+        osMemFileName.c_str(), psJob->pabyBlob, psJob->nBlobSize, FALSE );
+    VSIFCloseL(fp);
+    psJob->poDS->ReadTile(osMemFileName, psJob->pabyTileData,
+                          psJob->dfTileOffset, psJob->dfTileScale, NULL);
+    VSIUnlink(osMemFileName);
+}
+
+/************************************************************************/
+/*                           PrefetchTiles()                            */
+/************************************************************************/
+
+/* Fetch with a single request the tiles intersecting a RasterIO() window */
+/* that are not yet in the block cache, decode them in the worker threads */
+/* and put the result in the block cache of all bands. */
+void GDALGPKGMBTilesLikePseudoDataset::PrefetchTiles(int nXOff, int nYOff,
+                                                     int nXSize, int nYSize,
+                                                     int nBufXSize,
+                                                     int nBufYSize)
+{
+    GDALGPKGMBTilesLikePseudoDataset* poMainDS =
+        m_poParentDS ? m_poParentDS : this;
+    CPLWorkerThreadPool* poPool = poMainDS->m_poWorkerThreadPool;
+    // In update mode, tiles may be partially written in m_pabyCachedTiles or
+    // in the temporary database, so let IReadBlock() deal with them.
+    if( poPool == NULL || IGetUpdate() ||
+        m_nShiftXPixelsMod != 0 || m_nShiftYPixelsMod != 0 )
+        return;
+
+    GDALRasterBand* poBand1 = IGetRasterBand(1);
+    // Downsampled requests are redirected to the overviews, which will
+    // prefetch their own tiles.
+    if( (nBufXSize < nXSize || nBufYSize < nYSize) &&
+        poBand1->GetOverviewCount() > 0 )
+        return;
+
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poBand1->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const int nBands = IGetRasterCount();
+    const size_t nBandBlockSize =
+        static_cast<size_t>(nBlockXSize) * nBlockYSize * m_nDTSize;
+
+    const int nBlockXOff0 = nXOff / nBlockXSize;
+    const int nBlockYOff0 = nYOff / nBlockYSize;
+    const int nBlockXOff1 = (nXOff + nXSize - 1) / nBlockXSize;
+    const int nBlockYOff1 = (nYOff + nYSize - 1) / nBlockYSize;
+    const int nBlocksPerRow = nBlockXOff1 - nBlockXOff0 + 1;
+    const GIntBig nBlocksBig = static_cast<GIntBig>(nBlocksPerRow) *
+                                        (nBlockYOff1 - nBlockYOff0 + 1);
+    // Decoding more than the cache can hold would be wasted
+    if( nBlocksBig < 2 ||
+        nBlocksBig > GDALGetCacheMax64() / 2 /
+                        (nBands * static_cast<GIntBig>(nBandBlockSize)) )
+        return;
+    const int nBlocks = static_cast<int>(nBlocksBig);
+
+    // Collect the blocks that are missing in the cache for at least one band
+    std::vector<int> anJobIdx(nBlocks, -1);
+    int nJobs = 0;
+    for( int iBlock = 0; iBlock < nBlocks; iBlock++ )
+    {
+        const int nBlockXOff = nBlockXOff0 + iBlock % nBlocksPerRow;
+        const int nBlockYOff = nBlockYOff0 + iBlock / nBlocksPerRow;
+        for( int iBand = 1; iBand <= nBands; iBand++ )
+        {
+            GDALRasterBlock* poBlock =
+                static_cast<GDALGPKGMBTilesLikeRasterBand*>(
+                    IGetRasterBand(iBand))->
+                        AccessibleTryGetLockedBlockRef(nBlockXOff, nBlockYOff);
+            if( poBlock == NULL )
+            {
+                anJobIdx[iBlock] = nJobs++;
+                break;
+            }
+            poBlock->DropLock();
+        }
+    }
+    if( nJobs < 2 )
+        return;
+
+    // Must be established here, since ReadTile() consults it
+    poBand1->GetColorTable();
+
+    std::vector<GPKGTileDecodingJob> asJobs(nJobs);
+    memset(&asJobs[0], 0, nJobs * sizeof(GPKGTileDecodingJob));
+    for( int iBlock = 0; iBlock < nBlocks; iBlock++ )
+    {
+        if( anJobIdx[iBlock] < 0 )
+            continue;
+        GPKGTileDecodingJob* psJob = &asJobs[anJobIdx[iBlock]];
+        psJob->poDS = this;
+        psJob->nBlockXOff = nBlockXOff0 + iBlock % nBlocksPerRow;
+        psJob->nBlockYOff = nBlockYOff0 + iBlock / nBlocksPerRow;
+        psJob->dfTileScale = 1.0;
+    }
+
+    const int nRowMin = nBlockYOff0 + m_nShiftYTiles;
+    const int nRowMax = nBlockYOff1 + m_nShiftYTiles;
+    const int nColMin = nBlockXOff0 + m_nShiftXTiles;
+    const int nColMax = nBlockXOff1 + m_nShiftXTiles;
+    const int nTopRow1 = GetRowFromIntoTopConvention(nRowMin);
+    const int nTopRow2 = GetRowFromIntoTopConvention(nRowMax);
+    char *pszSQL = sqlite3_mprintf( "SELECT tile_row, tile_column, tile_data%s "
+        "FROM \"%w\" WHERE zoom_level = %d AND tile_row >= %d AND "
+        "tile_row <= %d AND tile_column >= %d AND tile_column <= %d%s",
+        m_eDT != GDT_Byte ? ", id" : "", // MBTiles do not have an id
+        m_osRasterTable.c_str(), m_nZoomLevel,
+        std::min(nTopRow1, nTopRow2), std::max(nTopRow1, nTopRow2),
+        nColMin, nColMax,
+        !m_osWHERE.empty() ? CPLSPrintf(" AND (%s)", m_osWHERE.c_str()): "");
+
+#ifdef DEBUG_VERBOSE
+    CPLDebug("GPKG", "%s", pszSQL);
+#endif
+
+    sqlite3_stmt *hStmt = NULL;
+    int rc = sqlite3_prepare_v2( IGetDB(), pszSQL, -1, &hStmt, NULL );
+    sqlite3_free(pszSQL);
+    if ( rc != SQLITE_OK )
+        return;
+
+    bool bOK = true;
+    while( (rc = sqlite3_step( hStmt )) == SQLITE_ROW )
+    {
+        if( sqlite3_column_type( hStmt, 2 ) != SQLITE_BLOB )
+            continue;
+        const int nRow =
+            GetRowFromIntoTopConvention(sqlite3_column_int( hStmt, 0 ));
+        const int nCol = sqlite3_column_int( hStmt, 1 );
+        if( nRow < nRowMin || nRow > nRowMax ||
+            nCol < nColMin || nCol > nColMax )
+            continue;
+        const int iBlock =
+            (nRow - nRowMin) * nBlocksPerRow + (nCol - nColMin);
+        if( anJobIdx[iBlock] < 0 )
+            continue;
+        GPKGTileDecodingJob* psJob = &asJobs[anJobIdx[iBlock]];
+        if( psJob->pabyBlob != NULL )
+            continue;
+
+        const int nBytes = sqlite3_column_bytes( hStmt, 2 );
+        psJob->pabyBlob = static_cast<GByte*>(VSI_MALLOC_VERBOSE(nBytes));
+        if( psJob->pabyBlob == NULL )
+        {
+            bOK = false;
+            break;
+        }
+        memcpy(psJob->pabyBlob, sqlite3_column_blob( hStmt, 2 ), nBytes);
+        psJob->nBlobSize = nBytes;
+        if( m_eDT != GDT_Byte )
+        {
+            GetTileOffsetAndScale(sqlite3_column_int64( hStmt, 3 ),
+                                  psJob->dfTileOffset, psJob->dfTileScale);
+        }
+    }
+    sqlite3_finalize(hStmt);
+
+    // Tiles outside of the tile matrix are read as empty tiles, which is
+    // also what a missing tile gives since the dataset is not shifted.
+    for( int i = 0; bOK && i < nJobs; i++ )
+    {
+        asJobs[i].pabyTileData = static_cast<GByte*>(
+            VSI_MALLOC_VERBOSE(std::max(nBands, 4) * nBandBlockSize));
+        if( asJobs[i].pabyTileData == NULL )
+            bOK = false;
+    }
+
+    if( bOK )
+    {
+        for( int i = 0; i < nJobs; i++ )
+            poPool->SubmitJob(ThreadDecodeTileFunc, &asJobs[i]);
+        poPool->WaitCompletion(0);
+
+        for( int i = 0; i < nJobs; i++ )
+        {
+            for( int iBand = 1; iBand <= nBands; iBand++ )
+            {
+                GDALRasterBlock* poBlock =
+                    IGetRasterBand(iBand)->GetLockedBlockRef(
+                        asJobs[i].nBlockXOff, asJobs[i].nBlockYOff, TRUE);
+                if( poBlock == NULL )
+                    continue;
+                if( !poBlock->GetDirty() )
+                {
+                    memcpy(poBlock->GetDataRef(),
+                           asJobs[i].pabyTileData +
+                                        (iBand - 1) * nBandBlockSize,
+                           nBandBlockSize);
+                }
+                poBlock->DropLock();
+            }
+        }
+    }
+
+    for( int i = 0; i < nJobs; i++ )
+    {
+        CPLFree(asJobs[i].pabyBlob);
+        CPLFree(asJobs[i].pabyTileData);
+    }
+}
+
 /************************************************************************/
 /*                       WEBPSupports4Bands()                           */
 /************************************************************************/
@@ -1250,6 +1566,9 @@ static bool WEBPSupports4Bands()
 
 GIntBig GDALGPKGMBTilesLikePseudoDataset::GetTileId(int nRow, int nCol)
 {
+    if( WaitCompletionForTile(nRow, nCol) != CE_None )
+        return 0;
+
     char* pszSQL = sqlite3_mprintf(
             "SELECT id FROM \"%w\" WHERE zoom_level = %d AND "
             "tile_row = %d AND tile_column = %d",
@@ -1266,6 +1585,9 @@ GIntBig GDALGPKGMBTilesLikePseudoDataset::GetTileId(int nRow, int nCol)
 
 bool GDALGPKGMBTilesLikePseudoDataset::DeleteTile(int nRow, int nCol)
 {
+    if( WaitCompletionForTile(nRow, nCol) != CE_None )
+        return false;
+
     char* pszSQL = sqlite3_mprintf("DELETE FROM \"%w\" "
         "WHERE zoom_level = %d AND tile_row = %d AND "
         "tile_column = %d",
@@ -1722,8 +2044,8 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
     GDALDriver* l_poDriver = (GDALDriver*) GDALGetDriverByName(pszDriverName);
     if( l_poDriver != NULL)
     {
-        GDALDataset* poMEMDS = MEMDataset::Create("", nBlockXSize, nBlockYSize,
-                                                  0, eTileDT, NULL);
+        // Only used for elevation tiles. Byte tiles are set up by EncodeTile()
+        GDALDataset* poMEMDS = NULL;
         int nTileBands = nBands;
         if( bPartialTile && nBands == 1 && m_poCT == NULL && bTileDriverSupports2Bands )
             nTileBands = 2;
@@ -1791,6 +2113,8 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
         double dfTileScale = 1.0;
         if( m_eTF == GPKG_TF_PNG_16BIT )
         {
+            poMEMDS = MEMDataset::Create("", nBlockXSize, nBlockYSize,
+                                         0, eTileDT, NULL);
             pTempTileBuffer = static_cast<GUInt16*>(
                 VSI_MALLOC3_VERBOSE(2, nBlockXSize, nBlockYSize));
 
@@ -1945,6 +2269,8 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
         }
         else if( m_eTF == GPKG_TF_TIFF_32BIT_FLOAT )
         {
+            poMEMDS = MEMDataset::Create("", nBlockXSize, nBlockYSize,
+                                         0, eTileDT, NULL);
             const float* pSrc = reinterpret_cast<float*>(m_pabyCachedTiles);
             float fMin = 0.0f;
             float fMax = 0.0f;
@@ -1994,34 +2320,6 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
             poMEMDS->AddBand(GDT_Float32, papszOptions);
             CSLDestroy(papszOptions);
         }
-        else
-        {
-            CPLAssert( m_eDT == GDT_Byte );
-            for( int i = 0; i < nTileBands; i++ )
-            {
-                char** papszOptions = NULL;
-                char szDataPointer[32];
-                int iSrc = i;
-                if( nBands == 1 && m_poCT == NULL && nTileBands == 3 )
-                    iSrc = 0;
-                else if( nBands == 1 && m_poCT == NULL && bPartialTile &&
-                         nTileBands == 4 )
-                    iSrc = (i < 3) ? 0 : 3;
-                else if( nBands == 2 && nTileBands >= 3 )
-                    iSrc = (i < 3) ? 0 : 1;
-                int nRet = CPLPrintPointer(szDataPointer,
-                        m_pabyCachedTiles + iSrc * nBlockXSize * nBlockYSize,
-                        sizeof(szDataPointer));
-                szDataPointer[nRet] = '\0';
-                papszOptions = CSLSetNameValue(papszOptions,
-                                               "DATAPOINTER", szDataPointer);
-                poMEMDS->AddBand(GDT_Byte, papszOptions);
-                if( i == 0 && nTileBands == 1 && m_poCT != NULL )
-                    poMEMDS->GetRasterBand(1)->SetColorTable(m_poCT);
-                CSLDestroy(papszOptions);
-            }
-        }
-
         if( (m_eTF == GPKG_TF_PNG_16BIT ||
              m_eTF == GPKG_TF_TIFF_32BIT_FLOAT) &&
             nValidPixels == 0 )
@@ -2041,60 +2339,7 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
             return CE_None;
         }
 
-        if( m_eTF == GPKG_TF_PNG8 && nTileBands == 1 && nBands >= 3 )
-        {
-            GDALDataset* poMEM_RGB_DS = MEMDataset::Create("", nBlockXSize, nBlockYSize,
-                                                  0, GDT_Byte, NULL);
-            for( int i = 0; i < 3; i++ )
-            {
-                char** papszOptions = NULL;
-                char szDataPointer[32];
-                int nRet = CPLPrintPointer(szDataPointer,
-                                        m_pabyCachedTiles + i * nBandBlockSize,
-                                        sizeof(szDataPointer));
-                szDataPointer[nRet] = '\0';
-                papszOptions = CSLSetNameValue(papszOptions, "DATAPOINTER", szDataPointer);
-                poMEM_RGB_DS->AddBand(GDT_Byte, papszOptions);
-                CSLDestroy(papszOptions);
-            }
-
-            if( m_pabyHugeColorArray == NULL )
-            {
-                if( nBlockXSize <= 65536 / nBlockYSize )
-                    m_pabyHugeColorArray = (GByte*) VSIMalloc(MEDIAN_CUT_AND_DITHER_BUFFER_SIZE_65536);
-                else
-                    m_pabyHugeColorArray = (GByte*) VSIMalloc2(256 * 256 * 256, sizeof(GUInt32));
-            }
-
-            GDALColorTable* poCT = new GDALColorTable();
-            GDALComputeMedianCutPCTInternal( poMEM_RGB_DS->GetRasterBand(1),
-                                       poMEM_RGB_DS->GetRasterBand(2),
-                                       poMEM_RGB_DS->GetRasterBand(3),
-                                       /*NULL, NULL, NULL,*/
-                                       m_pabyCachedTiles,
-                                       m_pabyCachedTiles + nBandBlockSize,
-                                       m_pabyCachedTiles + 2 * nBandBlockSize,
-                                       NULL,
-                                       256, /* max colors */
-                                       8, /* bit depth */
-                                       (GUInt32*)m_pabyHugeColorArray, /* preallocated histogram */
-                                       poCT,
-                                       NULL, NULL );
-
-            GDALDitherRGB2PCTInternal( poMEM_RGB_DS->GetRasterBand(1),
-                               poMEM_RGB_DS->GetRasterBand(2),
-                               poMEM_RGB_DS->GetRasterBand(3),
-                               poMEMDS->GetRasterBand(1),
-                               poCT,
-                               8, /* bit depth */
-                               (GInt16*)m_pabyHugeColorArray, /* pasDynamicColorMap */
-                               m_bDither,
-                               NULL, NULL );
-            poMEMDS->GetRasterBand(1)->SetColorTable(poCT);
-            delete poCT;
-            GDALClose( poMEM_RGB_DS );
-        }
-        else if( nBands == 1 && m_poCT != NULL && nTileBands > 1 )
+        if( nBands == 1 && m_poCT != NULL && nTileBands > 1 )
         {
             GByte abyCT[4*256];
             const int nEntries = std::min(256, m_poCT->GetColorEntryCount());
@@ -2175,76 +2420,72 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
             papszDriverOptions = CSLSetNameValue(
                 papszDriverOptions, "COMPRESS", "LZW");
         }
-#ifdef DEBUG
-        VSIStatBufL sStat;
-        CPLAssert(VSIStatL(osMemFileName, &sStat) != 0);
-#endif
-        GDALDataset* poOutDS = l_poDriver->CreateCopy(osMemFileName, poMEMDS,
-                                                    FALSE, papszDriverOptions, NULL, NULL);
-        CSLDestroy( papszDriverOptions );
-        CPLFree(pTempTileBuffer);
-
-        if( poOutDS )
+        GByte* pabyBlob = NULL;
+        vsi_l_offset nBlobSize = 0;
+        if( poMEMDS == NULL )
         {
-            GDALClose( poOutDS );
-            vsi_l_offset nBlobSize = 0;
-            GByte* pabyBlob =
-                VSIGetMemFileBuffer(osMemFileName, &nBlobSize, TRUE);
-
-            /* Create or commit and recreate transaction */
-            GDALGPKGMBTilesLikePseudoDataset* poMainDS = m_poParentDS ? m_poParentDS : this;
-            if( poMainDS->m_nTileInsertionCount == 0 )
-            {
-                poMainDS->IStartTransaction();
-            }
-            else if( poMainDS->m_nTileInsertionCount == 1000 )
+            GPKGTileEncodingJob sJob;
+            memset(&sJob, 0, sizeof(sJob));
+            sJob.poDS = this;
+            sJob.nRow = nRow;
+            sJob.nCol = nCol;
+            sJob.pabyTileData = m_pabyCachedTiles;
+            sJob.nBlockXSize = nBlockXSize;
+            sJob.nBlockYSize = nBlockYSize;
+            sJob.nBands = nBands;
+            sJob.nTileBands = nTileBands;
+            sJob.bPartialTile = bPartialTile;
+            sJob.bPNG8 = m_eTF == GPKG_TF_PNG8 && nTileBands == 1 && nBands >= 3;
+            sJob.bDither = m_bDither;
+            sJob.poCT = m_poCT;
+            sJob.poDriver = l_poDriver;
+            sJob.papszDriverOptions = papszDriverOptions;
+
+            GDALGPKGMBTilesLikePseudoDataset* poMainDS =
+                m_poParentDS ? m_poParentDS : this;
+            if( poMainDS->m_poWorkerThreadPool != NULL )
             {
-                if( poMainDS->ICommitTransaction() != OGRERR_NONE )
-                {
-                    poMainDS->m_nTileInsertionCount = -1;
-                    CPLFree(pabyBlob);
-                    VSIUnlink(osMemFileName);
-                    delete poMEMDS;
-                    return CE_Failure;
-                }
-                poMainDS->IStartTransaction();
-                poMainDS->m_nTileInsertionCount = 0;
+                // The job takes ownership of the options and of the copy
+                // of the color table.
+                sJob.poCT = m_poCT ? m_poCT->Clone() : NULL;
+                return poMainDS->SubmitEncodingJob(
+                    sJob, nBandBlockSize * std::max(nBands, nTileBands));
             }
-            poMainDS->m_nTileInsertionCount ++;
 
-            char* pszSQL = sqlite3_mprintf("INSERT OR REPLACE INTO \"%w\" "
-                "(zoom_level, tile_row, tile_column, tile_data) VALUES (%d, %d, %d, ?)",
-                m_osRasterTable.c_str(), m_nZoomLevel, GetRowFromIntoTopConvention(nRow), nCol);
-#ifdef DEBUG_VERBOSE
-            CPLDebug("GPKG", "%s", pszSQL);
+            sJob.pszTmpFilename = const_cast<char*>(osMemFileName.c_str());
+            sJob.pabyHugeColorArray = m_pabyHugeColorArray;
+            EncodeTile(&sJob);
+            m_pabyHugeColorArray = sJob.pabyHugeColorArray;
+            pabyBlob = sJob.pabyBlob;
+            nBlobSize = sJob.nBlobSize;
+            CSLDestroy( papszDriverOptions );
+        }
+        else
+        {
+#ifdef DEBUG
+            VSIStatBufL sStat;
+            CPLAssert(VSIStatL(osMemFileName, &sStat) != 0);
 #endif
-            sqlite3_stmt* hStmt = NULL;
-            int rc = sqlite3_prepare_v2(IGetDB(), pszSQL, -1, &hStmt, NULL);
-            if ( rc != SQLITE_OK )
+            GDALDataset* poOutDS = l_poDriver->CreateCopy(osMemFileName,
+                                    poMEMDS, FALSE, papszDriverOptions, NULL, NULL);
+            CSLDestroy( papszDriverOptions );
+            CPLFree(pTempTileBuffer);
+            if( poOutDS )
             {
-                CPLError( CE_Failure, CPLE_AppDefined,
-                          "failed to prepare SQL %s: %s",
-                          pszSQL, sqlite3_errmsg(IGetDB()) );
-                CPLFree(pabyBlob);
+                GDALClose( poOutDS );
+                pabyBlob = VSIGetMemFileBuffer(osMemFileName, &nBlobSize, TRUE);
             }
-            else
-            {
-                sqlite3_bind_blob( hStmt, 1, pabyBlob, (int)nBlobSize, CPLFree);
-                rc = sqlite3_step( hStmt );
-                if( rc == SQLITE_DONE )
-                    eErr = CE_None;
-                else
-                {
-                    CPLError(CE_Failure, CPLE_AppDefined,
-                             "Failure when inserting tile (row=%d,col=%d) at zoom_level=%d : %s",
-                             GetRowFromIntoTopConvention(nRow), nCol, m_nZoomLevel, sqlite3_errmsg(IGetDB()));
-                }
-            }
-            sqlite3_finalize(hStmt);
-            sqlite3_free(pszSQL);
+            VSIUnlink(osMemFileName);
+            delete poMEMDS;
+        }
 
-            if( m_eTF == GPKG_TF_PNG_16BIT ||
-                m_eTF == GPKG_TF_TIFF_32BIT_FLOAT )
+        if( pabyBlob != NULL )
+        {
+            eErr = InsertTile(nRow, nCol, pabyBlob, nBlobSize);
+
+            if( eErr == CE_None &&
+                (m_eTF == GPKG_TF_PNG_16BIT ||
+                 m_eTF == GPKG_TF_TIFF_32BIT_FLOAT) )
             {
                 GIntBig nTileId = GetTileId(nRow, nCol);
                 if( nTileId == 0 )
@@ -2253,7 +2494,7 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
                 {
                     DeleteFromGriddedTileAncillary(nTileId);
 
-                    pszSQL = sqlite3_mprintf(
+                    char* pszSQL = sqlite3_mprintf(
                         "INSERT INTO gpkg_2d_gridded_tile_ancillary "
                         "(tpudt_name, tpudt_id, scale, offset, min, max, "
                         "mean, std_dev) VALUES "
@@ -2262,8 +2503,8 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
 #ifdef DEBUG_VERBOSE
                     CPLDebug("GPKG", "%s", pszSQL);
 #endif
-                    hStmt = NULL;
-                    rc = sqlite3_prepare_v2(IGetDB(), pszSQL, -1, &hStmt, NULL);
+                    sqlite3_stmt* hStmt = NULL;
+                    int rc = sqlite3_prepare_v2(IGetDB(), pszSQL, -1, &hStmt, NULL);
                     if ( rc != SQLITE_OK )
                     {
                         eErr = CE_Failure;
@@ -2296,9 +2537,6 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
                 }
             }
         }
-
-        VSIUnlink(osMemFileName);
-        delete poMEMDS;
     }
     else
     {
@@ -2309,6 +2547,344 @@ CPLErr GDALGPKGMBTilesLikePseudoDataset::WriteTileInternal()
     return eErr;
 }
 
+/************************************************************************/
+/*                            EncodeTile()                              */
+/************************************************************************/
+
+/* Compress a Byte tile with the tile driver. Must not touch the dataset, */
+/* since it may run in a worker thread. */
+void GDALGPKGMBTilesLikePseudoDataset::EncodeTile(GPKGTileEncodingJob* psJob)
+{
+    const int nBlockXSize = psJob->nBlockXSize;
+    const int nBlockYSize = psJob->nBlockYSize;
+    const int nBands = psJob->nBands;
+    const int nTileBands = psJob->nTileBands;
+    const size_t nBandBlockSize = static_cast<size_t>(nBlockXSize) * nBlockYSize;
+    GByte* pabyTileData = psJob->pabyTileData;
+
+    GDALDataset* poMEMDS = MEMDataset::Create("", nBlockXSize, nBlockYSize,
+                                              0, GDT_Byte, NULL);
+    for( int i = 0; i < nTileBands; i++ )
+    {
+        char** papszOptions = NULL;
+        char szDataPointer[32];
+        int iSrc = i;
+        if( nBands == 1 && psJob->poCT == NULL && nTileBands == 3 )
+            iSrc = 0;
+        else if( nBands == 1 && psJob->poCT == NULL && psJob->bPartialTile &&
+                 nTileBands == 4 )
+            iSrc = (i < 3) ? 0 : 3;
+        else if( nBands == 2 && nTileBands >= 3 )
+            iSrc = (i < 3) ? 0 : 1;
+        int nRet = CPLPrintPointer(szDataPointer,
+                pabyTileData + iSrc * nBandBlockSize,
+                sizeof(szDataPointer));
+        szDataPointer[nRet] = '\0';
+        papszOptions = CSLSetNameValue(papszOptions,
+                                       "DATAPOINTER", szDataPointer);
+        poMEMDS->AddBand(GDT_Byte, papszOptions);
+        if( i == 0 && nTileBands == 1 && psJob->poCT != NULL )
+            poMEMDS->GetRasterBand(1)->SetColorTable(psJob->poCT);
+        CSLDestroy(papszOptions);
+    }
+
+    if( psJob->bPNG8 )
+    {
+        GDALDataset* poMEM_RGB_DS = MEMDataset::Create("", nBlockXSize, nBlockYSize,
+                                              0, GDT_Byte, NULL);
+        for( int i = 0; i < 3; i++ )
+        {
+            char** papszOptions = NULL;
+            char szDataPointer[32];
+            int nRet = CPLPrintPointer(szDataPointer,
+                                    pabyTileData + i * nBandBlockSize,
+                                    sizeof(szDataPointer));
+            szDataPointer[nRet] = '\0';
+            papszOptions = CSLSetNameValue(papszOptions, "DATAPOINTER", szDataPointer);
+            poMEM_RGB_DS->AddBand(GDT_Byte, papszOptions);
+            CSLDestroy(papszOptions);
+        }
+
+        if( psJob->pabyHugeColorArray == NULL )
+        {
+            if( nBlockXSize <= 65536 / nBlockYSize )
+                psJob->pabyHugeColorArray = (GByte*) VSIMalloc(MEDIAN_CUT_AND_DITHER_BUFFER_SIZE_65536);
+            else
+                psJob->pabyHugeColorArray = (GByte*) VSIMalloc2(256 * 256 * 256, sizeof(GUInt32));
+        }
+
+        GDALColorTable* poCT = new GDALColorTable();
+        GDALComputeMedianCutPCTInternal( poMEM_RGB_DS->GetRasterBand(1),
+                                   poMEM_RGB_DS->GetRasterBand(2),
+                                   poMEM_RGB_DS->GetRasterBand(3),
+                                   /*NULL, NULL, NULL,*/
+                                   pabyTileData,
+                                   pabyTileData + nBandBlockSize,
+                                   pabyTileData + 2 * nBandBlockSize,
+                                   NULL,
+                                   256, /* max colors */
+                                   8, /* bit depth */
+                                   (GUInt32*)psJob->pabyHugeColorArray, /* preallocated histogram */
+                                   poCT,
+                                   NULL, NULL );
+
+        GDALDitherRGB2PCTInternal( poMEM_RGB_DS->GetRasterBand(1),
+                           poMEM_RGB_DS->GetRasterBand(2),
+                           poMEM_RGB_DS->GetRasterBand(3),
+                           poMEMDS->GetRasterBand(1),
+                           poCT,
+                           8, /* bit depth */
+                           (GInt16*)psJob->pabyHugeColorArray, /* pasDynamicColorMap */
+                           psJob->bDither,
+                           NULL, NULL );
+        poMEMDS->GetRasterBand(1)->SetColorTable(poCT);
+        delete poCT;
+        GDALClose( poMEM_RGB_DS );
+    }
+
+#ifdef DEBUG
+    VSIStatBufL sStat;
+    CPLAssert(VSIStatL(psJob->pszTmpFilename, &sStat) != 0);
+#endif
+    GDALDataset* poOutDS = psJob->poDriver->CreateCopy(psJob->pszTmpFilename,
+                    poMEMDS, FALSE, psJob->papszDriverOptions, NULL, NULL);
+    psJob->pabyBlob = NULL;
+    psJob->nBlobSize = 0;
+    if( poOutDS )
+    {
+        GDALClose( poOutDS );
+        psJob->pabyBlob = VSIGetMemFileBuffer(psJob->pszTmpFilename,
+                                              &psJob->nBlobSize, TRUE);
+    }
+    VSIUnlink(psJob->pszTmpFilename);
+    delete poMEMDS;
+}
+
+/************************************************************************/
+/*                        ThreadEncodeTileFunc()                        */
+/************************************************************************/
+
+void GDALGPKGMBTilesLikePseudoDataset::ThreadEncodeTileFunc(void* pData)
+{
+    GPKGTileEncodingJob* psJob = static_cast<GPKGTileEncodingJob*>(pData);
+    EncodeTile(psJob);
+
+    GDALGPKGMBTilesLikePseudoDataset* poMainDS =
+        psJob->poDS->m_poParentDS ? psJob->poDS->m_poParentDS : psJob->poDS;
+    CPLAcquireMutex(poMainDS->m_hWorkerThreadPoolMutex, 1000.0);
+    psJob->bReady = true;
+    CPLReleaseMutex(poMainDS->m_hWorkerThreadPoolMutex);
+}
+
+/************************************************************************/
+/*                             InsertTile()                             */
+/************************************************************************/
+
+/* Takes ownership of pabyBlob */
+CPLErr GDALGPKGMBTilesLikePseudoDataset::InsertTile(int nRow, int nCol,
+                                                    GByte* pabyBlob,
+                                                    vsi_l_offset nBlobSize)
+{
+    /* Create or commit and recreate transaction */
+    GDALGPKGMBTilesLikePseudoDataset* poMainDS = m_poParentDS ? m_poParentDS : this;
+    if( poMainDS->m_nTileInsertionCount == 0 )
+    {
+        poMainDS->IStartTransaction();
+    }
+    else if( poMainDS->m_nTileInsertionCount == 1000 )
+    {
+        if( poMainDS->ICommitTransaction() != OGRERR_NONE )
+        {
+            poMainDS->m_nTileInsertionCount = -1;
+            CPLFree(pabyBlob);
+            return CE_Failure;
+        }
+        poMainDS->IStartTransaction();
+        poMainDS->m_nTileInsertionCount = 0;
+    }
+    poMainDS->m_nTileInsertionCount ++;
+
+    CPLErr eErr = CE_Failure;
+    char* pszSQL = sqlite3_mprintf("INSERT OR REPLACE INTO \"%w\" "
+        "(zoom_level, tile_row, tile_column, tile_data) VALUES (%d, %d, %d, ?)",
+        m_osRasterTable.c_str(), m_nZoomLevel, GetRowFromIntoTopConvention(nRow), nCol);
+#ifdef DEBUG_VERBOSE
+    CPLDebug("GPKG", "%s", pszSQL);
+#endif
+    sqlite3_stmt* hStmt = NULL;
+    int rc = sqlite3_prepare_v2(IGetDB(), pszSQL, -1, &hStmt, NULL);
+    if ( rc != SQLITE_OK )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "failed to prepare SQL %s: %s",
+                  pszSQL, sqlite3_errmsg(IGetDB()) );
+        CPLFree(pabyBlob);
+    }
+    else
+    {
+        sqlite3_bind_blob( hStmt, 1, pabyBlob, (int)nBlobSize, CPLFree);
+        rc = sqlite3_step( hStmt );
+        if( rc == SQLITE_DONE )
+            eErr = CE_None;
+        else
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Failure when inserting tile (row=%d,col=%d) at zoom_level=%d : %s",
+                     GetRowFromIntoTopConvention(nRow), nCol, m_nZoomLevel, sqlite3_errmsg(IGetDB()));
+        }
+    }
+    sqlite3_finalize(hStmt);
+    sqlite3_free(pszSQL);
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          InsertEncodedTile()                         */
+/************************************************************************/
+
+/* Insert the result of a completed job, and release its slot */
+CPLErr GDALGPKGMBTilesLikePseudoDataset::InsertEncodedTile(
+                                                GPKGTileEncodingJob* psJob)
+{
+    CPLErr eErr = CE_Failure;
+    if( psJob->pabyBlob != NULL )
+    {
+        eErr = psJob->poDS->InsertTile(psJob->nRow, psJob->nCol,
+                                       psJob->pabyBlob, psJob->nBlobSize);
+        psJob->pabyBlob = NULL;
+        psJob->nBlobSize = 0;
+    }
+    delete psJob->poCT;
+    psJob->poCT = NULL;
+    CSLDestroy(psJob->papszDriverOptions);
+    psJob->papszDriverOptions = NULL;
+    psJob->poDS = NULL;
+    psJob->bReady = false;
+    return eErr;
+}
+
+/************************************************************************/
+/*                          SubmitEncodingJob()                         */
+/************************************************************************/
+
+/* Queue the encoding of a tile. sJob.pabyTileData is copied, and the job */
+/* takes ownership of sJob.poCT and sJob.papszDriverOptions. Must be      */
+/* called on the main dataset. */
+CPLErr GDALGPKGMBTilesLikePseudoDataset::SubmitEncodingJob(
+                                            const GPKGTileEncodingJob& sJob,
+                                            size_t nTileDataSize)
+{
+    CPLAssert( m_poParentDS == NULL );
+
+    // Do not let an older version of the same tile be inserted after this one
+    CPLErr eErr = sJob.poDS->WaitCompletionForTile(sJob.nRow, sJob.nCol);
+
+    // Make sure at least one slot is free, and flush ready jobs in the
+    // meantime, so that the writer keeps up with the encoders.
+    m_poWorkerThreadPool->WaitCompletion(
+        static_cast<int>(m_asEncodingJobs.size()) - 1);
+
+    GPKGTileEncodingJob* psFreeJob = NULL;
+    for( size_t i = 0; i < m_asEncodingJobs.size(); i++ )
+    {
+        GPKGTileEncodingJob* psJob = &m_asEncodingJobs[i];
+        CPLAcquireMutex(m_hWorkerThreadPoolMutex, 1000.0);
+        const bool bReady = psJob->bReady;
+        CPLReleaseMutex(m_hWorkerThreadPoolMutex);
+        if( psJob->poDS != NULL && bReady )
+        {
+            if( InsertEncodedTile(psJob) != CE_None )
+                eErr = CE_Failure;
+        }
+        if( psJob->poDS == NULL && psFreeJob == NULL )
+            psFreeJob = psJob;
+    }
+    CPLAssert( psFreeJob != NULL );
+    if( psFreeJob == NULL )
+    {
+        delete sJob.poCT;
+        CSLDestroy(sJob.papszDriverOptions);
+        return CE_Failure;
+    }
+
+    GByte* pabyTileData = static_cast<GByte*>(
+        VSI_REALLOC_VERBOSE(psFreeJob->pabyTileData, nTileDataSize));
+    if( pabyTileData == NULL )
+    {
+        delete sJob.poCT;
+        CSLDestroy(sJob.papszDriverOptions);
+        return CE_Failure;
+    }
+    memcpy(pabyTileData, sJob.pabyTileData, nTileDataSize);
+
+    // Keep the per-slot temporary filename and histogram buffer
+    char* pszTmpFilename = psFreeJob->pszTmpFilename;
+    GByte* pabyHugeColorArray = psFreeJob->pabyHugeColorArray;
+    *psFreeJob = sJob;
+    psFreeJob->pabyTileData = pabyTileData;
+    psFreeJob->pszTmpFilename = pszTmpFilename;
+    psFreeJob->pabyHugeColorArray = pabyHugeColorArray;
+    psFreeJob->pabyBlob = NULL;
+    psFreeJob->nBlobSize = 0;
+    psFreeJob->bReady = false;
+
+    m_poWorkerThreadPool->SubmitJob(ThreadEncodeTileFunc, psFreeJob);
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                        WaitCompletionForTile()                       */
+/************************************************************************/
+
+/* Make sure a pending encoding of the tile, if any, is in the database */
+CPLErr GDALGPKGMBTilesLikePseudoDataset::WaitCompletionForTile(int nRow, int nCol)
+{
+    GDALGPKGMBTilesLikePseudoDataset* poMainDS = m_poParentDS ? m_poParentDS : this;
+    if( poMainDS->m_poWorkerThreadPool == NULL )
+        return CE_None;
+
+    for( size_t i = 0; i < poMainDS->m_asEncodingJobs.size(); i++ )
+    {
+        GPKGTileEncodingJob* psJob = &poMainDS->m_asEncodingJobs[i];
+        if( psJob->poDS == this && psJob->nRow == nRow && psJob->nCol == nCol )
+        {
+            CPLAcquireMutex(poMainDS->m_hWorkerThreadPoolMutex, 1000.0);
+            const bool bReady = psJob->bReady;
+            CPLReleaseMutex(poMainDS->m_hWorkerThreadPoolMutex);
+            if( !bReady )
+                poMainDS->m_poWorkerThreadPool->WaitCompletion(0);
+            return poMainDS->InsertEncodedTile(psJob);
+        }
+    }
+    return CE_None;
+}
+
+/************************************************************************/
+/*                          FlushEncodingJobs()                         */
+/************************************************************************/
+
+CPLErr GDALGPKGMBTilesLikePseudoDataset::FlushEncodingJobs()
+{
+    if( m_poWorkerThreadPool == NULL )
+        return CE_None;
+
+    m_poWorkerThreadPool->WaitCompletion(0);
+
+    CPLErr eErr = CE_None;
+    for( size_t i = 0; i < m_asEncodingJobs.size(); i++ )
+    {
+        GPKGTileEncodingJob* psJob = &m_asEncodingJobs[i];
+        if( psJob->poDS != NULL )
+        {
+            if( InsertEncodedTile(psJob) != CE_None )
+                eErr = CE_Failure;
+        }
+    }
+    return eErr;
+}
+
 /************************************************************************/
 /*                     FlushRemainingShiftedTiles()                     */
 /************************************************************************/
@@ -31,9 +31,12 @@
 #define GPKGMBTILESCOMMON_H_INCLUDED
 
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_pam.h"
 #include "ogr_sqlite.h" // for sqlite3*
 
+#include <vector>
+
 typedef struct
 {
     int     nRow;
@@ -55,6 +58,46 @@ typedef enum
 
 GPKGTileFormat GDALGPKGMBTilesGetTileFormat(const char* pszTF );
 
+class GDALGPKGMBTilesLikePseudoDataset;
+
+/* Encoding of a Byte tile to PNG/JPEG/WEBP, possibly in a worker thread */
+typedef struct
+{
+    GDALGPKGMBTilesLikePseudoDataset *poDS; /* NULL if the job slot is free */
+    int             nRow;
+    int             nCol;
+    GByte          *pabyTileData;   /* nTileBands source bands, or less */
+    int             nBlockXSize;
+    int             nBlockYSize;
+    int             nBands;
+    int             nTileBands;
+    bool            bPartialTile;
+    bool            bPNG8;
+    bool            bDither;
+    GDALColorTable *poCT;
+    GDALDriver     *poDriver;
+    char          **papszDriverOptions;
+    char           *pszTmpFilename;
+    GByte          *pabyHugeColorArray;
+
+    GByte          *pabyBlob;       /* result, owned by the job */
+    vsi_l_offset    nBlobSize;
+    bool            bReady;
+} GPKGTileEncodingJob;
+
+/* Decoding of a tile fetched by PrefetchTiles(), in a worker thread */
+typedef struct
+{
+    GDALGPKGMBTilesLikePseudoDataset *poDS;
+    int             nBlockXOff;
+    int             nBlockYOff;
+    GByte          *pabyBlob;       /* NULL for a missing tile */
+    int             nBlobSize;
+    double          dfTileOffset;
+    double          dfTileScale;
+    GByte          *pabyTileData;   /* result, all bands */
+} GPKGTileDecodingJob;
+
 class GDALGPKGMBTilesLikePseudoDataset
 {
     friend class GDALGPKGMBTilesLikeRasterBand;
@@ -102,6 +145,12 @@ class GDALGPKGMBTilesLikePseudoDataset
 
     int                 m_nTileInsertionCount;
 
+    // Only used on the main dataset: tiles encoded and decoded in worker
+    // threads.
+    CPLWorkerThreadPool *m_poWorkerThreadPool;
+    std::vector<GPKGTileEncodingJob> m_asEncodingJobs;
+    CPLMutex           *m_hWorkerThreadPoolMutex;
+
     GDALGPKGMBTilesLikePseudoDataset* m_poParentDS;
 
   private:
@@ -117,10 +166,27 @@ class GDALGPKGMBTilesLikePseudoDataset
         void                    FillEmptyTile(GByte* pabyData);
         void                    FillEmptyTileSingleBand(GByte* pabyData);
 
+        static void             EncodeTile(GPKGTileEncodingJob* psJob);
+        static void             ThreadEncodeTileFunc(void* pData);
+        CPLErr                  InsertTile(int nRow, int nCol, GByte* pabyBlob,
+                                           vsi_l_offset nBlobSize);
+        CPLErr                  SubmitEncodingJob(
+                                    const GPKGTileEncodingJob& sJob,
+                                    size_t nTileDataSize);
+        CPLErr                  InsertEncodedTile(GPKGTileEncodingJob* psJob);
+        CPLErr                  WaitCompletionForTile(int nRow, int nCol);
+        static void             ThreadDecodeTileFunc(void* pData);
+
   public:
                                 GDALGPKGMBTilesLikePseudoDataset();
         virtual                ~GDALGPKGMBTilesLikePseudoDataset();
 
+        void                    InitWorkerThreads(char** papszOptions);
+        CPLErr                  FlushEncodingJobs();
+        void                    PrefetchTiles(int nXOff, int nYOff,
+                                              int nXSize, int nYSize,
+                                              int nBufXSize, int nBufYSize);
+
         void                    SetDataType(GDALDataType eDT);
         void                    SetGlobalOffsetScale(double dfOffset,
                                                      double dfScale);
@@ -172,6 +238,10 @@ class GDALGPKGMBTilesLikeRasterBand: public GDALPamRasterBand
         virtual CPLErr          IWriteBlock(int nBlockXOff, int nBlockYOff,
                                            void* pData) override;
         virtual CPLErr          FlushCache() override;
+        virtual CPLErr          IRasterIO( GDALRWFlag, int, int, int, int,
+                                           void *, int, int, GDALDataType,
+                                           GSpacing nPixelSpace, GSpacing nLineSpace,
+                                           GDALRasterIOExtraArg* psExtraArg ) override;
 
         virtual GDALColorTable* GetColorTable() override;
         virtual CPLErr          SetColorTable(GDALColorTable* poCT) override;
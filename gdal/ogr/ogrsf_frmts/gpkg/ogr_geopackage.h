@@ -35,6 +35,7 @@
 #include "gpkgmbtilescommon.h"
 #include "ogrsqliteutility.h"
 
+#include <deque>
 #include <vector>
 #include <set>
 
@@ -131,6 +132,11 @@ class GDALGeoPackageDataset CPL_FINAL : public OGRSQLiteBaseDataSource, public G
 
     CPLString           m_osTilingScheme;
 
+    bool                m_bOrderedScan;
+    // Idle read-only connections of the worker threads of parallel scans
+    std::vector<sqlite3*> m_ahReadOnlyDB;
+    sqlite3*            OpenReadOnlyConnection();
+
         bool            ComputeTileAndPixelShifts();
         bool            InitRaster ( GDALGeoPackageDataset* poParentDS,
                                      const char* pszTableName,
@@ -232,6 +238,11 @@ class GDALGeoPackageDataset CPL_FINAL : public OGRSQLiteBaseDataSource, public G
         virtual CPLErr      SetGeoTransform( double* padfGeoTransform ) override;
 
         virtual void        FlushCache() override;
+        virtual CPLErr      IRasterIO( GDALRWFlag, int, int, int, int,
+                                       void *, int, int, GDALDataType,
+                                       int, int *, GSpacing, GSpacing,
+                                       GSpacing,
+                                       GDALRasterIOExtraArg* psExtraArg ) override;
         virtual CPLErr      IBuildOverviews( const char *, int, int *,
                                              int, int *, GDALProgressFunc, void * ) override;
 
@@ -279,6 +290,11 @@ class GDALGeoPackageDataset CPL_FINAL : public OGRSQLiteBaseDataSource, public G
         OGRErr              UpdateGpkgContentsLastChange(
                                                 const char* pszTableName);
 
+        CPLWorkerThreadPool* GetWorkerThreadPool() { return m_poWorkerThreadPool; }
+        bool                IsOrderedScan() const { return m_bOrderedScan; }
+        sqlite3*            AcquireReadOnlyConnection();
+        void                ReleaseReadOnlyConnection(sqlite3* hDBRO);
+
         static GDALDataset* CreateCopy( const char *pszFilename,
                                                    GDALDataset *poSrcDS,
                                                    int bStrict,
@@ -362,6 +378,13 @@ class OGRGeoPackageLayer : public OGRLayer, public IOGRSQLiteGetSpatialWhere
     OGRFeature*         TranslateFeature(sqlite3_stmt* hStmt);
 
   public:
+    static OGRFeature*  TranslateFeature( OGRFeatureDefn* poFeatureDefn,
+                                          sqlite3_stmt* hStmt,
+                                          int iFIDColIn,
+                                          int iGeomColIn,
+                                          const int* panFieldOrdinalsIn,
+                                          bool bHasFIDColumn,
+                                          GIntBig nDefaultFID );
 
     explicit            OGRGeoPackageLayer(GDALGeoPackageDataset* poDS);
                         virtual ~OGRGeoPackageLayer();
@@ -379,6 +402,78 @@ class OGRGeoPackageLayer : public OGRLayer, public IOGRSQLiteGetSpatialWhere
                                          OGRGeometry* /*poFilterGeom*/) override { return ""; }
 };
 
+/************************************************************************/
+/*                       OGRGeoPackageParallelScan                      */
+/************************************************************************/
+
+class OGRGeoPackageParallelScan;
+
+/* A batch of features read by a worker thread on its own connection */
+typedef struct
+{
+    OGRGeoPackageParallelScan *poScan;
+    GIntBig             nMinFID;    /* FID range, when scanning by FID */
+    GIntBig             nMaxFID;
+    std::vector<GIntBig> anFIDs;    /* FIDs from the R-Tree otherwise */
+    std::vector<OGRFeature*> apoFeatures; /* result */
+    size_t              iNextFeature;
+    CPLString           osError;
+    bool                bDone;
+} GPKGScanJob;
+
+class OGRGeoPackageParallelScan
+{
+    GDALGeoPackageDataset     *m_poDS;
+    CPLWorkerThreadPool       *m_poPool;
+
+    // One read-only connection, and the statement prepared on it, per
+    // worker thread, while the scan is active.
+    std::vector<sqlite3*>      m_ahDB;
+    std::vector<sqlite3_stmt*> m_ahStmt;
+    std::vector<bool>          m_abInUse;
+
+    CPLMutex                  *m_hMutex;
+    CPLCond                   *m_hCond;
+    volatile int               m_bStop;
+
+    bool                       m_bActive;
+    bool                       m_bOrdered;
+    std::deque<GPKGScanJob*>   m_apoJobs;
+    GPKGScanJob               *m_psCurJob;
+
+    OGRFeatureDefn            *m_poFeatureDefn;
+    int                        m_iFIDCol;
+    int                        m_iGeomCol;
+    std::vector<int>           m_anFieldOrdinals;
+
+    bool                       m_bByRTree;
+    GIntBig                    m_nNextFID;
+    sqlite3_stmt              *m_hFIDBoundStmt;
+    sqlite3_stmt              *m_hRTreeStmt;
+    bool                       m_bEOF;
+
+    bool                       SubmitJobs();
+    void                       ClearStatements();
+    void                       ReleaseConnections();
+    static void                ScanJobFunc(void* pData);
+    void                       RunJob(GPKGScanJob* psJob);
+
+  public:
+                               OGRGeoPackageParallelScan(
+                                            GDALGeoPackageDataset* poDS );
+                              ~OGRGeoPackageParallelScan();
+
+    bool                       Start( OGRFeatureDefn* poFeatureDefn,
+                                      int iFIDCol, int iGeomCol,
+                                      const int* panFieldOrdinals,
+                                      const CPLString& osSQL,
+                                      const CPLString& osFIDBoundSQL,
+                                      const CPLString& osRTreeSQL );
+    void                       Stop();
+    bool                       IsActive() const { return m_bActive; }
+    OGRFeature*                GetNextFeature();
+};
+
 /************************************************************************/
 /*                        OGRGeoPackageTableLayer                       */
 /************************************************************************/
@@ -424,6 +519,7 @@ class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
     bool                        m_bHasTriedDetectingFID64;
     GPKGASpatialVariant         m_eASPatialVariant;
     std::set<OGRwkbGeometryType> m_eSetBadGeomTypeWarned;
+    OGRGeoPackageParallelScan*  m_poParallelScan;
 
     virtual OGRErr      ResetStatement() override;
 
@@ -444,6 +540,9 @@ class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
     OGRErr              ReadTableDefinition();
     void                InitView();
 
+    bool                StartParallelScan();
+    void                StopParallelScan();
+
     public:
                         OGRGeoPackageTableLayer( GDALGeoPackageDataset *poDS,
                                                  const char * pszTableName );
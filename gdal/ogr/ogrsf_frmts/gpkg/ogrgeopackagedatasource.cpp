@@ -517,6 +517,7 @@ GDALGeoPackageDataset::GDALGeoPackageDataset() :
     m_bInFlushCache(false),
     m_bTableCreated(false),
     m_osTilingScheme("CUSTOM"),
+    m_bOrderedScan(true),
     m_bMapTableToExtensionsBuilt(false),
     m_bMapTableToContentsBuilt(false)
 {
@@ -576,6 +577,10 @@ GDALGeoPackageDataset::~GDALGeoPackageDataset()
     for( int i = 0; i < m_nLayers; i++ )
         delete m_papoLayers[i];
 
+    // Once the layers have given them back
+    for( size_t i = 0; i < m_ahReadOnlyDB.size(); i++ )
+        sqlite3_close(m_ahReadOnlyDB[i]);
+
     CPLFree( m_papoLayers );
     CPLFree( m_papoOverviewDS );
     CSLDestroy( m_papszSubDatasets );
@@ -1113,6 +1118,15 @@ int GDALGeoPackageDataset::Open( GDALOpenInfo* poOpenInfo )
         }
 
         SQLResultFree(&oResult);
+
+        // In read-only mode, vector layers can be scanned by worker
+        // threads, each on its own connection.
+        if( m_nLayers > 0 && !bUpdate )
+        {
+            InitWorkerThreads(poOpenInfo->papszOpenOptions);
+            m_bOrderedScan = CPLFetchBool(poOpenInfo->papszOpenOptions,
+                                          "ORDERED_SCAN", true);
+        }
     }
 
     bool bHasTileMatrixSet = false;
@@ -2254,6 +2268,30 @@ OGRErr GDALGeoPackageDataset::UpdateGpkgContentsLastChange(
     return eErr;
 }
 
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr GDALGeoPackageDataset::IRasterIO( GDALRWFlag eRWFlag,
+                                int nXOff, int nYOff, int nXSize, int nYSize,
+                                void * pData, int nBufXSize, int nBufYSize,
+                                GDALDataType eBufType,
+                                int nBandCount, int *panBandMap,
+                                GSpacing nPixelSpace, GSpacing nLineSpace,
+                                GSpacing nBandSpace,
+                                GDALRasterIOExtraArg* psExtraArg )
+{
+    if( eRWFlag == GF_Read )
+    {
+        PrefetchTiles(nXOff, nYOff, nXSize, nYSize, nBufXSize, nBufYSize);
+    }
+    return OGRSQLiteBaseDataSource::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize,
+                               pData, nBufXSize, nBufYSize, eBufType,
+                               nBandCount, panBandMap,
+                               nPixelSpace, nLineSpace, nBandSpace,
+                               psExtraArg);
+}
+
 /************************************************************************/
 /*                          IBuildOverviews()                           */
 /************************************************************************/
@@ -4504,6 +4542,8 @@ void GDALGeoPackageDataset::ParseCompressionOptions(char** papszOptions)
     const char* pszDither = CSLFetchNameValue(papszOptions, "DITHER");
     if( pszDither )
         m_bDither = CPLTestBool(pszDither);
+
+    InitWorkerThreads(papszOptions);
 }
 
 /************************************************************************/
@@ -6059,27 +6099,19 @@ void GPKG_GDAL_HasColorTable(sqlite3_context* pContext,
     VSIUnlink(osMemFileName);
 }
 
-/************************************************************************/
-/*                      InstallSQLFunctions()                           */
-/************************************************************************/
-
 #ifndef SQLITE_DETERMINISTIC
 #define SQLITE_DETERMINISTIC 0
 #endif
 
-void GDALGeoPackageDataset::InstallSQLFunctions()
-{
-#ifdef SPATIALITE_412_OR_LATER
-    InitNewSpatialite();
-
-    // Enable SpatiaLite 4.3 "amphibious" mode, i.e. that SpatiaLite functions
-    // that take geometries will accept GPKG encoded geometries without
-    // explicit conversion.
-    // Use sqlite3_exec() instead of SQLCommand() since we don't want verbose
-    // error.
-    sqlite3_exec(hDB, "SELECT EnableGpkgAmphibiousMode()", NULL, NULL, NULL);
-#endif
+/************************************************************************/
+/*                    InstallStatelessSQLFunctions()                    */
+/*                                                                      */
+/*      Functions that do not depend on the dataset, and can thus also  */
+/*      be installed on the read-only connections of worker threads.    */
+/************************************************************************/
 
+static void InstallStatelessSQLFunctions( sqlite3* hDB )
+{
     /* Used by RTree Spatial Index Extension */
     sqlite3_create_function(hDB, "ST_MinX", 1,
                             SQLITE_UTF8 | SQLITE_DETERMINISTIC, NULL,
@@ -6110,6 +6142,31 @@ void GDALGeoPackageDataset::InstallSQLFunctions()
                             SQLITE_UTF8 | SQLITE_DETERMINISTIC, NULL,
                             OGRGeoPackageSTSRID, NULL, NULL);
 
+    // HSTORE functions
+    sqlite3_create_function(hDB, "hstore_get_value", 2,
+                            SQLITE_UTF8 | SQLITE_DETERMINISTIC, NULL,
+                            GPKG_hstore_get_value, NULL, NULL);
+}
+
+/************************************************************************/
+/*                         InstallSQLFunctions()                        */
+/************************************************************************/
+
+void GDALGeoPackageDataset::InstallSQLFunctions()
+{
+#ifdef SPATIALITE_412_OR_LATER
+    InitNewSpatialite();
+
+    // Enable SpatiaLite 4.3 "amphibious" mode, i.e. that SpatiaLite functions
+    // that take geometries will accept GPKG encoded geometries without
+    // explicit conversion.
+    // Use sqlite3_exec() instead of SQLCommand() since we don't want verbose
+    // error.
+    sqlite3_exec(hDB, "SELECT EnableGpkgAmphibiousMode()", NULL, NULL, NULL);
+#endif
+
+    InstallStatelessSQLFunctions(hDB);
+
     /* Spatialite-like functions */
     sqlite3_create_function(hDB, "CreateSpatialIndex", 2,
                             SQLITE_UTF8, this,
@@ -6121,11 +6178,6 @@ void GDALGeoPackageDataset::InstallSQLFunctions()
                             OGRGeoPackageHasSpatialIndex,
                             NULL, NULL);
 
-    // HSTORE functions
-    sqlite3_create_function(hDB, "hstore_get_value", 2,
-                            SQLITE_UTF8 | SQLITE_DETERMINISTIC, NULL,
-                            GPKG_hstore_get_value, NULL, NULL);
-
     // Override a few Spatialite functions to work with gpkg_spatial_ref_sys
     sqlite3_create_function(hDB, "ST_Transform", 2,
                             SQLITE_UTF8 | SQLITE_DETERMINISTIC, this,
@@ -6173,6 +6225,69 @@ bool GDALGeoPackageDataset::OpenOrCreateDB(int flags)
     return true;
 }
 
+/************************************************************************/
+/*                       OpenReadOnlyConnection()                       */
+/*                                                                      */
+/*      Open another connection to the database, for the worker         */
+/*      threads of parallel scans. Returns NULL if not possible.        */
+/************************************************************************/
+
+sqlite3* GDALGeoPackageDataset::OpenReadOnlyConnection()
+{
+    // The OGR VFS reports the files it opens to the dataset, so it cannot
+    // be shared by several connections.
+    if( pMyVFS != NULL || bUpdate || !sqlite3_threadsafe() )
+        return NULL;
+
+    int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+#ifdef SQLITE_OPEN_URI
+    if( STARTS_WITH(m_pszFilename, "file:") &&
+        CPLTestBool(CPLGetConfigOption("SQLITE_USE_URI", "YES")) )
+    {
+        flags |= SQLITE_OPEN_URI;
+    }
+#endif
+
+    sqlite3* hDBRO = NULL;
+    if( sqlite3_open_v2( m_pszFilename, &hDBRO, flags, NULL ) != SQLITE_OK )
+    {
+        CPLDebug("GPKG", "sqlite3_open(%s) failed: %s",
+                 m_pszFilename, sqlite3_errmsg( hDBRO ));
+        sqlite3_close(hDBRO);
+        return NULL;
+    }
+
+    InstallStatelessSQLFunctions(hDBRO);
+
+    return hDBRO;
+}
+
+/************************************************************************/
+/*                     AcquireReadOnlyConnection()                      */
+/*                                                                      */
+/*      Connections are kept by the dataset between scans, and shared   */
+/*      by its layers.                                                  */
+/************************************************************************/
+
+sqlite3* GDALGeoPackageDataset::AcquireReadOnlyConnection()
+{
+    if( m_ahReadOnlyDB.empty() )
+        return OpenReadOnlyConnection();
+
+    sqlite3* hDBRO = m_ahReadOnlyDB.back();
+    m_ahReadOnlyDB.pop_back();
+    return hDBRO;
+}
+
+/************************************************************************/
+/*                     ReleaseReadOnlyConnection()                      */
+/************************************************************************/
+
+void GDALGeoPackageDataset::ReleaseReadOnlyConnection( sqlite3* hDBRO )
+{
+    m_ahReadOnlyDB.push_back(hDBRO);
+}
+
 /************************************************************************/
 /*                   GetLayerWithGetSpatialWhereByName()                */
 /************************************************************************/
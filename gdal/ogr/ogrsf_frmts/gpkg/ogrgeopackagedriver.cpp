@@ -319,7 +319,8 @@ void RegisterOGRGeoPackage()
 "  </Option>" \
 "  <Option name='QUALITY' type='int' min='1' max='100' description='Quality for JPEG and WEBP tiles' default='75'/>" \
 "  <Option name='ZLEVEL' type='int' min='1' max='9' description='DEFLATE compression level for PNG tiles' default='6'/>" \
-"  <Option name='DITHER' type='boolean' description='Whether to apply Floyd-Steinberg dithering (for TILE_FORMAT=PNG8)' default='NO'/>"
+"  <Option name='DITHER' type='boolean' description='Whether to apply Floyd-Steinberg dithering (for TILE_FORMAT=PNG8)' default='NO'/>" \
+"  <Option name='NUM_THREADS' type='string' description='Number of worker threads for tile encoding and decoding, and for reading vector layers in read-only mode. Can be set to ALL_CPUS' default='1'/>"
 
     poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST, "<OpenOptionList>"
 "  <Option name='LIST_ALL_TABLES' type='string-select' description='Whether all tables, including those non listed in gpkg_contents, should be listed' default='AUTO'>"
@@ -337,6 +338,7 @@ void RegisterOGRGeoPackage()
 "  <Option name='USE_TILE_EXTENT' type='boolean' description='Use tile extent of content to determine area of interest' default='NO'/>"
 "  <Option name='WHERE' type='string' description='SQL WHERE clause to be appended to tile requests'/>"
 COMPRESSION_OPTIONS
+"  <Option name='ORDERED_SCAN' type='boolean' description='Whether features read by worker threads are returned in FID order (R-Tree order with a spatial filter), rather than as soon as they are read' default='YES'/>"
 "</OpenOptionList>");
 
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, "<CreationOptionList>"
@@ -154,44 +154,68 @@ OGRFeature *OGRGeoPackageLayer::GetNextFeature()
 
 OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
 
+{
+    OGRFeature *poFeature =
+        TranslateFeature( m_poFeatureDefn, hStmt, iFIDCol, iGeomCol,
+                          panFieldOrdinals, m_pszFidColumn != NULL,
+                          iNextShapeId );
+
+    iNextShapeId++;
+
+    m_nFeaturesRead++;
+
+    return poFeature;
+}
+
+/************************************************************************/
+/*                         TranslateFeature()                           */
+/*                                                                      */
+/*      Does not touch the state of any layer, so that it can be        */
+/*      called from worker threads.                                     */
+/************************************************************************/
+
+OGRFeature *OGRGeoPackageLayer::TranslateFeature( OGRFeatureDefn* poFeatureDefn,
+                                                  sqlite3_stmt* hStmt,
+                                                  int iFIDColIn,
+                                                  int iGeomColIn,
+                                                  const int* panFieldOrdinalsIn,
+                                                  bool bHasFIDColumn,
+                                                  GIntBig nDefaultFID )
+
 {
 /* -------------------------------------------------------------------- */
 /*      Create a feature from the current result.                       */
 /* -------------------------------------------------------------------- */
-    OGRFeature *poFeature = new OGRFeature( m_poFeatureDefn );
+    OGRFeature *poFeature = new OGRFeature( poFeatureDefn );
 
 /* -------------------------------------------------------------------- */
 /*      Set FID if we have a column to set it from.                     */
 /* -------------------------------------------------------------------- */
-    if( iFIDCol >= 0 )
+    if( iFIDColIn >= 0 )
     {
-        poFeature->SetFID( sqlite3_column_int64( hStmt, iFIDCol ) );
-        if( m_pszFidColumn == NULL && poFeature->GetFID() == 0 )
+        poFeature->SetFID( sqlite3_column_int64( hStmt, iFIDColIn ) );
+        if( !bHasFIDColumn && poFeature->GetFID() == 0 )
         {
             // Miht be the case for views with joins.
-            poFeature->SetFID( iNextShapeId );
+            poFeature->SetFID( nDefaultFID );
         }
     }
     else
-        poFeature->SetFID( iNextShapeId );
-
-    iNextShapeId++;
-
-    m_nFeaturesRead++;
+        poFeature->SetFID( nDefaultFID );
 
 /* -------------------------------------------------------------------- */
 /*      Process Geometry if we have a column.                           */
 /* -------------------------------------------------------------------- */
-    if( iGeomCol >= 0 )
+    if( iGeomColIn >= 0 )
     {
-        OGRGeomFieldDefn* poGeomFieldDefn = m_poFeatureDefn->GetGeomFieldDefn(0);
-        if ( sqlite3_column_type(hStmt, iGeomCol) != SQLITE_NULL &&
+        OGRGeomFieldDefn* poGeomFieldDefn = poFeatureDefn->GetGeomFieldDefn(0);
+        if ( sqlite3_column_type(hStmt, iGeomColIn) != SQLITE_NULL &&
             !poGeomFieldDefn->IsIgnored() )
         {
             OGRSpatialReference* poSrs = poGeomFieldDefn->GetSpatialRef();
-            int iGpkgSize = sqlite3_column_bytes(hStmt, iGeomCol);
+            int iGpkgSize = sqlite3_column_bytes(hStmt, iGeomColIn);
             // coverity[tainted_data_return]
-            GByte *pabyGpkg = (GByte *)sqlite3_column_blob(hStmt, iGeomCol);
+            GByte *pabyGpkg = (GByte *)sqlite3_column_blob(hStmt, iGeomColIn);
             OGRGeometry *poGeom = GPkgGeometryToOGR(pabyGpkg, iGpkgSize, NULL);
             if ( poGeom == NULL )
             {
@@ -211,13 +235,13 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
 /* -------------------------------------------------------------------- */
 /*      set the fields.                                                 */
 /* -------------------------------------------------------------------- */
-    for( int iField = 0; iField < m_poFeatureDefn->GetFieldCount(); iField++ )
+    for( int iField = 0; iField < poFeatureDefn->GetFieldCount(); iField++ )
     {
-        OGRFieldDefn *poFieldDefn = m_poFeatureDefn->GetFieldDefn( iField );
+        OGRFieldDefn *poFieldDefn = poFeatureDefn->GetFieldDefn( iField );
         if ( poFieldDefn->IsIgnored() )
             continue;
 
-        const int iRawField = panFieldOrdinals[iField];
+        const int iRawField = panFieldOrdinalsIn[iField];
 
         if( sqlite3_column_type( hStmt, iRawField ) == SQLITE_NULL )
         {
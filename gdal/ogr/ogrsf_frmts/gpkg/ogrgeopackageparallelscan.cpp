@@ -0,0 +1,458 @@
+/******************************************************************************
+ *
+ * Project:  GeoPackage Translator
+ * Purpose:  Parallel scan of GeoPackage vector tables by worker threads
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_geopackage.h"
+
+#include <limits>
+
+CPL_CVSID("$Id$")
+
+// Number of features a job deals with, before the attribute filter.
+static const int GPKG_SCAN_BATCH_SIZE = 1000;
+
+/************************************************************************/
+/*                      OGRGeoPackageParallelScan()                     */
+/************************************************************************/
+
+OGRGeoPackageParallelScan::OGRGeoPackageParallelScan(
+                                            GDALGeoPackageDataset* poDS ) :
+    m_poDS(poDS),
+    m_poPool(poDS->GetWorkerThreadPool()),
+    m_hMutex(NULL),
+    m_hCond(NULL),
+    m_bStop(FALSE),
+    m_bActive(false),
+    m_bOrdered(poDS->IsOrderedScan()),
+    m_psCurJob(NULL),
+    m_poFeatureDefn(NULL),
+    m_iFIDCol(-1),
+    m_iGeomCol(-1),
+    m_bByRTree(false),
+    m_nNextFID(0),
+    m_hFIDBoundStmt(NULL),
+    m_hRTreeStmt(NULL),
+    m_bEOF(false)
+{
+    m_hMutex = CPLCreateMutex();
+    CPLReleaseMutex(m_hMutex);
+    m_hCond = CPLCreateCond();
+}
+
+/************************************************************************/
+/*                     ~OGRGeoPackageParallelScan()                     */
+/************************************************************************/
+
+OGRGeoPackageParallelScan::~OGRGeoPackageParallelScan()
+{
+    Stop();
+
+    CPLDestroyCond(m_hCond);
+    CPLDestroyMutex(m_hMutex);
+}
+
+/************************************************************************/
+/*                               Start()                                */
+/*                                                                      */
+/*      osSQL is run on the connection of each worker thread. It has    */
+/*      two parameters, the bounds of a FID range, when osRTreeSQL is   */
+/*      empty: osFIDBoundSQL then returns, on the main connection, the  */
+/*      first FID of the next range from the FID (first parameter) and  */
+/*      the number of features (second parameter) of the current one.   */
+/*      Otherwise osRTreeSQL returns the FIDs to read in the R-Tree,    */
+/*      and osSQL has a single FID parameter.                           */
+/************************************************************************/
+
+bool OGRGeoPackageParallelScan::Start( OGRFeatureDefn* poFeatureDefn,
+                                       int iFIDCol, int iGeomCol,
+                                       const int* panFieldOrdinals,
+                                       const CPLString& osSQL,
+                                       const CPLString& osFIDBoundSQL,
+                                       const CPLString& osRTreeSQL )
+{
+    Stop();
+
+    if( m_poPool == NULL )
+        return false;
+
+    // Jobs only run on the threads of the pool, so one connection per
+    // thread is enough. The connections are given back to the dataset
+    // when the scan stops.
+    const int nThreads = m_poPool->GetThreadCount();
+    while( static_cast<int>(m_ahDB.size()) < nThreads )
+    {
+        sqlite3* hDB = m_poDS->AcquireReadOnlyConnection();
+        if( hDB == NULL )
+        {
+            ReleaseConnections();
+            return false;
+        }
+        m_ahDB.push_back(hDB);
+    }
+
+    // Prepare statements now, so as to fall back to a sequential scan
+    // if the SQL uses functions not available on the worker connections.
+    m_ahStmt.resize(m_ahDB.size());
+    m_abInUse.resize(m_ahDB.size());
+    for( size_t i = 0; i < m_ahDB.size(); i++ )
+    {
+        m_ahStmt[i] = NULL;
+        m_abInUse[i] = false;
+    }
+    for( size_t i = 0; i < m_ahDB.size(); i++ )
+    {
+        if( sqlite3_prepare_v2( m_ahDB[i], osSQL.c_str(), -1,
+                                &m_ahStmt[i], NULL ) != SQLITE_OK )
+        {
+            CPLDebug("GPKG", "Cannot use parallel scan for %s: %s",
+                     osSQL.c_str(), sqlite3_errmsg(m_ahDB[i]));
+            ClearStatements();
+            ReleaseConnections();
+            return false;
+        }
+    }
+
+    m_bByRTree = !osRTreeSQL.empty();
+    const CPLString& osKeySQL = m_bByRTree ? osRTreeSQL : osFIDBoundSQL;
+    sqlite3_stmt*& hKeyStmt = m_bByRTree ? m_hRTreeStmt : m_hFIDBoundStmt;
+    if( sqlite3_prepare_v2( m_poDS->GetDB(), osKeySQL.c_str(), -1,
+                            &hKeyStmt, NULL ) != SQLITE_OK )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "failed to prepare SQL: %s", osKeySQL.c_str());
+        hKeyStmt = NULL;
+        ClearStatements();
+        ReleaseConnections();
+        return false;
+    }
+    if( !m_bByRTree )
+    {
+        m_nNextFID = std::numeric_limits<GIntBig>::min();
+        sqlite3_bind_int(m_hFIDBoundStmt, 2, GPKG_SCAN_BATCH_SIZE);
+    }
+
+    m_poFeatureDefn = poFeatureDefn;
+    m_iFIDCol = iFIDCol;
+    m_iGeomCol = iGeomCol;
+    m_anFieldOrdinals.assign(panFieldOrdinals,
+                             panFieldOrdinals + poFeatureDefn->GetFieldCount());
+
+    CPLDebug("GPKG", "Parallel scan with %d threads: %s",
+             nThreads, osSQL.c_str());
+
+    m_bEOF = false;
+    m_bActive = true;
+    return true;
+}
+
+/************************************************************************/
+/*                                Stop()                                */
+/*                                                                      */
+/*      Interrupt the jobs in progress, and wait for them, since they   */
+/*      use the statements.                                             */
+/************************************************************************/
+
+void OGRGeoPackageParallelScan::Stop()
+{
+    if( !m_bActive )
+        return;
+
+    m_bStop = TRUE;
+    CPLAcquireMutex(m_hMutex, 1000.0);
+    for( size_t i = 0; i < m_apoJobs.size(); i++ )
+    {
+        while( !m_apoJobs[i]->bDone )
+            CPLCondWait(m_hCond, m_hMutex);
+    }
+    CPLReleaseMutex(m_hMutex);
+    m_bStop = FALSE;
+
+    if( m_psCurJob != NULL )
+        m_apoJobs.push_back(m_psCurJob);
+    for( size_t i = 0; i < m_apoJobs.size(); i++ )
+    {
+        GPKGScanJob* psJob = m_apoJobs[i];
+        for( size_t j = psJob->iNextFeature;
+             j < psJob->apoFeatures.size(); j++ )
+        {
+            delete psJob->apoFeatures[j];
+        }
+        delete psJob;
+    }
+    m_apoJobs.clear();
+    m_psCurJob = NULL;
+
+    ClearStatements();
+    ReleaseConnections();
+    m_bActive = false;
+}
+
+/************************************************************************/
+/*                          ClearStatements()                           */
+/************************************************************************/
+
+void OGRGeoPackageParallelScan::ClearStatements()
+{
+    for( size_t i = 0; i < m_ahStmt.size(); i++ )
+        sqlite3_finalize(m_ahStmt[i]);
+    m_ahStmt.clear();
+    m_abInUse.clear();
+
+    if( m_hRTreeStmt != NULL )
+    {
+        sqlite3_finalize(m_hRTreeStmt);
+        m_hRTreeStmt = NULL;
+    }
+    if( m_hFIDBoundStmt != NULL )
+    {
+        sqlite3_finalize(m_hFIDBoundStmt);
+        m_hFIDBoundStmt = NULL;
+    }
+}
+
+/************************************************************************/
+/*                         ReleaseConnections()                         */
+/************************************************************************/
+
+void OGRGeoPackageParallelScan::ReleaseConnections()
+{
+    for( size_t i = 0; i < m_ahDB.size(); i++ )
+        m_poDS->ReleaseReadOnlyConnection(m_ahDB[i]);
+    m_ahDB.clear();
+}
+
+/************************************************************************/
+/*                             SubmitJobs()                             */
+/*                                                                      */
+/*      Keep twice as many jobs as threads ahead of the reader, so that */
+/*      the threads are not idle while it consumes a batch.             */
+/************************************************************************/
+
+bool OGRGeoPackageParallelScan::SubmitJobs()
+{
+    const size_t nMaxJobs = 2 * m_ahDB.size();
+    while( !m_bEOF && m_apoJobs.size() < nMaxJobs )
+    {
+        GPKGScanJob* psJob = new GPKGScanJob();
+        psJob->poScan = this;
+        psJob->nMinFID = 0;
+        psJob->nMaxFID = 0;
+        psJob->iNextFeature = 0;
+        psJob->bDone = false;
+
+        if( m_bByRTree )
+        {
+            // The R-Tree is read on the main connection, in the order a
+            // sequential scan would return the features.
+            while( static_cast<int>(psJob->anFIDs.size()) <
+                                                        GPKG_SCAN_BATCH_SIZE )
+            {
+                const int rc = sqlite3_step(m_hRTreeStmt);
+                if( rc != SQLITE_ROW )
+                {
+                    if( rc != SQLITE_DONE )
+                    {
+                        CPLError( CE_Failure, CPLE_AppDefined,
+                                  "sqlite3_step() : %s",
+                                  sqlite3_errmsg(m_poDS->GetDB()) );
+                        delete psJob;
+                        return false;
+                    }
+                    m_bEOF = true;
+                    break;
+                }
+                psJob->anFIDs.push_back(sqlite3_column_int64(m_hRTreeStmt, 0));
+            }
+            if( psJob->anFIDs.empty() )
+            {
+                delete psJob;
+                break;
+            }
+        }
+        else
+        {
+            // Look for the start of the next batch in the primary key, so
+            // that batches are full whatever the gaps between FIDs.
+            psJob->nMinFID = m_nNextFID;
+            sqlite3_bind_int64(m_hFIDBoundStmt, 1, m_nNextFID);
+            const int rc = sqlite3_step(m_hFIDBoundStmt);
+            if( rc == SQLITE_ROW )
+            {
+                m_nNextFID = sqlite3_column_int64(m_hFIDBoundStmt, 0);
+                psJob->nMaxFID = m_nNextFID - 1;
+            }
+            else if( rc == SQLITE_DONE )
+            {
+                psJob->nMaxFID = std::numeric_limits<GIntBig>::max();
+                m_bEOF = true;
+            }
+            else
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                          "sqlite3_step() : %s",
+                          sqlite3_errmsg(m_poDS->GetDB()) );
+                sqlite3_reset(m_hFIDBoundStmt);
+                delete psJob;
+                return false;
+            }
+            sqlite3_reset(m_hFIDBoundStmt);
+        }
+
+        m_apoJobs.push_back(psJob);
+        m_poPool->SubmitJob(ScanJobFunc, psJob);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                            ScanJobFunc()                             */
+/************************************************************************/
+
+void OGRGeoPackageParallelScan::ScanJobFunc(void* pData)
+{
+    GPKGScanJob* psJob = static_cast<GPKGScanJob*>(pData);
+    psJob->poScan->RunJob(psJob);
+}
+
+/************************************************************************/
+/*                               RunJob()                               */
+/************************************************************************/
+
+void OGRGeoPackageParallelScan::RunJob(GPKGScanJob* psJob)
+{
+    // Take a connection that no other running job uses.
+    CPLAcquireMutex(m_hMutex, 1000.0);
+    size_t iConn = 0;
+    while( m_abInUse[iConn] )
+        iConn++;
+    m_abInUse[iConn] = true;
+    CPLReleaseMutex(m_hMutex);
+
+    sqlite3* hDB = m_ahDB[iConn];
+    sqlite3_stmt* hStmt = m_ahStmt[iConn];
+    const size_t nQueries = m_bByRTree ? psJob->anFIDs.size() : 1;
+    for( size_t iQuery = 0; iQuery < nQueries && !m_bStop; iQuery++ )
+    {
+        if( m_bByRTree )
+        {
+            sqlite3_bind_int64(hStmt, 1, psJob->anFIDs[iQuery]);
+        }
+        else
+        {
+            sqlite3_bind_int64(hStmt, 1, psJob->nMinFID);
+            sqlite3_bind_int64(hStmt, 2, psJob->nMaxFID);
+        }
+
+        int rc = SQLITE_DONE;
+        while( !m_bStop && (rc = sqlite3_step(hStmt)) == SQLITE_ROW )
+        {
+            psJob->apoFeatures.push_back(
+                OGRGeoPackageLayer::TranslateFeature(
+                    m_poFeatureDefn, hStmt, m_iFIDCol, m_iGeomCol,
+                    m_anFieldOrdinals.empty() ? NULL : &m_anFieldOrdinals[0],
+                    true, 0) );
+        }
+        if( !m_bStop && rc != SQLITE_DONE )
+        {
+            psJob->osError = sqlite3_errmsg(hDB);
+            sqlite3_reset(hStmt);
+            break;
+        }
+        sqlite3_reset(hStmt);
+    }
+
+    CPLAcquireMutex(m_hMutex, 1000.0);
+    m_abInUse[iConn] = false;
+    psJob->bDone = true;
+    CPLCondBroadcast(m_hCond);
+    CPLReleaseMutex(m_hMutex);
+}
+
+/************************************************************************/
+/*                           GetNextFeature()                           */
+/*                                                                      */
+/*      Return NULL and stop the scan once all the features have been   */
+/*      read.                                                           */
+/************************************************************************/
+
+OGRFeature* OGRGeoPackageParallelScan::GetNextFeature()
+{
+    while( m_bActive )
+    {
+        if( m_psCurJob != NULL )
+        {
+            if( m_psCurJob->iNextFeature < m_psCurJob->apoFeatures.size() )
+            {
+                return m_psCurJob->apoFeatures[m_psCurJob->iNextFeature++];
+            }
+            delete m_psCurJob;
+            m_psCurJob = NULL;
+        }
+
+        if( !SubmitJobs() || m_apoJobs.empty() )
+        {
+            Stop();
+            return NULL;
+        }
+
+        // Take the first job in scan order, or the first completed one.
+        CPLAcquireMutex(m_hMutex, 1000.0);
+        size_t iJob = 0;
+        while( true )
+        {
+            if( m_bOrdered )
+            {
+                if( m_apoJobs[0]->bDone )
+                    break;
+            }
+            else
+            {
+                for( iJob = 0; iJob < m_apoJobs.size(); iJob++ )
+                {
+                    if( m_apoJobs[iJob]->bDone )
+                        break;
+                }
+                if( iJob < m_apoJobs.size() )
+                    break;
+            }
+            CPLCondWait(m_hCond, m_hMutex);
+        }
+        CPLReleaseMutex(m_hMutex);
+
+        m_psCurJob = m_apoJobs[iJob];
+        m_apoJobs.erase(m_apoJobs.begin() + iJob);
+
+        if( !m_psCurJob->osError.empty() )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "In GetNextRawFeature(): sqlite3_step() : %s",
+                      m_psCurJob->osError.c_str() );
+            Stop();
+            return NULL;
+        }
+    }
+    return NULL;
+}
@@ -1150,7 +1150,8 @@ OGRGeoPackageTableLayer::OGRGeoPackageTableLayer(
     m_iFIDAsRegularColumnIndex(-1),
     m_bHasReadMetadataFromStorage(false),
     m_bHasTriedDetectingFID64(false),
-    m_eASPatialVariant(GPKG_ATTRIBUTES)
+    m_eASPatialVariant(GPKG_ATTRIBUTES),
+    m_poParallelScan(NULL)
 {
     memset(m_abHasGeometryExtension, 0, sizeof(m_abHasGeometryExtension));
 
@@ -1166,6 +1167,8 @@ OGRGeoPackageTableLayer::OGRGeoPackageTableLayer(
 
 OGRGeoPackageTableLayer::~OGRGeoPackageTableLayer()
 {
+    delete m_poParallelScan;
+
     SyncToDisk();
 
     if( m_bDropRTreeTable )
@@ -1988,6 +1991,8 @@ OGRErr OGRGeoPackageTableLayer::SetAttributeFilter( const char *pszQuery )
 
 void OGRGeoPackageTableLayer::ResetReading()
 {
+    StopParallelScan();
+
     if( m_bDeferredCreation && RunDeferredCreationIfNecessary() != OGRERR_NONE )
         return;
 
@@ -2100,7 +2105,29 @@ OGRFeature* OGRGeoPackageTableLayer::GetNextFeature()
 
     CreateSpatialIndexIfNecessary();
 
-    OGRFeature* poFeature = OGRGeoPackageLayer::GetNextFeature();
+    OGRFeature* poFeature = NULL;
+    if( m_poQueryStatement == NULL &&
+        ((m_poParallelScan != NULL && m_poParallelScan->IsActive()) ||
+         StartParallelScan()) )
+    {
+        while( (poFeature = m_poParallelScan->GetNextFeature()) != NULL )
+        {
+            iNextShapeId++;
+            m_nFeaturesRead++;
+
+            // Done in this thread, since the prepared filter geometry
+            // cannot be shared.
+            if( m_poFilterGeom == NULL ||
+                FilterGeometry(poFeature->GetGeomFieldRef(m_iGeomFieldFilter)) )
+                break;
+
+            delete poFeature;
+        }
+    }
+    else
+    {
+        poFeature = OGRGeoPackageLayer::GetNextFeature();
+    }
     if( poFeature && m_iFIDAsRegularColumnIndex >= 0 )
     {
         poFeature->SetField(m_iFIDAsRegularColumnIndex, poFeature->GetFID());
@@ -2108,6 +2135,109 @@ OGRFeature* OGRGeoPackageTableLayer::GetNextFeature()
     return poFeature;
 }
 
+/************************************************************************/
+/*                         StartParallelScan()                          */
+/*                                                                      */
+/*      In read-only mode, with the NUM_THREADS open option, tables are */
+/*      read by worker threads, each on its own connection: by FID      */
+/*      ranges, or by batches of the FIDs selected in the R-Tree when   */
+/*      the spatial filter uses it.                                     */
+/************************************************************************/
+
+bool OGRGeoPackageTableLayer::StartParallelScan()
+{
+    if( m_poDS->GetWorkerThreadPool() == NULL || m_poDS->GetUpdate() ||
+        !m_bIsTable || m_pszFidColumn == NULL || m_poAttrQuery != NULL )
+    {
+        return false;
+    }
+
+    CPLString osRTreeSQL;
+    if( m_poFilterGeom != NULL && HasSpatialIndex() )
+    {
+        OGREnvelope sEnvelope;
+        m_poFilterGeom->getEnvelope( &sEnvelope );
+
+        const bool bMinXInf = CPLIsInf(sEnvelope.MinX) != 0;
+        const bool bMinYInf = CPLIsInf(sEnvelope.MinY) != 0;
+        const bool bMaxXInf = CPLIsInf(sEnvelope.MaxX) != 0;
+        const bool bMaxYInf = CPLIsInf(sEnvelope.MaxY) != 0;
+        if( bMinXInf || bMinYInf || bMaxXInf || bMaxYInf )
+        {
+            // Without any spatial filter in SQL if fully infinite.
+            if( !(bMinXInf && bMinYInf && bMaxXInf && bMaxYInf) )
+                return false;
+        }
+        else if( !(m_poExtent &&
+                   sEnvelope.MinX <= m_poExtent->MinX &&
+                   sEnvelope.MinY <= m_poExtent->MinY &&
+                   sEnvelope.MaxX >= m_poExtent->MaxX &&
+                   sEnvelope.MaxY >= m_poExtent->MaxY) )
+        {
+            // Same selection as GetSpatialWhere()
+            osRTreeSQL.Printf("SELECT id FROM \"%s\" WHERE "
+                              "maxx >= %.12f AND minx <= %.12f AND "
+                              "maxy >= %.12f AND miny <= %.12f",
+                              SQLEscapeName(m_osRTreeName).c_str(),
+                              sEnvelope.MinX - 1e-11, sEnvelope.MaxX + 1e-11,
+                              sEnvelope.MinY - 1e-11, sEnvelope.MaxY + 1e-11);
+        }
+    }
+
+    const CPLString osFIDColumn(SQLEscapeName(m_pszFidColumn));
+    CPLString osSQL;
+    CPLString osFIDBoundSQL;
+    if( !osRTreeSQL.empty() )
+    {
+        osSQL.Printf("SELECT %s FROM \"%s\" m WHERE m.\"%s\" = ?",
+                     m_soColumns.c_str(),
+                     SQLEscapeName(m_pszTableName).c_str(),
+                     osFIDColumn.c_str());
+        if( !osQuery.empty() )
+        {
+            osSQL += " AND (";
+            osSQL += osQuery;
+            osSQL += ")";
+        }
+    }
+    else
+    {
+        osSQL.Printf("SELECT %s FROM \"%s\" m WHERE m.\"%s\" BETWEEN ? AND ?",
+                     m_soColumns.c_str(),
+                     SQLEscapeName(m_pszTableName).c_str(),
+                     osFIDColumn.c_str());
+        if( !m_soFilter.empty() )
+        {
+            osSQL += " AND (";
+            osSQL += m_soFilter;
+            osSQL += ")";
+        }
+        osSQL += CPLSPrintf(" ORDER BY m.\"%s\"", osFIDColumn.c_str());
+
+        osFIDBoundSQL.Printf("SELECT \"%s\" FROM \"%s\" WHERE \"%s\" >= ? "
+                             "ORDER BY \"%s\" LIMIT 1 OFFSET ?",
+                             osFIDColumn.c_str(),
+                             SQLEscapeName(m_pszTableName).c_str(),
+                             osFIDColumn.c_str(), osFIDColumn.c_str());
+    }
+
+    if( m_poParallelScan == NULL )
+        m_poParallelScan = new OGRGeoPackageParallelScan(m_poDS);
+    return m_poParallelScan->Start( m_poFeatureDefn, iFIDCol, iGeomCol,
+                                    panFieldOrdinals, osSQL,
+                                    osFIDBoundSQL, osRTreeSQL );
+}
+
+/************************************************************************/
+/*                          StopParallelScan()                          */
+/************************************************************************/
+
+void OGRGeoPackageTableLayer::StopParallelScan()
+{
+    if( m_poParallelScan != NULL )
+        m_poParallelScan->Stop();
+}
+
 /************************************************************************/
 /*                        GetFeature()                                  */
 /************************************************************************/
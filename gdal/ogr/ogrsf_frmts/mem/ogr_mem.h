@@ -31,9 +31,11 @@
 #ifndef OGRMEM_H_INCLUDED
 #define OGRMEM_H_INCLUDED
 
+#include "cpl_quad_tree.h"
 #include "ogrsf_frmts.h"
 
 #include <map>
+#include <vector>
 
 /************************************************************************/
 /*                             OGRMemLayer                              */
@@ -66,10 +68,33 @@ class OGRMemLayer : public OGRLayer
 
     bool                m_bUpdated;
 
+    // Spatial index on the geometry field of the spatial filter, built on
+    // the first spatially filtered read.  Tree items are indices in
+    // m_anSpatialIndexFIDs.  Entries of deleted or rewritten features are
+    // not removed, but counted as stale until the next rebuild.
+    CPLQuadTree        *m_hSpatialIndex;
+    int                 m_iSpatialIndexGeomField;
+    OGREnvelope         m_sSpatialIndexExtent;
+    std::vector<GIntBig> m_anSpatialIndexFIDs;
+    std::vector<GIntBig> m_anSpatialIndexOutsideFIDs;
+    GIntBig             m_nSpatialIndexStaleEntries;
+
+    // Candidate FIDs of the current spatially filtered read.
+    std::vector<GIntBig> m_anFilteredFIDs;
+    size_t              m_iNextFilteredFID;
+    bool                m_bFilteredFIDsValid;
+
     // Only use it in the lifetime of a function where the list of features
     // doesn't change.
     IOGRMemLayerFeatureIterator* GetIterator();
 
+    OGRFeature         *GetFeatureRef( GIntBig nFeatureId );
+
+    void                DropSpatialIndex();
+    void                BuildSpatialIndex();
+    void                AddToSpatialIndex( OGRFeature *poFeature );
+    void                CollectFilteredFIDs();
+
   public:
                         OGRMemLayer( const char * pszName,
                                      OGRSpatialReference *poSRS,
@@ -62,7 +62,12 @@ OGRMemLayer::OGRMemLayer( const char *pszName, OGRSpatialReference *poSRSIn,
     m_iNextCreateFID(0),
     m_bUpdatable(true),
     m_bAdvertizeUTF8(false),
-    m_bUpdated(false)
+    m_bUpdated(false),
+    m_hSpatialIndex(NULL),
+    m_iSpatialIndexGeomField(-1),
+    m_nSpatialIndexStaleEntries(0),
+    m_iNextFilteredFID(0),
+    m_bFilteredFIDsValid(false)
 {
     m_poFeatureDefn->Reference();
 
@@ -111,6 +116,8 @@ OGRMemLayer::~OGRMemLayer()
         }
     }
 
+    DropSpatialIndex();
+
     if( m_poFeatureDefn )
         m_poFeatureDefn->Release();
 }
@@ -124,6 +131,204 @@ void OGRMemLayer::ResetReading()
 {
     m_iNextReadFID = 0;
     m_oMapFeaturesIter = m_oMapFeatures.begin();
+    m_bFilteredFIDsValid = false;
+}
+
+/************************************************************************/
+/*                          DropSpatialIndex()                          */
+/************************************************************************/
+
+void OGRMemLayer::DropSpatialIndex()
+
+{
+    if( m_hSpatialIndex != NULL )
+        CPLQuadTreeDestroy(m_hSpatialIndex);
+    m_hSpatialIndex = NULL;
+    m_iSpatialIndexGeomField = -1;
+    m_anSpatialIndexFIDs.clear();
+    m_anSpatialIndexOutsideFIDs.clear();
+    m_nSpatialIndexStaleEntries = 0;
+}
+
+/************************************************************************/
+/*                         BuildSpatialIndex()                          */
+/*                                                                      */
+/*      Index the envelopes of the geometries of the spatial filter     */
+/*      field.  The extent of the layer at that time becomes the one    */
+/*      of the quad tree.                                               */
+/************************************************************************/
+
+void OGRMemLayer::BuildSpatialIndex()
+
+{
+    DropSpatialIndex();
+
+    OGREnvelope sExtent;
+    IOGRMemLayerFeatureIterator *poIter = GetIterator();
+    OGRFeature *poFeature = NULL;
+    while( (poFeature = poIter->Next()) != NULL )
+    {
+        OGRGeometry *poGeom = poFeature->GetGeomFieldRef(m_iGeomFieldFilter);
+        if( poGeom == NULL || poGeom->IsEmpty() )
+            continue;
+
+        OGREnvelope sEnvelope;
+        poGeom->getEnvelope(&sEnvelope);
+        if( sEnvelope.MinX <= sEnvelope.MaxX &&
+            sEnvelope.MinY <= sEnvelope.MaxY )
+            sExtent.Merge(sEnvelope);
+    }
+    delete poIter;
+
+    if( !sExtent.IsInit() )
+    {
+        sExtent.MinX = 0.0;
+        sExtent.MinY = 0.0;
+        sExtent.MaxX = 0.0;
+        sExtent.MaxY = 0.0;
+    }
+
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = sExtent.MinX;
+    sGlobalBounds.miny = sExtent.MinY;
+    sGlobalBounds.maxx = sExtent.MaxX;
+    sGlobalBounds.maxy = sExtent.MaxY;
+    m_hSpatialIndex = CPLQuadTreeCreate(&sGlobalBounds, NULL);
+    CPLQuadTreeSetMaxDepth(m_hSpatialIndex,
+        CPLQuadTreeGetAdvisedMaxDepth(
+            static_cast<int>(std::min(m_nFeatureCount,
+                                      static_cast<GIntBig>(INT_MAX)))));
+    m_iSpatialIndexGeomField = m_iGeomFieldFilter;
+    m_sSpatialIndexExtent = sExtent;
+
+    poIter = GetIterator();
+    while( m_hSpatialIndex != NULL && (poFeature = poIter->Next()) != NULL )
+        AddToSpatialIndex(poFeature);
+    delete poIter;
+}
+
+/************************************************************************/
+/*                         AddToSpatialIndex()                          */
+/*                                                                      */
+/*      Geometries that are not within the extent of the quad tree     */
+/*      are kept aside, and are returned by all searches.               */
+/************************************************************************/
+
+void OGRMemLayer::AddToSpatialIndex( OGRFeature *poFeature )
+
+{
+    if( m_hSpatialIndex == NULL )
+        return;
+
+    OGRGeometry *poGeom = poFeature->GetGeomFieldRef(m_iSpatialIndexGeomField);
+    if( poGeom == NULL || poGeom->IsEmpty() )
+        return;
+
+    OGREnvelope sEnvelope;
+    poGeom->getEnvelope(&sEnvelope);
+
+    try
+    {
+        if( sEnvelope.MinX >= m_sSpatialIndexExtent.MinX &&
+            sEnvelope.MinY >= m_sSpatialIndexExtent.MinY &&
+            sEnvelope.MaxX <= m_sSpatialIndexExtent.MaxX &&
+            sEnvelope.MaxY <= m_sSpatialIndexExtent.MaxY )
+        {
+            CPLRectObj sRect;
+            sRect.minx = sEnvelope.MinX;
+            sRect.miny = sEnvelope.MinY;
+            sRect.maxx = sEnvelope.MaxX;
+            sRect.maxy = sEnvelope.MaxY;
+            m_anSpatialIndexFIDs.push_back(poFeature->GetFID());
+            CPLQuadTreeInsertWithBounds(
+                m_hSpatialIndex,
+                reinterpret_cast<void *>(static_cast<GUIntptr_t>(
+                    m_anSpatialIndexFIDs.size() - 1)),
+                &sRect);
+        }
+        else
+        {
+            m_anSpatialIndexOutsideFIDs.push_back(poFeature->GetFID());
+        }
+    }
+    catch( const std::bad_alloc & )
+    {
+        // Searches will fall back to a rebuild of the index.
+        DropSpatialIndex();
+    }
+}
+
+/************************************************************************/
+/*                        CollectFilteredFIDs()                         */
+/*                                                                      */
+/*      Collect, in increasing order, the FIDs of the features whose    */
+/*      geometry envelope may intersect the one of the spatial filter.  */
+/************************************************************************/
+
+void OGRMemLayer::CollectFilteredFIDs()
+
+{
+    m_anFilteredFIDs.clear();
+    m_iNextFilteredFID = 0;
+    m_bFilteredFIDsValid = true;
+
+    // Rebuild the index once the stale entries and the geometries out of
+    // its extent become too numerous.
+    if( m_hSpatialIndex == NULL ||
+        m_iSpatialIndexGeomField != m_iGeomFieldFilter ||
+        m_nSpatialIndexStaleEntries +
+            static_cast<GIntBig>(m_anSpatialIndexOutsideFIDs.size()) >
+            100 + m_nFeatureCount / 4 )
+    {
+        try
+        {
+            BuildSpatialIndex();
+        }
+        catch( const std::bad_alloc & )
+        {
+            DropSpatialIndex();
+        }
+        if( m_hSpatialIndex == NULL )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Cannot build spatial index");
+            return;
+        }
+    }
+
+    CPLRectObj sAoi;
+    sAoi.minx = m_sFilterEnvelope.MinX;
+    sAoi.miny = m_sFilterEnvelope.MinY;
+    sAoi.maxx = m_sFilterEnvelope.MaxX;
+    sAoi.maxy = m_sFilterEnvelope.MaxY;
+
+    int nCount = 0;
+    void **pahEntries = CPLQuadTreeSearch(m_hSpatialIndex, &sAoi, &nCount);
+    try
+    {
+        m_anFilteredFIDs.reserve(nCount + m_anSpatialIndexOutsideFIDs.size());
+        for( int i = 0; i < nCount; i++ )
+        {
+            m_anFilteredFIDs.push_back(m_anSpatialIndexFIDs[
+                static_cast<size_t>(
+                    reinterpret_cast<GUIntptr_t>(pahEntries[i]))]);
+        }
+        m_anFilteredFIDs.insert(m_anFilteredFIDs.end(),
+                                m_anSpatialIndexOutsideFIDs.begin(),
+                                m_anSpatialIndexOutsideFIDs.end());
+    }
+    catch( const std::bad_alloc & )
+    {
+        m_anFilteredFIDs.clear();
+        CPLError(CE_Failure, CPLE_OutOfMemory, "Cannot allocate memory");
+    }
+    CPLFree(pahEntries);
+
+    // A feature rewritten with the same FID may appear several times.
+    std::sort(m_anFilteredFIDs.begin(), m_anFilteredFIDs.end());
+    m_anFilteredFIDs.erase(
+        std::unique(m_anFilteredFIDs.begin(), m_anFilteredFIDs.end()),
+        m_anFilteredFIDs.end());
 }
 
 /************************************************************************/
@@ -133,6 +338,32 @@ void OGRMemLayer::ResetReading()
 OGRFeature *OGRMemLayer::GetNextFeature()
 
 {
+/* -------------------------------------------------------------------- */
+/*      With a spatial filter, only visit the features that the         */
+/*      spatial index reports as candidates.                            */
+/* -------------------------------------------------------------------- */
+    if( m_poFilterGeom != NULL )
+    {
+        if( !m_bFilteredFIDsValid )
+            CollectFilteredFIDs();
+
+        while( m_iNextFilteredFID < m_anFilteredFIDs.size() )
+        {
+            OGRFeature *poFeature =
+                GetFeatureRef(m_anFilteredFIDs[m_iNextFilteredFID++]);
+            if( poFeature != NULL &&
+                FilterGeometry(
+                    poFeature->GetGeomFieldRef(m_iGeomFieldFilter)) &&
+                (m_poAttrQuery == NULL ||
+                 m_poAttrQuery->Evaluate(poFeature)) )
+            {
+                m_nFeaturesRead++;
+                return poFeature->Clone();
+            }
+        }
+        return NULL;
+    }
+
     while( true )
     {
         OGRFeature *poFeature = NULL;
@@ -154,10 +385,7 @@ OGRFeature *OGRMemLayer::GetNextFeature()
             break;
         }
 
-        if( (m_poFilterGeom == NULL ||
-             FilterGeometry(poFeature->GetGeomFieldRef(m_iGeomFieldFilter)) )
-            && (m_poAttrQuery == NULL ||
-                m_poAttrQuery->Evaluate(poFeature)) )
+        if( m_poAttrQuery == NULL || m_poAttrQuery->Evaluate(poFeature) )
         {
             m_nFeaturesRead++;
             return poFeature->Clone();
@@ -187,10 +415,10 @@ OGRErr OGRMemLayer::SetNextByIndex( GIntBig nIndex )
 }
 
 /************************************************************************/
-/*                             GetFeature()                             */
+/*                           GetFeatureRef()                            */
 /************************************************************************/
 
-OGRFeature *OGRMemLayer::GetFeature( GIntBig nFeatureId )
+OGRFeature *OGRMemLayer::GetFeatureRef( GIntBig nFeatureId )
 
 {
     if( nFeatureId < 0 )
@@ -209,6 +437,17 @@ OGRFeature *OGRMemLayer::GetFeature( GIntBig nFeatureId )
         if( oIter != m_oMapFeatures.end() )
             poFeature = oIter->second;
     }
+    return poFeature;
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/************************************************************************/
+
+OGRFeature *OGRMemLayer::GetFeature( GIntBig nFeatureId )
+
+{
+    OGRFeature *poFeature = GetFeatureRef(nFeatureId);
     if( poFeature == NULL )
         return NULL;
 
@@ -333,6 +572,8 @@ OGRErr OGRMemLayer::ISetFeature( OGRFeature *poFeature )
         {
             delete m_papoFeatures[nFID];
             m_papoFeatures[nFID] = NULL;
+            if( m_hSpatialIndex != NULL )
+                m_nSpatialIndexStaleEntries++;
         }
         else
         {
@@ -348,6 +589,8 @@ OGRErr OGRMemLayer::ISetFeature( OGRFeature *poFeature )
         {
             delete oIter->second;
             oIter->second = poFeatureCloned;
+            if( m_hSpatialIndex != NULL )
+                m_nSpatialIndexStaleEntries++;
         }
         else
         {
@@ -376,6 +619,8 @@ OGRErr OGRMemLayer::ISetFeature( OGRFeature *poFeature )
         }
     }
 
+    AddToSpatialIndex(poFeatureCloned);
+
     m_bUpdated = true;
 
     return OGRERR_NONE;
@@ -456,6 +701,9 @@ OGRErr OGRMemLayer::DeleteFeature( GIntBig nFID )
     m_bHasHoles = true;
     --m_nFeatureCount;
 
+    if( m_hSpatialIndex != NULL )
+        m_nSpatialIndexStaleEntries++;
+
     m_bUpdated = true;
 
     return OGRERR_NONE;
@@ -497,7 +745,7 @@ int OGRMemLayer::TestCapability( const char *pszCap )
         return m_poFilterGeom == NULL && m_poAttrQuery == NULL;
 
     else if( EQUAL(pszCap, OLCFastSpatialFilter) )
-        return FALSE;
+        return TRUE;
 
     else if( EQUAL(pszCap, OLCDeleteFeature) )
         return m_bUpdatable;
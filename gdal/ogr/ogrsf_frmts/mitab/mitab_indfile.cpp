@@ -678,6 +678,71 @@ GInt32 TABINDFile::FindNext(int nIndexNumber, GByte *pKeyValue)
     return m_papoIndexRootNodes[nIndexNumber-1]->FindNext(pKeyValue);
 }
 
+/**********************************************************************
+ *                   TABINDFile::GetKeyLength()
+ *
+ * Return the length in bytes of the keys of the specified index, or -1
+ * if the index number is invalid.
+ **********************************************************************/
+int TABINDFile::GetKeyLength(int nIndexNumber)
+{
+    if (ValidateIndexNo(nIndexNumber) != 0)
+        return -1;
+
+    return m_papoIndexRootNodes[nIndexNumber-1]->GetKeyLength();
+}
+
+/**********************************************************************
+ *                   TABINDFile::FindFirstInRange()
+ *
+ * Start a search for all the keys of one of the indexes that are
+ * >= pMinKey and whose first nMaxKeyLength bytes are <= those of pMaxKey.
+ * A NULL pMinKey (resp. pMaxKey) starts at the first (resp. ends at the
+ * last) key of the index.  Passing a key prefix as pMaxKey with its length
+ * as nMaxKeyLength selects all the keys that start with it.
+ *
+ * The keys are the raw keys as returned by BuildKey(), so the ranges
+ * follow the byte order of the encoded keys.  The caller must keep
+ * pMaxKey valid until the end of the search.
+ *
+ * Note that index numbers are positive values starting at 1.
+ *
+ * Return value:
+ *  - the record number of the first key in the range (greater than 0)
+ *  - 0 if no key is in the range
+ *  - or -1 if an error happened
+ **********************************************************************/
+GInt32 TABINDFile::FindFirstInRange(int nIndexNumber, GByte *pMinKey,
+                                    GByte *pMaxKey, int nMaxKeyLength)
+{
+    if (ValidateIndexNo(nIndexNumber) != 0)
+        return -1;
+
+    return m_papoIndexRootNodes[nIndexNumber-1]->FindFirstInRange(
+                                        pMinKey, pMaxKey, nMaxKeyLength);
+}
+
+/**********************************************************************
+ *                   TABINDFile::FindNextInRange()
+ *
+ * Continue the search previously initiated by FindFirstInRange(),
+ * returning the record numbers in the order of the keys.
+ *
+ * Return value:
+ *  - the record number of the next key in the range (greater than 0)
+ *  - 0 if there are no more keys in the range
+ *  - or -1 if an error happened
+ **********************************************************************/
+GInt32 TABINDFile::FindNextInRange(int nIndexNumber,
+                                   GByte *pMaxKey, int nMaxKeyLength)
+{
+    if (ValidateIndexNo(nIndexNumber) != 0)
+        return -1;
+
+    return m_papoIndexRootNodes[nIndexNumber-1]->FindNextInRange(
+                                                pMaxKey, nMaxKeyLength);
+}
+
 /**********************************************************************
  *                   TABINDFile::CreateIndex()
  *
@@ -1358,6 +1423,164 @@ GInt32 TABINDNode::FindNext(GByte *pKeyValue)
     return 0;
 }
 
+/**********************************************************************
+ *                   TABINDNode::ReadEntryInRange()
+ *
+ * Return the record number of the current leaf entry if its key is not
+ * past pMaxKey, following the chain of leaf nodes when the end of the
+ * current node has been reached.
+ *
+ * Return value:
+ *  - the record number (greater than 0)
+ *  - 0 if the end of the range or of the index has been reached
+ *  - or -1 if an error happened
+ **********************************************************************/
+GInt32 TABINDNode::ReadEntryInRange(GByte *pMaxKey, int nMaxKeyLength)
+{
+    while (m_nCurIndexEntry >= m_numEntriesInNode)
+    {
+        if (m_nNextNodePtr <= 0)
+            return 0;
+
+        if (GotoNodePtr(m_nNextNodePtr) != 0)
+            return -1;  // Error happened and has already been reported.
+        m_nCurIndexEntry = 0;
+    }
+
+    if (pMaxKey != NULL)
+    {
+        m_poDataBlock->GotoByteInBlock(12 + m_nCurIndexEntry*(m_nKeyLength+4));
+        if (memcmp(m_poDataBlock->GetCurDataPtr(), pMaxKey,
+                   std::min(nMaxKeyLength, m_nKeyLength)) > 0)
+            return 0;
+    }
+
+    return ReadIndexEntry(m_nCurIndexEntry, NULL);
+}
+
+/**********************************************************************
+ *                   TABINDNode::FindFirstInRange()
+ *
+ * Start a range search in this node and its children: position the search
+ * pointer on the first key >= pMinKey (or on the first key of the index
+ * if pMinKey is NULL).  FindNextInRange() then walks the chain of leaf
+ * nodes in key order until the first key past pMaxKey.
+ *
+ * See TABINDFile::FindFirstInRange() for the meaning of the arguments.
+ *
+ * Return value:
+ *  - the record number of the first key in the range (greater than 0)
+ *  - 0 if no key is in the range
+ *  - or -1 if an error happened
+ **********************************************************************/
+GInt32 TABINDNode::FindFirstInRange(GByte *pMinKey,
+                                    GByte *pMaxKey, int nMaxKeyLength)
+{
+    if (m_poDataBlock == NULL)
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "TABINDNode::Search(): Node has not been initialized yet!");
+        return -1;
+    }
+
+    m_nCurIndexEntry = 0;
+
+    if (m_nSubTreeDepth == 1)
+    {
+        /*-------------------------------------------------------------
+         * Leaf node level... skip the keys < pMinKey.  If they all are,
+         * the first key of the range is at the start of the next node.
+         *------------------------------------------------------------*/
+        while (pMinKey != NULL && m_nCurIndexEntry < m_numEntriesInNode &&
+               IndexKeyCmp(pMinKey, m_nCurIndexEntry) > 0)
+        {
+            m_nCurIndexEntry++;
+        }
+
+        return ReadEntryInRange(pMaxKey, nMaxKeyLength);
+    }
+
+    if (m_numEntriesInNode == 0)
+        return 0;
+
+    /*-----------------------------------------------------------------
+     * Index Node: the key of each entry is the first key of its child
+     * node, so the first key >= pMinKey is in the child of the last
+     * entry whose key is < pMinKey (with non-unique indexes, keys equal
+     * to pMinKey can be at the end of that child), or in the first child.
+     *----------------------------------------------------------------*/
+    while (pMinKey != NULL && m_nCurIndexEntry+1 < m_numEntriesInNode &&
+           IndexKeyCmp(pMinKey, m_nCurIndexEntry+1) > 0)
+    {
+        m_nCurIndexEntry++;
+    }
+
+    const int nChildNodePtr = ReadIndexEntry(m_nCurIndexEntry, NULL);
+    if (nChildNodePtr == 0)
+    {
+        /* Invalid child node??? */
+        return 0;
+    }
+    else if (m_poCurChildNode == NULL)
+    {
+        m_poCurChildNode = new TABINDNode(m_eAccessMode);
+        if ( m_poCurChildNode->InitNode(m_fp, nChildNodePtr,
+                                        m_nKeyLength,
+                                        m_nSubTreeDepth-1,
+                                        m_bUnique,
+                                        m_poBlockManagerRef,
+                                        this) != 0 ||
+             m_poCurChildNode->SetFieldType(m_eFieldType)!=0)
+        {
+            // An error happened... and was already reported
+            return -1;
+        }
+    }
+
+    if (m_poCurChildNode->GotoNodePtr(nChildNodePtr) != 0)
+    {
+        // An error happened and has already been reported
+        return -1;
+    }
+
+    return m_poCurChildNode->FindFirstInRange(pMinKey, pMaxKey,
+                                              nMaxKeyLength);
+}
+
+/**********************************************************************
+ *                   TABINDNode::FindNextInRange()
+ *
+ * Continue the range search previously started by FindFirstInRange().
+ *
+ * Return value:
+ *  - the record number of the next key in the range (greater than 0)
+ *  - 0 if there are no more keys in the range
+ *  - or -1 if an error happened
+ **********************************************************************/
+GInt32 TABINDNode::FindNextInRange(GByte *pMaxKey, int nMaxKeyLength)
+{
+    if (m_poDataBlock == NULL)
+    {
+        CPLError(CE_Failure, CPLE_AssertionFailed,
+                 "TABINDNode::Search(): Node has not been initialized yet!");
+        return -1;
+    }
+
+    if (m_nSubTreeDepth > 1)
+    {
+        /*-------------------------------------------------------------
+         * Index Node: the search continues in the leaf node chain that
+         * our current child leads to.
+         *------------------------------------------------------------*/
+        if (m_poCurChildNode == NULL)
+            return 0;
+        return m_poCurChildNode->FindNextInRange(pMaxKey, nMaxKeyLength);
+    }
+
+    m_nCurIndexEntry++;
+    return ReadEntryInRange(pMaxKey, nMaxKeyLength);
+}
+
 /**********************************************************************
  *                   TABINDNode::CommitToFile()
  *
@@ -1510,6 +1510,7 @@ class TABINDNode
     int         GotoNodePtr(GInt32 nNewNodePtr);
     GInt32      ReadIndexEntry(int nEntryNo, GByte *pKeyValue);
     int         IndexKeyCmp(GByte *pKeyValue, int nEntryNo);
+    GInt32      ReadEntryInRange(GByte *pMaxKey, int nMaxKeyLength);
 
     int         InsertEntry(GByte *pKeyValue, GInt32 nRecordNo,
                             GBool bInsertAfterCurChild=FALSE,
@@ -1542,6 +1543,9 @@ class TABINDNode
 
     GInt32      FindFirst(GByte *pKeyValue);
     GInt32      FindNext(GByte *pKeyValue);
+    GInt32      FindFirstInRange(GByte *pMinKey,
+                                 GByte *pMaxKey, int nMaxKeyLength);
+    GInt32      FindNextInRange(GByte *pMaxKey, int nMaxKeyLength);
 
     int         CommitToFile();
 
@@ -1607,6 +1611,11 @@ class TABINDFile
     GByte      *BuildKey(int nIndexNumber, double dValue);
     GInt32      FindFirst(int nIndexNumber, GByte *pKeyValue);
     GInt32      FindNext(int nIndexNumber, GByte *pKeyValue);
+    int         GetKeyLength(int nIndexNumber);
+    GInt32      FindFirstInRange(int nIndexNumber, GByte *pMinKey,
+                                 GByte *pMaxKey, int nMaxKeyLength);
+    GInt32      FindNextInRange(int nIndexNumber,
+                                GByte *pMaxKey, int nMaxKeyLength);
 
     int         CreateIndex(TABFieldType eType, int nFieldSize);
     int         AddEntry(int nIndexNumber, GByte *pKeyValue, GInt32 nRecordNo);
@@ -52,6 +52,14 @@ public:
     virtual GIntBig  *GetAllMatches( OGRField *psKey ) = 0;
     virtual GIntBig  *GetAllMatches( OGRField *psKey, GIntBig* panFIDList, int* nFIDCount, int* nLength ) = 0;
 
+    // Range and prefix lookups. They return an OGRNullFID terminated list
+    // of FIDs in key order, that may be a superset of the exact matches,
+    // or NULL if the index cannot answer the query.
+    virtual GIntBig  *GetRangeMatches( OGRField *psMinKey, OGRField *psMaxKey,
+                                       int *pnFIDCount );
+    virtual GIntBig  *GetPrefixMatches( const char *pszPrefix,
+                                        int *pnFIDCount );
+
     virtual OGRErr AddEntry( OGRField *psKey, GIntBig nFID ) = 0;
     virtual OGRErr RemoveEntry( OGRField *psKey, GIntBig nFID ) = 0;
 
@@ -35,6 +35,7 @@
 
 #include "ogrsf_frmts.h"
 #include "cpl_string.h"
+#include "cpl_virtualmem.h"
 
 #include <set>
 #if HAVE_CXX11
@@ -365,6 +366,10 @@ class OGROSMDataSource : public OGRDataSource
 
     bool                bCustomIndexing;
     bool                bCompressNodes;
+    bool                bDenseNodeIndex;
+
+    /* Chunks of the memory-mapped nodes file, in dense node index mode */
+    std::vector<CPLVirtualMem*> apsDenseNodeChunks;
 
     unsigned int        nUnsortedReqIds;
     GIntBig            *panUnsortedReqIds;
@@ -436,6 +441,9 @@ class OGROSMDataSource : public OGRDataSource
     bool                FlushCurrentSectorCompressedCase();
     bool                FlushCurrentSectorNonCompressedCase();
     bool                IndexPointCustom( OSMNode* psNode );
+    bool                IndexPointDense( OSMNode* psNode );
+    LonLat*             GetDenseNodeChunk( int iChunk, bool bCreate );
+    void                FreeDenseNodeChunks();
 
     void                IndexWay(GIntBig nWayID, bool bIsArea,
                                  unsigned int nTags, IndexedKVP* pasTags,
@@ -455,6 +463,10 @@ class OGROSMDataSource : public OGRDataSource
     void                LookupNodesCustom();
     void                LookupNodesCustomCompressedCase();
     void                LookupNodesCustomNonCompressedCase();
+    void                LookupNodesDense();
+    void                LookupNodesDenseRange( unsigned int nStart,
+                                               unsigned int nEnd );
+    static void         LookupNodesDenseJob( void* pData );
 
     unsigned int        LookupWays( std::map< GIntBig, std::pair<int,void*> >& aoMapWays,
                                     OSMRelation* psRelation );
@@ -29,6 +29,7 @@
 #include "cpl_conv.h"
 #include "cpl_multiproc.h"
 #include "cpl_time.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_api.h"
 #include "ogr_osm.h"
 #include "ogr_p.h"
@@ -114,6 +115,22 @@ static int COMPRESS_SIZE_FROM_BYTE( GByte byte_on_size )
     return static_cast<int>(byte_on_size) * 2 + 8;
 }
 
+// In dense node index mode, the coordinates of node nID are stored at offset
+// nID * sizeof(LonLat) of a sparse temporary file, which is memory mapped by
+// chunks of DENSE_NODES_PER_CHUNK nodes (1 GB).
+static const int DENSE_NODES_PER_CHUNK_SHIFT = 27;
+static const GIntBig DENSE_NODES_PER_CHUNK =
+    static_cast<GIntBig>(1) << DENSE_NODES_PER_CHUNK_SHIFT;
+// Limits the size of the sparse file to 8 TB.
+static const GIntBig DENSE_MAX_NODE_ID = static_cast<GIntBig>(1) << 40;
+// Minimum number of nodes looked up by each worker thread.
+static const unsigned int DENSE_MIN_NODES_PER_JOB = 10000;
+
+static bool VALID_ID_FOR_DENSE_INDEXING( GIntBig _id )
+{
+    return _id >= 0 && _id < DENSE_MAX_NODE_ID;
+}
+
 // Max number of features that are accumulated in pasWayFeaturePairs.
 static const int MAX_DELAYED_FEATURES = 75000;
 // Max number of tags that are accumulated in pasAccumulatedTags.
@@ -249,6 +266,7 @@ OGROSMDataSource::OGROSMDataSource() :
     nRelationsProcessed(0),
     bCustomIndexing(true),
     bCompressNodes(false),
+    bDenseNodeIndex(false),
     nUnsortedReqIds(0),
     panUnsortedReqIds(NULL),
     nReqIds(0),
@@ -359,6 +377,7 @@ OGROSMDataSource::~OGROSMDataSource()
         delete psKD;
     }
 
+    FreeDenseNodeChunks();
     if( fpNodes )
         VSIFCloseL(fpNodes);
     if( !osNodesFilename.empty() && bMustUnlinkNodesFile )
@@ -471,7 +490,11 @@ bool OGROSMDataSource::IndexPoint( OSMNode* psNode )
         return true;
 
     if( bCustomIndexing)
+    {
+        if( bDenseNodeIndex )
+            return IndexPointDense(psNode);
         return IndexPointCustom(psNode);
+    }
 
     return IndexPointSQLite(psNode);
 }
@@ -774,6 +797,100 @@ bool OGROSMDataSource::IndexPointCustom(OSMNode* psNode)
     return true;
 }
 
+/************************************************************************/
+/*                          GetDenseNodeChunk()                         */
+/************************************************************************/
+
+LonLat* OGROSMDataSource::GetDenseNodeChunk( int iChunk, bool bCreate )
+{
+    if( iChunk < static_cast<int>(apsDenseNodeChunks.size()) &&
+        apsDenseNodeChunks[iChunk] != NULL )
+    {
+        return static_cast<LonLat*>(
+            CPLVirtualMemGetAddr(apsDenseNodeChunks[iChunk]));
+    }
+    if( !bCreate )
+        return NULL;
+
+    // Grow the sparse file so that the chunk can be mapped.
+    const GIntBig nChunkSize = DENSE_NODES_PER_CHUNK * sizeof(LonLat);
+    const GIntBig nChunkEnd = (iChunk + 1) * nChunkSize;
+    if( nNodesFileSize < nChunkEnd )
+    {
+        if( VSIFTruncateL(fpNodes, static_cast<vsi_l_offset>(nChunkEnd)) != 0 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot extend temporary node file %s : %s",
+                      osNodesFilename.c_str(), VSIStrerror(errno));
+            return NULL;
+        }
+        nNodesFileSize = nChunkEnd;
+    }
+
+    CPLVirtualMem* psVMem = CPLVirtualMemFileMapNew(
+        fpNodes, static_cast<vsi_l_offset>(iChunk * nChunkSize),
+        static_cast<vsi_l_offset>(nChunkSize), VIRTUALMEM_READWRITE,
+        NULL, NULL);
+    if( psVMem == NULL )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Cannot map temporary node file %s. "
+                  "Use OSM_DENSE_NODE_INDEX=NO",
+                  osNodesFilename.c_str() );
+        return NULL;
+    }
+    if( iChunk >= static_cast<int>(apsDenseNodeChunks.size()) )
+        apsDenseNodeChunks.resize(iChunk + 1, NULL);
+    apsDenseNodeChunks[iChunk] = psVMem;
+    return static_cast<LonLat*>(CPLVirtualMemGetAddr(psVMem));
+}
+
+/************************************************************************/
+/*                         FreeDenseNodeChunks()                        */
+/************************************************************************/
+
+void OGROSMDataSource::FreeDenseNodeChunks()
+{
+    for( size_t i = 0; i < apsDenseNodeChunks.size(); i++ )
+    {
+        if( apsDenseNodeChunks[i] != NULL )
+            CPLVirtualMemFree(apsDenseNodeChunks[i]);
+    }
+    apsDenseNodeChunks.clear();
+}
+
+/************************************************************************/
+/*                          IndexPointDense()                           */
+/************************************************************************/
+
+bool OGROSMDataSource::IndexPointDense(OSMNode* psNode)
+{
+    if( !VALID_ID_FOR_DENSE_INDEXING(psNode->nID) )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Unsupported node id value (" CPL_FRMT_GIB
+                  "). Use OSM_DENSE_NODE_INDEX=NO",
+                  psNode->nID);
+        bStopParsing = true;
+        return false;
+    }
+
+    LonLat* pasChunk = GetDenseNodeChunk(
+        static_cast<int>(psNode->nID >> DENSE_NODES_PER_CHUNK_SHIFT), true);
+    if( pasChunk == NULL )
+    {
+        bStopParsing = true;
+        return false;
+    }
+
+    LonLat* psLonLat =
+        &pasChunk[psNode->nID & (DENSE_NODES_PER_CHUNK - 1)];
+    psLonLat->nLon = DBL_TO_INT(psNode->dfLon);
+    psLonLat->nLat = DBL_TO_INT(psNode->dfLat);
+
+    return true;
+}
+
 /************************************************************************/
 /*                             NotifyNodes()                            */
 /************************************************************************/
@@ -859,7 +976,12 @@ static void OGROSMNotifyNodes ( unsigned int nNodes,
 void OGROSMDataSource::LookupNodes( )
 {
     if( bCustomIndexing )
-        LookupNodesCustom();
+    {
+        if( bDenseNodeIndex )
+            LookupNodesDense();
+        else
+            LookupNodesCustom();
+    }
     else
         LookupNodesSQLite();
 
@@ -1349,6 +1471,126 @@ void OGROSMDataSource::LookupNodesCustomNonCompressedCase()
     nReqIds = j;
 }
 
+/************************************************************************/
+/*                           LookupNodesDense()                         */
+/************************************************************************/
+
+namespace {
+typedef struct
+{
+    OGROSMDataSource *poDS;
+    unsigned int      nStart;
+    unsigned int      nEnd;
+} DenseLookupJob;
+}
+
+void OGROSMDataSource::LookupNodesDense()
+{
+    CPLAssert(
+        nUnsortedReqIds <= static_cast<unsigned int>(MAX_ACCUMULATED_NODES));
+
+    nReqIds = 0;
+    for( unsigned int i = 0; i < nUnsortedReqIds; i++ )
+    {
+        if( VALID_ID_FOR_DENSE_INDEXING(panUnsortedReqIds[i]) )
+            panReqIds[nReqIds++] = panUnsortedReqIds[i];
+    }
+
+    // Sorting makes accesses to the mapping mostly sequential.
+    std::sort(panReqIds, panReqIds + nReqIds);
+
+    /* Remove duplicates */
+    unsigned int j = 0;  // Used after for.
+    for( unsigned int i = 0; i < nReqIds; i++)
+    {
+        if( !(i > 0 && panReqIds[i] == panReqIds[i-1]) )
+            panReqIds[j++] = panReqIds[i];
+    }
+    nReqIds = j;
+
+    // Page faults on a planet file that does not fit in RAM are the
+    // bottleneck, so issue them from several threads.
+    CPLWorkerThreadPool* poWTP = OSM_GetWorkerThreadPool(psParser);
+    const unsigned int nJobs = poWTP ?
+        std::min(static_cast<unsigned int>(poWTP->GetThreadCount()),
+                 nReqIds / DENSE_MIN_NODES_PER_JOB) : 0;
+    if( nJobs > 1 )
+    {
+        std::vector<DenseLookupJob> asJobs(nJobs);
+        std::vector<void*> apJobs;
+        for( unsigned int i = 0; i < nJobs; i++ )
+        {
+            asJobs[i].poDS = this;
+            asJobs[i].nStart = static_cast<unsigned int>(
+                static_cast<GUIntBig>(nReqIds) * i / nJobs);
+            asJobs[i].nEnd = static_cast<unsigned int>(
+                static_cast<GUIntBig>(nReqIds) * (i + 1) / nJobs);
+            apJobs.push_back(&asJobs[i]);
+        }
+        poWTP->SubmitJobs(LookupNodesDenseJob, apJobs);
+        poWTP->WaitCompletion();
+    }
+    else
+    {
+        LookupNodesDenseRange(0, nReqIds);
+    }
+
+    /* Remove nodes that have not been found */
+    j = 0;
+    for( unsigned int i = 0; i < nReqIds; i++ )
+    {
+        if( pasLonLatArray[i].nLon || pasLonLatArray[i].nLat )
+        {
+            panReqIds[j] = panReqIds[i];
+            pasLonLatArray[j] = pasLonLatArray[i];
+            j++;
+        }
+    }
+    nReqIds = j;
+}
+
+/************************************************************************/
+/*                        LookupNodesDenseJob()                         */
+/************************************************************************/
+
+void OGROSMDataSource::LookupNodesDenseJob( void* pData )
+{
+    DenseLookupJob* psJob = static_cast<DenseLookupJob*>(pData);
+    psJob->poDS->LookupNodesDenseRange(psJob->nStart, psJob->nEnd);
+}
+
+/************************************************************************/
+/*                       LookupNodesDenseRange()                        */
+/************************************************************************/
+
+void OGROSMDataSource::LookupNodesDenseRange( unsigned int nStart,
+                                              unsigned int nEnd )
+{
+    int iChunkOld = -1;
+    const LonLat* pasChunk = NULL;
+    for( unsigned int i = nStart; i < nEnd; i++ )
+    {
+        const GIntBig id = panReqIds[i];
+        const int iChunk =
+            static_cast<int>(id >> DENSE_NODES_PER_CHUNK_SHIFT);
+        if( iChunk != iChunkOld )
+        {
+            // Only reads apsDenseNodeChunks, so safe from worker threads.
+            pasChunk = GetDenseNodeChunk(iChunk, false);
+            iChunkOld = iChunk;
+        }
+        if( pasChunk != NULL )
+        {
+            pasLonLatArray[i] = pasChunk[id & (DENSE_NODES_PER_CHUNK - 1)];
+        }
+        else
+        {
+            pasLonLatArray[i].nLon = 0;
+            pasLonLatArray[i].nLat = 0;
+        }
+    }
+}
+
 /************************************************************************/
 /*                            WriteVarInt()                             */
 /************************************************************************/
@@ -2811,6 +3053,18 @@ int OGROSMDataSource::Open( const char * pszFilename,
                         CPLGetConfigOption("OSM_COMPRESS_NODES", "NO")));
     if( bCompressNodes )
         CPLDebug("OSM", "Using compression for nodes DB");
+    bDenseNodeIndex = bCustomIndexing && CPLTestBool(CSLFetchNameValueDef(
+            papszOpenOptionsIn, "DENSE_NODE_INDEX",
+                        CPLGetConfigOption("OSM_DENSE_NODE_INDEX", "NO")));
+    if( bDenseNodeIndex &&
+        (sizeof(void*) < 8 || !CPLIsVirtualMemFileMapAvailable()) )
+    {
+        CPLDebug("OSM", "Dense node index requires 64 bit memory mapping. "
+                 "Ignoring it");
+        bDenseNodeIndex = false;
+    }
+    else if( bDenseNodeIndex )
+        CPLDebug("OSM", "Using dense memory-mapped index for nodes");
 
     nLayers = 5;
     papoLayers = static_cast<OGROSMLayer **>(
@@ -2900,7 +3154,33 @@ int OGROSMDataSource::Open( const char * pszFilename,
         nSize = static_cast<GIntBig>(nMaxSizeForInMemoryDBInMB) * 1024 * 1024;
     }
 
-    if( bCustomIndexing )
+    if( bCustomIndexing && bDenseNodeIndex )
+    {
+        pabySector = static_cast<GByte *>(VSI_CALLOC_VERBOSE(1, SECTOR_SIZE));
+
+        if( pabySector == NULL )
+        {
+            return FALSE;
+        }
+
+        // The dense index is a sparse file, sized by the largest node id,
+        // that must be on a real file system to be memory mapped.
+        osNodesFilename = CPLGenerateTempFilename("osm_tmp_dense_nodes");
+        fpNodes = VSIFOpenL(osNodesFilename, "wb+");
+        if( fpNodes == NULL )
+        {
+            return FALSE;
+        }
+
+        const char* pszVal = CPLGetConfigOption("OSM_UNLINK_TMPFILE", "YES");
+        if( EQUAL(pszVal, "YES") )
+        {
+            CPLPushErrorHandler(CPLQuietErrorHandler);
+            bMustUnlinkNodesFile = VSIUnlink( osNodesFilename ) != 0;
+            CPLPopErrorHandler();
+        }
+    }
+    else if( bCustomIndexing )
     {
         pabySector = static_cast<GByte *>(VSI_CALLOC_VERBOSE(1, SECTOR_SIZE));
 
@@ -3833,6 +4113,9 @@ int OGROSMDataSource::MyResetReading()
         nBucketOld = -1;
         nOffInBucketReducedOld = -1;
 
+        // Mappings must not outlive the truncation of the file.
+        FreeDenseNodeChunks();
+
         VSIFSeekL(fpNodes, 0, SEEK_SET);
         VSIFTruncateL(fpNodes, 0);
         nNodesFileSize = 0;
@@ -113,6 +113,7 @@ void RegisterOGROSM()
 "  <Option name='CONFIG_FILE' type='string' description='Configuration filename.'/>"
 "  <Option name='USE_CUSTOM_INDEXING' type='boolean' description='Whether to enable custom indexing.' default='YES'/>"
 "  <Option name='COMPRESS_NODES' type='boolean' description='Whether to compress nodes in temporary DB.' default='NO'/>"
+"  <Option name='DENSE_NODE_INDEX' type='boolean' description='Whether to store nodes in a memory-mapped array indexed by node id.' default='NO'/>"
 "  <Option name='MAX_TMPFILE_SIZE' type='int' description='Maximum size in MB of in-memory temporary file. If it exceeds that value, it will go to disk' default='100'/>"
 "  <Option name='INTERLEAVED_READING' type='boolean' description='Whether to enable interleaved reading.' default='NO'/>"
 "</OpenOptionList>" );
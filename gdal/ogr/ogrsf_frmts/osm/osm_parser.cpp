@@ -2745,6 +2745,15 @@ void OSM_Close(OSMContext* psCtxt)
     VSIFCloseL(psCtxt->fp);
     VSIFree(psCtxt);
 }
+/************************************************************************/
+/*                       OSM_GetWorkerThreadPool()                      */
+/************************************************************************/
+
+CPLWorkerThreadPool* OSM_GetWorkerThreadPool( OSMContext* psCtxt )
+{
+    return psCtxt->poWTP;
+}
+
 /************************************************************************/
 /*                          OSM_ResetReading()                          */
 /************************************************************************/
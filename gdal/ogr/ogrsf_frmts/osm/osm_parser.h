@@ -130,4 +130,12 @@ void OSM_Close( OSMContext* psOSMContext );
 
 CPL_C_END
 
+#ifdef __cplusplus
+class CPLWorkerThreadPool;
+
+/* Pool used to decompress PBF blobs, or NULL. It is idle when the notification */
+/* callbacks are called, so they may use it too. */
+CPLWorkerThreadPool* OSM_GetWorkerThreadPool( OSMContext* psOSMContext );
+#endif
+
 #endif /*  OSM_PARSER_H_INCLUDED */
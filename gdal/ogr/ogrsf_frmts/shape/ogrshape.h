@@ -93,6 +93,28 @@ class OGRShapeGeomFieldDefn CPL_FINAL: public OGRGeomFieldDefn
         const CPLString& GetPrjFilename() const { return osPrjFile; }
 };
 
+/************************************************************************/
+/*                        OGRShapeRawFilterNode                         */
+/*                                                                      */
+/*      Subset of an attribute filter that can be evaluated directly    */
+/*      on the fixed-width DBF record, before any feature is built.     */
+/************************************************************************/
+
+struct OGRShapeRawFilterNode
+{
+    int                 nOperation;      // swq_op
+    int                 iField;          // For comparison operations.
+    OGRFieldType        eFieldType;
+    bool                bCompareAsFloat;
+    std::vector<GIntBig> anValues;
+    std::vector<double> adfValues;
+    std::vector<CPLString> aosValues;
+    std::vector<OGRShapeRawFilterNode> aoChildren; // For AND and OR.
+
+    OGRShapeRawFilterNode() : nOperation(0), iField(-1),
+                              eFieldType(OFTString), bCompareAsFloat(false) {}
+};
+
 /************************************************************************/
 /*                            OGRShapeLayer                             */
 /************************************************************************/
@@ -176,6 +198,14 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
     } NormandyState; /* French joke. "Peut'et' ben que oui, peut'et' ben que non." Sorry :-) */
     NormandyState       m_eNeedRepack;
 
+    OGRShapeRawFilterNode *m_poRawFilter;
+    bool                m_bAttrFilterBeforeGeometry;
+    std::vector<char>   m_abyRawFieldBuffer;
+    void                CompileRawFilter();
+    bool                IsRejectedByRawFilter( int iShapeId );
+    OGRFeature         *FetchShapeFiltered( int iShapeId,
+                                            bool& bAttrFilterEvaluated );
+
   protected:
 
     virtual void        CloseUnderlyingLayer() override;
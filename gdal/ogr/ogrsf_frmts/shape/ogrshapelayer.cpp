@@ -33,6 +33,7 @@
 #include "cpl_string.h"
 #include "cpl_time.h"
 #include "ogr_p.h"
+#include "swq.h"
 
 #include <algorithm>
 
@@ -81,7 +82,9 @@ OGRShapeLayer::OGRShapeLayer( OGRShapeDataSource* poDSIn,
     bCreateSpatialIndexAtClose(false),
     bRewindOnWrite(false),
     m_bAutoRepack(false),
-    m_eNeedRepack(MAYBE)
+    m_eNeedRepack(MAYBE),
+    m_poRawFilter(NULL),
+    m_bAttrFilterBeforeGeometry(false)
 {
     if( hSHP != NULL )
     {
@@ -261,6 +264,8 @@ OGRShapeLayer::~OGRShapeLayer()
     ClearMatchingFIDs();
     ClearSpatialFIDs();
 
+    delete m_poRawFilter;
+
     CPLFree( pszFullName );
 
     if( poFeatureDefn != NULL )
@@ -703,7 +708,313 @@ OGRErr OGRShapeLayer::SetAttributeFilter( const char * pszAttributeFilter )
 {
     ClearMatchingFIDs();
 
-    return OGRLayer::SetAttributeFilter(pszAttributeFilter);
+    const OGRErr eErr = OGRLayer::SetAttributeFilter(pszAttributeFilter);
+    CompileRawFilter();
+    return eErr;
+}
+
+/************************************************************************/
+/*                     OGRShapeCompileRawFilter()                       */
+/*                                                                      */
+/*      Translate the part of the attribute filter made of AND, OR      */
+/*      and comparisons between a field and constants.  The resulting   */
+/*      node is only used to discard records for which the filter is    */
+/*      known to be false, so an AND node may skip the operands that    */
+/*      cannot be translated, but an OR node cannot.                    */
+/************************************************************************/
+
+static bool OGRShapeCompileRawFilter( const swq_expr_node* poNode,
+                                      OGRFeatureDefn* poDefn,
+                                      OGRShapeRawFilterNode& oOut )
+{
+    if( poNode->eNodeType != SNT_OPERATION )
+        return false;
+
+    oOut.nOperation = poNode->nOperation;
+    if( poNode->nOperation == SWQ_AND || poNode->nOperation == SWQ_OR )
+    {
+        for( int i = 0; i < poNode->nSubExprCount; i++ )
+        {
+            OGRShapeRawFilterNode oChild;
+            if( OGRShapeCompileRawFilter(poNode->papoSubExpr[i], poDefn,
+                                         oChild) )
+                oOut.aoChildren.push_back(oChild);
+            else if( poNode->nOperation == SWQ_OR )
+                return false;
+        }
+        return !oOut.aoChildren.empty();
+    }
+
+    if( poNode->nOperation != SWQ_EQ && poNode->nOperation != SWQ_NE &&
+        poNode->nOperation != SWQ_LT && poNode->nOperation != SWQ_LE &&
+        poNode->nOperation != SWQ_GT && poNode->nOperation != SWQ_GE &&
+        poNode->nOperation != SWQ_IN && poNode->nOperation != SWQ_BETWEEN )
+        return false;
+    if( poNode->nSubExprCount < 2 ||
+        (poNode->nOperation == SWQ_BETWEEN && poNode->nSubExprCount != 3) ||
+        (poNode->nOperation != SWQ_IN && poNode->nOperation != SWQ_BETWEEN &&
+         poNode->nSubExprCount != 2) )
+        return false;
+
+    const swq_expr_node* poColumn = poNode->papoSubExpr[0];
+    if( poColumn->eNodeType != SNT_COLUMN || poColumn->table_index != 0 ||
+        poColumn->field_index < 0 ||
+        poColumn->field_index >= poDefn->GetFieldCount() )
+        return false;
+    OGRFieldDefn* poFieldDefn = poDefn->GetFieldDefn(poColumn->field_index);
+    if( poFieldDefn->GetSubType() != OFSTNone )
+        return false;
+    oOut.iField = poColumn->field_index;
+    oOut.eFieldType = poFieldDefn->GetType();
+
+    for( int i = 1; i < poNode->nSubExprCount; i++ )
+    {
+        if( poNode->papoSubExpr[i]->eNodeType != SNT_CONSTANT ||
+            poNode->papoSubExpr[i]->is_null )
+            return false;
+    }
+
+    if( oOut.eFieldType == OFTString )
+    {
+        // Only equality tests, as ordering might be affected by the
+        // recoding of the values.
+        if( poNode->nOperation != SWQ_EQ && poNode->nOperation != SWQ_NE &&
+            poNode->nOperation != SWQ_IN )
+            return false;
+        for( int i = 1; i < poNode->nSubExprCount; i++ )
+        {
+            const swq_expr_node* poConstant = poNode->papoSubExpr[i];
+            if( poConstant->field_type != SWQ_STRING )
+                return false;
+            const char* pszValue = poConstant->string_value;
+            const size_t nLen = strlen(pszValue);
+            // Skip the special handling of timestamps with time zone.
+            if( nLen > 3 && (pszValue[nLen - 3] == ':' ||
+                             strcmp(pszValue + nLen - 3, "+00") == 0) )
+                return false;
+            for( size_t j = 0; j < nLen; j++ )
+            {
+                if( static_cast<unsigned char>(pszValue[j]) >= 0x80 )
+                    return false;
+            }
+            oOut.aosValues.push_back(pszValue);
+        }
+        return true;
+    }
+
+    if( oOut.eFieldType != OFTInteger && oOut.eFieldType != OFTInteger64 &&
+        oOut.eFieldType != OFTReal )
+        return false;
+
+    // Mimic the type promotion rules of swq_op_general.cpp: the comparison
+    // is done on doubles if the field or the first constant is a double,
+    // and only those two operands are converted.
+    oOut.bCompareAsFloat = oOut.eFieldType == OFTReal ||
+                           poNode->papoSubExpr[1]->field_type == SWQ_FLOAT;
+    for( int i = 1; i < poNode->nSubExprCount; i++ )
+    {
+        const swq_expr_node* poConstant = poNode->papoSubExpr[i];
+        const bool bIsFloat = poConstant->field_type == SWQ_FLOAT;
+        if( !bIsFloat && !SWQ_IS_INTEGER(poConstant->field_type) )
+            return false;
+        if( i >= 2 && bIsFloat != oOut.bCompareAsFloat )
+            return false;
+        if( oOut.bCompareAsFloat )
+            oOut.adfValues.push_back(
+                bIsFloat ? poConstant->float_value :
+                           static_cast<double>(poConstant->int_value));
+        else
+            oOut.anValues.push_back(poConstant->int_value);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                  OGRShapeAttrFilterNeedsGeometry()                   */
+/************************************************************************/
+
+static bool OGRShapeAttrFilterNeedsGeometry( const swq_expr_node* poNode,
+                                             int nFieldCount )
+{
+    if( poNode->eNodeType == SNT_COLUMN )
+    {
+        return poNode->table_index != 0 || poNode->field_index < 0 ||
+               (poNode->field_index >= nFieldCount &&
+                poNode->field_index != nFieldCount + SPF_FID);
+    }
+    if( poNode->eNodeType == SNT_OPERATION )
+    {
+        if( poNode->nOperation == SWQ_CUSTOM_FUNC )
+            return true;
+        for( int i = 0; i < poNode->nSubExprCount; i++ )
+        {
+            if( OGRShapeAttrFilterNeedsGeometry(poNode->papoSubExpr[i],
+                                                nFieldCount) )
+                return true;
+        }
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                          CompileRawFilter()                          */
+/************************************************************************/
+
+void OGRShapeLayer::CompileRawFilter()
+{
+    delete m_poRawFilter;
+    m_poRawFilter = NULL;
+    m_bAttrFilterBeforeGeometry = false;
+
+    if( m_poAttrQuery == NULL || hDBF == NULL )
+        return;
+
+    const swq_expr_node* poExpr =
+        static_cast<const swq_expr_node*>(m_poAttrQuery->GetSWQExpr());
+    if( poExpr == NULL )
+        return;
+
+    m_bAttrFilterBeforeGeometry =
+        !OGRShapeAttrFilterNeedsGeometry(poExpr,
+                                         poFeatureDefn->GetFieldCount());
+
+    OGRShapeRawFilterNode* poRawFilter = new OGRShapeRawFilterNode();
+    if( OGRShapeCompileRawFilter(poExpr, poFeatureDefn, *poRawFilter) )
+        m_poRawFilter = poRawFilter;
+    else
+        delete poRawFilter;
+}
+
+/************************************************************************/
+/*                        OGRShapeRawCompare()                          */
+/************************************************************************/
+
+template<class T> static bool OGRShapeRawCompare( int nOperation, T tValue,
+                                                  const std::vector<T>& atRef )
+{
+    switch( nOperation )
+    {
+        case SWQ_EQ: return tValue == atRef[0];
+        case SWQ_NE: return tValue != atRef[0];
+        case SWQ_LT: return tValue < atRef[0];
+        case SWQ_LE: return tValue <= atRef[0];
+        case SWQ_GT: return tValue > atRef[0];
+        case SWQ_GE: return tValue >= atRef[0];
+        case SWQ_BETWEEN: return tValue >= atRef[0] && tValue <= atRef[1];
+        case SWQ_IN:
+            return std::find(atRef.begin(), atRef.end(), tValue) !=
+                   atRef.end();
+        default: break;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                        OGRShapeRawFilterIsFalse()                    */
+/*                                                                      */
+/*      Returns true if the filter is known to be false for the raw     */
+/*      record.  Values are decoded like SHPReadOGRFeature() does.      */
+/*      Comparisons involving a NULL value are false in OGR SQL, so     */
+/*      they need no special treatment.                                 */
+/************************************************************************/
+
+static bool OGRShapeRawFilterIsFalse( const OGRShapeRawFilterNode& oNode,
+                                      DBFHandle hDBF,
+                                      OGRFeatureDefn* poDefn,
+                                      const char* pabyRecord,
+                                      std::vector<char>& abyBuffer )
+{
+    if( oNode.nOperation == SWQ_AND )
+    {
+        for( size_t i = 0; i < oNode.aoChildren.size(); i++ )
+        {
+            if( OGRShapeRawFilterIsFalse(oNode.aoChildren[i], hDBF, poDefn,
+                                         pabyRecord, abyBuffer) )
+                return true;
+        }
+        return false;
+    }
+    if( oNode.nOperation == SWQ_OR )
+    {
+        for( size_t i = 0; i < oNode.aoChildren.size(); i++ )
+        {
+            if( !OGRShapeRawFilterIsFalse(oNode.aoChildren[i], hDBF, poDefn,
+                                          pabyRecord, abyBuffer) )
+                return false;
+        }
+        return true;
+    }
+
+    // The layer definition might have been altered since the compilation.
+    const int iField = oNode.iField;
+    if( iField >= hDBF->nFields || iField >= poDefn->GetFieldCount() ||
+        poDefn->GetFieldDefn(iField)->GetType() != oNode.eFieldType )
+        return false;
+
+    // Same extraction and trimming as DBFReadStringAttribute().
+    const int nWidth = hDBF->panFieldSize[iField];
+    abyBuffer.resize(nWidth + 1);
+    memcpy(&abyBuffer[0], pabyRecord + hDBF->panFieldOffset[iField], nWidth);
+    abyBuffer[nWidth] = '\0';
+    char* pszValue = &abyBuffer[0];
+    while( *pszValue == ' ' )
+        pszValue++;
+    size_t nLen = strlen(pszValue);
+    while( nLen > 0 && pszValue[nLen - 1] == ' ' )
+        pszValue[--nLen] = '\0';
+    if( nLen == 0 )
+        return true;  // NULL value.
+
+    if( oNode.eFieldType == OFTString )
+    {
+        // Non-ASCII values would need to be recoded first.
+        for( size_t i = 0; i < nLen; i++ )
+        {
+            if( static_cast<unsigned char>(pszValue[i]) >= 0x80 )
+                return false;
+        }
+        bool bMatch = false;
+        for( size_t i = 0; !bMatch && i < oNode.aosValues.size(); i++ )
+            bMatch = EQUAL(pszValue, oNode.aosValues[i]);
+        return oNode.nOperation == SWQ_NE ? bMatch : !bMatch;
+    }
+
+    GIntBig nValue = 0;
+    if( oNode.eFieldType == OFTInteger )
+    {
+        const long nVal = strtol(pszValue, NULL, 10);
+        nValue = nVal > INT_MAX ? INT_MAX : nVal < INT_MIN ? INT_MIN : nVal;
+    }
+    else if( oNode.eFieldType == OFTInteger64 )
+    {
+        nValue = CPLAtoGIntBigEx(pszValue, FALSE, NULL);
+    }
+
+    if( oNode.bCompareAsFloat )
+    {
+        const double dfValue = oNode.eFieldType == OFTReal ?
+            CPLStrtod(pszValue, NULL) : static_cast<double>(nValue);
+        return !OGRShapeRawCompare(oNode.nOperation, dfValue,
+                                   oNode.adfValues);
+    }
+    return !OGRShapeRawCompare(oNode.nOperation, nValue, oNode.anValues);
+}
+
+/************************************************************************/
+/*                       IsRejectedByRawFilter()                        */
+/************************************************************************/
+
+bool OGRShapeLayer::IsRejectedByRawFilter( int iShapeId )
+{
+    if( m_poRawFilter == NULL || hDBF == NULL )
+        return false;
+
+    const char* pabyRecord = DBFReadTuple(hDBF, iShapeId);
+    if( pabyRecord == NULL )
+        return false;
+
+    return OGRShapeRawFilterIsFalse(*m_poRawFilter, hDBF, poFeatureDefn,
+                                    pabyRecord, m_abyRawFieldBuffer);
 }
 
 /************************************************************************/
@@ -784,6 +1095,56 @@ OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
     return poFeature;
 }
 
+/************************************************************************/
+/*                         FetchShapeFiltered()                         */
+/*                                                                      */
+/*      Same as FetchShape(), but first discards records rejected by    */
+/*      the attribute filter on the raw DBF record.  When the filter    */
+/*      does not depend on the geometry, and there is no spatial        */
+/*      filter, it is evaluated before reading the geometry.            */
+/************************************************************************/
+
+OGRFeature *OGRShapeLayer::FetchShapeFiltered( int iShapeId,
+                                               bool& bAttrFilterEvaluated )
+
+{
+    bAttrFilterEvaluated = false;
+
+    if( IsRejectedByRawFilter(iShapeId) )
+        return NULL;
+
+    if( m_poAttrQuery == NULL || !m_bAttrFilterBeforeGeometry ||
+        m_poFilterGeom != NULL || hSHP == NULL || hDBF == NULL )
+        return FetchShape(iShapeId);
+
+    OGRFeature *poFeature =
+        SHPReadOGRFeature( NULL, hDBF, poFeatureDefn, iShapeId, NULL,
+                           osEncoding );
+    if( poFeature == NULL )
+        return NULL;
+
+    bAttrFilterEvaluated = true;
+    if( !m_poAttrQuery->Evaluate( poFeature ) )
+    {
+        delete poFeature;
+        return NULL;
+    }
+
+    if( !poFeatureDefn->IsGeometryIgnored() )
+    {
+        OGRFeature *poGeomFeature =
+            SHPReadOGRFeature( hSHP, NULL, poFeatureDefn, iShapeId, NULL,
+                               osEncoding );
+        if( poGeomFeature != NULL )
+        {
+            poFeature->SetGeometryDirectly( poGeomFeature->StealGeometry() );
+            delete poGeomFeature;
+        }
+    }
+
+    return poFeature;
+}
+
 /************************************************************************/
 /*                           GetNextFeature()                           */
 /************************************************************************/
@@ -812,6 +1173,7 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
 
     while( true )
     {
+        bool bAttrFilterEvaluated = false;
         if( panMatchingFIDs != NULL )
         {
             if( panMatchingFIDs[iMatchingFID] == OGRNullFID )
@@ -821,8 +1183,9 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
 
             // Check the shape object's geometry, and if it matches
             // any spatial filter, return it.
-            poFeature =
-                FetchShape(static_cast<int>(panMatchingFIDs[iMatchingFID]));
+            poFeature = FetchShapeFiltered(
+                static_cast<int>(panMatchingFIDs[iMatchingFID]),
+                bAttrFilterEvaluated);
 
             iMatchingFID++;
         }
@@ -840,7 +1203,8 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
                 else if( VSIFEofL(VSI_SHP_GetVSIL(hDBF->fp)) )
                     return NULL;  //* I/O error.
                 else
-                    poFeature = FetchShape(iNextShapeId);
+                    poFeature = FetchShapeFiltered(iNextShapeId,
+                                                   bAttrFilterEvaluated);
             }
             else
                 poFeature = FetchShape(iNextShapeId);
@@ -859,7 +1223,7 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
             m_nFeaturesRead++;
 
             if( (m_poFilterGeom == NULL || FilterGeometry( poGeom ) )
-                && (m_poAttrQuery == NULL ||
+                && (m_poAttrQuery == NULL || bAttrFilterEvaluated ||
                     m_poAttrQuery->Evaluate( poFeature )) )
             {
                 return poFeature;
@@ -1908,6 +2272,10 @@ OGRErr OGRShapeLayer::DeleteField( int iField )
     {
         TruncateDBF();
 
+        // The raw filter refers to fields by their index.
+        delete m_poRawFilter;
+        m_poRawFilter = NULL;
+
         return poFeatureDefn->DeleteFieldDefn( iField );
     }
 
@@ -1940,6 +2308,9 @@ OGRErr OGRShapeLayer::ReorderFields( int* panMap )
 
     if( DBFReorderFields( hDBF, panMap ) )
     {
+        delete m_poRawFilter;
+        m_poRawFilter = NULL;
+
         return poFeatureDefn->ReorderFieldDefns( panMap );
     }
 
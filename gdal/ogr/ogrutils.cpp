@@ -64,6 +64,27 @@ inline bool CPLIsDoubleAnInt(double d)
     return d == static_cast<double>(static_cast<int>(d));
 }
 
+/************************************************************************/
+/*                         OGRPrintDouble()                             */
+/*                                                                      */
+/*      Same as CPLsnprintf() with a "%.<nPrecision><f|g>" format,      */
+/*      but avoids the C library for the common short decimals.         */
+/************************************************************************/
+
+static int OGRPrintDouble( char *pszBuffer, int nBufferLen, double dfVal,
+                           int nPrecision, char chConversionSpecifier )
+{
+    const int nRet = CPLFormatDoubleFast(pszBuffer, nBufferLen, dfVal,
+                                         nPrecision, chConversionSpecifier);
+    if( nRet >= 0 )
+        return nRet;
+
+    char szFormat[16] = {};
+    snprintf(szFormat, sizeof(szFormat),
+             "%%.%d%c", nPrecision, chConversionSpecifier);
+    return CPLsnprintf(pszBuffer, nBufferLen, szFormat, dfVal);
+}
+
 /************************************************************************/
 /*                        OGRFormatDouble()                             */
 /************************************************************************/
@@ -87,11 +108,8 @@ void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
         return;
     }
 
-    char szFormat[16] = {};
-    snprintf(szFormat, sizeof(szFormat),
-             "%%.%d%c", nPrecision, chConversionSpecifier);
-
-    int ret = CPLsnprintf(pszBuffer, nBufferLen, szFormat, dfVal);
+    int ret = OGRPrintDouble(pszBuffer, nBufferLen, dfVal, nPrecision,
+                             chConversionSpecifier);
     // Windows CRT does not conform with C99 and returns -1 when buffer is
     // truncated.
     if( ret >= nBufferLen || ret == -1 )
@@ -175,9 +193,8 @@ void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
             {
                 --nPrecision;
                 ++nTruncations;
-                snprintf(szFormat, sizeof(szFormat),
-                         "%%.%d%c", nPrecision, chConversionSpecifier);
-                CPLsnprintf(pszBuffer, nBufferLen, szFormat, dfVal);
+                OGRPrintDouble(pszBuffer, nBufferLen, dfVal, nPrecision,
+                               chConversionSpecifier);
                 if( chConversionSpecifier == 'g' && strchr(pszBuffer, 'e') )
                     return;
                 continue;
@@ -195,9 +212,8 @@ void OGRFormatDouble( char *pszBuffer, int nBufferLen, double dfVal,
             {
                 --nPrecision;
                 ++nTruncations;
-                snprintf(szFormat, sizeof(szFormat),
-                         "%%.%d%c", nPrecision, chConversionSpecifier);
-                CPLsnprintf(pszBuffer, nBufferLen, szFormat, dfVal);
+                OGRPrintDouble(pszBuffer, nBufferLen, dfVal, nPrecision,
+                               chConversionSpecifier);
                 if( chConversionSpecifier == 'g' && strchr(pszBuffer, 'e') )
                     return;
                 continue;
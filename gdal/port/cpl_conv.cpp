@@ -68,10 +68,12 @@
 #include <unistd.h>
 #endif
 
+#include <atomic>
 #ifdef DEBUG_CONFIG_OPTIONS
 #include <set>
 #endif
 #include <string>
+#include <vector>
 
 #include "cpl_config.h"
 #include "cpl_multiproc.h"
@@ -92,8 +94,30 @@ void OGRAPISPYCPLSetThreadLocalConfigOption(const char*, const char*);
 
 CPL_CVSID("$Id$")
 
+// Writers of the global configuration options are serialized by
+// hConfigMutex. Readers do not take it: the list pointed by
+// g_papszConfigOptions is never modified in place, but replaced by a new
+// list on each change (copy-on-write). Replaced lists and values are
+// retired, and only freed once no reader is active.
 static CPLMutex *hConfigMutex = NULL;
-static volatile char **g_papszConfigOptions = NULL;
+static std::atomic<char **> g_papszConfigOptions(NULL);
+static std::vector<void *> *g_papRetiredConfigOptions = NULL;
+// Above this number of retired pointers, the writer waits for the readers
+// to leave, so that memory stays bounded under constant read activity.
+constexpr size_t MAX_RETIRED_CONFIG_OPTIONS = 1024;
+
+// Number of readers of g_papszConfigOptions, split over several cache
+// lines to avoid contention between threads.
+constexpr int CONFIG_READER_SLOT_COUNT = 16;
+struct CPLConfigReaderSlot
+{
+    std::atomic<int> nCount;
+    char abyPadding[64 - sizeof(std::atomic<int>)];
+};
+static CPLConfigReaderSlot g_asConfigReaders[CONFIG_READER_SLOT_COUNT];
+
+// Incremented each time a global or thread local option is changed.
+static std::atomic<int> g_nConfigOptionsGeneration(0);
 
 // Used by CPLOpenShared() and friends.
 static CPLMutex *hSharedFileMutex = NULL;
@@ -1596,6 +1620,80 @@ static void CPLAccessConfigOption( const char *pszKey, bool bGet )
 }
 #endif
 
+/************************************************************************/
+/*                       CPLGetConfigReaderSlot()                       */
+/************************************************************************/
+
+static std::atomic<int>& CPLGetConfigReaderSlot()
+{
+    const GUIntBig nThreadId = static_cast<GUIntBig>(CPLGetPID());
+    // Fibonacci hashing: thread ids tend to be aligned on large powers of 2.
+    const int iSlot = static_cast<int>(
+        (nThreadId * static_cast<GUIntBig>(0x9E3779B97F4A7C15ULL)) >> 60);
+    return g_asConfigReaders[iSlot % CONFIG_READER_SLOT_COUNT].nCount;
+}
+
+/************************************************************************/
+/*                     CPLFetchGlobalConfigOption()                     */
+/************************************************************************/
+
+/* Lookup in the global options without taking hConfigMutex. */
+static const char *CPLFetchGlobalConfigOption( const char *pszKey )
+{
+    std::atomic<int>& nReaders = CPLGetConfigReaderSlot();
+    ++nReaders;
+    const char *pszResult =
+        CSLFetchNameValue(g_papszConfigOptions.load(), pszKey);
+    --nReaders;
+    return pszResult;
+}
+
+/************************************************************************/
+/*                     CPLPublishConfigOptions()                        */
+/************************************************************************/
+
+/* Must be called with hConfigMutex held. Install papszNew as the global */
+/* option list, and retire the previous list array as well as the entries */
+/* of papszRetiredEntries (which is freed). Retired memory is freed once */
+/* no reader is active, or after waiting for the readers when too much of */
+/* it is pending. */
+static void CPLPublishConfigOptions( char **papszNew,
+                                     char **papszRetiredEntries )
+{
+    if( g_papRetiredConfigOptions == NULL )
+        g_papRetiredConfigOptions = new std::vector<void *>();
+
+    char **papszOld = g_papszConfigOptions.exchange(papszNew);
+    if( papszOld != NULL )
+        g_papRetiredConfigOptions->push_back(papszOld);
+    for( int i = 0;
+         papszRetiredEntries != NULL && papszRetiredEntries[i] != NULL; i++ )
+    {
+        g_papRetiredConfigOptions->push_back(papszRetiredEntries[i]);
+    }
+    CPLFree(papszRetiredEntries);
+    ++g_nConfigOptionsGeneration;
+
+    // A reader entering after the exchange above sees the new list, so if
+    // every slot is observed idle at least once, nobody can still use the
+    // retired memory. Readers hold a slot only during a lookup, so waiting
+    // for them is short.
+    const bool bMustReclaim =
+        g_papRetiredConfigOptions->size() >= MAX_RETIRED_CONFIG_OPTIONS;
+    for( int i = 0; i < CONFIG_READER_SLOT_COUNT; i++ )
+    {
+        while( g_asConfigReaders[i].nCount.load() != 0 )
+        {
+            if( !bMustReclaim )
+                return;
+            CPLSleep(0.0);
+        }
+    }
+    for( size_t i = 0; i < g_papRetiredConfigOptions->size(); i++ )
+        CPLFree((*g_papRetiredConfigOptions)[i]);
+    g_papRetiredConfigOptions->clear();
+}
+
 /************************************************************************/
 /*                         CPLGetConfigOption()                         */
 /************************************************************************/
@@ -1650,12 +1748,7 @@ CPLGetConfigOption( const char *pszKey, const char *pszDefault )
         pszResult = CSLFetchNameValue(papszTLConfigOptions, pszKey);
 
     if( pszResult == NULL )
-    {
-        CPLMutexHolderD(&hConfigMutex);
-
-        pszResult =
-            CSLFetchNameValue(const_cast<char **>(g_papszConfigOptions), pszKey);
-    }
+        pszResult = CPLFetchGlobalConfigOption(pszKey);
 
     if( pszResult == NULL )
         pszResult = getenv(pszKey);
@@ -1684,7 +1777,7 @@ CPLGetConfigOption( const char *pszKey, const char *pszDefault )
 char** CPLGetConfigOptions(void)
 {
     CPLMutexHolderD(&hConfigMutex);
-    return CSLDuplicate(const_cast<char**>(g_papszConfigOptions));
+    return CSLDuplicate(g_papszConfigOptions.load());
 }
 
 /************************************************************************/
@@ -1710,9 +1803,16 @@ char** CPLGetConfigOptions(void)
 void CPLSetConfigOptions(const char* const * papszConfigOptions)
 {
     CPLMutexHolderD(&hConfigMutex);
-    CSLDestroy(const_cast<char**>(g_papszConfigOptions));
-    g_papszConfigOptions = const_cast<volatile char**>(
-            CSLDuplicate(const_cast<char**>(papszConfigOptions)));
+    // All the current entries are retired along with the list.
+    char **papszOld = g_papszConfigOptions.load();
+    const int nCount = CSLCount(papszOld);
+    char **papszOldEntries =
+        static_cast<char **>(CPLMalloc(sizeof(char *) * (nCount + 1)));
+    for( int i = 0; i < nCount; i++ )
+        papszOldEntries[i] = papszOld[i];
+    papszOldEntries[nCount] = NULL;
+    CPLPublishConfigOptions(
+        CSLDuplicate(const_cast<char**>(papszConfigOptions)), papszOldEntries);
 }
 
 /************************************************************************/
@@ -1786,9 +1886,45 @@ CPLSetConfigOption( const char *pszKey, const char *pszValue )
     OGRAPISPYCPLSetConfigOption(pszKey, pszValue);
 #endif
 
-    g_papszConfigOptions = const_cast<volatile char **>(
-        CSLSetNameValue(
-            const_cast<char **>(g_papszConfigOptions), pszKey, pszValue));
+    // Build a new list sharing the unchanged entries with the current one,
+    // as readers might be scanning it concurrently.
+    char **papszOld = g_papszConfigOptions.load();
+    const int nCount = CSLCount(papszOld);
+    const int iIndex = CSLFindName(papszOld, pszKey);
+    if( iIndex < 0 && pszValue == NULL )
+        return;
+
+    char **papszNew =
+        static_cast<char **>(CPLMalloc(sizeof(char *) * (nCount + 2)));
+    int nNewCount = 0;
+    for( int i = 0; i < nCount; i++ )
+    {
+        if( i != iIndex )
+            papszNew[nNewCount++] = papszOld[i];
+        else if( pszValue != NULL )
+            papszNew[nNewCount++] = NULL;  // Filled below.
+    }
+    if( pszValue != NULL )
+    {
+        const size_t nLen = strlen(pszKey) + strlen(pszValue) + 2;
+        char *pszEntry = static_cast<char *>(CPLMalloc(nLen));
+        snprintf(pszEntry, nLen, "%s=%s", pszKey, pszValue);
+        if( iIndex < 0 )
+            papszNew[nNewCount++] = pszEntry;
+        else
+            papszNew[iIndex] = pszEntry;
+    }
+    papszNew[nNewCount] = NULL;
+
+    char **papszRetiredEntries = NULL;
+    if( iIndex >= 0 )
+    {
+        papszRetiredEntries =
+            static_cast<char **>(CPLMalloc(sizeof(char *) * 2));
+        papszRetiredEntries[0] = papszOld[iIndex];
+        papszRetiredEntries[1] = NULL;
+    }
+    CPLPublishConfigOptions(papszNew, papszRetiredEntries);
 }
 
 /************************************************************************/
@@ -1849,6 +1985,7 @@ CPLSetThreadLocalConfigOption( const char *pszKey, const char *pszValue )
 
     CPLSetTLSWithFreeFunc(CTLS_CONFIGOPTIONS, papszTLConfigOptions,
                           CPLSetThreadLocalTLSFreeFunc);
+    ++g_nConfigOptionsGeneration;
 }
 
 /************************************************************************/
@@ -1905,6 +2042,7 @@ void CPLSetThreadLocalConfigOptions(const char* const * papszConfigOptions)
     papszTLConfigOptions = CSLDuplicate(const_cast<char**>(papszConfigOptions));
     CPLSetTLSWithFreeFunc(CTLS_CONFIGOPTIONS, papszTLConfigOptions,
                           CPLSetThreadLocalTLSFreeFunc);
+    ++g_nConfigOptionsGeneration;
 }
 
 /************************************************************************/
@@ -1917,8 +2055,15 @@ void CPL_STDCALL CPLFreeConfig()
     {
         CPLMutexHolderD(&hConfigMutex);
 
-        CSLDestroy(const_cast<char **>(g_papszConfigOptions));
-        g_papszConfigOptions = NULL;
+        CSLDestroy(g_papszConfigOptions.exchange(NULL));
+        if( g_papRetiredConfigOptions != NULL )
+        {
+            for( size_t i = 0; i < g_papRetiredConfigOptions->size(); i++ )
+                CPLFree((*g_papRetiredConfigOptions)[i]);
+            delete g_papRetiredConfigOptions;
+            g_papRetiredConfigOptions = NULL;
+        }
+        ++g_nConfigOptionsGeneration;
 
         int bMemoryError = FALSE;
         char **papszTLConfigOptions = reinterpret_cast<char **>(
@@ -3089,3 +3234,91 @@ CPLConfigOptionSetter::~CPLConfigOptionSetter()
     CPLFree(m_pszKey);
 }
 //! @endcond
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          CPLConfigOptionCache                        */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                         CPLConfigOptionCache()                       */
+/************************************************************************/
+
+/**
+ * Create a cached accessor to a configuration option.
+ *
+ * Get() returns the same value as CPLGetConfigOption(pszKey, pszDefault),
+ * but only does the actual lookup again when a configuration option has
+ * been set since the previous call, or when called from another thread.
+ * This is meant for options read in loops.
+ *
+ * Changes of environment variables after the first call are not taken
+ * into account. An instance must not be used by several threads at the
+ * same time.
+ *
+ * @param pszKey the key of the option.
+ * @param pszDefault the default value (may be NULL).
+ * @since GDAL 2.3
+ */
+CPLConfigOptionCache::CPLConfigOptionCache( const char* pszKey,
+                                            const char* pszDefault ) :
+    m_pszKey(CPLStrdup(pszKey)),
+    m_pszDefault(pszDefault ? CPLStrdup(pszDefault) : NULL),
+    m_pszValue(NULL),
+    m_bValid(false),
+    m_nGeneration(0),
+    m_nThreadId(0)
+{}
+
+/************************************************************************/
+/*                        ~CPLConfigOptionCache()                       */
+/************************************************************************/
+
+CPLConfigOptionCache::~CPLConfigOptionCache()
+{
+    CPLFree(m_pszKey);
+    CPLFree(m_pszDefault);
+    CPLFree(m_pszValue);
+}
+
+/************************************************************************/
+/*                                Get()                                 */
+/************************************************************************/
+
+/**
+ * Return the value of the option.
+ *
+ * The returned string is owned by the object, and is valid until the next
+ * call to Get().
+ */
+const char* CPLConfigOptionCache::Get()
+{
+    const int nGeneration = g_nConfigOptionsGeneration.load();
+    const GIntBig nThreadId = CPLGetPID();
+    if( !m_bValid || nGeneration != m_nGeneration ||
+        nThreadId != m_nThreadId )
+    {
+        // Fetch the generation before the value, so that a concurrent
+        // change results in a new lookup on the next call.
+        CPLFree(m_pszValue);
+        const char* pszValue = CPLGetConfigOption(m_pszKey, m_pszDefault);
+        m_pszValue = pszValue ? CPLStrdup(pszValue) : NULL;
+        m_nGeneration = nGeneration;
+        m_nThreadId = nThreadId;
+        m_bValid = true;
+    }
+    return m_pszValue;
+}
+
+/************************************************************************/
+/*                              GetBool()                               */
+/************************************************************************/
+
+/** Return the value of the option evaluated with CPLTestBool(), or false
+ * if it is not set and there is no default value. */
+bool CPLConfigOptionCache::GetBool()
+{
+    const char* pszValue = Get();
+    return pszValue != NULL && CPLTestBool(pszValue);
+}
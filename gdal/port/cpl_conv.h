@@ -105,6 +105,12 @@ double CPL_DLL CPLStrtodDelim(const char *, char **, char);
 float CPL_DLL CPLStrtof(const char *, char **);
 float CPL_DLL CPLStrtofDelim(const char *, char **, char);
 
+/* -------------------------------------------------------------------- */
+/*      Convert floating point number to ASCII string, "%.Nf"/"%.Ng"    */
+/*      style.  Returns -1 when CPLsnprintf() must be used instead.     */
+/* -------------------------------------------------------------------- */
+int CPL_DLL CPLFormatDoubleFast(char *, size_t, double, int, char);
+
 /* -------------------------------------------------------------------- */
 /*      Convert number to string.  This function is locale agnostic     */
 /*      (i.e. it will support "," or "." regardless of current locale)  */
@@ -354,5 +360,38 @@ private:
 #endif /* def __cplusplus */
 //! @endcond
 
+/* -------------------------------------------------------------------- */
+/*      C++ object for reading a config option in a loop                */
+/* -------------------------------------------------------------------- */
+
+#if defined(__cplusplus) && !defined(CPL_SUPRESS_CPLUSPLUS)
+
+/** Cached accessor to a configuration option, for options read in loops.
+ * @since GDAL 2.3
+ */
+class CPL_DLL CPLConfigOptionCache
+{
+public:
+    CPLConfigOptionCache(const char* pszKey, const char* pszDefault);
+    ~CPLConfigOptionCache();
+
+    const char* Get();
+    bool GetBool();
+
+private:
+    char* m_pszKey;
+    char* m_pszDefault;
+    char* m_pszValue;
+    bool m_bValid;
+    int m_nGeneration;
+    GIntBig m_nThreadId;
+
+    /* Make it non-copyable */
+    CPLConfigOptionCache(const CPLConfigOptionCache&);
+    CPLConfigOptionCache& operator=(const CPLConfigOptionCache&);
+};
+
+#endif /* def __cplusplus */
+
 
 #endif /* ndef CPL_CONV_H_INCLUDED */
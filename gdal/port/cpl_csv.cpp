@@ -44,11 +44,35 @@
 
 CPL_CVSID("$Id$")
 
+/* ==================================================================== */
+/*      The CSVSharedData holds the ingested content of a CSV file:     */
+/*      the raw file buffer with zero terminated lines, the line        */
+/*      pointers and the integer key index.  It is never modified      */
+/*      once built, so it is shared by all the threads of the process   */
+/*      that access the same file, and reference counted by the         */
+/*      per-thread CSVTable structures.                                 */
+/* ==================================================================== */
+typedef struct ctbshared {
+    struct ctbshared *psNext;
+    char       *pszFilename;
+    vsi_l_offset nFileSize;
+    GIntBig     nMTime;
+    int         nRefCount;
+
+    int         nLineCount;
+    char      **papszLines;
+    int        *panLineIndex;
+    char       *pszRawData;
+} CSVSharedData;
+
+static CPLMutex *hCSVSharedMutex = NULL;
+static CSVSharedData *psCSVSharedList = NULL;
+
 /* ==================================================================== */
 /*      The CSVTable is a persistent set of info about an open CSV      */
-/*      table.  While it doesn't currently maintain a record index,     */
-/*      or in-memory copy of the table, it could be changed to do so    */
-/*      in the future.                                                  */
+/*      table.  It holds the per-thread state (current record, file     */
+/*      handle for non ingested tables) and points to the shared        */
+/*      ingested content once the table has been ingested.              */
 /* ==================================================================== */
 typedef struct ctb {
     VSILFILE   *fp;
@@ -61,7 +85,8 @@ typedef struct ctb {
     int         iLastLine;
     bool        bNonUniqueKey;
 
-    /* Cache for whole file */
+    /* Cache for whole file (pointers into psShared) */
+    CSVSharedData *psShared;
     int         nLineCount;
     char      **papszLines;
     int        *panLineIndex;
@@ -80,8 +105,48 @@ static void CSVFreeTLS( void* pData )
     CPLFree(pData);
 }
 
-/* It would likely be better to share this list between threads, but
-   that will require some rework. */
+/************************************************************************/
+/*                          CSVReleaseShared()                          */
+/************************************************************************/
+
+static void CSVReleaseShared( CSVSharedData *psShared )
+{
+    CPLMutexHolderD( &hCSVSharedMutex );
+
+    psShared->nRefCount--;
+    if( psShared->nRefCount > 0 )
+        return;
+
+    CSVSharedData **ppsIter = &psCSVSharedList;
+    while( *ppsIter != NULL && *ppsIter != psShared )
+        ppsIter = &((*ppsIter)->psNext);
+    if( *ppsIter != NULL )
+        *ppsIter = psShared->psNext;
+
+    CPLFree( psShared->pszFilename );
+    CPLFree( psShared->panLineIndex );
+    CPLFree( psShared->pszRawData );
+    CPLFree( psShared->papszLines );
+    CPLFree( psShared );
+}
+
+/************************************************************************/
+/*                       CSVCleanupSharedMutex()                        */
+/************************************************************************/
+
+/* Only to be called at library cleanup time, once all threads are done */
+/* with CSV tables. */
+void CSVCleanupSharedMutex( void )
+{
+    if( hCSVSharedMutex != NULL )
+    {
+        CPLDestroyMutex( hCSVSharedMutex );
+        hCSVSharedMutex = NULL;
+    }
+}
+
+/* The list of opened tables is per thread, but the ingested content of */
+/* the tables is shared between threads. */
 
 /************************************************************************/
 /*                             CSVAccess()                              */
@@ -242,9 +307,8 @@ static void CSVDeaccessInternal( CSVTable **ppsCSVTableList, bool bCanUseTLS,
     CPLFree( psTable->panFieldNamesLength );
     CSLDestroy( psTable->papszRecFields );
     CPLFree( psTable->pszFilename );
-    CPLFree( psTable->panLineIndex );
-    CPLFree( psTable->pszRawData );
-    CPLFree( psTable->papszLines );
+    if( psTable->psShared != NULL )
+        CSVReleaseShared( psTable->psShared );
 
     CPLFree( psTable );
 
@@ -431,55 +495,65 @@ static char *CSVFindNextLine( char *pszThisLine )
 }
 
 /************************************************************************/
-/*                             CSVIngest()                              */
+/*                          CSVIngestShared()                           */
 /*                                                                      */
 /*      Load entire file into memory and setup index if possible.       */
 /************************************************************************/
 
-// TODO(schwehr): Clean up all the casting in CSVIngest.
-static void CSVIngest( CSVTable *psTable )
+// TODO(schwehr): Clean up all the casting in CSVIngestShared.
+static CSVSharedData *CSVIngestShared( VSILFILE *fp, const char *pszFilename )
 
 {
-    if( psTable->pszRawData != NULL )
-        return;
-
 /* -------------------------------------------------------------------- */
 /*      Ingest whole file.                                              */
 /* -------------------------------------------------------------------- */
-    if( VSIFSeekL( psTable->fp, 0, SEEK_END ) != 0 )
+    if( VSIFSeekL( fp, 0, SEEK_END ) != 0 )
     {
         CPLError( CE_Failure, CPLE_FileIO,
                   "Failed using seek end and tell to get file length: %s",
-                  psTable->pszFilename );
-        return;
+                  pszFilename );
+        return NULL;
     }
-    const vsi_l_offset nFileLen = VSIFTellL( psTable->fp );
+    const vsi_l_offset nFileLen = VSIFTellL( fp );
     if( static_cast<long>(nFileLen) == -1 )
     {
         CPLError( CE_Failure, CPLE_FileIO,
                   "Failed using seek end and tell to get file length: %s",
-                  psTable->pszFilename );
-        return;
+                  pszFilename );
+        return NULL;
     }
-    VSIRewindL( psTable->fp );
+    VSIRewindL( fp );
 
-    psTable->pszRawData = static_cast<char *>(
+    CSVSharedData *psShared = static_cast<CSVSharedData *>(
+        VSI_CALLOC_VERBOSE( sizeof(CSVSharedData), 1 ) );
+    if( psShared == NULL )
+        return NULL;
+    psShared->nFileSize = nFileLen;
+
+    psShared->pszRawData = static_cast<char *>(
         VSI_MALLOC_VERBOSE( static_cast<size_t>(nFileLen) + 1) );
-    if( psTable->pszRawData == NULL )
-        return;
-    if( VSIFReadL( psTable->pszRawData, 1,
-                   static_cast<size_t>(nFileLen), psTable->fp )
+    psShared->pszFilename = VSI_STRDUP_VERBOSE( pszFilename );
+    if( psShared->pszRawData == NULL || psShared->pszFilename == NULL )
+    {
+        CPLFree( psShared->pszRawData );
+        CPLFree( psShared->pszFilename );
+        CPLFree( psShared );
+        return NULL;
+    }
+    if( VSIFReadL( psShared->pszRawData, 1,
+                   static_cast<size_t>(nFileLen), fp )
         != static_cast<size_t>(nFileLen) )
     {
-        CPLFree( psTable->pszRawData );
-        psTable->pszRawData = NULL;
+        CPLFree( psShared->pszRawData );
+        CPLFree( psShared->pszFilename );
+        CPLFree( psShared );
 
         CPLError( CE_Failure, CPLE_FileIO, "Read of file %s failed.",
-                  psTable->pszFilename );
-        return;
+                  pszFilename );
+        return NULL;
     }
 
-    psTable->pszRawData[nFileLen] = '\0';
+    psShared->pszRawData[nFileLen] = '\0';
 
 /* -------------------------------------------------------------------- */
 /*      Get count of newlines so we can allocate line array.            */
@@ -487,14 +561,19 @@ static void CSVIngest( CSVTable *psTable )
     int nMaxLineCount = 0;
     for( int i = 0; i < static_cast<int>(nFileLen); i++ )
     {
-        if( psTable->pszRawData[i] == 10 )
+        if( psShared->pszRawData[i] == 10 )
             nMaxLineCount++;
     }
 
-    psTable->papszLines = static_cast<char **>(
+    psShared->papszLines = static_cast<char **>(
         VSI_CALLOC_VERBOSE( sizeof(char*), nMaxLineCount ) );
-    if( psTable->papszLines == NULL )
-        return;
+    if( psShared->papszLines == NULL && nMaxLineCount > 0 )
+    {
+        CPLFree( psShared->pszRawData );
+        CPLFree( psShared->pszFilename );
+        CPLFree( psShared );
+        return NULL;
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Build a list of record pointers into the raw data buffer        */
@@ -502,40 +581,102 @@ static void CSVIngest( CSVTable *psTable )
 /*      strings.                                                        */
 /* -------------------------------------------------------------------- */
     /* skip header line */
-    char *pszThisLine = CSVFindNextLine( psTable->pszRawData );
+    char *pszThisLine = CSVFindNextLine( psShared->pszRawData );
 
     int iLine = 0;
     while( pszThisLine != NULL && iLine < nMaxLineCount )
     {
         if( pszThisLine[0] != '#' )
-            psTable->papszLines[iLine++] = pszThisLine;
+            psShared->papszLines[iLine++] = pszThisLine;
         pszThisLine = CSVFindNextLine( pszThisLine );
     }
 
-    psTable->nLineCount = iLine;
+    psShared->nLineCount = iLine;
 
 /* -------------------------------------------------------------------- */
 /*      Allocate and populate index array.  Ensure they are in          */
 /*      ascending order so that binary searches can be done on the      */
 /*      array.                                                          */
 /* -------------------------------------------------------------------- */
-    psTable->panLineIndex = static_cast<int *>(
-        VSI_MALLOC_VERBOSE( sizeof(int) * psTable->nLineCount ) );
-    if( psTable->panLineIndex == NULL )
+    psShared->panLineIndex = static_cast<int *>(
+        VSI_MALLOC_VERBOSE( sizeof(int) * psShared->nLineCount ) );
+
+    for( int i = 0;
+         psShared->panLineIndex != NULL && i < psShared->nLineCount; i++ )
+    {
+        psShared->panLineIndex[i] = atoi(psShared->papszLines[i]);
+
+        if( i > 0 && psShared->panLineIndex[i] < psShared->panLineIndex[i-1] )
+        {
+            CPLFree( psShared->panLineIndex );
+            psShared->panLineIndex = NULL;
+        }
+    }
+
+    return psShared;
+}
+
+/************************************************************************/
+/*                             CSVIngest()                              */
+/*                                                                      */
+/*      Attach the table to the ingested content of its file, reusing   */
+/*      the one of another thread if the file has not changed since.    */
+/************************************************************************/
+
+static void CSVIngest( CSVTable *psTable )
+
+{
+    if( psTable->pszRawData != NULL )
         return;
 
-    for( int i = 0; i < psTable->nLineCount; i++ )
+    VSIStatBufL sStat;
+    GIntBig nMTime = 0;
+    vsi_l_offset nFileSize = 0;
+    bool bHasStat = false;
+    if( VSIStatL( psTable->pszFilename, &sStat ) == 0 )
+    {
+        bHasStat = true;
+        nMTime = static_cast<GIntBig>(sStat.st_mtime);
+        nFileSize = static_cast<vsi_l_offset>(sStat.st_size);
+    }
+
+    CSVSharedData *psShared = NULL;
     {
-        psTable->panLineIndex[i] = atoi(psTable->papszLines[i]);
+        CPLMutexHolderD( &hCSVSharedMutex );
 
-        if( i > 0 && psTable->panLineIndex[i] < psTable->panLineIndex[i-1] )
+        for( psShared = bHasStat ? psCSVSharedList : NULL;
+             psShared != NULL;
+             psShared = psShared->psNext )
         {
-            CPLFree( psTable->panLineIndex );
-            psTable->panLineIndex = NULL;
-            break;
+            if( strcmp(psShared->pszFilename, psTable->pszFilename) == 0
+                && psShared->nFileSize == nFileSize
+                && psShared->nMTime == nMTime )
+            {
+                break;
+            }
+        }
+
+        if( psShared == NULL )
+        {
+            psShared = CSVIngestShared( psTable->fp, psTable->pszFilename );
+            if( psShared == NULL )
+                return;
+            psShared->nMTime = nMTime;
+            if( bHasStat )
+            {
+                psShared->psNext = psCSVSharedList;
+                psCSVSharedList = psShared;
+            }
         }
+
+        psShared->nRefCount++;
     }
 
+    psTable->psShared = psShared;
+    psTable->pszRawData = psShared->pszRawData;
+    psTable->papszLines = psShared->papszLines;
+    psTable->nLineCount = psShared->nLineCount;
+    psTable->panLineIndex = psShared->panLineIndex;
     psTable->iLastLine = -1;
 
 /* -------------------------------------------------------------------- */
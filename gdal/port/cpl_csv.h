@@ -67,6 +67,9 @@ int CPL_DLL CSVGetFieldIdL( VSILFILE *, const char * );
 int CPL_DLL CSVGetFileFieldId( const char *, const char * );
 
 void CPL_DLL CSVDeaccess( const char * );
+/*! @cond Doxygen_Suppress */
+void CPL_DLL CSVCleanupSharedMutex( void );
+/*! @endcond */
 
 const char CPL_DLL *CSVGetField( const char *, const char *, const char *,
                                  CSVCompareCriteria, const char * );
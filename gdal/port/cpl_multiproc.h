@@ -214,6 +214,7 @@ class CPL_DLL CPLLockHolder
 #define CTLS_CONFIGOPTIONS              14         /* cpl_conv.cpp */
 #define CTLS_FINDFILE                   15         /* cpl_findfile.cpp */
 #define CTLS_VSIERRORCONTEXT            16         /* cpl_vsi_error.cpp */
+#define CTLS_DISABLEDIRTYBLOCKFLUSH     17         /* gdalrasterblock.cpp */
 
 #define CTLS_MAX                        32
 
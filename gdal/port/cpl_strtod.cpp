@@ -30,8 +30,10 @@
 #include "cpl_port.h"
 #include "cpl_conv.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <clocale>
+#include <cmath>
 #include <cstring>
 #include <cstdlib>
 #include <limits>
@@ -207,6 +209,139 @@ static char* CPLReplacePointByLocalePoint( const char* pszNumber, char point )
     return const_cast<char*>( pszNumber );
 }
 
+/************************************************************************/
+/*                           CPLPowersOf10                              */
+/************************************************************************/
+
+// Powers of ten that are exactly representable as doubles.
+static const double adfCPLPowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int nCPLMaxExactPowerOf10 = 22;
+
+// 2^53: integers up to this value are exactly representable as doubles.
+static const GUIntBig nCPLMaxExactMantissa =
+    static_cast<GUIntBig>(1) << 53;
+
+/************************************************************************/
+/*                          CPLStrtodFastPath()                         */
+/*                                                                      */
+/*      Parse the common "[-+]ddd[.ddd][e[-+]dd]" forms without         */
+/*      going through the C library.  When the decimal mantissa fits    */
+/*      in 53 bits and the decimal exponent in [-22,22], a single       */
+/*      multiplication or division of two exact doubles gives the       */
+/*      correctly rounded result (Clinger's fast path), so the value    */
+/*      is identical to what strtod() would return.  Anything else      */
+/*      (hexadecimal, inf/nan, long mantissas, large exponents) is      */
+/*      left to strtod().                                               */
+/************************************************************************/
+
+static bool CPLStrtodFastPath( const char *nptr, char **endptr, char point,
+                               double *pdfValue )
+{
+    const char* pszIter = nptr;
+    bool bNegative = false;
+    if( *pszIter == '-' )
+    {
+        bNegative = true;
+        pszIter++;
+    }
+    else if( *pszIter == '+' )
+    {
+        pszIter++;
+    }
+
+    // Leave hexadecimal numbers to strtod().
+    if( pszIter[0] == '0' && (pszIter[1] == 'x' || pszIter[1] == 'X') )
+        return false;
+
+    GUIntBig nMantissa = 0;
+    int nDigits = 0;
+    int nExponent = 0;
+    const char* pszDigitsStart = pszIter;
+    while( *pszIter >= '0' && *pszIter <= '9' )
+    {
+        if( nMantissa != 0 || *pszIter != '0' )
+        {
+            if( ++nDigits > 19 )
+                return false;
+            nMantissa = nMantissa * 10 + (*pszIter - '0');
+        }
+        pszIter++;
+    }
+    bool bHasDigits = pszIter != pszDigitsStart;
+    if( *pszIter == point )
+    {
+        pszIter++;
+        const char* pszFractionStart = pszIter;
+        while( *pszIter >= '0' && *pszIter <= '9' )
+        {
+            if( nMantissa != 0 || *pszIter != '0' )
+            {
+                if( ++nDigits > 19 )
+                    return false;
+                nMantissa = nMantissa * 10 + (*pszIter - '0');
+            }
+            nExponent--;
+            pszIter++;
+        }
+        bHasDigits |= pszIter != pszFractionStart;
+    }
+    if( !bHasDigits )
+        return false;
+
+    if( *pszIter == 'e' || *pszIter == 'E' )
+    {
+        const char* pszExp = pszIter + 1;
+        bool bNegativeExp = false;
+        if( *pszExp == '-' )
+        {
+            bNegativeExp = true;
+            pszExp++;
+        }
+        else if( *pszExp == '+' )
+        {
+            pszExp++;
+        }
+        // Without digits, the 'e' is not part of the number.
+        if( *pszExp >= '0' && *pszExp <= '9' )
+        {
+            int nExplicitExp = 0;
+            while( *pszExp >= '0' && *pszExp <= '9' )
+            {
+                if( nExplicitExp > 10000 )
+                    return false;
+                nExplicitExp = nExplicitExp * 10 + (*pszExp - '0');
+                pszExp++;
+            }
+            nExponent += bNegativeExp ? -nExplicitExp : nExplicitExp;
+            pszIter = pszExp;
+        }
+    }
+
+    double dfValue = 0.0;
+    if( nMantissa != 0 )
+    {
+        if( nMantissa > nCPLMaxExactMantissa ||
+            nExponent < -nCPLMaxExactPowerOf10 ||
+            nExponent > nCPLMaxExactPowerOf10 )
+        {
+            return false;
+        }
+        dfValue = static_cast<double>(nMantissa);
+        if( nExponent < 0 )
+            dfValue /= adfCPLPowersOf10[-nExponent];
+        else
+            dfValue *= adfCPLPowersOf10[nExponent];
+    }
+
+    if( endptr )
+        *endptr = const_cast<char *>(pszIter);
+    *pdfValue = bNegative ? -dfValue : dfValue;
+    return true;
+}
+
 /************************************************************************/
 /*                          CPLStrtodDelim()                            */
 /************************************************************************/
@@ -276,6 +411,10 @@ double CPLStrtodDelim(const char *nptr, char **endptr, char point)
         return std::numeric_limits<double>::quiet_NaN();
     }
 
+    double dfFastValue = 0.0;
+    if( CPLStrtodFastPath(nptr, endptr, point, &dfFastValue) )
+        return dfFastValue;
+
 /* -------------------------------------------------------------------- */
 /*  We are implementing a simple method here: copy the input string     */
 /*  into the temporary buffer, replace the specified decimal delimiter  */
@@ -398,3 +537,226 @@ float CPLStrtof(const char *nptr, char **endptr)
 {
     return CPLStrtofDelim(nptr, endptr, '.');
 }
+
+/************************************************************************/
+/*                        CPLFormatDoubleFast()                         */
+/************************************************************************/
+
+/**
+ * Formats a double the way "%.<nPrecision>f" or "%.<nPrecision>g" would.
+ *
+ * The value is first converted to the shortest decimal that reads back to
+ * the same double (integers are converted directly).  When that decimal
+ * provably gives the same text as CPLsnprintf() with the requested format,
+ * which is the case for the vast majority of coordinates and attribute
+ * values written by OGR drivers, it is emitted without going through the C
+ * library.  Otherwise -1 is returned and the caller is expected to fall
+ * back to CPLsnprintf().
+ *
+ * The decimal point is always '.', regardless of the locale.
+ *
+ * @param pszBuffer Output buffer.
+ * @param nBufferSize Size of pszBuffer, including the nul terminator.
+ * @param dfValue Value to format.
+ * @param nPrecision Precision, as in the printf() format.
+ * @param chConversionSpecifier 'f' or 'g'.
+ *
+ * @return the number of characters written (not counting the nul
+ * terminator), or -1 if the value must be formatted with CPLsnprintf().
+ * @since GDAL 2.3
+ */
+int CPLFormatDoubleFast( char *pszBuffer, size_t nBufferSize, double dfValue,
+                         int nPrecision, char chConversionSpecifier )
+{
+    const bool bFixed = chConversionSpecifier == 'f';
+    if( (!bFixed && chConversionSpecifier != 'g') ||
+        nPrecision < 0 || nPrecision > 40 || !CPLIsFinite(dfValue) )
+    {
+        return -1;
+    }
+    if( !bFixed && nPrecision == 0 )
+        nPrecision = 1;
+
+    char szOut[128] = {};
+    int nLen = 0;
+    if( std::signbit(dfValue) )
+        szOut[nLen++] = '-';
+    const double dfAbs = fabs(dfValue);
+
+    if( dfAbs == 0.0 )
+    {
+        szOut[nLen++] = '0';
+        if( bFixed && nPrecision > 0 )
+        {
+            szOut[nLen++] = '.';
+            for( int i = 0; i < nPrecision; i++ )
+                szOut[nLen++] = '0';
+        }
+    }
+    else
+    {
+/* -------------------------------------------------------------------- */
+/*      Find the decimal nMantissa * 10^-nFracDigits with the fewest    */
+/*      fractional digits that reads back as dfAbs.                     */
+/* -------------------------------------------------------------------- */
+        GUIntBig nMantissa = 0;
+        int nFracDigits = 0;
+        bool bExact = false;
+        if( dfAbs < 9e18 && dfAbs == floor(dfAbs) )
+        {
+            // Fast integer path: the decimal is the exact value.
+            nMantissa = static_cast<GUIntBig>(dfAbs);
+            bExact = true;
+        }
+        else
+        {
+            if( dfAbs >= static_cast<double>(nCPLMaxExactMantissa) )
+                return -1;
+            const int nMaxFracDigits =
+                bFixed ? std::min(nPrecision, nCPLMaxExactPowerOf10)
+                       : nCPLMaxExactPowerOf10;
+            bool bFound = false;
+            for( nFracDigits = 1;
+                 !bFound && nFracDigits <= nMaxFracDigits; nFracDigits++ )
+            {
+                const double dfScaled =
+                    dfAbs * adfCPLPowersOf10[nFracDigits];
+                if( dfScaled + 1 >= static_cast<double>(nCPLMaxExactMantissa) )
+                    break;
+                // The product may be off by one unit, so also try the
+                // neighbours of the rounded value.
+                const GUIntBig nRounded =
+                    static_cast<GUIntBig>(dfScaled + 0.5);
+                const GUIntBig anCandidates[3] =
+                    { nRounded, nRounded - 1, nRounded + 1 };
+                for( int i = 0; i < 3; i++ )
+                {
+                    if( anCandidates[i] != 0 &&
+                        static_cast<double>(anCandidates[i]) /
+                            adfCPLPowersOf10[nFracDigits] == dfAbs )
+                    {
+                        nMantissa = anCandidates[i];
+                        bFound = true;
+                        break;
+                    }
+                }
+            }
+            if( !bFound )
+                return -1;
+            nFracDigits--;
+            // Values such as 0.5 or 1234.25 are exactly decimal: scaling
+            // by 2^nFracDigits gives an integer iff scaling by
+            // 10^nFracDigits does.
+            const double dfScaledBy2 = ldexp(dfAbs, nFracDigits);
+            bExact = dfScaledBy2 == floor(dfScaledBy2);
+        }
+
+        char szDigits[24] = {};
+        int nDigits = 0;
+        {
+            char szReversed[24] = {};
+            GUIntBig nTmp = nMantissa;
+            while( nTmp != 0 )
+            {
+                szReversed[nDigits++] = static_cast<char>('0' + nTmp % 10);
+                nTmp /= 10;
+            }
+            for( int i = 0; i < nDigits; i++ )
+                szDigits[i] = szReversed[nDigits - 1 - i];
+        }
+        // Decimal exponent of the leading digit.
+        const int nExp10 = nDigits - 1 - nFracDigits;
+
+/* -------------------------------------------------------------------- */
+/*      The decimal differs from the exact binary value by at most      */
+/*      half an ULP.  If that is less than half of the last digit       */
+/*      printf() would emit, printf() rounds the exact value to the     */
+/*      same decimal.                                                   */
+/* -------------------------------------------------------------------- */
+        int nSignificant = nDigits;
+        while( szDigits[nSignificant - 1] == '0' )
+            nSignificant--;
+        if( !bFixed && nSignificant > nPrecision )
+            return -1;
+        if( !bExact )
+        {
+            int nBinaryExp = 0;
+            CPL_IGNORE_RET_VAL(frexp(dfAbs, &nBinaryExp));
+            const double dfULP = ldexp(1.0, nBinaryExp - 53);
+            // Power of ten of printf()'s last digit, negated.
+            const int nLastDigitExp =
+                bFixed ? nPrecision : nPrecision - 1 - nExp10;
+            if( nLastDigitExp < 0 || nLastDigitExp > nCPLMaxExactPowerOf10 ||
+                dfULP * adfCPLPowersOf10[nLastDigitExp] >= 0.5 )
+            {
+                return -1;
+            }
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Emit the text.                                                  */
+/* -------------------------------------------------------------------- */
+        if( bFixed )
+        {
+            if( nDigits > nFracDigits )
+            {
+                for( int i = 0; i < nDigits - nFracDigits; i++ )
+                    szOut[nLen++] = szDigits[i];
+            }
+            else
+            {
+                szOut[nLen++] = '0';
+            }
+            if( nPrecision > 0 )
+            {
+                szOut[nLen++] = '.';
+                for( int i = nDigits; i < nFracDigits; i++ )
+                    szOut[nLen++] = '0';
+                for( int i = std::max(0, nDigits - nFracDigits);
+                     i < nDigits; i++ )
+                    szOut[nLen++] = szDigits[i];
+                for( int i = nFracDigits; i < nPrecision; i++ )
+                    szOut[nLen++] = '0';
+            }
+        }
+        else if( nExp10 < -4 || nExp10 >= nPrecision )
+        {
+            szOut[nLen++] = szDigits[0];
+            if( nSignificant > 1 )
+            {
+                szOut[nLen++] = '.';
+                for( int i = 1; i < nSignificant; i++ )
+                    szOut[nLen++] = szDigits[i];
+            }
+            nLen += snprintf(szOut + nLen, sizeof(szOut) - nLen,
+                             "e%c%02d", nExp10 < 0 ? '-' : '+',
+                             std::abs(nExp10));
+        }
+        else if( nExp10 >= 0 )
+        {
+            for( int i = 0; i <= nExp10; i++ )
+                szOut[nLen++] = i < nSignificant ? szDigits[i] : '0';
+            if( nSignificant > nExp10 + 1 )
+            {
+                szOut[nLen++] = '.';
+                for( int i = nExp10 + 1; i < nSignificant; i++ )
+                    szOut[nLen++] = szDigits[i];
+            }
+        }
+        else
+        {
+            szOut[nLen++] = '0';
+            szOut[nLen++] = '.';
+            for( int i = -1; i > nExp10; i-- )
+                szOut[nLen++] = '0';
+            for( int i = 0; i < nSignificant; i++ )
+                szOut[nLen++] = szDigits[i];
+        }
+    }
+
+    if( static_cast<size_t>(nLen) >= nBufferSize )
+        return -1;
+    memcpy(pszBuffer, szOut, nLen);
+    pszBuffer[nLen] = '\0';
+    return nLen;
+}